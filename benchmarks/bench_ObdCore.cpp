@@ -0,0 +1,549 @@
+#include <QtTest/QtTest>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "core/DtcParser.h"
+#include "core/LogCatalog.h"
+#include "core/Metrics.h"
+#include "core/ReadinessParser.h"
+#include "core/ReportGenerator.h"
+#include "core/ScanDiffer.h"
+#include "core/ScanService.h"
+#include "core/Trace.h"
+#include "hardware/SimulatedTransporter.h"
+#include "ui/models/DtcFilterProxyModel.h"
+#include "ui/models/DtcTableModel.h"
+#include "ui/models/LogCatalogModel.h"
+
+// Benchmark suite for obdcore.
+//
+// QBENCHMARK gives the usual QtTest timing output (use "-o file,csv" or
+// "-o file,xml" for tooling). In addition every case is run a fixed number of
+// times with an allocation counter, and the results (ns/op, allocations/op and
+// scan latency percentiles) are written as JSON to $OBDREAD_BENCH_JSON
+// (default: bench_ObdCore.json in the working directory) so releases can be
+// compared.
+
+// --- Allocation counting ---
+//
+// Qt containers allocate through malloc(), so on glibc every heap allocation is
+// counted by wrapping malloc() itself. Elsewhere only operator new is counted.
+
+namespace {
+std::atomic<quint64> g_allocations{0};
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+static const char* const ALLOCATION_COUNTER = "malloc";
+#else
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+static const char* const ALLOCATION_COUNTER = "operator-new";
+#endif
+
+static quint64 allocationCount()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+class BenchObdCore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchParseDtcResponse_data();
+    void benchParseDtcResponse();
+    void benchParseReadinessResponse();
+    void benchDecodeDtc();
+    void benchScanDiff();
+    void benchFleetDiff();
+    void benchFleetReport();
+    void benchDtcFilter();
+    void benchLogCatalogReopen();
+    void benchTraceRecord();
+    void benchMetricsUpdate();
+    void benchConnectAndScan();
+
+private:
+    template <typename Fn>
+    void measure(const QString& name, Fn fn, int iterations = MEASURE_ITERATIONS);
+    bool runConnectAndScan(SimulatedTransporter* transporter, ScanService* scanService);
+
+    DtcParser* m_dtcParser = nullptr;
+    ReadinessParser* m_readinessParser = nullptr;
+    QJsonArray m_results;
+    QJsonObject m_scanResult;
+    int m_sink = 0;
+
+    static constexpr int MEASURE_ITERATIONS = 20000;
+    static constexpr int WARMUP_ITERATIONS = 200;
+    static constexpr int FLEET_ITERATIONS = 20;    // Whole-fleet operations
+    static constexpr int SCAN_RUNS = 200;
+};
+
+void BenchObdCore::initTestCase()
+{
+    // Parser diagnostics would dominate the timings
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    m_dtcParser = new DtcParser(this);
+    m_readinessParser = new ReadinessParser(this);
+}
+
+void BenchObdCore::cleanupTestCase()
+{
+    QJsonObject report;
+    report["suite"] = "bench_ObdCore";
+    report["version"] = OBDREAD_VERSION;
+    report["qtVersion"] = qVersion();
+    report["allocationCounter"] = ALLOCATION_COUNTER;
+    report["benchmarks"] = m_results;
+    report["scan"] = m_scanResult;
+
+    QString path = qEnvironmentVariable("OBDREAD_BENCH_JSON");
+    if (path.isEmpty()) {
+        path = "bench_ObdCore.json";
+    }
+
+    QFile file(path);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    qInfo().noquote() << "Benchmark report written to" << QFileInfo(file).absoluteFilePath();
+}
+
+template <typename Fn>
+void BenchObdCore::measure(const QString& name, Fn fn, int iterations)
+{
+    for (int i = 0; i < qMin(WARMUP_ITERATIONS, iterations); ++i) {
+        fn();
+    }
+
+    const quint64 allocationsBefore = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    const quint64 allocations = allocationCount() - allocationsBefore;
+
+    QJsonObject result;
+    result["name"] = name;
+    result["iterations"] = iterations;
+    result["nsPerOp"] = double(elapsedNs) / iterations;
+    result["allocsPerOp"] = double(allocations) / iterations;
+    m_results.append(result);
+}
+
+void BenchObdCore::benchParseDtcResponse_data()
+{
+    QTest::addColumn<QByteArray>("response");
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("none") << QByteArray("43 00 00 00 00 00 00\r\r>") << 3;
+    QTest::newRow("single") << QByteArray("43 01 33 00 00 00 00\r\r>") << 3;
+    QTest::newRow("three") << QByteArray("43 01 33 01 71 C1 23\r\r>") << 3;
+    QTest::newRow("pending") << QByteArray("47 04 20 00 00 00 00\r\r>") << 7;
+    QTest::newRow("noData") << QByteArray("NO DATA\r\r>") << 3;
+}
+
+void BenchObdCore::benchParseDtcResponse()
+{
+    QFETCH(QByteArray, response);
+    QFETCH(int, mode);
+
+    auto op = [&]() {
+        m_sink += int(m_dtcParser->parseDtcResponse(response, mode).size());
+    };
+    measure(QString("DtcParser::parseDtcResponse/%1").arg(QTest::currentDataTag()), op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchParseReadinessResponse()
+{
+    const QByteArray response("41 01 81 07 65 04\r\r>");
+
+    auto op = [&]() {
+        m_sink += int(m_readinessParser->parseReadinessResponse(response).monitorCount());
+    };
+    measure("ReadinessParser::parseReadinessResponse", op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchDecodeDtc()
+{
+    quint16 raw = 0;
+    auto op = [&]() {
+        m_sink += int(DtcParser::decodeDtc(quint8(raw >> 8), quint8(raw & 0xFF)).size());
+        raw += 0x0133;
+    };
+    measure("DtcParser::decodeDtc", op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchScanDiff()
+{
+    // A typical revisit: one code cleared, one added, one pending code confirmed
+    ScanResult previous;
+    ScanResult current;
+    for (const char* code : {"P0420", "P0133", "P0171", "P0300", "U0100", "C0500"}) {
+        previous.dtcs.append(DtcEntry(code));
+        current.dtcs.append(DtcEntry(code));
+    }
+    previous.dtcs.append(DtcEntry("P0455", DtcStatus::Pending));
+    current.dtcs.append(DtcEntry("P0455"));
+    current.dtcs.removeAt(2);
+    current.dtcs.append(DtcEntry("P0301"));
+    previous.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Incomplete);
+    current.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Complete);
+
+    auto op = [&]() {
+        const ScanDiff diff = ScanDiffer::diff(previous, current);
+        m_sink += int(diff.addedDtcs.size() + diff.changedDtcs.size());
+    };
+    measure("ScanDiffer::diff", op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchFleetDiff()
+{
+    // A fleet revisit: every vehicle clears one of eight codes and gains one
+    const int vehicles = 5000;
+    QVector<ScanResult> previous;
+    QVector<ScanResult> current;
+    previous.reserve(vehicles);
+    current.reserve(vehicles);
+    for (int i = 0; i < vehicles; ++i) {
+        ScanResult before;
+        before.vin = QString("VIN%1").arg(i, 14, 10, QChar('0'));
+        ScanResult after = before;
+        for (int d = 0; d < 8; ++d) {
+            const QString code = QString("P%1").arg(0x0100 + ((i + d * 37) & 0x0FFF), 4, 16, QChar('0')).toUpper();
+            before.dtcs.append(DtcEntry(code, d % 3 == 0 ? DtcStatus::Pending : DtcStatus::Confirmed));
+            if (d != 2) {
+                after.dtcs.append(DtcEntry(code));
+            }
+        }
+        after.dtcs.append(DtcEntry("P0420"));
+        previous.append(before);
+        current.append(after);
+    }
+
+    auto op = [&]() {
+        m_sink += int(ScanDiffer::diffFleet(previous, current).size());
+    };
+    measure(QString("ScanDiffer::diffFleet/%1 vehicles").arg(vehicles), op, FLEET_ITERATIONS);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchFleetReport()
+{
+    const int vehicles = 500;
+    QVector<ScanResult> scans;
+    scans.reserve(vehicles);
+    for (int i = 0; i < vehicles; ++i) {
+        ScanResult scan;
+        scan.vin = QString("VIN%1").arg(i, 14, 10, QChar('0'));
+        for (int d = 0; d < i % 6; ++d) {
+            DtcEntry entry(QString("P0%1").arg(300 + d), d % 2 ? DtcStatus::Pending : DtcStatus::Confirmed);
+            entry.shortText = "Cylinder misfire <detected>";
+            scan.dtcs.append(entry);
+        }
+        scan.milOn = !scan.dtcs.isEmpty();
+        scan.readiness.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+        scan.readiness.setMonitorStatus(Monitor::Catalyst, i % 3 ? MonitorStatus::Complete : MonitorStatus::Incomplete);
+        scans.append(scan);
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto op = [&]() {
+        ReportGenerator generator;
+        m_sink += generator.generate(scans, dir.path()) ? int(generator.writtenFiles().size()) : 0;
+    };
+    measure(QString("ReportGenerator::generate/%1 vehicles (HTML)").arg(vehicles), op, FLEET_ITERATIONS);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchDtcFilter()
+{
+    // 100k codes from 10k vehicles in the Codes tab model
+    static const char* prefixes = "PBCU";
+    static const QStringList modules = {"ECM", "TCM", "ABS", "BCM", "SRS"};
+    const int vehicles = 10000;
+    DtcTableModel model;
+    QRandomGenerator random(9);
+    for (int v = 0; v < vehicles; ++v) {
+        const QString vin = QString("1HGCM8%1A%2").arg(v % 97, 2, 10, QChar('0')).arg(v, 8, 10, QChar('0'));
+        QVector<DtcEntry> dtcs;
+        for (int i = 0; i < 10; ++i) {
+            DtcEntry dtc(QString("%1%2").arg(QChar(prefixes[random.bounded(4)])).arg(random.bounded(800), 4, 10, QChar('0')),
+                         DtcStatus(random.bounded(3)));
+            dtc.module = modules[random.bounded(modules.size())];
+            dtcs.append(dtc);
+        }
+        model.appendDtcs(vin, dtcs, 1700000000000 + qint64(random.bounded(86400)) * 1000);
+    }
+    DtcFilterProxyModel proxy;
+    proxy.setDtcModel(&model);
+
+    // Alternating the order re-sorts every time
+    bool descending = false;
+    auto sortOp = [&]() {
+        descending = !descending;
+        proxy.sort(DtcTableModel::CodeColumn, descending ? Qt::DescendingOrder : Qt::AscendingOrder);
+        m_sink += proxy.rowCount();
+    };
+    measure(QString("DtcTableModel::sort/%1 codes").arg(model.rowCount()), sortOp, FLEET_ITERATIONS);
+
+    // Typing a VIN with the list sorted; one op is one keystroke
+    const QString search = "1HGCM842A";
+    int length = 0;
+    auto keystrokeOp = [&]() {
+        length = length % search.size() + 1;
+        proxy.setTextFilter(search.left(length));
+        m_sink += proxy.rowCount();     // The proxy maps lazily
+    };
+    measure(QString("DtcFilterProxyModel::setTextFilter/%1 codes").arg(model.rowCount()), keystrokeOp,
+            FLEET_ITERATIONS * int(search.size()));
+
+    QBENCHMARK {
+        keystrokeOp();
+    }
+}
+
+void BenchObdCore::benchLogCatalogReopen()
+{
+    // Opening the Logs tab on a 3000-log archive that is already catalogued
+    const int logs = 3000;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logDirectory = dir.filePath("logs");
+    const QString catalogPath = dir.filePath("log-catalog.sqlite");
+    QVERIFY(QDir().mkpath(logDirectory));
+    const QDateTime base(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC);
+    for (int i = 0; i < logs; ++i) {
+        LogMeta meta;
+        meta.id = QString::number(i);
+        meta.timestamp = base.addSecs(qint64(i) * 3600);
+        meta.duration = 600;
+        QFile file(QDir(logDirectory).filePath(QString("log-%1.obdlog").arg(i, 5, 10, QChar('0'))));
+        QVERIFY(file.open(QIODevice::WriteOnly) && LogCatalog::writeHeader(&file, meta));
+    }
+    {
+        LogCatalog catalog(logDirectory, catalogPath);
+        QVERIFY(catalog.open());
+        catalog.waitForScan();
+    }
+
+    // Open, count and the first page, then the background rescan, which
+    // finds nothing to re-read
+    auto op = [&]() {
+        LogCatalog catalog(logDirectory, catalogPath);
+        catalog.open();
+        m_sink += catalog.count() + int(catalog.entries(0, LogCatalogModel::PAGE_SIZE).size());
+        catalog.waitForScan();
+    };
+    measure(QString("LogCatalog reopen/%1 logs").arg(logs), op, FLEET_ITERATIONS);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchTraceRecord()
+{
+    const QByteArray command("01 0C\r");
+    quint32 sequence = 0;
+    auto op = [&]() {
+        OBD_TRACE(Scan, ScanCommandSent, sequence++, Trace::packText(command));
+    };
+    measure("Trace::record", op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchMetricsUpdate()
+{
+    // One command's worth of updates on the scan and transport path
+    qint64 rttNs = 0;
+    auto op = [&]() {
+        Metrics::increment(Metrics::CommandsSent);
+        Metrics::addTransportBytes(Metrics::Tcp, Metrics::Sent, 6);
+        Metrics::addTransportBytes(Metrics::Tcp, Metrics::Received, 17);
+        Metrics::observeCommandRtt(rttNs);
+        rttNs = (rttNs + 7000000) % 3000000000;
+    };
+    measure("Metrics update (per command)", op);
+
+    QBENCHMARK {
+        op();
+    }
+}
+
+void BenchObdCore::benchConnectAndScan()
+{
+    std::vector<qint64> latencies;
+    latencies.reserve(SCAN_RUNS);
+    quint64 allocations = 0;
+
+    for (int run = 0; run < SCAN_RUNS; ++run) {
+        const quint64 allocationsBefore = allocationCount();
+        QElapsedTimer timer;
+        timer.start();
+
+        // A fresh adapter and service per run: the measured path is the full
+        // connect sequence followed by the standard scan.
+        SimulatedTransporter transporter;
+        ScanService scanService(&transporter);
+        QVERIFY(runConnectAndScan(&transporter, &scanService));
+
+        latencies.push_back(timer.nsecsElapsed());
+        allocations += allocationCount() - allocationsBefore;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentileMs = [&](double p) {
+        // Nearest-rank percentile
+        const size_t rank = size_t(std::ceil(p / 100.0 * latencies.size()));
+        return latencies[qBound<size_t>(1, rank, latencies.size()) - 1] / 1e6;
+    };
+    double sumMs = 0.0;
+    for (qint64 ns : latencies) {
+        sumMs += ns / 1e6;
+    }
+
+    m_scanResult["name"] = "ScanService::connect+scan (simulated adapter)";
+    m_scanResult["runs"] = SCAN_RUNS;
+    m_scanResult["p50Ms"] = percentileMs(50.0);
+    m_scanResult["p99Ms"] = percentileMs(99.0);
+    m_scanResult["meanMs"] = sumMs / SCAN_RUNS;
+    m_scanResult["maxMs"] = latencies.back() / 1e6;
+    m_scanResult["allocsPerScan"] = double(allocations) / SCAN_RUNS;
+
+    QBENCHMARK {
+        SimulatedTransporter transporter;
+        ScanService scanService(&transporter);
+        runConnectAndScan(&transporter, &scanService);
+    }
+}
+
+bool BenchObdCore::runConnectAndScan(SimulatedTransporter* transporter, ScanService* scanService)
+{
+    QEventLoop loop;
+    bool ok = false;
+
+    connect(transporter, &ObdTransporter::connected, scanService, &ScanService::startConnection);
+    connect(scanService, &ScanService::connectionComplete, &loop, [scanService]() {
+        QTimer::singleShot(0, scanService, [scanService]() { scanService->startScan(); });
+    });
+    connect(scanService, &ScanService::scanComplete, &loop, [&]() {
+        ok = true;
+        loop.quit();
+    });
+    connect(scanService, &ScanService::connectionFailed, &loop, &QEventLoop::quit);
+    connect(scanService, &ScanService::adapterConnectedNoEcu, &loop, &QEventLoop::quit);
+    connect(scanService, &ScanService::scanFailed, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+
+    transporter->connectToDevice("sim");
+    loop.exec();
+    return ok;
+}
+
+QTEST_GUILESS_MAIN(BenchObdCore)
+#include "bench_ObdCore.moc"
@@ -0,0 +1,243 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMap>
+#include <cstdio>
+#include <memory>
+
+#include "core/AdapterOrchestrator.h"
+#include "core/ReportGenerator.h"
+#include "core/ScanDiffer.h"
+#ifdef OBDREAD_CLI_HISTORY
+#include "core/ScanHistoryStore.h"
+#endif
+#include "core/ScanPlanner.h"
+#include "core/ScanResultJson.h"
+#include "core/Trace.h"
+#include "core/TraceExport.h"
+
+// obdread-cli: headless batch scanner.
+// Connects to every port given on the command line at the same time, each on
+// its own thread, runs the standard scan on each and writes one JSON object per
+// port to stdout.
+
+namespace {
+
+void writeJsonLine(const QJsonObject& json)
+{
+    QByteArray line = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    fwrite(line.constData(), 1, size_t(line.size()), stdout);
+    fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("obdread-cli");
+    QCoreApplication::setApplicationVersion(OBDREAD_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs an OBD-II scan on one or more adapters and prints the results as JSON.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("ports", "Adapter addresses: serial device paths (e.g. /dev/ttyUSB0, COM3) or IP:PORT.",
+                                 "<port> [<port>...]");
+    QCommandLineOption timeoutOption({"t", "timeout"}, "Per-port time limit for connect and scan, in milliseconds.",
+                                     "ms", "30000");
+    QCommandLineOption recipeOption({"r", "recipe"}, "Scan recipe: quick, emissions or full.", "name", "quick");
+    QCommandLineOption prettyOption("pretty", "Print one indented JSON array after all ports finish "
+                                              "instead of one JSON line per port as it finishes.");
+    QCommandLineOption progressOption("progress", "Also print a JSON line for each partial result as replies "
+                                                  "arrive (ignored with --pretty).");
+#ifdef OBDREAD_CLI_HISTORY
+    QCommandLineOption historyOption("history", "SQLite scan history file. Each result is compared with the "
+                                                "previous scan of the same VIN (\"diff\" in the output) and then stored.",
+                                     "file");
+#endif
+    QCommandLineOption reportOption("report", "Also write an HTML (or JSON) report of the completed scans "
+                                              "into this directory: one page per vehicle plus an index.",
+                                    "dir");
+    QCommandLineOption reportFormatOption("report-format", "Report format: html or json.", "format", "html");
+    QCommandLineOption traceOption("trace", "Record the timeline of every command (queue, send, first byte, prompt, "
+                                            "parse) and write it as Chrome trace JSON for chrome://tracing or "
+                                            "ui.perfetto.dev.",
+                                   "file");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Print debug output and, at exit, the command trace to stderr.");
+    parser.addOption(timeoutOption);
+    parser.addOption(recipeOption);
+    parser.addOption(prettyOption);
+    parser.addOption(progressOption);
+#ifdef OBDREAD_CLI_HISTORY
+    parser.addOption(historyOption);
+#endif
+    parser.addOption(reportOption);
+    parser.addOption(reportFormatOption);
+    parser.addOption(traceOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    const QStringList ports = parser.positionalArguments();
+    if (ports.isEmpty()) {
+        fprintf(stderr, "%s\n", qPrintable(parser.helpText()));
+        return 2;
+    }
+
+    bool timeoutOk = false;
+    const int timeoutMs = parser.value(timeoutOption).toInt(&timeoutOk);
+    if (!timeoutOk || timeoutMs <= 0) {
+        fprintf(stderr, "Invalid --timeout value: %s\n", qPrintable(parser.value(timeoutOption)));
+        return 2;
+    }
+
+    bool recipeOk = false;
+    const ScanPlanner::Recipe recipe = ScanPlanner::recipeFromName(parser.value(recipeOption), &recipeOk);
+    if (!recipeOk) {
+        fprintf(stderr, "Unknown --recipe value: %s\n", qPrintable(parser.value(recipeOption)));
+        return 2;
+    }
+
+    const QString reportFormat = parser.value(reportFormatOption).toLower();
+    if (reportFormat != "html" && reportFormat != "json") {
+        fprintf(stderr, "Unknown --report-format value: %s\n", qPrintable(parser.value(reportFormatOption)));
+        return 2;
+    }
+    const QString reportDir = parser.value(reportOption);
+
+    const QString traceFile = parser.value(traceOption);
+    if (!traceFile.isEmpty()) {
+        Trace::setCategoriesEnabled(Trace::enabledCategories() | Trace::Lifecycle);
+    }
+
+    const bool verbose = parser.isSet(verboseOption);
+    const bool pretty = parser.isSet(prettyOption);
+    const bool progress = parser.isSet(progressOption) && !pretty;
+    if (!verbose) {
+        QLoggingCategory::setFilterRules("*.debug=false");
+    }
+
+#ifdef OBDREAD_CLI_HISTORY
+    std::unique_ptr<ScanHistoryStore> history;
+    if (parser.isSet(historyOption)) {
+        history.reset(new ScanHistoryStore(parser.value(historyOption)));
+        if (!history->open()) {
+            fprintf(stderr, "Cannot open --history file: %s\n", qPrintable(history->lastError()));
+            return 2;
+        }
+    }
+#endif
+
+    // Every port gets its own worker thread with its own transporter and scan
+    // service, so a slow vehicle never blocks the others
+    AdapterOrchestrator orchestrator;
+    QHash<int, QElapsedTimer> started;      // Job id -> submit time, for progress lines
+    QMap<int, ScanResult> completed;        // Job id (command-line order) -> completed scan
+    int failures = 0;
+    QJsonArray collected;
+
+    if (progress) {
+        QObject::connect(&orchestrator, &AdapterOrchestrator::progress, &app,
+                         [&](int jobId, const QString& port, const ScanResult& partial, quint32 changedItems) {
+            QJsonObject json;
+            json["port"] = port;
+            json["event"] = "partial";
+            json["elapsedMs"] = started.value(jobId).elapsed();
+            json["changed"] = QJsonArray::fromStringList(ScanPlanner::itemNames(changedItems));
+            json["result"] = ScanResultJson::toJson(partial);
+            writeJsonLine(json);
+        });
+    }
+
+    QObject::connect(&orchestrator, &AdapterOrchestrator::resultReady, &app,
+                     [&](const AdapterOrchestrator::Result& finished) {
+        QJsonObject json;
+        json["port"] = finished.port;
+        json["recipe"] = ScanPlanner::recipeName(recipe);
+        json["ok"] = finished.ok;
+        json["elapsedMs"] = finished.elapsedMs;
+        if (!finished.protocol.isEmpty()) {
+            json["protocol"] = finished.protocol;
+            QJsonObject planJson;
+            planJson["commands"] = finished.plannedCommands;
+            planJson["estimatedBusMs"] = finished.estimatedBusMs;
+            json["plan"] = planJson;
+        }
+        if (!finished.error.isEmpty()) {
+            json["error"] = finished.error;
+        }
+        if (finished.hasResult) {
+            json["result"] = finished.json;
+            completed.insert(finished.jobId, finished.result);
+#ifdef OBDREAD_CLI_HISTORY
+            if (history && !finished.result.vin.isEmpty()) {
+                const QVector<ScanResult> previous = history->scansForVehicle(finished.result.vin, 1);
+                const ScanDiff diff = previous.isEmpty() ? ScanDiffer::withoutBaseline(finished.result)
+                                                         : ScanDiffer::diff(previous.first(), finished.result);
+                json["diff"] = ScanResultJson::toJson(diff);
+                history->record(finished.result);
+            }
+#endif
+        } else if (finished.hasPartial) {
+            // Keep whatever was read before the failure
+            json["result"] = finished.json;
+        }
+
+        if (!finished.ok) {
+            ++failures;
+        }
+        if (pretty) {
+            collected.append(json);
+        } else {
+            writeJsonLine(json);
+        }
+    });
+
+    QObject::connect(&orchestrator, &AdapterOrchestrator::idle, &app, [&]() {
+        if (pretty) {
+            const QByteArray document = QJsonDocument(collected).toJson(QJsonDocument::Indented);
+            fwrite(document.constData(), 1, size_t(document.size()), stdout);
+            fflush(stdout);
+        }
+        if (!reportDir.isEmpty()) {
+            // Pages follow the order of the ports on the command line
+            const QVector<ScanResult> scans(completed.cbegin(), completed.cend());
+            ReportGenerator report(reportFormat == "json" ? ReportGenerator::Json : ReportGenerator::Html);
+            if (!report.generate(scans, reportDir)) {
+                fprintf(stderr, "Report failed: %s\n", qPrintable(report.lastError()));
+                ++failures;
+            }
+        }
+        if (!traceFile.isEmpty()) {
+            QString traceError;
+            if (!TraceExport::writeChromeJson(traceFile, &traceError)) {
+                fprintf(stderr, "Trace export failed: %s\n", qPrintable(traceError));
+                ++failures;
+            }
+        }
+        if (verbose) {
+            // Commands, replies and transport events of every port, formatted only now
+            for (const QString& line : Trace::formatAll()) {
+                fprintf(stderr, "%s\n", qPrintable(line));
+            }
+        }
+        app.exit(failures == 0 ? 0 : 1);
+    });
+
+    for (const QString& port : ports) {
+        AdapterOrchestrator::Job job;
+        job.type = AdapterOrchestrator::Job::Scan;
+        job.port = port;
+        job.recipe = recipe;
+        job.timeoutMs = timeoutMs;
+        started[orchestrator.submit(job)].start();
+    }
+
+    return app.exec();
+}
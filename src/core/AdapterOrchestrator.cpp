@@ -0,0 +1,394 @@
+#include "AdapterOrchestrator.h"
+#include "ScanResultJson.h"
+#include "ScanService.h"
+#include "hardware/ObdTransporter.h"
+#include "hardware/TransporterFactory.h"
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QThread>
+#include <QTimer>
+
+/**
+ * @brief One port's transporter and ScanService, living on the port's thread.
+ * Everything below runs on that thread; the orchestrator only posts events to it.
+ */
+class AdapterWorker : public QObject
+{
+public:
+    AdapterWorker(const QString& port, AdapterOrchestrator* orchestrator,
+                  AdapterOrchestrator::TransporterCreator creator)
+        : m_port(port)
+        , m_orchestrator(orchestrator)
+        , m_creator(std::move(creator))
+    {
+    }
+
+    void enqueue(int jobId, const AdapterOrchestrator::Job& job)
+    {
+        m_queue.enqueue({jobId, job});
+        startNext();
+    }
+
+    void cancelAll()
+    {
+        while (!m_queue.isEmpty()) {
+            const QueuedJob queued = m_queue.dequeue();
+            AdapterOrchestrator::Result result;
+            result.jobId = queued.id;
+            result.type = queued.job.type;
+            result.port = m_port;
+            result.error = "Cancelled";
+            m_orchestrator->postProcess(result);
+        }
+        fail("Cancelled");
+    }
+
+    void stop()
+    {
+        m_queue.clear();
+        m_busy = false;
+        if (m_scanService) {
+            m_deadline->stop();
+            m_streamTimer->stop();
+            m_scanService->cancel();
+            m_transporter->disconnectFromDevice();
+            QObject::disconnect(m_transporter, nullptr, this, nullptr);
+        }
+    }
+
+private:
+    struct QueuedJob {
+        int id = 0;
+        AdapterOrchestrator::Job job;
+    };
+
+    void setUp()
+    {
+        m_transporter = m_creator(m_port, this);
+        m_scanService = new ScanService(m_transporter, this);
+        m_deadline = new QTimer(this);
+        m_deadline->setSingleShot(true);
+        m_streamTimer = new QTimer(this);
+        m_streamTimer->setSingleShot(true);
+
+        connect(m_transporter, &ObdTransporter::connected, m_scanService, &ScanService::startConnection);
+        connect(m_transporter, &ObdTransporter::errorOccurred, this, [this](const QString& errorMsg) {
+            fail(errorMsg);
+        });
+        connect(m_transporter, &ObdTransporter::disconnected, this, [this]() {
+            m_ecuReady = false;
+            fail("Adapter disconnected");
+        });
+        connect(m_scanService, &ScanService::connectionComplete, this, [this](const QString& protocolName) {
+            m_ecuReady = true;
+            m_protocol = protocolName;
+            if (m_job.type == AdapterOrchestrator::Job::Connect) {
+                AdapterOrchestrator::Result result = baseResult();
+                result.ok = true;
+                finish(result);
+            } else {
+                // Let the connection sequence unwind before starting the scan
+                QTimer::singleShot(0, this, [this]() { startScan(); });
+            }
+        });
+        connect(m_scanService, &ScanService::connectionFailed, this, [this](const QString& errorMessage) {
+            fail(errorMessage);
+        });
+        connect(m_scanService, &ScanService::adapterConnectedNoEcu, this, [this]() {
+            fail("Adapter connected but ECU not responding");
+        });
+        connect(m_scanService, &ScanService::scanUpdated, this, [this](const ScanResult& partial, quint32 changedItems) {
+            m_partial = partial;
+            m_hasPartial = true;
+            m_orchestrator->postProgress(m_jobId, m_port, partial, changedItems);
+        });
+        connect(m_scanService, &ScanService::scanComplete, this, [this](const ScanResult& scan) {
+            onScanComplete(scan);
+        });
+        connect(m_scanService, &ScanService::scanFailed, this, [this](const QString& errorMessage) {
+            fail(errorMessage);
+        });
+        connect(m_deadline, &QTimer::timeout, this, [this]() { fail("Timed out"); });
+        connect(m_streamTimer, &QTimer::timeout, this, [this]() {
+            m_elapsed.start();
+            m_deadline->start(m_job.timeoutMs);
+            startScan();
+        });
+    }
+
+    void startNext()
+    {
+        if (m_busy || m_queue.isEmpty()) {
+            return;
+        }
+        if (!m_scanService) {
+            setUp();
+        }
+
+        const QueuedJob next = m_queue.dequeue();
+        m_jobId = next.id;
+        m_job = next.job;
+        m_iteration = 0;
+        m_partial = ScanResult();
+        m_hasPartial = false;
+        m_plannedCommands = 0;
+        m_estimatedBusMs = 0;
+        m_busy = true;
+        m_elapsed.start();
+        m_deadline->start(m_job.timeoutMs);
+
+        // A previous job on this port may have left the ECU connected
+        if (m_ecuReady && m_transporter->isConnected()) {
+            if (m_job.type == AdapterOrchestrator::Job::Connect) {
+                AdapterOrchestrator::Result result = baseResult();
+                result.ok = true;
+                finish(result);
+            } else {
+                startScan();
+            }
+            return;
+        }
+
+        m_ecuReady = false;
+        m_protocol.clear();
+        if (m_transporter->isConnected()) {
+            m_scanService->startConnection();
+        } else {
+            m_transporter->connectToDevice(m_port);
+        }
+    }
+
+    void startScan()
+    {
+        if (!m_busy) {
+            return;
+        }
+        m_partial = ScanResult();
+        m_hasPartial = false;
+        m_scanService->startScan(m_job.recipe);
+
+        // Reported with the result: what ran, not what the plan would be after
+        // the scan learned more about the vehicle
+        m_plannedCommands = int(m_scanService->lastPlan().commands.size());
+        m_estimatedBusMs = m_scanService->lastPlan().estimatedBusTimeMs;
+    }
+
+    void onScanComplete(const ScanResult& scan)
+    {
+        if (!m_busy) {
+            return;
+        }
+        m_deadline->stop();
+
+        AdapterOrchestrator::Result result = baseResult();
+        result.result = scan;
+        if (scan.timedOut) {
+            // Reported as a failure that kept what was read before the timeout
+            result.error = "Scan timed out";
+            result.hasPartial = true;
+        } else {
+            result.ok = true;
+            result.hasResult = true;
+        }
+
+        const bool more = m_job.type == AdapterOrchestrator::Job::Stream &&
+                          (m_job.repeat == 0 || m_iteration + 1 < m_job.repeat);
+        if (!more) {
+            // ScanService resets before it emits scanComplete, so the next
+            // job can start from inside the signal
+            complete(result);
+            startNext();
+            return;
+        }
+        result.last = false;
+        m_orchestrator->postProcess(result);
+        ++m_iteration;
+        m_streamTimer->start(m_job.intervalMs);
+    }
+
+    AdapterOrchestrator::Result baseResult() const
+    {
+        AdapterOrchestrator::Result result;
+        result.jobId = m_jobId;
+        result.type = m_job.type;
+        result.port = m_port;
+        result.iteration = m_iteration;
+        result.protocol = m_protocol;
+        result.elapsedMs = m_elapsed.elapsed();
+        result.plannedCommands = m_plannedCommands;
+        result.estimatedBusMs = m_estimatedBusMs;
+        return result;
+    }
+
+    void fail(const QString& error)
+    {
+        if (!m_busy) {
+            return;
+        }
+
+        AdapterOrchestrator::Result result = baseResult();
+        result.error = error;
+        if (m_hasPartial) {
+            // Keep whatever was read before the failure
+            result.hasPartial = true;
+            result.result = m_partial;
+        }
+        finish(result);
+
+        // Start the next job from a clean connection
+        m_ecuReady = false;
+        m_scanService->cancel();
+        m_transporter->disconnectFromDevice();
+    }
+
+    void complete(const AdapterOrchestrator::Result& result)
+    {
+        m_busy = false;
+        m_deadline->stop();
+        m_streamTimer->stop();
+        m_orchestrator->postProcess(result);
+    }
+
+    void finish(const AdapterOrchestrator::Result& result)
+    {
+        complete(result);
+
+        // Not from inside a failure signal, which ScanService emits before
+        // resetting itself, nor from inside startNext() itself
+        QTimer::singleShot(0, this, [this]() { startNext(); });
+    }
+
+    QString m_port;
+    AdapterOrchestrator* m_orchestrator;
+    AdapterOrchestrator::TransporterCreator m_creator;
+
+    ObdTransporter* m_transporter = nullptr;
+    ScanService* m_scanService = nullptr;
+    QTimer* m_deadline = nullptr;
+    QTimer* m_streamTimer = nullptr;
+
+    QQueue<QueuedJob> m_queue;
+    bool m_busy = false;
+    bool m_ecuReady = false;        // Connection sequence done, ECU answered
+    int m_jobId = 0;
+    AdapterOrchestrator::Job m_job;
+    int m_iteration = 0;
+    QElapsedTimer m_elapsed;
+    QString m_protocol;
+    ScanResult m_partial;
+    bool m_hasPartial = false;
+    int m_plannedCommands = 0;      // Plan of the scan in progress or last run
+    int m_estimatedBusMs = 0;
+};
+
+AdapterOrchestrator::AdapterOrchestrator(QObject *parent)
+    : QObject(parent)
+    , m_transporterCreator(&TransporterFactory::create)
+{
+    qRegisterMetaType<AdapterOrchestrator::Result>();
+}
+
+AdapterOrchestrator::~AdapterOrchestrator()
+{
+    shutdown();
+}
+
+void AdapterOrchestrator::setTransporterCreator(TransporterCreator creator)
+{
+    m_transporterCreator = std::move(creator);
+}
+
+void AdapterOrchestrator::setPostProcessThreads(int threads)
+{
+    m_postProcessPool.setMaxThreadCount(qMax(1, threads));
+}
+
+int AdapterOrchestrator::submit(const Job& job)
+{
+    const int jobId = m_nextJobId++;
+    m_openJobs.insert(jobId, OpenJob());
+
+    Adapter& adapter = m_adapters[job.port];
+    if (!adapter.thread) {
+        adapter.thread = new QThread(this);
+        adapter.thread->setObjectName(QString("adapter %1").arg(job.port));
+        adapter.worker = new AdapterWorker(job.port, this, m_transporterCreator);
+        adapter.worker->moveToThread(adapter.thread);
+        adapter.thread->start();
+    }
+
+    AdapterWorker* worker = adapter.worker;
+    QMetaObject::invokeMethod(worker, [worker, jobId, job]() { worker->enqueue(jobId, job); }, Qt::QueuedConnection);
+    return jobId;
+}
+
+void AdapterOrchestrator::cancel()
+{
+    for (const Adapter& adapter : std::as_const(m_adapters)) {
+        AdapterWorker* worker = adapter.worker;
+        QMetaObject::invokeMethod(worker, [worker]() { worker->cancelAll(); }, Qt::QueuedConnection);
+    }
+}
+
+void AdapterOrchestrator::shutdown()
+{
+    for (const Adapter& adapter : std::as_const(m_adapters)) {
+        // The worker and its transporter must be destroyed on their own thread
+        AdapterWorker* worker = adapter.worker;
+        QMetaObject::invokeMethod(worker, [worker]() {
+            worker->stop();
+            delete worker;
+        }, Qt::BlockingQueuedConnection);
+        adapter.thread->quit();
+        adapter.thread->wait();
+        delete adapter.thread;
+    }
+    m_adapters.clear();
+
+    // Results still queued for delivery are dropped by deliver()
+    m_postProcessPool.waitForDone();
+    m_openJobs.clear();
+}
+
+void AdapterOrchestrator::postProcess(Result result)
+{
+    m_postProcessPool.start([this, result]() mutable {
+        if (result.hasResult || result.hasPartial) {
+            result.json = ScanResultJson::toJson(result.result);
+        }
+        QMetaObject::invokeMethod(this, [this, result]() { deliver(result); }, Qt::QueuedConnection);
+    });
+}
+
+void AdapterOrchestrator::postProgress(int jobId, const QString& port, const ScanResult& partial, quint32 changedItems)
+{
+    QMetaObject::invokeMethod(this, [this, jobId, port, partial, changedItems]() {
+        if (m_openJobs.contains(jobId)) {
+            emit progress(jobId, port, partial, changedItems);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void AdapterOrchestrator::deliver(const Result& result)
+{
+    auto it = m_openJobs.find(result.jobId);
+    if (it == m_openJobs.end()) {
+        return;     // Job dropped by shutdown()
+    }
+
+    // Stream results may finish post-processing out of order; the job closes
+    // once every iteration up to the last one has been delivered
+    ++it->delivered;
+    if (result.last) {
+        it->expected = result.iteration + 1;
+    }
+    const bool closed = it->expected >= 0 && it->delivered >= it->expected;
+    if (closed) {
+        m_openJobs.erase(it);
+    }
+
+    emit resultReady(result);
+    if (closed && m_openJobs.isEmpty()) {
+        emit idle();
+    }
+}
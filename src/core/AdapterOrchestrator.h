@@ -0,0 +1,143 @@
+#ifndef ADAPTERORCHESTRATOR_H
+#define ADAPTERORCHESTRATOR_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+#include "core/ScanPlanner.h"
+#include "core/dto/ScanResult.h"
+
+class AdapterWorker;
+class ObdTransporter;
+class QThread;
+
+/**
+ * @brief The AdapterOrchestrator class
+ * Drives many adapters from one process, one worker thread per port.
+ *
+ * Every port gets its own QThread whose event loop owns the port's transporter
+ * and ScanService, so adapters never wait on each other and the per-adapter
+ * path takes no shared lock: jobs reach a worker as queued events on its own
+ * thread. Jobs for the same port run one after another and reuse the
+ * connection. Finished scans are serialized to JSON on a shared thread pool
+ * and then delivered, in completion order, through the signals below on the
+ * orchestrator's thread.
+ */
+class AdapterOrchestrator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief One unit of work for a port.
+     */
+    struct Job {
+        enum Type {
+            Connect,    // Connect and identify the ECU only
+            Scan,       // Connect if needed, then scan once
+            Stream      // Connect if needed, then scan repeatedly
+        };
+
+        Type type = Scan;
+        QString port;                               // Device path or "IP:PORT"
+        ScanPlanner::Recipe recipe = ScanPlanner::Quick;
+        int timeoutMs = 30000;                      // Per scan, including the connection if needed
+        int repeat = 0;                             // Stream: scans to run, 0 = until cancel()
+        int intervalMs = 1000;                      // Stream: pause between scans
+    };
+
+    /**
+     * @brief Outcome of a job; a Stream job delivers one per scan.
+     */
+    struct Result {
+        int jobId = 0;
+        Job::Type type = Job::Scan;
+        QString port;
+        bool ok = false;
+        bool last = true;               // No further results for this job
+        int iteration = 0;              // Stream: scan number, from 0
+        QString error;
+        QString protocol;
+        qint64 elapsedMs = 0;           // Since the job (or the stream scan) started
+        int plannedCommands = 0;
+        int estimatedBusMs = 0;
+        bool hasResult = false;         // result is a completed scan
+        bool hasPartial = false;        // result holds what arrived before a failure
+        ScanResult result;
+        QJsonObject json;               // ScanResultJson of result, built off the worker thread
+    };
+
+    using TransporterCreator = std::function<ObdTransporter*(const QString& port, QObject* parent)>;
+
+    explicit AdapterOrchestrator(QObject *parent = nullptr);
+    ~AdapterOrchestrator() override;
+
+    /**
+     * @brief Replaces TransporterFactory::create(), e.g. with simulated adapters.
+     * Called on the worker threads; set it before the first submit().
+     */
+    void setTransporterCreator(TransporterCreator creator);
+
+    void setPostProcessThreads(int threads);
+
+    /**
+     * @brief Queues a job, starting the port's worker thread if needed.
+     * @return Job id used in progress() and resultReady().
+     */
+    int submit(const Job& job);
+
+    /**
+     * @brief Drops queued jobs and stops running ones; each reports "Cancelled".
+     */
+    void cancel();
+
+    /**
+     * @brief Disconnects every adapter and stops the worker threads.
+     * Results still in post-processing are not delivered. Also run by the destructor.
+     */
+    void shutdown();
+
+    int adapterCount() const { return m_adapters.size(); }
+    int pendingJobs() const { return m_openJobs.size(); }
+
+signals:
+    void progress(int jobId, const QString& port, const ScanResult& partial, quint32 changedItems);
+    void resultReady(const AdapterOrchestrator::Result& result);
+
+    /**
+     * @brief Every submitted job has delivered its last result.
+     */
+    void idle();
+
+private:
+    friend class AdapterWorker;
+
+    // Called on worker threads
+    void postProcess(Result result);
+    void postProgress(int jobId, const QString& port, const ScanResult& partial, quint32 changedItems);
+
+    void deliver(const Result& result);
+
+    struct Adapter {
+        QThread* thread = nullptr;
+        AdapterWorker* worker = nullptr;
+    };
+
+    struct OpenJob {
+        int delivered = 0;      // Results emitted so far
+        int expected = -1;      // Known once the last result arrives
+    };
+
+    QHash<QString, Adapter> m_adapters;     // Port -> worker
+    QHash<int, OpenJob> m_openJobs;         // Job id -> delivery state
+    TransporterCreator m_transporterCreator;
+    QThreadPool m_postProcessPool;
+    int m_nextJobId = 1;
+};
+
+Q_DECLARE_METATYPE(AdapterOrchestrator::Result)
+
+#endif // ADAPTERORCHESTRATOR_H
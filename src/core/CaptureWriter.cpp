@@ -0,0 +1,85 @@
+#include "CaptureWriter.h"
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+
+const char* FORMAT = "obdread-capture-1";
+
+} // namespace
+
+QByteArray CaptureWriter::toCsv(const TriggerEngine::Capture& capture)
+{
+    QByteArray csv;
+    csv.reserve(256 + capture.samples.size() * 24);
+
+    auto header = [&csv](const char* key, const QString& value) {
+        csv += "# ";
+        csv += key;
+        csv += '=';
+        csv += value.toUtf8();
+        csv += '\n';
+    };
+
+    const QString triggerTime = capture.triggerWallMs > 0
+        ? QDateTime::fromMSecsSinceEpoch(capture.triggerWallMs).toUTC().toString(Qt::ISODateWithMs)
+        : QString();
+
+    // Rule names come from the user; keep them on one line
+    QString rule = capture.ruleName;
+    rule.replace('\n', ' ').replace('\r', ' ');
+
+    header("format", FORMAT);
+    header("rule", rule);
+    header("trigger_time", triggerTime);
+    header("trigger_ns", QString::number(capture.triggerTimeNs));
+    header("pre_trigger_ms", QString::number(capture.preTriggerNs / 1000000));
+    header("post_trigger_ms", QString::number(capture.postTriggerNs / 1000000));
+    header("samples", QString::number(capture.samples.size()));
+    header("truncated", capture.truncated ? "true" : "false");
+    header("suppressed_triggers", QString::number(capture.suppressedTriggers));
+    csv += "time_ms,pid,value\n";
+
+    for (const TriggerEngine::CapturedSample& sample : capture.samples) {
+        csv += QByteArray::number((sample.timeNs - capture.triggerTimeNs) / 1e6, 'f', 3);
+        csv += ',';
+        csv += capture.pids.value(sample.pid).toUtf8();
+        csv += ',';
+        csv += QByteArray::number(sample.value, 'g', 10);
+        csv += '\n';
+    }
+    return csv;
+}
+
+QString CaptureWriter::fileName(const TriggerEngine::Capture& capture)
+{
+    const QDateTime time = capture.triggerWallMs > 0
+        ? QDateTime::fromMSecsSinceEpoch(capture.triggerWallMs).toUTC()
+        : QDateTime::currentDateTimeUtc();
+
+    QString rule = capture.ruleName;
+    rule.replace(QRegularExpression("[^A-Za-z0-9_-]+"), "_");
+    if (rule.isEmpty()) {
+        rule = "rule";
+    }
+    return QString("capture-%1-%2.csv").arg(time.toString("yyyyMMdd-hhmmss-zzz"), rule.left(64));
+}
+
+bool CaptureWriter::write(const TriggerEngine::Capture& capture, const QString& path, QString* error)
+{
+    const QByteArray csv = toCsv(capture);
+
+    // The capture directory is only made once there is something to put in it
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(csv) != csv.size() || !file.commit()) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef CAPTUREWRITER_H
+#define CAPTUREWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include "TriggerEngine.h"
+
+/**
+ * @brief The CaptureWriter class
+ * Writes a TriggerEngine::Capture as CSV with a header of "# key=value"
+ * lines, so spreadsheets and scripts can open captures without a parser:
+ *
+ *     # format=obdread-capture-1
+ *     # rule=Misfire at load
+ *     # trigger_time=2024-05-01T10:15:30.250Z
+ *     ...
+ *     time_ms,pid,value
+ *     -9950.000,010C,2450
+ *
+ * time_ms is relative to the trigger; pre-trigger samples are negative.
+ */
+class CaptureWriter
+{
+public:
+    static QByteArray toCsv(const TriggerEngine::Capture& capture);
+
+    /**
+     * @brief File name for a capture, from its trigger time and rule name,
+     * e.g. "capture-20240501-101530-250-Misfire_at_load.csv".
+     */
+    static QString fileName(const TriggerEngine::Capture& capture);
+
+    /**
+     * @brief Writes toCsv() to @p path. The file appears complete or not at all.
+     * @return false with @p error set if the file cannot be written.
+     */
+    static bool write(const TriggerEngine::Capture& capture, const QString& path, QString* error = nullptr);
+
+private:
+    CaptureWriter() = delete;  // Static class, prevent instantiation
+};
+
+#endif // CAPTUREWRITER_H
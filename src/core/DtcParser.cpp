@@ -16,12 +16,13 @@ QStringList DtcParser::parseDtcResponse(const QByteArray &rawData)
     return parseDtcResponse(rawData, 3); // Default to Mode 03
 }
 
-// main function: converts raw ELM327 response to code list (Mode 03 or 07)
+// main function: converts raw ELM327 response to code list (Mode 03, 07 or 0A)
 QStringList DtcParser::parseDtcResponse(const QByteArray &rawData, int mode)
 {
     QStringList dtcList;
 
-    // Expected format: "43 XX YY XX YY ..." for Mode 03, "47 XX YY XX YY ..." for Mode 07
+    // Expected format: "43 XX YY XX YY ..." for Mode 03, "47 XX YY XX YY ..." for Mode 07,
+    // "4A XX YY XX YY ..." for Mode 0A
     // each DTC is 2 bytes (XX YY)
 
     // 1. clean the input (remove whitespace, newlines, and the prompt '>')
@@ -37,8 +38,13 @@ QStringList DtcParser::parseDtcResponse(const QByteArray &rawData, int mode)
     // 3. convert Hex String to Byte Array
     QByteArray bytes = QByteArray::fromHex(clean);
 
-    // 4. validate Mode Response (first byte should be 0x43 for Mode 03, 0x47 for Mode 07)
-    quint8 expectedModeByte = (mode == 7) ? 0x47 : 0x43;
+    // 4. validate Mode Response (first byte should be 0x43 for Mode 03, 0x47 for Mode 07, 0x4A for Mode 0A)
+    quint8 expectedModeByte = 0x43;
+    if (mode == 7) {
+        expectedModeByte = 0x47;
+    } else if (mode == 0x0A) {
+        expectedModeByte = 0x4A;
+    }
     if (bytes.isEmpty() || (quint8)bytes.at(0) != expectedModeByte) {
         qDebug() << "Parser: Not a valid Mode" << mode << "response:" << clean;
         return dtcList;
@@ -83,3 +89,32 @@ QString DtcParser::decodeDtc(quint8 byte1, quint8 byte2)
         .toUpper();
 }
 
+// helper: turns "P0101" back into its 2 bytes
+quint16 DtcParser::encodeDtc(const QString &code, bool *ok)
+{
+    if (ok) *ok = false;
+    if (code.size() != 5) return 0;
+
+    quint16 typeIndex = 0;
+    switch (code.at(0).toUpper().unicode()) {
+    case 'P': typeIndex = 0; break;
+    case 'C': typeIndex = 1; break;
+    case 'B': typeIndex = 2; break;
+    case 'U': typeIndex = 3; break;
+    default: return 0;
+    }
+
+    // first digit is 0-3 (2 bits), the remaining three are hex nibbles
+    quint16 digits = 0;
+    for (int i = 1; i < 5; ++i) {
+        const char16_t c = code.at(i).toUpper().unicode();
+        int nibble = -1;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        if (nibble < 0 || (i == 1 && nibble > 3)) return 0;
+        digits = quint16((digits << 4) | nibble);
+    }
+
+    if (ok) *ok = true;
+    return quint16((typeIndex << 14) | digits);
+}
@@ -8,7 +8,7 @@
 /**
  * @brief The DtcParser class
  * Parses Diagnostic Trouble Code (DTC) responses from OBD-II adapters.
- * Mode 03 returns stored DTCs, Mode 07 returns pending DTCs.
+ * Mode 03 returns stored DTCs, Mode 07 returns pending DTCs, Mode 0A returns permanent DTCs.
  */
 class DtcParser : public QObject
 {
@@ -26,9 +26,9 @@ public:
     QStringList parseDtcResponse(const QByteArray &rawData);
 
     /**
-     * @brief Parses raw OBD-II response data for DTCs (Mode 03 or Mode 07).
+     * @brief Parses raw OBD-II response data for DTCs (Mode 03, 07 or 0A).
      * @param rawData The raw hex response from the adapter.
-     * @param mode The OBD mode (3 for stored DTCs, 7 for pending DTCs).
+     * @param mode The OBD mode (3 for stored, 7 for pending, 0x0A for permanent DTCs).
      * @return A list of DTC strings (e.g., "P0133").
      */
     QStringList parseDtcResponse(const QByteArray &rawData, int mode);
@@ -40,6 +40,15 @@ public:
      * @return The DTC string (e.g., "P0133").
      */
     static QString decodeDtc(quint8 byte1, quint8 byte2);
+
+    /**
+     * @brief Converts a DTC string back to its 2-byte wire form (the inverse of decodeDtc()).
+     * The result is a compact key: it sorts P < C < B < U, then by number.
+     * @param code The DTC string (e.g., "P0133").
+     * @param ok Set to false if the code is not a valid 5-character DTC.
+     * @return (byte1 << 8) | byte2, or 0 if the code is invalid.
+     */
+    static quint16 encodeDtc(const QString &code, bool *ok = nullptr);
 };
 
 #endif // DTCPARSER_H
@@ -0,0 +1,203 @@
+#include "DtcStore.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+void DtcStore::RowSet::resize(int rows)
+{
+    size = rows;
+    words.resize((rows + 63) / 64);
+}
+
+int DtcStore::RowSet::count() const
+{
+    int total = 0;
+    for (quint64 word : words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+QVector<int> DtcStore::RowSet::rows() const
+{
+    QVector<int> result;
+    result.reserve(count());
+    for (int w = 0; w < words.size(); ++w) {
+        quint64 word = words[w];
+        while (word) {
+            result.append(w * 64 + qCountTrailingZeroBits(word));
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
+quint32 DtcStore::Dictionary::intern(const QString& string)
+{
+    const auto it = ids.constFind(string);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = quint32(strings.size());
+    ids.insert(string, id);
+    strings.append(string);
+    folded.append(string.toUpper());
+    rows.append(QVector<int>());
+    ranks.clear();
+    return id;
+}
+
+quint32 DtcStore::Dictionary::rank(quint32 id) const
+{
+    if (ranks.size() != strings.size()) {
+        QVector<quint32> order(strings.size());
+        for (int i = 0; i < order.size(); ++i) {
+            order[i] = quint32(i);
+        }
+        std::sort(order.begin(), order.end(), [this](quint32 a, quint32 b) {
+            return strings[int(a)] < strings[int(b)];
+        });
+        ranks.resize(strings.size());
+        for (int i = 0; i < order.size(); ++i) {
+            ranks[int(order[i])] = quint32(i);
+        }
+    }
+    return ranks[int(id)];
+}
+
+void DtcStore::Dictionary::clear()
+{
+    strings.clear();
+    folded.clear();
+    ids.clear();
+    rows.clear();
+    ranks.clear();
+}
+
+int DtcStore::append(const QString& vin, const QVector<DtcEntry>& dtcs, qint64 timestampMs)
+{
+    const int first = rowCount();
+    const quint32 vinId = m_vins.intern(vin);
+    for (const DtcEntry& dtc : dtcs) {
+        addRow(m_codes.intern(dtc.code), quint8(dtc.status), quint8(dtc.category),
+               m_modules.intern(dtc.module), vinId, timestampMs);
+    }
+    return first;
+}
+
+int DtcStore::append(const QString& vin, const DtcEntry& dtc, qint64 timestampMs)
+{
+    const int row = rowCount();
+    addRow(m_codes.intern(dtc.code), quint8(dtc.status), quint8(dtc.category),
+           m_modules.intern(dtc.module), m_vins.intern(vin), timestampMs);
+    return row;
+}
+
+void DtcStore::clear()
+{
+    m_codes.clear();
+    m_modules.clear();
+    m_vins.clear();
+    m_codeIds.clear();
+    m_moduleIds.clear();
+    m_vinIds.clear();
+    m_statuses.clear();
+    m_categories.clear();
+    m_timestamps.clear();
+    for (RowSet& rows : m_statusRows) {
+        rows = RowSet();
+    }
+    for (RowSet& rows : m_categoryRows) {
+        rows = RowSet();
+    }
+}
+
+DtcStore::RowSet DtcStore::select(const Filter& filter) const
+{
+    RowSet result;
+    result.resize(rowCount());
+    if (result.words.isEmpty()) {
+        return result;
+    }
+
+    // Rows of any selected status, and of any selected category
+    for (int w = 0; w < result.words.size(); ++w) {
+        quint64 statuses = 0;
+        for (int s = 0; s < STATUS_COUNT; ++s) {
+            if (filter.statuses & (1u << s)) {
+                statuses |= m_statusRows[s].words[w];
+            }
+        }
+        quint64 categories = 0;
+        for (int c = 0; c < CATEGORY_COUNT; ++c) {
+            if (filter.categories & (1u << c)) {
+                categories |= m_categoryRows[c].words[w];
+            }
+        }
+        result.words[w] = statuses & categories;
+    }
+
+    if (!filter.text.isEmpty()) {
+        RowSet textRows;
+        textRows.resize(rowCount());
+        const QString foldedText = filter.text.toUpper();
+        markMatches(m_codes, foldedText, textRows);
+        markMatches(m_modules, foldedText, textRows);
+        markMatches(m_vins, foldedText, textRows);
+        for (int w = 0; w < result.words.size(); ++w) {
+            result.words[w] &= textRows.words[w];
+        }
+    }
+    return result;
+}
+
+bool DtcStore::matches(int row, const Filter& filter) const
+{
+    if (!(filter.statuses & (1u << m_statuses[row])) || !(filter.categories & (1u << m_categories[row]))) {
+        return false;
+    }
+    if (filter.text.isEmpty()) {
+        return true;
+    }
+    const QString foldedText = filter.text.toUpper();
+    return m_codes.folded[int(m_codeIds[row])].contains(foldedText)
+        || m_modules.folded[int(m_moduleIds[row])].contains(foldedText)
+        || m_vins.folded[int(m_vinIds[row])].contains(foldedText);
+}
+
+void DtcStore::addRow(quint32 codeId, quint8 status, quint8 category, quint32 moduleId, quint32 vinId, qint64 timestampMs)
+{
+    const int row = rowCount();
+    m_codeIds.append(codeId);
+    m_moduleIds.append(moduleId);
+    m_vinIds.append(vinId);
+    m_statuses.append(status);
+    m_categories.append(category);
+    m_timestamps.append(timestampMs);
+
+    m_codes.rows[int(codeId)].append(row);
+    m_modules.rows[int(moduleId)].append(row);
+    m_vins.rows[int(vinId)].append(row);
+
+    // All bitsets keep the length of the store so select() can combine them word by word
+    for (RowSet& rows : m_statusRows) {
+        rows.resize(row + 1);
+    }
+    for (RowSet& rows : m_categoryRows) {
+        rows.resize(row + 1);
+    }
+    m_statusRows[status].set(row);
+    m_categoryRows[category].set(row);
+}
+
+void DtcStore::markMatches(const Dictionary& dictionary, const QString& foldedText, RowSet& rows)
+{
+    for (int id = 0; id < dictionary.folded.size(); ++id) {
+        if (!dictionary.folded[id].contains(foldedText)) {
+            continue;
+        }
+        for (int row : dictionary.rows[id]) {
+            rows.set(row);
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef DTCSTORE_H
+#define DTCSTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <array>
+#include "core/dto/DtcEntry.h"
+
+/**
+ * @brief The DtcStore class
+ * Append-only columnar store of DTC occurrences across a fleet: code,
+ * status, category, module, VIN and time, one row per code per scan.
+ *
+ * Codes, modules and VINs are interned, so a row takes 22 bytes of column
+ * data plus its postings, however long its strings are. Each interned string
+ * keeps the rows it appears in, which makes it the text index: a search tests
+ * each distinct string once, not each row, and ORs the posting lists of the
+ * matches.
+ * Every status and category keeps a bitset of its rows, so those filters are
+ * a few word-wide ANDs and ORs. Sorting compares integer ranks of the
+ * interned strings instead of the strings.
+ *
+ * Not thread-safe; the ranks are rebuilt lazily by const methods.
+ */
+class DtcStore
+{
+public:
+    /**
+     * @brief One bit per row.
+     */
+    struct RowSet {
+        QVector<quint64> words;
+        int size = 0;
+
+        void resize(int rows);
+        void set(int row) { words[row >> 6] |= quint64(1) << (row & 63); }
+        bool test(int row) const { return row >= 0 && row < size && (words[row >> 6] >> (row & 63)) & 1; }
+        int count() const;
+        QVector<int> rows() const;
+    };
+
+    static constexpr int STATUS_COUNT = 3;      // DtcStatus values
+    static constexpr int CATEGORY_COUNT = 4;    // DtcCategory values
+    static constexpr quint8 ALL_STATUSES = (1u << STATUS_COUNT) - 1;
+    static constexpr quint8 ALL_CATEGORIES = (1u << CATEGORY_COUNT) - 1;
+
+    static constexpr quint8 statusBit(DtcStatus status) { return quint8(1u << int(status)); }
+    static constexpr quint8 categoryBit(DtcCategory category) { return quint8(1u << int(category)); }
+
+    struct Filter {
+        quint8 statuses = ALL_STATUSES;         // statusBit() of each status shown
+        quint8 categories = ALL_CATEGORIES;     // categoryBit() of each category shown
+        QString text;                           // Case-insensitive part of the code, module or VIN
+
+        bool isEmpty() const {
+            return statuses == ALL_STATUSES && categories == ALL_CATEGORIES && text.isEmpty();
+        }
+    };
+
+    DtcStore() = default;
+
+    /**
+     * @brief Appends one row per DTC.
+     * @return The first new row.
+     */
+    int append(const QString& vin, const QVector<DtcEntry>& dtcs, qint64 timestampMs);
+    int append(const QString& vin, const DtcEntry& dtc, qint64 timestampMs);
+    void clear();
+
+    int rowCount() const { return m_codeIds.size(); }
+    int vehicleCount() const { return m_vins.strings.size(); }
+    int distinctCodeCount() const { return m_codes.strings.size(); }
+
+    QString code(int row) const { return m_codes.strings[int(m_codeIds[row])]; }
+    DtcStatus status(int row) const { return DtcStatus(m_statuses[row]); }
+    DtcCategory category(int row) const { return DtcCategory(m_categories[row]); }
+    QString module(int row) const { return m_modules.strings[int(m_moduleIds[row])]; }
+    QString vin(int row) const { return m_vins.strings[int(m_vinIds[row])]; }
+    qint64 timestampMs(int row) const { return m_timestamps[row]; }
+
+    /**
+     * @brief Position of the row's string among the distinct strings of its
+     * column in sorted order; equal strings have equal ranks.
+     */
+    quint32 codeRank(int row) const { return m_codes.rank(m_codeIds[row]); }
+    quint32 moduleRank(int row) const { return m_modules.rank(m_moduleIds[row]); }
+    quint32 vinRank(int row) const { return m_vins.rank(m_vinIds[row]); }
+
+    /**
+     * @brief Every row @p filter accepts.
+     */
+    RowSet select(const Filter& filter) const;
+
+    /**
+     * @brief Whether @p filter accepts one row; for rows added after a select().
+     */
+    bool matches(int row, const Filter& filter) const;
+
+private:
+    struct Dictionary {
+        QStringList strings;
+        QStringList folded;                 // Upper case, for searching
+        QHash<QString, quint32> ids;
+        QVector<QVector<int>> rows;         // Postings: rows by string id
+        mutable QVector<quint32> ranks;     // By string id; empty when stale
+
+        quint32 intern(const QString& string);
+        quint32 rank(quint32 id) const;
+        void clear();
+    };
+
+    void addRow(quint32 codeId, quint8 status, quint8 category, quint32 moduleId, quint32 vinId, qint64 timestampMs);
+    static void markMatches(const Dictionary& dictionary, const QString& foldedText, RowSet& rows);
+
+    Dictionary m_codes;
+    Dictionary m_modules;
+    Dictionary m_vins;
+
+    // Columns, one entry per row
+    QVector<quint32> m_codeIds;
+    QVector<quint32> m_moduleIds;
+    QVector<quint32> m_vinIds;
+    QVector<quint8> m_statuses;
+    QVector<quint8> m_categories;
+    QVector<qint64> m_timestamps;
+
+    std::array<RowSet, STATUS_COUNT> m_statusRows;
+    std::array<RowSet, CATEGORY_COUNT> m_categoryRows;
+};
+
+#endif // DTCSTORE_H
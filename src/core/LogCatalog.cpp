@@ -0,0 +1,565 @@
+#include "LogCatalog.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTimer>
+
+namespace {
+
+const int SCHEMA_VERSION = 1;
+const char* const HEADER_FORMAT = "obdread-log-1";
+
+// One row per log file. Times are UTC milliseconds since the epoch.
+const char* const SCHEMA[] = {
+    "CREATE TABLE IF NOT EXISTS logs ("
+    "  file TEXT PRIMARY KEY,"
+    "  log_id TEXT NOT NULL,"
+    "  started_at INTEGER NOT NULL,"
+    "  duration_s INTEGER NOT NULL,"
+    "  pid_count INTEGER NOT NULL,"
+    "  sample_rate REAL NOT NULL,"
+    "  vehicle_year INTEGER NOT NULL,"
+    "  vehicle_make TEXT NOT NULL,"
+    "  vehicle_model TEXT NOT NULL,"
+    "  vin TEXT NOT NULL,"
+    "  file_size INTEGER NOT NULL,"
+    "  modified_at INTEGER NOT NULL)",
+    "CREATE INDEX IF NOT EXISTS idx_logs_started ON logs(started_at DESC, file)",
+};
+
+const char* const UPSERT =
+    "INSERT OR REPLACE INTO logs (file, log_id, started_at, duration_s, pid_count, sample_rate,"
+    " vehicle_year, vehicle_make, vehicle_model, vin, file_size, modified_at)"
+    " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+// A rescan writes a row only if nobody else did since it read the table:
+// record() may have stored the final metadata of a file while the rescan
+// read its header. New files are inserted only if still missing; changed
+// files and deleted rows must still have the size and time the rescan saw.
+const char* const SCAN_INSERT =
+    "INSERT INTO logs (file, log_id, started_at, duration_s, pid_count, sample_rate,"
+    " vehicle_year, vehicle_make, vehicle_model, vin, file_size, modified_at)"
+    " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+    " ON CONFLICT(file) DO NOTHING";
+const char* const SCAN_UPDATE =
+    "INSERT INTO logs (file, log_id, started_at, duration_s, pid_count, sample_rate,"
+    " vehicle_year, vehicle_make, vehicle_model, vin, file_size, modified_at)"
+    " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+    " ON CONFLICT(file) DO UPDATE SET log_id = excluded.log_id, started_at = excluded.started_at,"
+    " duration_s = excluded.duration_s, pid_count = excluded.pid_count, sample_rate = excluded.sample_rate,"
+    " vehicle_year = excluded.vehicle_year, vehicle_make = excluded.vehicle_make,"
+    " vehicle_model = excluded.vehicle_model, vin = excluded.vin, file_size = excluded.file_size,"
+    " modified_at = excluded.modified_at"
+    " WHERE logs.file_size = ? AND logs.modified_at = ?";
+const char* const SCAN_DELETE = "DELETE FROM logs WHERE file = ? AND file_size = ? AND modified_at = ?";
+
+struct ScanOutcome {
+    int added = 0;
+    int updated = 0;
+    int removed = 0;
+    QString error;
+};
+
+QSqlDatabase openConnection(const QString& catalogPath, const QString& connectionName)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(catalogPath);
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    db.open();
+    return db;
+}
+
+bool createSchema(QSqlDatabase& db, QString* error)
+{
+    QSqlQuery query(db);
+    // WAL so the listing reads while a rescan commits
+    if (!query.exec("PRAGMA journal_mode=WAL") || !query.exec("PRAGMA synchronous=NORMAL")) {
+        *error = query.lastError().text();
+        return false;
+    }
+
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+    if (version > SCHEMA_VERSION) {
+        *error = QString("Log catalog schema %1 is newer than supported (%2)").arg(version).arg(SCHEMA_VERSION);
+        return false;
+    }
+
+    db.transaction();
+    for (const char* statement : SCHEMA) {
+        if (!query.exec(statement)) {
+            *error = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    query.exec(QString("PRAGMA user_version=%1").arg(SCHEMA_VERSION));
+    return db.commit();
+}
+
+void bindEntry(QSqlQuery& query, const LogCatalog::Entry& entry)
+{
+    const LogMeta& meta = entry.meta;
+    query.addBindValue(entry.fileName);
+    query.addBindValue(meta.id);
+    query.addBindValue(meta.timestamp.isValid() ? meta.timestamp.toMSecsSinceEpoch() : 0);
+    query.addBindValue(meta.duration);
+    query.addBindValue(meta.pidCount);
+    query.addBindValue(meta.sampleRate);
+    query.addBindValue(meta.vehicleProfile.year);
+    query.addBindValue(meta.vehicleProfile.make);
+    query.addBindValue(meta.vehicleProfile.model);
+    query.addBindValue(meta.vehicleProfile.vin);
+    query.addBindValue(entry.fileSize);
+    query.addBindValue(entry.modifiedMs);
+}
+
+bool upsert(QSqlQuery& query, const LogCatalog::Entry& entry, QString* error)
+{
+    bindEntry(query, entry);
+    if (!query.exec()) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+LogCatalog::Entry entryForFile(const QFileInfo& info)
+{
+    LogCatalog::Entry entry;
+    entry.fileName = info.fileName();
+    entry.fileSize = info.size();
+    entry.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+
+    // Still listed if the header cannot be read, e.g. while it is being
+    // written; the file is read again once its size or time changes
+    if (!LogCatalog::readHeader(info.filePath(), &entry.meta)) {
+        entry.meta = LogMeta();
+        entry.meta.id = info.completeBaseName();
+        entry.meta.timestamp = info.lastModified();
+    }
+    return entry;
+}
+
+ScanOutcome syncCatalog(QSqlDatabase& db, const QString& logDirectory)
+{
+    ScanOutcome outcome;
+
+    struct Known {
+        qint64 size;
+        qint64 modifiedMs;
+    };
+    struct Change {
+        LogCatalog::Entry entry;
+        bool isNew;
+        Known seen;         // The row as read, if not new
+    };
+    QHash<QString, Known> known;
+    QSqlQuery query(db);
+    if (!query.exec("SELECT file, file_size, modified_at FROM logs")) {
+        outcome.error = query.lastError().text();
+        return outcome;
+    }
+    while (query.next()) {
+        known.insert(query.value(0).toString(), {query.value(1).toLongLong(), query.value(2).toLongLong()});
+    }
+
+    // Only files that are new or differ from their row are opened
+    QVector<Change> changed;
+    QDirIterator it(logDirectory, {"*." + LogCatalog::logSuffix()}, QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const auto found = known.find(info.fileName());
+        if (found == known.end()) {
+            changed.append({entryForFile(info), true, {0, 0}});
+            continue;
+        }
+        const Known seen = *found;
+        known.erase(found);
+        if (seen.size != info.size() || seen.modifiedMs != info.lastModified().toMSecsSinceEpoch()) {
+            changed.append({entryForFile(info), false, seen});
+        }
+    }
+    // Rows left over in known have no file any more
+    if (changed.isEmpty() && known.isEmpty()) {
+        return outcome;
+    }
+
+    // Applied in one transaction: a listing sees the whole rescan or none of
+    // it. Rows another writer changed meanwhile are left alone and not counted.
+    QSqlQuery insertQuery(db);
+    QSqlQuery updateQuery(db);
+    QSqlQuery deleteQuery(db);
+    bool ok = insertQuery.prepare(SCAN_INSERT) && updateQuery.prepare(SCAN_UPDATE)
+           && deleteQuery.prepare(SCAN_DELETE) && db.transaction();
+    for (int i = 0; ok && i < changed.size(); ++i) {
+        const Change& change = changed.at(i);
+        QSqlQuery& write = change.isNew ? insertQuery : updateQuery;
+        bindEntry(write, change.entry);
+        if (!change.isNew) {
+            write.addBindValue(change.seen.size);
+            write.addBindValue(change.seen.modifiedMs);
+        }
+        if (!write.exec()) {
+            outcome.error = write.lastError().text();
+            ok = false;
+        } else if (write.numRowsAffected() > 0) {
+            int& count = change.isNew ? outcome.added : outcome.updated;
+            ++count;
+        }
+    }
+    for (auto gone = known.constBegin(); ok && gone != known.constEnd(); ++gone) {
+        deleteQuery.addBindValue(gone.key());
+        deleteQuery.addBindValue(gone->size);
+        deleteQuery.addBindValue(gone->modifiedMs);
+        ok = deleteQuery.exec();
+        if (ok && deleteQuery.numRowsAffected() > 0) {
+            ++outcome.removed;
+        }
+    }
+    ok = ok && db.commit();
+    if (!ok) {
+        if (outcome.error.isEmpty()) {
+            outcome.error = db.lastError().text();
+        }
+        db.rollback();
+    }
+    return outcome;
+}
+
+ScanOutcome scanDirectory(const QString& logDirectory, const QString& catalogPath, const QString& connectionName)
+{
+    ScanOutcome outcome;
+    {
+        QSqlDatabase db = openConnection(catalogPath, connectionName);
+        if (db.isOpen()) {
+            outcome = syncCatalog(db, logDirectory);
+        } else {
+            outcome.error = db.lastError().text();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return outcome;
+}
+
+} // namespace
+
+LogCatalog::LogCatalog(const QString& logDirectory, const QString& catalogPath, QObject *parent)
+    : QObject(parent)
+    , m_logDirectory(logDirectory)
+    , m_catalogPath(catalogPath)
+    , m_rescanTimer(new QTimer(this))
+{
+    // One rescan at a time; requests during it are folded into the next one
+    m_scanPool.setMaxThreadCount(1);
+
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(RESCAN_DELAY_MS);
+    connect(m_rescanTimer, &QTimer::timeout, this, &LogCatalog::rescan);
+}
+
+LogCatalog::~LogCatalog()
+{
+    close();
+}
+
+bool LogCatalog::open()
+{
+    if (isOpen()) {
+        return true;
+    }
+    m_lastError.clear();
+
+    const QString connection = QString("LogCatalog-%1").arg(quintptr(this), 0, 16);
+    QString error;
+    {
+        QSqlDatabase db = openConnection(m_catalogPath, connection);
+        if (!db.isOpen()) {
+            error = db.lastError().text();
+        } else {
+            createSchema(db, &error);
+        }
+    }
+    if (!error.isEmpty()) {
+        QSqlDatabase::removeDatabase(connection);
+        m_lastError = error;
+        qDebug() << "LogCatalog: Cannot open" << m_catalogPath << ":" << error;
+        return false;
+    }
+    m_connection = connection;
+
+    QDir().mkpath(m_logDirectory);
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(m_logDirectory);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        m_rescanTimer->start();
+    });
+
+    rescan();
+    return true;
+}
+
+void LogCatalog::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    delete m_watcher;
+    m_watcher = nullptr;
+    m_rescanTimer->stop();
+    m_rescanPending = false;
+    m_scanPool.waitForDone();
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    m_scanning = false;
+
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_connection, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connection);
+    m_connection.clear();
+}
+
+bool LogCatalog::record(const QString& fileName, const LogMeta& meta, QString* error)
+{
+    auto reject = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (!isOpen()) {
+        return reject("Log catalog is not open");
+    }
+    const QFileInfo info(QDir(m_logDirectory).filePath(fileName));
+    if (!info.isFile()) {
+        return reject(QString("%1 does not exist").arg(info.filePath()));
+    }
+
+    Entry entry;
+    entry.fileName = info.fileName();
+    entry.meta = meta;
+    entry.fileSize = info.size();
+    entry.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+
+    QSqlQuery query(QSqlDatabase::database(m_connection, false));
+    QString message;
+    if (!query.prepare(UPSERT) || !upsert(query, entry, &message)) {
+        return reject(message.isEmpty() ? query.lastError().text() : message);
+    }
+
+    emit changed();
+    if (error) {
+        error->clear();
+    }
+    return true;
+}
+
+bool LogCatalog::remove(const QString& fileName, QString* error)
+{
+    if (!isOpen()) {
+        if (error) {
+            *error = "Log catalog is not open";
+        }
+        return false;
+    }
+
+    QSqlQuery query(QSqlDatabase::database(m_connection, false));
+    query.prepare("DELETE FROM logs WHERE file = ?");
+    query.addBindValue(QFileInfo(fileName).fileName());
+    if (!query.exec()) {
+        if (error) {
+            *error = query.lastError().text();
+        }
+        return false;
+    }
+
+    if (query.numRowsAffected() > 0) {
+        emit changed();
+    }
+    if (error) {
+        error->clear();
+    }
+    return true;
+}
+
+int LogCatalog::count() const
+{
+    if (!isOpen()) {
+        return 0;
+    }
+
+    QSqlQuery query(QSqlDatabase::database(m_connection, false));
+    if (!query.exec("SELECT COUNT(*) FROM logs") || !query.next()) {
+        qDebug() << "LogCatalog: Query failed:" << query.lastError().text();
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+QVector<LogCatalog::Entry> LogCatalog::entries(int offset, int limit) const
+{
+    QVector<Entry> result;
+    if (!isOpen() || limit <= 0) {
+        return result;
+    }
+
+    QSqlQuery query(QSqlDatabase::database(m_connection, false));
+    query.setForwardOnly(true);
+    query.prepare("SELECT file, log_id, started_at, duration_s, pid_count, sample_rate,"
+                  " vehicle_year, vehicle_make, vehicle_model, vin, file_size, modified_at"
+                  " FROM logs ORDER BY started_at DESC, file LIMIT ? OFFSET ?");
+    query.addBindValue(limit);
+    query.addBindValue(qMax(0, offset));
+    if (!query.exec()) {
+        qDebug() << "LogCatalog: Query failed:" << query.lastError().text();
+        return result;
+    }
+
+    result.reserve(limit);
+    while (query.next()) {
+        Entry entry;
+        entry.fileName = query.value(0).toString();
+        entry.meta.id = query.value(1).toString();
+        entry.meta.timestamp = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        entry.meta.duration = query.value(3).toLongLong();
+        entry.meta.pidCount = query.value(4).toInt();
+        entry.meta.sampleRate = query.value(5).toDouble();
+        entry.meta.vehicleProfile.year = query.value(6).toInt();
+        entry.meta.vehicleProfile.make = query.value(7).toString();
+        entry.meta.vehicleProfile.model = query.value(8).toString();
+        entry.meta.vehicleProfile.vin = query.value(9).toString();
+        entry.fileSize = query.value(10).toLongLong();
+        entry.modifiedMs = query.value(11).toLongLong();
+        result.append(entry);
+    }
+    return result;
+}
+
+void LogCatalog::rescan()
+{
+    if (!isOpen()) {
+        return;
+    }
+    if (m_scanning) {
+        m_rescanPending = true;
+        return;
+    }
+    startScan();
+}
+
+void LogCatalog::waitForScan()
+{
+    while (m_scanning) {
+        m_scanPool.waitForDone();
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+}
+
+void LogCatalog::startScan()
+{
+    m_scanning = true;
+    const QString logDirectory = m_logDirectory;
+    const QString catalogPath = m_catalogPath;
+    const QString connection = m_connection + "-scan";
+    m_scanPool.start([this, logDirectory, catalogPath, connection]() {
+        const ScanOutcome outcome = scanDirectory(logDirectory, catalogPath, connection);
+        QMetaObject::invokeMethod(this, [this, outcome]() {
+            m_scanning = false;
+            if (!outcome.error.isEmpty()) {
+                qDebug() << "LogCatalog: Rescan failed:" << outcome.error;
+                emit errorOccurred(outcome.error);
+            } else {
+                emit scanFinished(outcome.added, outcome.updated, outcome.removed);
+                if (outcome.added || outcome.updated || outcome.removed) {
+                    emit changed();
+                }
+            }
+            if (m_rescanPending) {
+                m_rescanPending = false;
+                startScan();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool LogCatalog::writeHeader(QIODevice* device, const LogMeta& meta)
+{
+    QJsonObject vehicle;
+    vehicle["year"] = meta.vehicleProfile.year;
+    vehicle["make"] = meta.vehicleProfile.make;
+    vehicle["model"] = meta.vehicleProfile.model;
+    vehicle["vin"] = meta.vehicleProfile.vin;
+    vehicle["notes"] = meta.vehicleProfile.notes;
+
+    QJsonObject header;
+    header["format"] = HEADER_FORMAT;
+    header["id"] = meta.id;
+    header["started"] = meta.timestamp.toUTC().toString(Qt::ISODateWithMs);
+    header["duration"] = meta.duration;
+    header["pidCount"] = meta.pidCount;
+    header["sampleRate"] = meta.sampleRate;
+    header["vehicle"] = vehicle;
+
+    const QByteArray line = QJsonDocument(header).toJson(QJsonDocument::Compact) + '\n';
+    return device && device->write(line) == line.size();
+}
+
+bool LogCatalog::readHeader(const QString& path, LogMeta* meta, QString* error)
+{
+    auto reject = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return reject(file.errorString());
+    }
+    const QByteArray line = file.readLine(MAX_HEADER_BYTES);
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (!document.isObject()) {
+        return reject(QString("No log header: %1").arg(parseError.errorString()));
+    }
+    const QJsonObject header = document.object();
+    if (header["format"].toString() != HEADER_FORMAT) {
+        return reject(QString("Unknown log format \"%1\"").arg(header["format"].toString()));
+    }
+
+    const QJsonObject vehicle = header["vehicle"].toObject();
+    meta->id = header["id"].toString();
+    meta->timestamp = QDateTime::fromString(header["started"].toString(), Qt::ISODateWithMs);
+    meta->duration = qint64(header["duration"].toDouble());
+    meta->pidCount = header["pidCount"].toInt();
+    meta->sampleRate = header["sampleRate"].toDouble();
+    meta->vehicleProfile.year = vehicle["year"].toInt();
+    meta->vehicleProfile.make = vehicle["make"].toString();
+    meta->vehicleProfile.model = vehicle["model"].toString();
+    meta->vehicleProfile.vin = vehicle["vin"].toString();
+    meta->vehicleProfile.notes = vehicle["notes"].toString();
+
+    if (error) {
+        error->clear();
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef LOGCATALOG_H
+#define LOGCATALOG_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include "core/dto/LogMeta.h"
+
+class QFileSystemWatcher;
+class QIODevice;
+class QTimer;
+
+/**
+ * @brief The LogCatalog class
+ * Index of the recordings in a log directory, so a list of every log with its
+ * LogMeta never opens the logs themselves.
+ *
+ * The catalog is an SQLite database with one row of fixed columns per log
+ * file: the LogMeta from the file's header plus the file's size and
+ * modification time. Listing is a COUNT(*) and one indexed page of rows at a
+ * time (see entries()), whatever the size of the archive.
+ *
+ * The recorder calls record() once a log is complete; that upsert is a
+ * single statement, so readers see the old row or the new one. Files that
+ * appear, change or disappear behind the catalog's back are picked up by
+ * rescan(), which runs on a background thread and re-reads the header only
+ * of files whose size or modification time differ from their row. A rescan
+ * never overwrites a row record() wrote while it ran. While the catalog is
+ * open, a QFileSystemWatcher on the directory triggers a rescan
+ * RESCAN_DELAY_MS after the last change.
+ *
+ * A log file starts with one line of JSON (see writeHeader()); only that line
+ * is read. Keep the catalog database outside the log directory, or its own
+ * writes will trigger rescans.
+ */
+class LogCatalog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString fileName;           // Relative to the log directory
+        LogMeta meta;               // Default values (id = file name) if the header is unreadable
+        qint64 fileSize = 0;
+        qint64 modifiedMs = 0;      // File modification time, ms since the epoch
+    };
+
+    static constexpr int RESCAN_DELAY_MS = 500;
+    static constexpr int MAX_HEADER_BYTES = 64 * 1024;
+
+    /**
+     * @brief File name suffix of logs, without the dot.
+     */
+    static QString logSuffix() { return QStringLiteral("obdlog"); }
+
+    LogCatalog(const QString& logDirectory, const QString& catalogPath, QObject *parent = nullptr);
+    ~LogCatalog();
+
+    /**
+     * @brief Opens (and if needed creates) the catalog, starts watching the
+     * directory and starts a rescan in the background.
+     * @return false on failure; see lastError().
+     */
+    bool open();
+    void close();
+
+    bool isOpen() const { return !m_connection.isEmpty(); }
+    QString lastError() const { return m_lastError; }
+    QString logDirectory() const { return m_logDirectory; }
+    QString catalogPath() const { return m_catalogPath; }
+
+    /**
+     * @brief Adds or replaces the row of a log the recorder has finished writing.
+     * @param fileName Relative to the log directory; the file must exist.
+     */
+    bool record(const QString& fileName, const LogMeta& meta, QString* error = nullptr);
+    bool remove(const QString& fileName, QString* error = nullptr);
+
+    /**
+     * @brief Number of logs in the catalog.
+     */
+    int count() const;
+
+    /**
+     * @brief Up to @p limit logs starting at @p offset, newest first.
+     */
+    QVector<Entry> entries(int offset, int limit) const;
+
+    /**
+     * @brief Brings the catalog in line with the directory on a background
+     * thread. A rescan requested while one runs starts when it finishes.
+     */
+    void rescan();
+    bool isScanning() const { return m_scanning; }
+
+    /**
+     * @brief Blocks until no rescan is running or pending and its signals were emitted.
+     */
+    void waitForScan();
+
+    /**
+     * @brief Writes the header line a log file starts with.
+     */
+    static bool writeHeader(QIODevice* device, const LogMeta& meta);
+
+    /**
+     * @brief Reads the header line of a log file.
+     */
+    static bool readHeader(const QString& path, LogMeta* meta, QString* error = nullptr);
+
+signals:
+    /**
+     * @brief Emitted after rows were added, updated or removed.
+     */
+    void changed();
+
+    /**
+     * @brief Emitted when a rescan is done, whether or not it changed anything.
+     */
+    void scanFinished(int added, int updated, int removed);
+
+    void errorOccurred(const QString& message);
+
+private:
+    void startScan();
+
+    QString m_logDirectory;
+    QString m_catalogPath;
+    QString m_connection;           // Read/write connection on the owning thread
+    QString m_lastError;
+
+    QFileSystemWatcher* m_watcher = nullptr;
+    QTimer* m_rescanTimer = nullptr;
+    QThreadPool m_scanPool;
+    bool m_scanning = false;
+    bool m_rescanPending = false;
+};
+
+#endif // LOGCATALOG_H
@@ -0,0 +1,314 @@
+#include "Metrics.h"
+#include "Trace.h"
+#include <QtNumeric>
+#include <atomic>
+
+namespace {
+
+// Bucket upper bounds in nanoseconds; ELM327 replies take from ~20 ms (AT
+// commands) to several seconds (first request after AT SP 0)
+const qint64 RTT_BOUNDS_NS[Metrics::RTT_BUCKET_COUNT - 1] = {
+    10000000, 25000000, 50000000, 100000000, 250000000,
+    500000000, 1000000000, 2500000000, 5000000000
+};
+
+struct TimeoutSlot {
+    std::atomic<quint64> key{0};    // Trace::packText() of the command, 0 = free
+    std::atomic<quint64> count{0};
+};
+
+std::atomic<quint64> g_counters[Metrics::CounterCount];
+std::atomic<quint64> g_transportBytes[Metrics::TransportCount][2];
+std::atomic<quint64> g_transportConnects[Metrics::TransportCount];
+std::atomic<quint64> g_transportReconnects[Metrics::TransportCount];
+std::atomic<quint64> g_rttBuckets[Metrics::RTT_BUCKET_COUNT];
+std::atomic<quint64> g_rttSumNs{0};
+TimeoutSlot g_timeouts[Metrics::TIMEOUT_SLOTS];
+std::atomic<quint64> g_otherTimeouts{0};
+std::atomic<int> g_requestedSampleRate{0};
+
+const char* const TRANSPORT_NAMES[Metrics::TransportCount] = {"serial", "tcp"};
+
+quint64 timeoutKey(const QByteArray& command)
+{
+    return Trace::packText(command.trimmed());
+}
+
+int slotFor(quint64 key)
+{
+    // Fibonacci hashing onto the power-of-two table
+    static_assert((Metrics::TIMEOUT_SLOTS & (Metrics::TIMEOUT_SLOTS - 1)) == 0, "TIMEOUT_SLOTS must be a power of two");
+    return int((key * 0x9E3779B97F4A7C15ull) >> 58) & (Metrics::TIMEOUT_SLOTS - 1);
+}
+
+QByteArray labelValue(const QByteArray& value)
+{
+    QByteArray escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void header(QByteArray& out, const char* name, const char* type, const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void sample(QByteArray& out, const char* name, const QByteArray& labels, const QByteArray& value)
+{
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+void counter(QByteArray& out, const char* name, const char* help, quint64 value)
+{
+    header(out, name, "counter", help);
+    sample(out, name, QByteArray(), QByteArray::number(value));
+}
+
+} // namespace
+
+void Metrics::increment(Counter counter, quint64 by)
+{
+    g_counters[counter].fetch_add(by, std::memory_order_relaxed);
+}
+
+quint64 Metrics::value(Counter counter)
+{
+    return g_counters[counter].load(std::memory_order_relaxed);
+}
+
+void Metrics::addTransportBytes(Transport transport, Direction direction, quint64 bytes)
+{
+    g_transportBytes[transport][direction].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+quint64 Metrics::transportBytes(Transport transport, Direction direction)
+{
+    return g_transportBytes[transport][direction].load(std::memory_order_relaxed);
+}
+
+void Metrics::transportConnected(Transport transport, bool reconnect)
+{
+    g_transportConnects[transport].fetch_add(1, std::memory_order_relaxed);
+    if (reconnect) {
+        g_transportReconnects[transport].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+quint64 Metrics::transportConnects(Transport transport)
+{
+    return g_transportConnects[transport].load(std::memory_order_relaxed);
+}
+
+quint64 Metrics::transportReconnects(Transport transport)
+{
+    return g_transportReconnects[transport].load(std::memory_order_relaxed);
+}
+
+void Metrics::observeCommandRtt(qint64 nanoseconds)
+{
+    nanoseconds = qMax<qint64>(0, nanoseconds);
+    int bucket = 0;
+    while (bucket < RTT_BUCKET_COUNT - 1 && nanoseconds > RTT_BOUNDS_NS[bucket]) {
+        ++bucket;
+    }
+    g_rttBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    g_rttSumNs.fetch_add(quint64(nanoseconds), std::memory_order_relaxed);
+}
+
+double Metrics::rttBucketBound(int index)
+{
+    if (index < 0 || index >= RTT_BUCKET_COUNT - 1) {
+        return qInf();
+    }
+    return double(RTT_BOUNDS_NS[index]) / 1e9;
+}
+
+QVector<quint64> Metrics::commandRttBuckets()
+{
+    QVector<quint64> buckets(RTT_BUCKET_COUNT);
+    for (int i = 0; i < RTT_BUCKET_COUNT; ++i) {
+        buckets[i] = g_rttBuckets[i].load(std::memory_order_relaxed);
+    }
+    return buckets;
+}
+
+quint64 Metrics::commandRttCount()
+{
+    quint64 count = 0;
+    for (const auto& bucket : g_rttBuckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+double Metrics::commandRttSumSeconds()
+{
+    return double(g_rttSumNs.load(std::memory_order_relaxed)) / 1e9;
+}
+
+void Metrics::commandTimedOut(const QByteArray& command)
+{
+    g_counters[CommandTimeouts].fetch_add(1, std::memory_order_relaxed);
+
+    const quint64 key = timeoutKey(command);
+    if (key != 0) {
+        const int start = slotFor(key);
+        for (int probe = 0; probe < TIMEOUT_SLOTS; ++probe) {
+            TimeoutSlot& slot = g_timeouts[(start + probe) & (TIMEOUT_SLOTS - 1)];
+            quint64 current = slot.key.load(std::memory_order_acquire);
+            if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                current = key;
+            }
+            if (current == key) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+    g_otherTimeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 Metrics::commandTimeouts(const QByteArray& command)
+{
+    const quint64 key = timeoutKey(command);
+    if (key == 0) {
+        return 0;
+    }
+    const int start = slotFor(key);
+    for (int probe = 0; probe < TIMEOUT_SLOTS; ++probe) {
+        const TimeoutSlot& slot = g_timeouts[(start + probe) & (TIMEOUT_SLOTS - 1)];
+        const quint64 current = slot.key.load(std::memory_order_acquire);
+        if (current == key) {
+            return slot.count.load(std::memory_order_relaxed);
+        }
+        if (current == 0) {
+            break;
+        }
+    }
+    return 0;
+}
+
+void Metrics::setRequestedSampleRate(int hz)
+{
+    g_requestedSampleRate.store(hz, std::memory_order_relaxed);
+}
+
+int Metrics::requestedSampleRate()
+{
+    return g_requestedSampleRate.load(std::memory_order_relaxed);
+}
+
+QByteArray Metrics::prometheusText()
+{
+    QByteArray out;
+    out.reserve(4096);
+
+    counter(out, "obdread_scans_completed_total", "Scans that ran to the end of their plan.",
+            value(ScansCompleted));
+    counter(out, "obdread_scans_failed_total", "Scans that failed or were cut short by a timeout.",
+            value(ScansFailed));
+    counter(out, "obdread_commands_sent_total", "OBD-II and AT commands written to an adapter.",
+            value(CommandsSent));
+
+    header(out, "obdread_command_rtt_seconds", "histogram", "Time from writing a command to its prompt.");
+    quint64 cumulative = 0;
+    const QVector<quint64> buckets = commandRttBuckets();
+    for (int i = 0; i < RTT_BUCKET_COUNT; ++i) {
+        cumulative += buckets.at(i);
+        const QByteArray bound = i < RTT_BUCKET_COUNT - 1 ? QByteArray::number(rttBucketBound(i), 'g', 6)
+                                                         : QByteArray("+Inf");
+        sample(out, "obdread_command_rtt_seconds_bucket", "le=\"" + bound + "\"", QByteArray::number(cumulative));
+    }
+    sample(out, "obdread_command_rtt_seconds_sum", QByteArray(), QByteArray::number(commandRttSumSeconds(), 'f', 6));
+    sample(out, "obdread_command_rtt_seconds_count", QByteArray(), QByteArray::number(cumulative));
+
+    header(out, "obdread_command_timeouts_total", "counter", "Commands that got no prompt in time, by command.");
+    for (const TimeoutSlot& slot : g_timeouts) {
+        const quint64 key = slot.key.load(std::memory_order_acquire);
+        if (key != 0) {
+            sample(out, "obdread_command_timeouts_total",
+                   "command=\"" + labelValue(Trace::unpackText(key)) + "\"",
+                   QByteArray::number(slot.count.load(std::memory_order_relaxed)));
+        }
+    }
+    const quint64 other = g_otherTimeouts.load(std::memory_order_relaxed);
+    if (other != 0) {
+        sample(out, "obdread_command_timeouts_total", "command=\"other\"", QByteArray::number(other));
+    }
+
+    header(out, "obdread_transport_bytes_total", "counter", "Bytes written to and read from adapters.");
+    for (int t = 0; t < TransportCount; ++t) {
+        const QByteArray transport = QByteArray("transport=\"") + TRANSPORT_NAMES[t] + "\"";
+        sample(out, "obdread_transport_bytes_total", transport + ",direction=\"sent\"",
+               QByteArray::number(transportBytes(Transport(t), Sent)));
+        sample(out, "obdread_transport_bytes_total", transport + ",direction=\"received\"",
+               QByteArray::number(transportBytes(Transport(t), Received)));
+    }
+
+    header(out, "obdread_transport_connects_total", "counter", "Successful adapter connections.");
+    for (int t = 0; t < TransportCount; ++t) {
+        sample(out, "obdread_transport_connects_total", QByteArray("transport=\"") + TRANSPORT_NAMES[t] + "\"",
+               QByteArray::number(transportConnects(Transport(t))));
+    }
+    header(out, "obdread_transport_reconnects_total", "counter",
+           "Connections of a transporter that had been connected before.");
+    for (int t = 0; t < TransportCount; ++t) {
+        sample(out, "obdread_transport_reconnects_total", QByteArray("transport=\"") + TRANSPORT_NAMES[t] + "\"",
+               QByteArray::number(transportReconnects(Transport(t))));
+    }
+
+    counter(out, "obdread_live_samples_total", "Live PID samples received.", value(LiveSamples));
+    counter(out, "obdread_live_notifications_total", "Frame-paced live data notifications delivered to views.",
+            value(LiveNotifications));
+    header(out, "obdread_live_notification_rate_requested_hz", "gauge", "Requested live data notification rate.");
+    sample(out, "obdread_live_notification_rate_requested_hz", QByteArray(), QByteArray::number(requestedSampleRate()));
+
+    return out;
+}
+
+void Metrics::reset()
+{
+    for (auto& entry : g_counters) {
+        entry.store(0, std::memory_order_relaxed);
+    }
+    for (int t = 0; t < TransportCount; ++t) {
+        g_transportBytes[t][Sent].store(0, std::memory_order_relaxed);
+        g_transportBytes[t][Received].store(0, std::memory_order_relaxed);
+        g_transportConnects[t].store(0, std::memory_order_relaxed);
+        g_transportReconnects[t].store(0, std::memory_order_relaxed);
+    }
+    for (auto& bucket : g_rttBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    g_rttSumNs.store(0, std::memory_order_relaxed);
+    for (TimeoutSlot& slot : g_timeouts) {
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.key.store(0, std::memory_order_release);
+    }
+    g_otherTimeouts.store(0, std::memory_order_relaxed);
+}
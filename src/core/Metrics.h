@@ -0,0 +1,99 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief The Metrics class
+ * Process-wide counters and histograms for unattended bay stations, served in
+ * Prometheus text format by MetricsServer.
+ *
+ * Every update is a relaxed atomic add on a fixed slot: no lock, no allocation
+ * and no formatting on the scan or transport path. Per-command timeouts use a
+ * fixed open-addressing table keyed by the packed command text; commands that
+ * do not fit are counted under command="other".
+ */
+class Metrics
+{
+public:
+    enum Counter {
+        ScansCompleted,     // Scans that ran to the end of their plan
+        ScansFailed,        // Scans that failed or were cut short by a timeout
+        CommandsSent,
+        CommandTimeouts,    // All commands; see commandTimeouts() for the split
+        LiveSamples,        // Samples stored in AppState
+        LiveNotifications,  // Frame-paced liveSampleChanged() deliveries
+        CounterCount
+    };
+
+    enum Transport {
+        Serial,
+        Tcp,
+        TransportCount
+    };
+
+    enum Direction {
+        Sent,
+        Received
+    };
+
+    static constexpr int RTT_BUCKET_COUNT = 10;         // Including +Inf
+    static constexpr int TIMEOUT_SLOTS = 64;            // Distinct commands tracked by text
+
+    static void increment(Counter counter, quint64 by = 1);
+    static quint64 value(Counter counter);
+
+    static void addTransportBytes(Transport transport, Direction direction, quint64 bytes);
+    static quint64 transportBytes(Transport transport, Direction direction);
+
+    /**
+     * @brief Counts a successful connection; @p reconnect if the same
+     * transporter had been connected before.
+     */
+    static void transportConnected(Transport transport, bool reconnect);
+    static quint64 transportConnects(Transport transport);
+    static quint64 transportReconnects(Transport transport);
+
+    /**
+     * @brief Records one command round trip (written to prompt received).
+     */
+    static void observeCommandRtt(qint64 nanoseconds);
+
+    /**
+     * @brief Upper bound of bucket @p index in seconds; the last bucket is +Inf.
+     */
+    static double rttBucketBound(int index);
+
+    /**
+     * @brief Non-cumulative count per bucket, RTT_BUCKET_COUNT entries.
+     */
+    static QVector<quint64> commandRttBuckets();
+    static quint64 commandRttCount();
+    static double commandRttSumSeconds();
+
+    static void commandTimedOut(const QByteArray& command);
+    static quint64 commandTimeouts(const QByteArray& command);
+
+    /**
+     * @brief Live data notification rate asked of AppState (Hz). The rate
+     * achieved is rate(obdread_live_notifications_total).
+     */
+    static void setRequestedSampleRate(int hz);
+    static int requestedSampleRate();
+
+    /**
+     * @brief All metrics in Prometheus text exposition format 0.0.4.
+     */
+    static QByteArray prometheusText();
+
+    /**
+     * @brief Zeroes every metric (tests and benchmarks).
+     */
+    static void reset();
+
+private:
+    Metrics() = delete;  // Static class, prevent instantiation
+};
+
+#endif // METRICS_H
@@ -0,0 +1,88 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+
+bool MetricsServer::listen(quint16 port, const QHostAddress& address)
+{
+    m_lastError.clear();
+    if (!m_server->listen(address, port)) {
+        m_lastError = QString("Cannot listen on %1:%2: %3").arg(address.toString()).arg(port)
+                          .arg(m_server->errorString());
+        return false;
+    }
+    return true;
+}
+
+void MetricsServer::close()
+{
+    m_server->close();
+}
+
+bool MetricsServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+quint16 MetricsServer::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+    }
+}
+
+void MetricsServer::onReadyRead(QTcpSocket* socket)
+{
+    // Wait for the end of the request headers; the body, if any, is ignored
+    const QByteArray pending = socket->peek(MAX_REQUEST_BYTES + 1);
+    if (!pending.contains("\r\n\r\n") && !pending.contains("\n\n")) {
+        if (pending.size() > MAX_REQUEST_BYTES) {
+            respond(socket, "431 Request Header Fields Too Large", "Request too large\n");
+        }
+        return;
+    }
+    socket->readAll();
+
+    const QList<QByteArray> requestLine = pending.left(pending.indexOf('\n')).trimmed().split(' ');
+    const QByteArray method = requestLine.value(0);
+    const QByteArray target = requestLine.value(1);
+    const QByteArray path = target.left(target.indexOf('?') >= 0 ? target.indexOf('?') : target.size());
+
+    if (path != "/metrics") {
+        respond(socket, "404 Not Found", "Not found; metrics are at /metrics\n");
+    } else if (method != "GET") {
+        respond(socket, "405 Method Not Allowed", "Only GET is supported\n");
+    } else {
+        respond(socket, "200 OK", Metrics::prometheusText());
+    }
+}
+
+void MetricsServer::respond(QTcpSocket* socket, const QByteArray& status, const QByteArray& body)
+{
+    QByteArray response = "HTTP/1.0 " + status + "\r\n";
+    response += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    QObject::disconnect(socket, &QTcpSocket::readyRead, nullptr, nullptr);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
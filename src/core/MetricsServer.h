@@ -0,0 +1,49 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @brief The MetricsServer class
+ * Minimal HTTP/1.0 endpoint serving Metrics::prometheusText() at GET /metrics.
+ *
+ * Runs on the owning thread's event loop. Each request is answered and the
+ * connection closed; anything other than GET /metrics gets 404 or 405.
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer() override;
+
+    /**
+     * @brief Starts listening. Port 0 picks a free port (see serverPort()).
+     * @return false with lastError() set if the port cannot be bound.
+     */
+    bool listen(quint16 port, const QHostAddress& address = QHostAddress::LocalHost);
+    void close();
+    bool isListening() const;
+    quint16 serverPort() const;
+    QString lastError() const { return m_lastError; }
+
+    static constexpr int MAX_REQUEST_BYTES = 8192;
+
+private slots:
+    void onNewConnection();
+
+private:
+    void onReadyRead(QTcpSocket* socket);
+    static void respond(QTcpSocket* socket, const QByteArray& status, const QByteArray& body);
+
+    QTcpServer* m_server;
+    QString m_lastError;
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,23 @@
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <QtGlobal>
+#include <chrono>
+
+/**
+ * @brief The MonotonicClock class
+ * The steady nanosecond clock that trace events, transport stamps and sample
+ * times are all taken with. Header-only and free of project includes, so
+ * transports can stamp with it without depending on SampleClock.
+ */
+class MonotonicClock
+{
+public:
+    static qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+#endif // MONOTONICCLOCK_H
@@ -0,0 +1,416 @@
+#include "PidExpression.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct PidName {
+    const char* name;
+    const char* pidId;
+};
+
+// Short names for the Mode 01 PIDs derived channels are usually built from
+constexpr PidName PID_NAMES[] = {
+    {"load", "0104"},
+    {"ect", "0105"},
+    {"coolant", "0105"},
+    {"stft", "0106"},
+    {"ltft", "0107"},
+    {"map", "010B"},
+    {"rpm", "010C"},
+    {"vss", "010D"},
+    {"speed", "010D"},
+    {"timing", "010E"},
+    {"iat", "010F"},
+    {"maf", "0110"},
+    {"tps", "0111"},
+    {"throttle", "0111"},
+    {"runtime", "011F"},
+    {"fuel_level", "012F"},
+    {"baro", "0133"},
+    {"voltage", "0142"},
+    {"abs_load", "0143"},
+    {"lambda", "0144"},
+    {"ambient", "0146"},
+    {"fuel_rate", "015E"}
+};
+
+// Applies op element-wise to two columns, leaving the result in the first
+template <typename Op>
+void applyColumns(double* a, const double* b, int count, Op op)
+{
+    for (int i = 0; i < count; ++i) {
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Recursive descent parser emitting postfix code as it goes.
+ */
+class PidExpression::Parser
+{
+public:
+    Parser(const QString& text, PidExpression& out)
+        : m_text(text), m_out(out) {}
+
+    bool run()
+    {
+        parseSum();
+        skipSpace();
+        if (m_error.isEmpty() && m_pos < m_text.size()) {
+            fail(QString("Unexpected '%1'").arg(m_text.at(m_pos)));
+        }
+        return m_error.isEmpty();
+    }
+
+    const QString& error() const { return m_error; }
+
+private:
+    void parseSum()
+    {
+        parseProduct();
+        while (m_error.isEmpty()) {
+            if (accept('+')) {
+                parseProduct();
+                emitOp(Add, -1);
+            } else if (accept('-')) {
+                parseProduct();
+                emitOp(Subtract, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseProduct()
+    {
+        parseUnary();
+        while (m_error.isEmpty()) {
+            if (accept('*')) {
+                parseUnary();
+                emitOp(Multiply, -1);
+            } else if (accept('/')) {
+                parseUnary();
+                emitOp(Divide, -1);
+            } else {
+                break;
+            }
+        }
+    }
+
+    void parseUnary()
+    {
+        // Every recursion passes through here; bounds the parser's own stack
+        if (++m_nesting > MAX_NESTING) {
+            fail("Expression nested too deeply");
+        } else if (accept('-')) {
+            parseUnary();
+            emitOp(Negate, 0);
+        } else {
+            parsePower();
+        }
+        --m_nesting;
+    }
+
+    void parsePower()
+    {
+        parsePrimary();
+        // Right associative, and binds tighter than unary minus on its left: -2^2 = -4
+        if (m_error.isEmpty() && accept('^')) {
+            parseUnary();
+            emitOp(Power, -1);
+        }
+    }
+
+    void parsePrimary()
+    {
+        skipSpace();
+        if (m_pos >= m_text.size()) {
+            fail("Unexpected end of expression");
+            return;
+        }
+
+        const QChar c = m_text.at(m_pos);
+        if (c == '(') {
+            ++m_pos;
+            parseSum();
+            expect(')');
+        } else if (c == '[') {
+            const int end = m_text.indexOf(']', m_pos);
+            if (end < 0) {
+                fail("Missing ']'");
+                return;
+            }
+            const QString pidId = m_text.mid(m_pos + 1, end - m_pos - 1).trimmed().toUpper();
+            if (pidId.isEmpty()) {
+                fail("Empty PID id");
+                return;
+            }
+            m_pos = end + 1;
+            pushInput(pidId);
+        } else if (c.isDigit() || c == '.') {
+            parseNumber();
+        } else if (c.isLetter() || c == '_') {
+            const int start = m_pos;
+            while (m_pos < m_text.size() && (m_text.at(m_pos).isLetterOrNumber() || m_text.at(m_pos) == '_')) {
+                ++m_pos;
+            }
+            const QString name = m_text.mid(start, m_pos - start).toLower();
+            if (accept('(')) {
+                parseCall(name);
+            } else {
+                const QString pidId = PidExpression::pidForName(name);
+                if (pidId.isEmpty()) {
+                    fail(QString("Unknown PID name '%1'").arg(name));
+                    return;
+                }
+                pushInput(pidId);
+            }
+        } else {
+            fail(QString("Unexpected '%1'").arg(c));
+        }
+    }
+
+    void parseCall(const QString& name)
+    {
+        if (name == "abs") {
+            parseSum();
+            expect(')');
+            emitOp(Abs, 0);
+        } else if (name == "min" || name == "max") {
+            parseSum();
+            expect(',');
+            parseSum();
+            expect(')');
+            emitOp(name == "min" ? Min : Max, -1);
+        } else {
+            fail(QString("Unknown function '%1'").arg(name));
+        }
+    }
+
+    void parseNumber()
+    {
+        // Digits, an optional fraction and an optional exponent
+        const int start = m_pos;
+        auto digits = [this]() {
+            while (m_pos < m_text.size() && m_text.at(m_pos).isDigit()) {
+                ++m_pos;
+            }
+        };
+        digits();
+        if (m_pos < m_text.size() && m_text.at(m_pos) == '.') {
+            ++m_pos;
+            digits();
+        }
+        if (m_pos < m_text.size() && (m_text.at(m_pos) == 'e' || m_text.at(m_pos) == 'E')) {
+            ++m_pos;
+            if (m_pos < m_text.size() && (m_text.at(m_pos) == '+' || m_text.at(m_pos) == '-')) {
+                ++m_pos;
+            }
+            digits();
+        }
+
+        bool ok = false;
+        const double value = m_text.mid(start, m_pos - start).toDouble(&ok);
+        if (!ok) {
+            fail(QString("Invalid number '%1'").arg(m_text.mid(start, m_pos - start)));
+            return;
+        }
+
+        int index = m_out.m_constants.indexOf(value);
+        if (index < 0) {
+            if (m_out.m_constants.size() >= MAX_OPERANDS) {
+                fail("Too many constants");
+                return;
+            }
+            index = m_out.m_constants.size();
+            m_out.m_constants.append(value);
+        }
+        emitPush(PushConstant, index);
+    }
+
+    void pushInput(const QString& pidId)
+    {
+        int slot = m_out.m_inputs.indexOf(pidId);
+        if (slot < 0) {
+            if (m_out.m_inputs.size() >= MAX_OPERANDS) {
+                fail("Too many PIDs");
+                return;
+            }
+            slot = m_out.m_inputs.size();
+            m_out.m_inputs.append(pidId);
+        }
+        emitPush(PushInput, slot);
+    }
+
+    void emitPush(OpCode op, int arg)
+    {
+        if (m_depth >= MAX_STACK_DEPTH) {
+            fail("Expression nested too deeply");
+            return;
+        }
+        m_out.m_code.append({op, quint8(arg)});
+        ++m_depth;
+        m_out.m_stackDepth = std::max(m_out.m_stackDepth, m_depth);
+    }
+
+    void emitOp(OpCode op, int stackChange)
+    {
+        if (!m_error.isEmpty()) {
+            return;
+        }
+        m_out.m_code.append({op, 0});
+        m_depth += stackChange;
+    }
+
+    void skipSpace()
+    {
+        while (m_pos < m_text.size() && m_text.at(m_pos).isSpace()) {
+            ++m_pos;
+        }
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text.at(m_pos) == QLatin1Char(c)) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (m_error.isEmpty() && !accept(c)) {
+            fail(QString("Expected '%1'").arg(QLatin1Char(c)));
+        }
+    }
+
+    void fail(const QString& message)
+    {
+        if (m_error.isEmpty()) {
+            m_error = QString("%1 at position %2").arg(message).arg(m_pos + 1);
+        }
+    }
+
+    const QString& m_text;
+    PidExpression& m_out;
+    static constexpr int MAX_NESTING = 256;
+
+    int m_pos = 0;
+    int m_depth = 0;
+    int m_nesting = 0;
+    QString m_error;
+};
+
+PidExpression PidExpression::parse(const QString& text, QString* error)
+{
+    PidExpression expression;
+    expression.m_text = text;
+
+    Parser parser(text, expression);
+    if (!parser.run()) {
+        if (error) {
+            *error = parser.error();
+        }
+        return PidExpression();
+    }
+
+    if (error) {
+        error->clear();
+    }
+    expression.m_valid = true;
+    return expression;
+}
+
+QString PidExpression::pidForName(const QString& name)
+{
+    const QString lower = name.toLower();
+    for (const PidName& entry : PID_NAMES) {
+        if (lower == QLatin1String(entry.name)) {
+            return QString::fromLatin1(entry.pidId);
+        }
+    }
+    return QString();
+}
+
+double PidExpression::evaluate(const double* inputs) const
+{
+    double stack[MAX_STACK_DEPTH];
+    int top = 0;
+    for (const Instruction& instruction : m_code) {
+        switch (instruction.op) {
+        case PushConstant: stack[top++] = m_constants[instruction.arg]; break;
+        case PushInput:    stack[top++] = inputs[instruction.arg]; break;
+        case Add:          --top; stack[top - 1] += stack[top]; break;
+        case Subtract:     --top; stack[top - 1] -= stack[top]; break;
+        case Multiply:     --top; stack[top - 1] *= stack[top]; break;
+        case Divide:       --top; stack[top - 1] /= stack[top]; break;
+        case Power:        --top; stack[top - 1] = std::pow(stack[top - 1], stack[top]); break;
+        case Negate:       stack[top - 1] = -stack[top - 1]; break;
+        case Min:          --top; stack[top - 1] = std::min(stack[top - 1], stack[top]); break;
+        case Max:          --top; stack[top - 1] = std::max(stack[top - 1], stack[top]); break;
+        case Abs:          stack[top - 1] = std::fabs(stack[top - 1]); break;
+        }
+    }
+    return top > 0 ? stack[top - 1] : 0.0;
+}
+
+void PidExpression::evaluateBatch(const double* const* columns, int count, double* out, double* scratch) const
+{
+    if (count <= 0 || m_code.isEmpty()) {
+        return;
+    }
+
+    // Stack entry k is the column scratch[k * count .. (k + 1) * count)
+    int top = 0;
+    auto column = [scratch, count](int index) { return scratch + qsizetype(index) * count; };
+
+    for (const Instruction& instruction : m_code) {
+        switch (instruction.op) {
+        case PushConstant:
+            std::fill(column(top), column(top) + count, m_constants[instruction.arg]);
+            ++top;
+            break;
+        case PushInput:
+            std::copy(columns[instruction.arg], columns[instruction.arg] + count, column(top));
+            ++top;
+            break;
+        case Negate: {
+            double* a = column(top - 1);
+            for (int i = 0; i < count; ++i) {
+                a[i] = -a[i];
+            }
+            break;
+        }
+        case Abs: {
+            double* a = column(top - 1);
+            for (int i = 0; i < count; ++i) {
+                a[i] = std::fabs(a[i]);
+            }
+            break;
+        }
+        default: {
+            --top;
+            double* a = column(top - 1);
+            const double* b = column(top);
+            switch (instruction.op) {
+            case Add:      applyColumns(a, b, count, [](double x, double y) { return x + y; }); break;
+            case Subtract: applyColumns(a, b, count, [](double x, double y) { return x - y; }); break;
+            case Multiply: applyColumns(a, b, count, [](double x, double y) { return x * y; }); break;
+            case Divide:   applyColumns(a, b, count, [](double x, double y) { return x / y; }); break;
+            case Power:    applyColumns(a, b, count, [](double x, double y) { return std::pow(x, y); }); break;
+            case Min:      applyColumns(a, b, count, [](double x, double y) { return std::min(x, y); }); break;
+            case Max:      applyColumns(a, b, count, [](double x, double y) { return std::max(x, y); }); break;
+            default:       break;
+            }
+            break;
+        }
+        }
+    }
+
+    std::copy(column(0), column(0) + count, out);
+}
@@ -0,0 +1,102 @@
+#ifndef PIDEXPRESSION_H
+#define PIDEXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The PidExpression class
+ * An arithmetic expression over live PIDs, parsed once into stack bytecode.
+ *
+ * Syntax:
+ * - numbers: 7.718, 1e-3
+ * - PIDs by name (rpm, vss, maf, load, ...; see pidForName()) or by id: [010C]
+ * - + - * / ^, unary minus and parentheses, with the usual precedence
+ * - min(a, b), max(a, b), abs(a)
+ *
+ * evaluateBatch() runs each instruction over a whole column of rows before
+ * the next one, so the inner loops are plain array loops the compiler can
+ * vectorise, and the dispatch cost is paid once per batch, not per row.
+ */
+class PidExpression
+{
+public:
+    enum OpCode : quint8 {
+        PushConstant,   // arg: index into constants()
+        PushInput,      // arg: input slot, see inputs()
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Power,
+        Negate,
+        Min,
+        Max,
+        Abs
+    };
+
+    struct Instruction {
+        OpCode op;
+        quint8 arg;
+    };
+
+    static constexpr int MAX_OPERANDS = 256;   // Constants and inputs each, as arg is one byte
+    static constexpr int MAX_STACK_DEPTH = 64;
+
+    PidExpression() = default;
+
+    /**
+     * @brief Parses and compiles an expression.
+     * @param error Set to a description of the problem if parsing fails.
+     * @return An invalid expression on failure (see isValid()).
+     */
+    static PidExpression parse(const QString& text, QString* error = nullptr);
+
+    /**
+     * @brief PID id for a well-known short name ("rpm" -> "010C"), empty if unknown.
+     */
+    static QString pidForName(const QString& name);
+
+    bool isValid() const { return m_valid; }
+    const QString& text() const { return m_text; }
+
+    /**
+     * @brief PID ids the expression reads; the position is the input slot.
+     */
+    const QStringList& inputs() const { return m_inputs; }
+    const QVector<double>& constants() const { return m_constants; }
+    const QVector<Instruction>& code() const { return m_code; }
+
+    /**
+     * @brief Deepest operand stack the code needs.
+     */
+    int stackDepth() const { return m_stackDepth; }
+
+    /**
+     * @brief Evaluates one row.
+     * @param inputs One value per input slot.
+     */
+    double evaluate(const double* inputs) const;
+
+    /**
+     * @brief Evaluates @p count rows.
+     * @param columns One array of @p count values per input slot.
+     * @param out Receives @p count results.
+     * @param scratch At least scratchSize(count) doubles, reused between calls.
+     */
+    void evaluateBatch(const double* const* columns, int count, double* out, double* scratch) const;
+    int scratchSize(int count) const { return m_stackDepth * count; }
+
+private:
+    class Parser;
+
+    QString m_text;
+    QStringList m_inputs;
+    QVector<double> m_constants;
+    QVector<Instruction> m_code;
+    int m_stackDepth = 0;
+    bool m_valid = false;
+};
+
+#endif // PIDEXPRESSION_H
@@ -0,0 +1,292 @@
+#include "PidStatistics.h"
+#include "SampleClock.h"
+#include <cmath>
+
+namespace {
+
+const double INITIAL_BIN_WIDTH = 1.0 / 256.0;
+
+} // namespace
+
+// --- Moments ---
+
+void PidStatistics::Moments::add(double value)
+{
+    if (count == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+    ++count;
+    const double delta = value - mean;
+    mean += delta / double(count);
+    m2 += delta * (value - mean);
+}
+
+void PidStatistics::Moments::merge(const Moments& other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    const double total = double(count + other.count);
+    const double delta = other.mean - mean;
+    mean += delta * double(other.count) / total;
+    m2 += other.m2 + delta * delta * double(count) * double(other.count) / total;
+    count += other.count;
+    min = qMin(min, other.min);
+    max = qMax(max, other.max);
+}
+
+double PidStatistics::Moments::stddev() const
+{
+    return std::sqrt(variance());
+}
+
+// --- Histogram ---
+
+void PidStatistics::Histogram::add(double value, quint64 count)
+{
+    if (!std::isfinite(value) || count == 0) {
+        return;
+    }
+
+    if (m_width == 0.0) {
+        m_width = INITIAL_BIN_WIDTH;
+        m_origin = std::floor(value / m_width) * m_width;
+    }
+    if (value < m_origin || value >= upper()) {
+        widen(value, value, m_width);
+    }
+
+    const int bin = qBound(0, int((value - m_origin) / m_width), BINS - 1);
+    m_bins[bin] += count;
+    m_total += count;
+}
+
+void PidStatistics::Histogram::merge(const Histogram& other)
+{
+    if (other.isEmpty()) {
+        return;
+    }
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+
+    // Both grids are aligned powers of two: at the coarser width every bin of
+    // the finer one falls into exactly one bin
+    widen(other.lower(), other.upper() - other.binWidth(), other.binWidth());
+    for (int i = 0; i < BINS; ++i) {
+        if (other.m_bins[i] > 0) {
+            add(other.lower() + i * other.binWidth(), other.m_bins[i]);
+        }
+    }
+}
+
+void PidStatistics::Histogram::clear()
+{
+    m_origin = 0.0;
+    m_width = 0.0;
+    m_bins.fill(0);
+    m_total = 0;
+}
+
+void PidStatistics::Histogram::widen(double low, double high, double minWidth)
+{
+    const double oldLower = m_origin;
+    const double oldUpper = upper();
+    low = qMin(low, oldLower);
+
+    double width = m_width;
+    double origin = m_origin;
+    while (width < minWidth || origin > low || high >= origin + BINS * width || oldUpper > origin + BINS * width) {
+        width *= 2.0;
+        origin = std::floor(low / width) * width;
+    }
+    if (width == m_width && origin == m_origin) {
+        return;
+    }
+
+    std::array<quint64, BINS> bins{};
+    for (int i = 0; i < BINS; ++i) {
+        if (m_bins[i] > 0) {
+            const int bin = qBound(0, int((oldLower + i * m_width - origin) / width), BINS - 1);
+            bins[bin] += m_bins[i];
+        }
+    }
+    m_bins = bins;
+    m_origin = origin;
+    m_width = width;
+}
+
+// --- Aggregate ---
+
+void PidStatistics::Aggregate::add(double value, qint64 timeNs)
+{
+    if (moments.count == 0) {
+        firstTimeNs = timeNs;
+    }
+    lastTimeNs = timeNs;
+    moments.add(value);
+    digest.add(value);
+    histogram.add(value);
+}
+
+void PidStatistics::Aggregate::merge(const Aggregate& other)
+{
+    if (other.moments.count == 0) {
+        return;
+    }
+    if (moments.count == 0) {
+        firstTimeNs = other.firstTimeNs;
+        lastTimeNs = other.lastTimeNs;
+    } else {
+        firstTimeNs = qMin(firstTimeNs, other.firstTimeNs);
+        lastTimeNs = qMax(lastTimeNs, other.lastTimeNs);
+    }
+    moments.merge(other.moments);
+    digest.merge(other.digest);
+    histogram.merge(other.histogram);
+}
+
+void PidStatistics::Aggregate::clear()
+{
+    moments = Moments();
+    digest.clear();
+    histogram.clear();
+    firstTimeNs = 0;
+    lastTimeNs = 0;
+}
+
+// --- PidStatistics ---
+
+PidStatistics::PidStatistics(int windowMs)
+    : m_bucketNs(1)
+{
+    setWindowMs(windowMs);
+}
+
+void PidStatistics::setWindowMs(int ms)
+{
+    m_bucketNs = qMax<qint64>(1, qint64(qMax(WINDOW_BUCKETS, ms)) * 1000000 / WINDOW_BUCKETS);
+    m_latestBucket = -1;
+    for (Stream& stream : m_streams) {
+        for (Bucket& bucket : stream.buckets) {
+            bucket.index = -1;
+            bucket.aggregate.clear();
+        }
+        stream.lastBucket = -1;
+    }
+}
+
+void PidStatistics::add(const PidSample& sample)
+{
+    if (sample.pidId.isEmpty() || !std::isfinite(sample.value)) {
+        return;
+    }
+
+    int streamIndex = m_index.value(sample.pidId, -1);
+    if (streamIndex < 0) {
+        streamIndex = m_streams.size();
+        m_index.insert(sample.pidId, streamIndex);
+        m_streams.append(Stream());
+        m_streams.last().pidId = sample.pidId;
+    }
+    Stream& stream = m_streams[streamIndex];
+    if (!sample.unit.isEmpty()) {
+        stream.unit = sample.unit;
+    }
+
+    const qint64 timeNs = SampleClock::timeOf(sample);
+    stream.session.add(sample.value, timeNs);
+
+    // Reuse the bucket's slot once its time has passed; a late sample whose
+    // bucket was already reused only counts for the session
+    const qint64 index = bucketIndex(timeNs);
+    Bucket& bucket = stream.buckets[size_t(index % WINDOW_BUCKETS)];
+    if (bucket.index < index) {
+        bucket.index = index;
+        bucket.aggregate.clear();
+    }
+    if (bucket.index == index) {
+        bucket.aggregate.add(sample.value, timeNs);
+        stream.lastBucket = qMax(stream.lastBucket, index);
+        m_latestBucket = qMax(m_latestBucket, index);
+    }
+}
+
+void PidStatistics::reset()
+{
+    m_streams.clear();
+    m_index.clear();
+    m_latestBucket = -1;
+}
+
+QStringList PidStatistics::pids() const
+{
+    QStringList result;
+    result.reserve(m_streams.size());
+    for (const Stream& stream : m_streams) {
+        result.append(stream.pidId);
+    }
+    return result;
+}
+
+PidStatistics::Summary PidStatistics::snapshot(const QString& pidId, Scope scope) const
+{
+    const int streamIndex = m_index.value(pidId, -1);
+    if (streamIndex < 0) {
+        Summary empty;
+        empty.pidId = pidId;
+        return empty;
+    }
+    return summarize(m_streams[streamIndex], scope);
+}
+
+QVector<PidStatistics::Summary> PidStatistics::snapshotAll(Scope scope) const
+{
+    QVector<Summary> result;
+    result.reserve(m_streams.size());
+    for (const Stream& stream : m_streams) {
+        result.append(summarize(stream, scope));
+    }
+    return result;
+}
+
+qint64 PidStatistics::bucketIndex(qint64 timeNs) const
+{
+    return qMax<qint64>(0, timeNs) / m_bucketNs;
+}
+
+PidStatistics::Summary PidStatistics::summarize(const Stream& stream, Scope scope) const
+{
+    Aggregate aggregate;
+    if (scope == Session) {
+        aggregate = stream.session;
+    } else {
+        const qint64 oldest = m_latestBucket - WINDOW_BUCKETS + 1;
+        for (const Bucket& bucket : stream.buckets) {
+            if (bucket.index >= 0 && bucket.index >= oldest) {
+                aggregate.merge(bucket.aggregate);
+            }
+        }
+    }
+    aggregate.digest.compress();
+
+    Summary summary;
+    summary.pidId = stream.pidId;
+    summary.unit = stream.unit;
+    summary.moments = aggregate.moments;
+    summary.digest = aggregate.digest;
+    summary.histogram = aggregate.histogram;
+    summary.firstTimeNs = aggregate.firstTimeNs;
+    summary.lastTimeNs = aggregate.lastTimeNs;
+    return summary;
+}
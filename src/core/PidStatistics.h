@@ -0,0 +1,172 @@
+#ifndef PIDSTATISTICS_H
+#define PIDSTATISTICS_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <array>
+#include "core/TDigest.h"
+#include "core/dto/PidSample.h"
+
+/**
+ * @brief The PidStatistics class
+ * Running statistics per PID, updated as samples arrive so that readers never
+ * scan the samples themselves.
+ *
+ * Every PID keeps a session aggregate and a sliding window of the last
+ * windowMs(). An aggregate holds Welford moments (count, mean, variance, exact
+ * min/max), a TDigest for percentiles and a fixed-size Histogram. The window
+ * is a ring of WINDOW_BUCKETS time buckets, each with its own aggregate: a
+ * sample updates the current bucket, and a snapshot merges the buckets still
+ * inside the window. Adding a sample is amortised O(1); a snapshot costs a
+ * merge of at most WINDOW_BUCKETS small aggregates.
+ *
+ * Window edges move in whole buckets (windowMs() / WINDOW_BUCKETS) and are
+ * measured from the newest sample of any PID. Not thread-safe.
+ */
+class PidStatistics
+{
+public:
+    /**
+     * @brief Welford's online mean and variance, mergeable (Chan et al.).
+     */
+    struct Moments {
+        quint64 count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;            // Sum of squared deviations from the mean
+        double min = 0.0;
+        double max = 0.0;
+
+        void add(double value);
+        void merge(const Moments& other);
+        double variance() const { return count > 1 ? m2 / double(count - 1) : 0.0; }  // Sample variance
+        double stddev() const;
+    };
+
+    /**
+     * @brief BINS equal-width bins whose range grows to fit the values.
+     * Bin widths are powers of two and bin edges are multiples of the width,
+     * so widening merges whole bins and histograms of different widths merge
+     * exactly. The range only grows: a single outlier coarsens the bins.
+     */
+    class Histogram
+    {
+    public:
+        static constexpr int BINS = 32;
+
+        void add(double value, quint64 count = 1);
+        void merge(const Histogram& other);
+        void clear();
+
+        bool isEmpty() const { return m_total == 0; }
+        quint64 total() const { return m_total; }
+        double lower() const { return m_origin; }
+        double binWidth() const { return m_width; }
+        double upper() const { return m_origin + BINS * m_width; }
+        const std::array<quint64, BINS>& counts() const { return m_bins; }
+
+    private:
+        void widen(double low, double high, double minWidth);
+
+        double m_origin = 0.0;
+        double m_width = 0.0;       // 0 until the first value
+        std::array<quint64, BINS> m_bins{};
+        quint64 m_total = 0;
+    };
+
+    /**
+     * @brief Statistics of one PID over one scope, detached from the live state.
+     */
+    struct Summary {
+        QString pidId;
+        QString unit;
+        Moments moments;
+        TDigest digest;
+        Histogram histogram;
+        qint64 firstTimeNs = 0;     // PidSample::sampleTimeNs of the oldest and newest sample included
+        qint64 lastTimeNs = 0;
+
+        bool isEmpty() const { return moments.count == 0; }
+        double quantile(double q) const { return digest.quantile(q); }
+    };
+
+    enum Scope {
+        Session,    // Everything since the last reset()
+        Window      // The last windowMs()
+    };
+
+    static constexpr int DEFAULT_WINDOW_MS = 60000;
+    static constexpr int WINDOW_BUCKETS = 12;
+    static constexpr double WINDOW_COMPRESSION = 50.0;   // Per bucket; buckets are short
+
+    explicit PidStatistics(int windowMs = DEFAULT_WINDOW_MS);
+
+    /**
+     * @brief Sets the sliding window length; forgets the window aggregates.
+     */
+    void setWindowMs(int ms);
+    int windowMs() const { return int(m_bucketNs * WINDOW_BUCKETS / 1000000); }
+
+    /**
+     * @brief Adds a sample. Samples without a finite value are ignored; an
+     * unstamped sample is timed now (SampleClock::timeOf()).
+     */
+    void add(const PidSample& sample);
+
+    /**
+     * @brief Forgets all PIDs, e.g. at the start of a session.
+     */
+    void reset();
+
+    QStringList pids() const;
+    bool contains(const QString& pidId) const { return m_index.contains(pidId); }
+
+    /**
+     * @brief Statistics of one PID; empty if it has no samples in the scope.
+     */
+    Summary snapshot(const QString& pidId, Scope scope = Session) const;
+
+    /**
+     * @brief Statistics of every PID, in the order they were first seen.
+     */
+    QVector<Summary> snapshotAll(Scope scope = Session) const;
+
+private:
+    struct Aggregate {
+        explicit Aggregate(double compression = TDigest::DEFAULT_COMPRESSION) : digest(compression) {}
+
+        Moments moments;
+        TDigest digest;
+        Histogram histogram;
+        qint64 firstTimeNs = 0;
+        qint64 lastTimeNs = 0;
+
+        void add(double value, qint64 timeNs);
+        void merge(const Aggregate& other);
+        void clear();               // Keeps the digest's allocations
+    };
+
+    struct Bucket {
+        qint64 index = -1;          // timeNs / bucket length; -1 = unused
+        Aggregate aggregate{WINDOW_COMPRESSION};
+    };
+
+    struct Stream {
+        QString pidId;
+        QString unit;
+        Aggregate session;
+        std::array<Bucket, WINDOW_BUCKETS> buckets;
+        qint64 lastBucket = -1;
+    };
+
+    qint64 bucketIndex(qint64 timeNs) const;
+    Summary summarize(const Stream& stream, Scope scope) const;
+
+    QVector<Stream> m_streams;
+    QHash<QString, int> m_index;    // PID id -> m_streams index
+    qint64 m_bucketNs;
+    qint64 m_latestBucket = -1;     // Newest bucket of any PID
+};
+
+#endif // PIDSTATISTICS_H
@@ -2,6 +2,105 @@
 #include <QDebug>
 #include <QByteArray>
 
+namespace {
+
+// Mode 01 PID 01 response format (per SAE J1979 / ISO 15031-5):
+// Byte 0: 0x41 (Mode 01 response)
+// Byte 1: 0x01 (PID 01)
+// Byte 2: A - MIL status (bit 7) and DTC count (bits 0-6)
+// Byte 3: B - Common monitors: availability (bits 0-2), engine type (bit 3), completeness (bits 4-6)
+// Byte 4: C - Engine-specific monitors availability
+// Byte 5: D - Engine-specific monitors completeness
+//
+// IMPORTANT: For availability bits, 1 = available. For completeness bits, 0 = complete, 1 = incomplete.
+//
+// PID 41 (monitor status this drive cycle) has the same layout; byte A is
+// reserved there and availability means "enabled this drive cycle".
+constexpr int RESPONSE_BYTES = 6;
+constexpr quint8 COMPRESSION_IGNITION_BIT = 0x08;   // B3
+
+// One row of a bit layout: the availability bit; completeness is the same bit
+// of the completeness byte (D, or the high nibble of B for common tests)
+struct MonitorBit {
+    quint8 mask;
+    Monitor monitor;
+};
+
+// Byte B, completeness in B4-B6
+constexpr MonitorBit COMMON_LAYOUT[] = {
+    {0x01, Monitor::Misfire},
+    {0x02, Monitor::FuelSystem},
+    {0x04, Monitor::Components}
+};
+
+// Bytes C/D for spark ignition (Otto or Wankel) engines
+constexpr MonitorBit SPARK_LAYOUT[] = {
+    {0x01, Monitor::Catalyst},
+    {0x02, Monitor::HeatedCatalyst},
+    {0x04, Monitor::EvapSystem},
+    {0x08, Monitor::SecondaryAir},
+    {0x10, Monitor::GasParticulate},
+    {0x20, Monitor::OxygenSensor},
+    {0x40, Monitor::OxygenSensorHeater},
+    {0x80, Monitor::Egr}
+};
+
+// Bytes C/D for compression ignition (diesel) engines; C2/D2 and C4/D4 are reserved
+constexpr MonitorBit COMPRESSION_LAYOUT[] = {
+    {0x01, Monitor::NmhcCatalyst},
+    {0x02, Monitor::NoxScr},
+    {0x08, Monitor::BoostPressure},
+    {0x20, Monitor::ExhaustGasSensor},
+    {0x40, Monitor::PmFilter},
+    {0x80, Monitor::Egr}
+};
+
+struct LayoutMasks {
+    quint16 reported = 0;
+    quint16 supported = 0;
+    quint16 incomplete = 0;
+};
+
+// Availability and completeness bits of one layout, as ReadinessResult masks
+template<size_t N>
+constexpr LayoutMasks decodeLayout(const MonitorBit (&layout)[N], quint8 available, quint8 incomplete)
+{
+    LayoutMasks masks;
+    for (const MonitorBit& entry : layout) {
+        const quint16 bit = ReadinessResult::bit(entry.monitor);
+        masks.reported |= bit;
+        if (available & entry.mask) {
+            masks.supported |= bit;
+            if (incomplete & entry.mask) {
+                masks.incomplete |= bit;
+            }
+        }
+    }
+    return masks;
+}
+
+static_assert(decodeLayout(SPARK_LAYOUT, 0x67, 0x00).supported ==
+              (ReadinessResult::bit(Monitor::Catalyst) | ReadinessResult::bit(Monitor::HeatedCatalyst) |
+               ReadinessResult::bit(Monitor::EvapSystem) | ReadinessResult::bit(Monitor::OxygenSensor) |
+               ReadinessResult::bit(Monitor::OxygenSensorHeater)),
+              "Spark layout decodes C0-C2, C5 and C6");
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
 ReadinessParser::ReadinessParser(QObject *parent)
     : QObject(parent)
 {
@@ -11,81 +110,51 @@ ReadinessParser::~ReadinessParser()
 {
 }
 
-ReadinessResult ReadinessParser::parseReadinessResponse(const QByteArray &rawData)
+ReadinessResult ReadinessParser::parseReadinessResponse(const QByteArray &rawData, quint8 pid)
 {
     ReadinessResult result;
 
-    // Clean the input (remove whitespace, newlines, and the prompt '>')
-    QByteArray clean = rawData.simplified();
-    clean.replace(">", "");
-    clean.replace(" ", "");
-
-    // Handle "Empty" or "Error" responses
-    if (clean.contains("NODATA") || clean.contains("NO DATA") || clean.contains("ERROR")) {
-        return result; // Return empty result
+    // Decode the first six bytes in place. Whitespace and the '>' prompt are
+    // skipped; any other non-hex character (e.g. "NO DATA", "ERROR") means
+    // there is nothing to decode.
+    quint8 bytes[RESPONSE_BYTES] = {};
+    int nibbles = 0;
+    for (const char c : rawData) {
+        if (c == ' ' || c == '\r' || c == '\n' || c == '\t' || c == '>') {
+            continue;
+        }
+        const int value = hexValue(c);
+        if (value < 0) {
+            return result; // Return empty result
+        }
+        if (nibbles < RESPONSE_BYTES * 2) {
+            bytes[nibbles / 2] = quint8((bytes[nibbles / 2] << 4) | value);
+        }
+        ++nibbles;
     }
 
-    // Convert Hex String to Byte Array
-    QByteArray bytes = QByteArray::fromHex(clean);
-
-    // Validate Mode 01 PID 01 Response (should start with 0x41 0x01 and have 6 data bytes)
-    if (bytes.size() < 6 || bytes.at(0) != 0x41 || bytes.at(1) != 0x01) {
-        qDebug() << "ReadinessParser: Not a valid Mode 01 PID 01 response:" << clean;
+    // Validate Mode 01 PID 01/41 Response (should start with 0x41 <pid> and have 6 data bytes)
+    if (nibbles < RESPONSE_BYTES * 2 || bytes[0] != 0x41 || bytes[1] != pid) {
+        qDebug() << "ReadinessParser: Not a valid Mode 01 PID" << Qt::hex << int(pid) << "response:" << rawData.simplified();
         return result;
     }
 
-    // Mode 01 PID 01 response format (per SAE J1979 / ISO 15031-5):
-    // Byte 0: 0x41 (Mode 01 response)
-    // Byte 1: 0x01 (PID 01)
-    // Byte 2: A - MIL status (bit 7) and DTC count (bits 0-6)
-    // Byte 3: B - Common monitors: availability (bits 0-2), engine type (bit 3), completeness (bits 4-6)
-    // Byte 4: C - Engine-specific monitors availability
-    // Byte 5: D - Engine-specific monitors completeness
-    //
-    // IMPORTANT: For availability bits, 1 = available. For completeness bits, 0 = complete, 1 = incomplete.
-
-    quint8 byteB = (quint8)bytes.at(3);
-    quint8 byteC = (quint8)bytes.at(4);
-    quint8 byteD = (quint8)bytes.at(5);
-
-    // Helper lambda to parse a monitor given availability and completeness bits
-    // availBit: 1 = monitor is available/supported
-    // compBit: 0 = complete, 1 = incomplete
-    auto parseMonitor = [&result](const QString& name, bool available, bool incompleteFlag) {
-        if (!available) {
-            result.setMonitorStatus(name, MonitorStatus::Unsupported);
-        } else if (incompleteFlag) {
-            result.setMonitorStatus(name, MonitorStatus::Incomplete);
-        } else {
-            result.setMonitorStatus(name, MonitorStatus::Complete);
-        }
-    };
-
-    // Parse common monitors from Byte B
-    // Availability: B0=MIS, B1=FUEL, B2=CCM
-    // Completeness: B4=MIS, B5=FUEL, B6=CCM (0 = complete, 1 = incomplete)
-    parseMonitor("MIS",  (byteB & 0x01) != 0, (byteB & 0x10) != 0);  // Misfire
-    parseMonitor("FUEL", (byteB & 0x02) != 0, (byteB & 0x20) != 0);  // Fuel System
-    parseMonitor("CCM",  (byteB & 0x04) != 0, (byteB & 0x40) != 0);  // Comprehensive Component
-
-    // Parse engine-specific monitors from Bytes C (availability) and D (completeness)
-    // For spark ignition engines (assuming spark ignition for now):
-    // C0/D0: Catalyst (CAT)
-    // C1/D1: Heated Catalyst (HCAT)
-    // C2/D2: Evaporative System (EVAP)
-    // C3/D3: Secondary Air System (SAS)
-    // C4/D4: Gasoline Particulate Filter (GPF) - formerly reserved/A/C
-    // C5/D5: Oxygen Sensor (O2S)
-    // C6/D6: Oxygen Sensor Heater (O2SH)
-    // C7/D7: EGR and/or VVT System (EGR)
-
-    parseMonitor("CAT",  (byteC & 0x01) != 0, (byteD & 0x01) != 0);  // Catalyst
-    parseMonitor("HCAT", (byteC & 0x02) != 0, (byteD & 0x02) != 0);  // Heated Catalyst
-    parseMonitor("EVAP", (byteC & 0x04) != 0, (byteD & 0x04) != 0);  // Evaporative System
-    parseMonitor("SAS",  (byteC & 0x08) != 0, (byteD & 0x08) != 0);  // Secondary Air System
-    parseMonitor("O2S",  (byteC & 0x20) != 0, (byteD & 0x20) != 0);  // Oxygen Sensor
-    parseMonitor("O2SH", (byteC & 0x40) != 0, (byteD & 0x40) != 0);  // Oxygen Sensor Heater
-    parseMonitor("EGR",  (byteC & 0x80) != 0, (byteD & 0x80) != 0);  // EGR/VVT System
+    return decode(bytes[3], bytes[4], bytes[5]);
+}
+
+ReadinessResult ReadinessParser::decode(quint8 byteB, quint8 byteC, quint8 byteD)
+{
+    ReadinessResult result;
+    result.compressionIgnition = (byteB & COMPRESSION_IGNITION_BIT) != 0;
+
+    const LayoutMasks common = decodeLayout(COMMON_LAYOUT, byteB, quint8(byteB >> 4));
+    const LayoutMasks specific = result.compressionIgnition
+        ? decodeLayout(COMPRESSION_LAYOUT, byteC, byteD)
+        : decodeLayout(SPARK_LAYOUT, byteC, byteD);
 
+    result.reportedMask = common.reported | specific.reported;
+    result.supportedMask = common.supported | specific.supported;
+    result.incompleteMask = common.incomplete | specific.incomplete;
+    result.updateOverallReady();
     return result;
 }
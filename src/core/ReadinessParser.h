@@ -7,6 +7,10 @@
 /**
  * @brief The ReadinessParser class
  * Parses OBD-II Mode 01 PID 01 response for readiness monitor status.
+ *
+ * Bit B3 selects the spark or compression ignition layout of bytes C/D (see
+ * design/readiness_parsing_reference.md). Both layouts are constexpr tables and
+ * parsing makes no heap allocations.
  */
 class ReadinessParser : public QObject
 {
@@ -19,9 +23,15 @@ public:
     /**
      * @brief Parses raw OBD-II Mode 01 PID 01 response for readiness monitors.
      * @param rawData The raw hex response from the adapter (e.g., "41 01 XX XX XX XX").
+     * @param pid 0x01 (since DTCs cleared) or 0x41 (this drive cycle); both share the bit layout.
      * @return ReadinessResult with monitor statuses populated.
      */
-    ReadinessResult parseReadinessResponse(const QByteArray &rawData);
+    ReadinessResult parseReadinessResponse(const QByteArray &rawData, quint8 pid = 0x01);
+
+    /**
+     * @brief Decodes the B, C and D data bytes of a PID 01 response.
+     */
+    static ReadinessResult decode(quint8 byteB, quint8 byteC, quint8 byteD);
 };
 
 #endif // READINESSPARSER_H
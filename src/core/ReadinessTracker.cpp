@@ -0,0 +1,231 @@
+#include "ReadinessTracker.h"
+#include "ReadinessParser.h"
+#include "ScanService.h"
+#include <QTimer>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const QByteArray SINCE_CLEARED_COMMAND("01 01\r");
+const QByteArray DRIVE_CYCLE_COMMAND("01 41\r");
+
+constexpr qint64 MINUTE_MS = 60 * 1000;
+
+// Rough drive time an enabled monitor needs under favourable conditions,
+// indexed by Monitor. Only used for estimate(); real times depend on the
+// manufacturer's enabling criteria (cold start, steady cruise, fuel level...).
+constexpr qint64 TYPICAL_DURATION_MS[ReadinessResult::MONITOR_COUNT] = {
+    5 * MINUTE_MS,      // Misfire
+    5 * MINUTE_MS,      // Fuel system
+    5 * MINUTE_MS,      // Components
+    15 * MINUTE_MS,     // Catalyst
+    10 * MINUTE_MS,     // Heated catalyst
+    40 * MINUTE_MS,     // EVAP, needs a long cruise after a cold soak
+    5 * MINUTE_MS,      // Secondary air, runs right after a cold start
+    20 * MINUTE_MS,     // Gasoline particulate filter
+    10 * MINUTE_MS,     // Oxygen sensor
+    5 * MINUTE_MS,      // Oxygen sensor heater
+    15 * MINUTE_MS,     // EGR/VVT
+    20 * MINUTE_MS,     // NMHC catalyst
+    20 * MINUTE_MS,     // NOx/SCR
+    10 * MINUTE_MS,     // Boost pressure
+    15 * MINUTE_MS,     // Exhaust gas sensor
+    30 * MINUTE_MS      // PM filter, usually needs a regeneration
+};
+
+static_assert(sizeof(ReadinessTracker::Transition) == 16, "Transition records stay compact");
+
+} // namespace
+
+ReadinessTracker::ReadinessTracker(ScanService* scanService, QObject *parent)
+    : QObject(parent)
+    , m_scanService(scanService)
+    , m_parser(new ReadinessParser(this))
+    , m_timer(new QTimer(this))
+{
+    qRegisterMetaType<ReadinessTracker::Transition>();
+
+    m_timer->setInterval(DEFAULT_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &ReadinessTracker::onTick);
+
+    if (m_scanService) {
+        connect(m_scanService, &ScanService::pollResponse, this, &ReadinessTracker::onPollResponse);
+        connect(m_scanService, &ScanService::pollFailed, this, &ReadinessTracker::onPollFailed);
+    }
+}
+
+ReadinessTracker::~ReadinessTracker()
+{
+}
+
+void ReadinessTracker::setIntervalMs(int intervalMs)
+{
+    m_timer->setInterval(qMax(MIN_INTERVAL_MS, intervalMs));
+}
+
+int ReadinessTracker::intervalMs() const
+{
+    return m_timer->interval();
+}
+
+void ReadinessTracker::start()
+{
+    if (m_timer->isActive()) {
+        return;
+    }
+    m_tick = 0;
+    m_driveCycleUnsupported = false;
+    m_timer->start();
+    onTick();
+}
+
+void ReadinessTracker::stop()
+{
+    // A reply still in flight is dropped when it arrives
+    m_timer->stop();
+    m_pendingCommand.clear();
+}
+
+bool ReadinessTracker::isRunning() const
+{
+    return m_timer->isActive();
+}
+
+void ReadinessTracker::clear()
+{
+    m_sinceCleared = ReadinessResult();
+    m_thisDriveCycle = ReadinessResult();
+    m_transitions.clear();
+    std::fill(std::begin(m_incompleteSinceMs), std::end(m_incompleteSinceMs), 0);
+    m_lastUpdateMs = 0;
+}
+
+void ReadinessTracker::onTick()
+{
+    if (!m_scanService) {
+        return;
+    }
+
+    // Never more than one request on the bus; a slow reply skips a tick
+    if (!m_pendingCommand.isEmpty()) {
+        if (m_pendingTimer.elapsed() < POLL_TIMEOUT_MS) {
+            return;
+        }
+        m_pendingCommand.clear();
+    }
+
+    // The first request, and every SINCE_CLEARED_EVERY-th after it, reads PID 01
+    const bool sinceCleared = m_driveCycleUnsupported || m_tick % SINCE_CLEARED_EVERY == 0;
+    const QByteArray& command = sinceCleared ? SINCE_CLEARED_COMMAND : DRIVE_CYCLE_COMMAND;
+
+    // Pending before the call: enqueuePoll() can fail the request right away
+    m_pendingCommand = command;
+    m_pendingTimer.start();
+    if (m_scanService->enqueuePoll(command)) {
+        ++m_tick;
+        ++m_requestsSent;
+    } else {
+        m_pendingCommand.clear();
+    }
+}
+
+void ReadinessTracker::onPollResponse(const QByteArray& command, const QByteArray& response, qint64 sampleTimeNs)
+{
+    if (m_pendingCommand.isEmpty() || command != m_pendingCommand) {
+        return; // Another client's poll, or sent before stop()
+    }
+    m_pendingCommand.clear();
+
+    const quint8 pid = command == DRIVE_CYCLE_COMMAND ? 0x41 : 0x01;
+    if (!handleResponse(pid, response, m_scanService->sampleClock().toWallMs(sampleTimeNs)) &&
+        pid == 0x41 && response.toUpper().contains("NO DATA")) {
+        m_driveCycleUnsupported = true;
+    }
+}
+
+void ReadinessTracker::onPollFailed(const QByteArray& command)
+{
+    if (command == m_pendingCommand) {
+        m_pendingCommand.clear();
+    }
+}
+
+bool ReadinessTracker::handleResponse(quint8 pid, const QByteArray& response, qint64 timestampMs)
+{
+    const ReadinessResult decoded = m_parser->parseReadinessResponse(response, pid);
+    if (decoded.isEmpty()) {
+        return false;
+    }
+
+    const Scope scope = pid == 0x41 ? ThisDriveCycle : SinceCleared;
+    ReadinessResult& current = scope == ThisDriveCycle ? m_thisDriveCycle : m_sinceCleared;
+
+    // The first reply of a scope is the baseline, not a transition
+    const bool baseline = current.isEmpty();
+    quint16 changed = 0;
+    const quint16 candidates = current.reportedMask | decoded.reportedMask;
+    for (quint16 remaining = candidates; remaining != 0; remaining &= quint16(remaining - 1)) {
+        const Monitor monitor = Monitor(qCountTrailingZeroBits(remaining));
+        const MonitorStatus before = current.getMonitorStatus(monitor);
+        const MonitorStatus after = decoded.getMonitorStatus(monitor);
+        if (before == after) {
+            continue;
+        }
+        changed |= ReadinessResult::bit(monitor);
+
+        // A drive cycle monitor that turns incomplete starts running; one that
+        // was complete and turns incomplete again means a new drive cycle
+        if (scope == ThisDriveCycle) {
+            m_incompleteSinceMs[int(monitor)] = after == MonitorStatus::Incomplete ? timestampMs : 0;
+        }
+
+        if (!baseline) {
+            Transition transition;
+            transition.timestampMs = timestampMs;
+            transition.monitor = monitor;
+            transition.scope = scope;
+            transition.before = before;
+            transition.after = after;
+            m_transitions.append(transition);
+            emit transitionRecorded(transition);
+        }
+    }
+
+    current = decoded;
+    m_lastUpdateMs = timestampMs;
+    emit statusUpdated(scope, changed);
+    return true;
+}
+
+ReadinessTracker::Estimate ReadinessTracker::estimate(Monitor monitor) const
+{
+    Estimate estimate;
+    estimate.sinceCleared = m_sinceCleared.getMonitorStatus(monitor);
+    estimate.thisDriveCycle = m_thisDriveCycle.getMonitorStatus(monitor);
+
+    if (!m_sinceCleared.isEmpty() && estimate.sinceCleared == MonitorStatus::Unsupported) {
+        return estimate; // The vehicle does not have this monitor
+    }
+    if (estimate.sinceCleared == MonitorStatus::Complete || estimate.thisDriveCycle == MonitorStatus::Complete) {
+        estimate.remainingMs = 0;
+        estimate.percent = 100;
+        return estimate;
+    }
+
+    const qint64 since = m_incompleteSinceMs[int(monitor)];
+    if (estimate.thisDriveCycle != MonitorStatus::Incomplete || since == 0) {
+        return estimate; // Not enabled this drive cycle: no way to tell
+    }
+
+    const qint64 typical = typicalDurationMs(monitor);
+    estimate.runningMs = qMax<qint64>(0, m_lastUpdateMs - since);
+    estimate.percent = int(qMin<qint64>(99, estimate.runningMs * 100 / typical));
+    estimate.remainingMs = estimate.runningMs < typical ? typical - estimate.runningMs : -1;
+    return estimate;
+}
+
+qint64 ReadinessTracker::typicalDurationMs(Monitor monitor)
+{
+    return int(monitor) < ReadinessResult::MONITOR_COUNT ? TYPICAL_DURATION_MS[int(monitor)] : 0;
+}
@@ -0,0 +1,142 @@
+#ifndef READINESSTRACKER_H
+#define READINESSTRACKER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+#include "core/dto/ReadinessResult.h"
+
+class QTimer;
+class ReadinessParser;
+class ScanService;
+
+/**
+ * @brief The ReadinessTracker class
+ * Follows readiness monitors while the vehicle is driven.
+ *
+ * Polls Mode 01 PID 41 (monitor status this drive cycle) and, every
+ * SINCE_CLEARED_EVERY requests, PID 01 (status since DTCs were cleared)
+ * through ScanService::enqueuePoll(), so the requests share the scan command
+ * queue. At most one request is outstanding and the interval is never below
+ * MIN_INTERVAL_MS, which keeps the bus load under one request per second. A
+ * request that gets neither a reply nor pollFailed() within POLL_TIMEOUT_MS
+ * is given up, so a lost request never stops the polling.
+ *
+ * Only status changes are kept, as 16-byte Transition records. estimate()
+ * guesses how far each incomplete monitor is from completing, from the time
+ * it has been running this drive cycle and a typical duration per monitor.
+ */
+class ReadinessTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Scope : quint8 {
+        SinceCleared,       // PID 01
+        ThisDriveCycle      // PID 41
+    };
+    Q_ENUM(Scope)
+
+    /**
+     * @brief One monitor status change.
+     */
+    struct Transition {
+        qint64 timestampMs = 0;     // Milliseconds since the epoch
+        Monitor monitor = Monitor::Count;
+        Scope scope = SinceCleared;
+        MonitorStatus before = MonitorStatus::Unsupported;
+        MonitorStatus after = MonitorStatus::Unsupported;
+    };
+
+    /**
+     * @brief Where one monitor stands.
+     */
+    struct Estimate {
+        MonitorStatus sinceCleared = MonitorStatus::Unsupported;
+        MonitorStatus thisDriveCycle = MonitorStatus::Unsupported;
+        qint64 runningMs = 0;       // Time seen incomplete in this drive cycle
+        qint64 remainingMs = -1;    // Estimated time to completion; 0 once complete, -1 if unknown
+        int percent = 0;            // Estimated progress, 0-100
+    };
+
+    static constexpr int MIN_INTERVAL_MS = 1000;
+    static constexpr int DEFAULT_INTERVAL_MS = 2000;
+    static constexpr int SINCE_CLEARED_EVERY = 5;
+    static constexpr int POLL_TIMEOUT_MS = 30000;  // Long enough to wait behind a full scan
+
+    explicit ReadinessTracker(ScanService* scanService, QObject *parent = nullptr);
+    ~ReadinessTracker() override;
+
+    /**
+     * @brief Time between requests, clamped to at least MIN_INTERVAL_MS.
+     */
+    void setIntervalMs(int intervalMs);
+    int intervalMs() const;
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief Forgets all statuses and transitions.
+     */
+    void clear();
+
+    const ReadinessResult& sinceCleared() const { return m_sinceCleared; }
+    const ReadinessResult& thisDriveCycle() const { return m_thisDriveCycle; }
+    const QVector<Transition>& transitions() const { return m_transitions; }
+    int requestsSent() const { return m_requestsSent; }
+
+    Estimate estimate(Monitor monitor) const;
+
+    /**
+     * @brief Drive time an enabled monitor typically needs to complete.
+     */
+    static qint64 typicalDurationMs(Monitor monitor);
+
+    /**
+     * @brief Applies one PID 01 or PID 41 reply received at @p timestampMs.
+     * Called for every poll reply; public so recorded replies can be replayed.
+     * @return false if the reply did not decode.
+     */
+    bool handleResponse(quint8 pid, const QByteArray& response, qint64 timestampMs);
+
+signals:
+    /**
+     * @brief Emitted for every recorded transition.
+     */
+    void transitionRecorded(const ReadinessTracker::Transition& transition);
+
+    /**
+     * @brief Emitted after each decoded reply.
+     * @param changedMonitors ReadinessResult::bit() of every monitor whose status changed.
+     */
+    void statusUpdated(ReadinessTracker::Scope scope, quint16 changedMonitors);
+
+private slots:
+    void onTick();
+    void onPollResponse(const QByteArray& command, const QByteArray& response, qint64 sampleTimeNs);
+    void onPollFailed(const QByteArray& command);
+
+private:
+    ScanService* m_scanService;
+    ReadinessParser* m_parser;
+    QTimer* m_timer;
+
+    QByteArray m_pendingCommand;    // Request in flight, empty if none
+    QElapsedTimer m_pendingTimer;   // Started when m_pendingCommand was queued
+    int m_tick = 0;
+    int m_requestsSent = 0;
+    bool m_driveCycleUnsupported = false;  // PID 41 did not answer; read PID 01 only
+
+    ReadinessResult m_sinceCleared;
+    ReadinessResult m_thisDriveCycle;
+    QVector<Transition> m_transitions;
+    qint64 m_incompleteSinceMs[ReadinessResult::MONITOR_COUNT] = {};   // PID 41 incomplete since, 0 = not running
+    qint64 m_lastUpdateMs = 0;
+};
+
+Q_DECLARE_METATYPE(ReadinessTracker::Transition)
+
+#endif // READINESSTRACKER_H
@@ -0,0 +1,339 @@
+#include "ReportGenerator.h"
+#include "ScanResultJson.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+const char* const DEFAULT_VEHICLE_TEMPLATE = R"(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>Scan report {{vin}}</title>
+</head>
+<body>
+<h1>Vehicle {{vin}}</h1>
+<p>Scanned {{timestamp}}</p>
+<p>MIL: {{#milOn}}ON{{/milOn}}{{^milOn}}off{{/milOn}}.
+Readiness: {{#overallReady}}ready{{/overallReady}}{{^overallReady}}not ready{{/overallReady}}.</p>
+<h2>Trouble codes ({{dtcCount}})</h2>
+{{^dtcs}}<p>No trouble codes.</p>
+{{/dtcs}}{{#hasDtcs}}<table>
+<tr><th>Code</th><th>Status</th><th>Description</th><th>Module</th></tr>
+{{#dtcs}}<tr><td>{{code}}</td><td>{{status}}</td><td>{{shortText}}</td><td>{{module}}</td></tr>
+{{/dtcs}}</table>
+{{/hasDtcs}}<h2>Readiness monitors</h2>
+{{^monitors}}<p>Not read.</p>
+{{/monitors}}{{#hasMonitors}}<table>
+<tr><th>Monitor</th><th>Status</th></tr>
+{{#monitors}}<tr><td>{{name}}</td><td>{{status}}</td></tr>
+{{/monitors}}</table>
+{{/hasMonitors}}<p><a href="index.html">Fleet summary</a></p>
+</body>
+</html>
+)";
+
+const char* const DEFAULT_INDEX_TEMPLATE = R"(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>Fleet scan report</title>
+</head>
+<body>
+<h1>Fleet scan report</h1>
+<p>Generated {{generatedAt}}: {{vehicleCount}} vehicles, {{milOnCount}} with MIL on,
+{{notReadyCount}} not ready, {{dtcTotal}} trouble codes.</p>
+<table>
+<tr><th>#</th><th>VIN</th><th>Scanned</th><th>MIL</th><th>Ready</th><th>Codes</th></tr>
+{{#vehicles}}<tr><td>{{number}}</td><td><a href="{{file}}">{{vin}}</a></td><td>{{timestamp}}</td><td>{{#milOn}}ON{{/milOn}}</td><td>{{#overallReady}}yes{{/overallReady}}{{^overallReady}}no{{/overallReady}}</td><td>{{dtcCount}}</td></tr>
+{{/vehicles}}</table>
+{{#hasStatistics}}<h2>Live data</h2>
+<table>
+<tr><th>PID</th><th>Unit</th><th>Samples</th><th>Mean</th><th>Std dev</th><th>Min</th><th>p50</th><th>p95</th><th>Max</th></tr>
+{{#statistics}}<tr><td>{{pid}}</td><td>{{unit}}</td><td>{{count}}</td><td>{{mean}}</td><td>{{stddev}}</td><td>{{min}}</td><td>{{p50}}</td><td>{{p95}}</td><td>{{max}}</td></tr>
+{{/statistics}}</table>
+{{/hasStatistics}}</body>
+</html>
+)";
+
+QString formatValue(double value)
+{
+    return QString::number(value, 'g', 6);
+}
+
+// One window of scans handed to the thread pool
+struct RenderWindow {
+    int start = 0;
+    int count = 0;
+    QVector<QByteArray> pages;
+    QSemaphore rendered;    // Released once per finished page
+};
+
+} // namespace
+
+ReportGenerator::ReportGenerator(Format format)
+    : m_format(format)
+    , m_vehicleTemplate(ReportTemplate::parse(DEFAULT_VEHICLE_TEMPLATE))
+    , m_indexTemplate(ReportTemplate::parse(DEFAULT_INDEX_TEMPLATE))
+    , m_maxThreads(QThread::idealThreadCount())
+{
+}
+
+bool ReportGenerator::setVehicleTemplate(const QString& text)
+{
+    QString error;
+    ReportTemplate parsed = ReportTemplate::parse(text, &error);
+    if (!parsed.isValid()) {
+        m_lastError = QString("Vehicle template: %1").arg(error);
+        return false;
+    }
+    m_vehicleTemplate = parsed;
+    return true;
+}
+
+bool ReportGenerator::setIndexTemplate(const QString& text)
+{
+    QString error;
+    ReportTemplate parsed = ReportTemplate::parse(text, &error);
+    if (!parsed.isValid()) {
+        m_lastError = QString("Index template: %1").arg(error);
+        return false;
+    }
+    m_indexTemplate = parsed;
+    return true;
+}
+
+void ReportGenerator::setMaxThreads(int threads)
+{
+    m_maxThreads = qMax(1, threads);
+}
+
+void ReportGenerator::setWindowSize(int scans)
+{
+    m_windowSize = qMax(1, scans);
+}
+
+ReportTemplate::Context ReportGenerator::vehicleContext(const ScanResult& scan)
+{
+    ReportTemplate::Context context;
+    context.set("vin", scan.vin.isEmpty() ? QString("(unknown)") : scan.vin);
+    context.set("timestamp", scan.timestamp.toString(Qt::ISODate));
+    context.setFlag("milOn", scan.milOn);
+    context.setFlag("overallReady", scan.readiness.overallReady);
+    context.set("dtcCount", QString::number(scan.dtcs.size()));
+    context.setFlag("hasDtcs", !scan.dtcs.isEmpty());
+    context.setFlag("hasMonitors", !scan.readiness.isEmpty());
+
+    QVector<ReportTemplate::Context> dtcs;
+    dtcs.reserve(scan.dtcs.size());
+    for (const DtcEntry& entry : scan.dtcs) {
+        ReportTemplate::Context dtc;
+        dtc.set("code", entry.code);
+        dtc.set("status", ScanResultJson::statusName(entry.status));
+        dtc.set("category", ScanResultJson::categoryName(entry.category));
+        dtc.set("shortText", entry.shortText);
+        dtc.set("module", entry.module);
+        dtcs.append(dtc);
+    }
+    context.lists.insert("dtcs", dtcs);
+
+    QVector<ReportTemplate::Context> monitors;
+    monitors.reserve(scan.readiness.monitorCount());
+    scan.readiness.forEachMonitor([&monitors](Monitor id, MonitorStatus status) {
+        ReportTemplate::Context monitor;
+        monitor.set("name", QString::fromLatin1(ReadinessResult::monitorName(id)));
+        monitor.set("status", ScanResultJson::monitorStatusName(status));
+        monitors.append(monitor);
+    });
+    context.lists.insert("monitors", monitors);
+
+    return context;
+}
+
+ReportTemplate::Context ReportGenerator::statisticsContext(const PidStatistics::Summary& summary)
+{
+    ReportTemplate::Context context;
+    context.set("pid", summary.pidId);
+    context.set("unit", summary.unit);
+    context.set("count", QString::number(summary.moments.count));
+    if (!summary.isEmpty()) {
+        context.set("mean", formatValue(summary.moments.mean));
+        context.set("stddev", formatValue(summary.moments.stddev()));
+        context.set("min", formatValue(summary.moments.min));
+        context.set("max", formatValue(summary.moments.max));
+        context.set("p50", formatValue(summary.quantile(0.5)));
+        context.set("p95", formatValue(summary.quantile(0.95)));
+        context.set("p99", formatValue(summary.quantile(0.99)));
+    }
+    return context;
+}
+
+QString ReportGenerator::pageFileName(const ScanResult& scan, int index) const
+{
+    // VINs are alphanumeric; anything else is dropped so the name is always safe
+    QString vin;
+    for (const QChar c : scan.vin) {
+        if (c.isLetterOrNumber()) {
+            vin += c;
+        }
+    }
+    if (vin.isEmpty()) {
+        vin = "unknown";
+    }
+    return QString("%1-%2.%3")
+        .arg(index + 1, 4, 10, QChar('0'))
+        .arg(vin)
+        .arg(m_format == Html ? "html" : "json");
+}
+
+QByteArray ReportGenerator::renderPage(const ScanResult& scan) const
+{
+    if (m_format == Json) {
+        return QJsonDocument(ScanResultJson::toJson(scan)).toJson(QJsonDocument::Indented);
+    }
+    return m_vehicleTemplate.render(vehicleContext(scan));
+}
+
+bool ReportGenerator::generate(const QVector<ScanResult>& scans, const QString& outputDir)
+{
+    m_lastError.clear();
+    m_writtenFiles.clear();
+
+    QDir dir(outputDir);
+    if (!dir.mkpath(".")) {
+        m_lastError = QString("Cannot create report directory %1").arg(outputDir);
+        return false;
+    }
+
+    auto writeFile = [&](const QString& name, const QByteArray& data) {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+            m_lastError = QString("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+            return false;
+        }
+        m_writtenFiles.append(file.fileName());
+        return true;
+    };
+
+    // Declared before the pool: the pool's destructor waits for tasks that write into them
+    RenderWindow windows[2];
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_maxThreads);
+
+    auto submit = [&](RenderWindow& window, int start) {
+        window.start = start;
+        window.count = qMin(m_windowSize, int(scans.size()) - start);
+        window.pages.resize(window.count);
+
+        QByteArray* pages = window.pages.data();
+        QSemaphore* rendered = &window.rendered;
+        for (int i = 0; i < window.count; ++i) {
+            const ScanResult* scan = &scans.at(start + i);
+            pool.start([this, scan, pages, rendered, i]() {
+                pages[i] = renderPage(*scan);
+                rendered->release();
+            });
+        }
+    };
+
+    // Index data is accumulated as pages are written, in input order
+    ReportTemplate::Context index;
+    QVector<ReportTemplate::Context> vehicles;
+    QJsonArray jsonVehicles;
+    int milOnCount = 0;
+    int notReadyCount = 0;
+    int dtcTotal = 0;
+
+    int current = 0;
+    if (!scans.isEmpty()) {
+        submit(windows[0], 0);
+    }
+    for (int start = 0; start < scans.size(); start += m_windowSize) {
+        RenderWindow& window = windows[current];
+
+        // Render the next window while this one is written
+        const int next = start + m_windowSize;
+        if (next < scans.size()) {
+            submit(windows[current ^ 1], next);
+        }
+
+        window.rendered.acquire(window.count);
+        for (int i = 0; i < window.count; ++i) {
+            const int position = window.start + i;
+            const ScanResult& scan = scans.at(position);
+            const QString fileName = pageFileName(scan, position);
+            if (!writeFile(fileName, window.pages.at(i))) {
+                pool.waitForDone();
+                return false;
+            }
+            window.pages[i].clear();
+
+            milOnCount += scan.milOn ? 1 : 0;
+            notReadyCount += scan.readiness.overallReady ? 0 : 1;
+            dtcTotal += int(scan.dtcs.size());
+
+            if (m_format == Json) {
+                QJsonObject entry;
+                entry["file"] = fileName;
+                entry["vin"] = scan.vin;
+                entry["timestamp"] = scan.timestamp.toString(Qt::ISODateWithMs);
+                entry["milOn"] = scan.milOn;
+                entry["overallReady"] = scan.readiness.overallReady;
+                entry["dtcCount"] = scan.dtcs.size();
+                jsonVehicles.append(entry);
+            } else {
+                ReportTemplate::Context entry;
+                entry.set("number", QString::number(position + 1));
+                entry.set("file", fileName);
+                entry.set("vin", scan.vin.isEmpty() ? QString("(unknown)") : scan.vin);
+                entry.set("timestamp", scan.timestamp.toString(Qt::ISODate));
+                entry.setFlag("milOn", scan.milOn);
+                entry.setFlag("overallReady", scan.readiness.overallReady);
+                entry.set("dtcCount", QString::number(scan.dtcs.size()));
+                vehicles.append(entry);
+            }
+        }
+        current ^= 1;
+    }
+
+    const QString generatedAt = QDateTime::currentDateTime().toString(Qt::ISODate);
+    if (m_format == Json) {
+        QJsonObject json;
+        json["generatedAt"] = generatedAt;
+        json["vehicleCount"] = scans.size();
+        json["milOnCount"] = milOnCount;
+        json["notReadyCount"] = notReadyCount;
+        json["dtcTotal"] = dtcTotal;
+        json["vehicles"] = jsonVehicles;
+        if (!m_statistics.isEmpty()) {
+            QJsonArray statistics;
+            for (const PidStatistics::Summary& summary : m_statistics) {
+                statistics.append(ScanResultJson::toJson(summary));
+            }
+            json["statistics"] = statistics;
+        }
+        return writeFile("index.json", QJsonDocument(json).toJson(QJsonDocument::Indented));
+    }
+
+    index.set("generatedAt", generatedAt);
+    index.set("vehicleCount", QString::number(scans.size()));
+    index.set("milOnCount", QString::number(milOnCount));
+    index.set("notReadyCount", QString::number(notReadyCount));
+    index.set("dtcTotal", QString::number(dtcTotal));
+    index.lists.insert("vehicles", vehicles);
+    QVector<ReportTemplate::Context> statistics;
+    statistics.reserve(m_statistics.size());
+    for (const PidStatistics::Summary& summary : m_statistics) {
+        statistics.append(statisticsContext(summary));
+    }
+    index.lists.insert("statistics", statistics);
+    index.setFlag("hasStatistics", !statistics.isEmpty());
+    return writeFile("index.html", m_indexTemplate.render(index));
+}
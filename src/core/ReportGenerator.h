@@ -0,0 +1,102 @@
+#ifndef REPORTGENERATOR_H
+#define REPORTGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "core/PidStatistics.h"
+#include "core/ReportTemplate.h"
+#include "core/dto/ScanResult.h"
+
+/**
+ * @brief The ReportGenerator class
+ * Writes fleet reports: one page per vehicle scan plus a summary index.
+ *
+ * Vehicle pages are rendered on a thread pool, a window of scans at a time,
+ * while the calling thread writes the previous window to disk in input order.
+ * Output is therefore identical for any thread count, and at most two windows
+ * of rendered pages are held in memory. The index is built in the same pass,
+ * and lists the live PID statistics given to setStatistics().
+ */
+class ReportGenerator
+{
+public:
+    enum Format {
+        Html,   // Pages rendered from ReportTemplate (defaults built in)
+        Json    // Pages from ScanResultJson, index.json summary
+    };
+
+    explicit ReportGenerator(Format format = Html);
+
+    Format format() const { return m_format; }
+
+    /**
+     * @brief Replaces the built-in vehicle page template (HTML only).
+     * @return false if the template does not parse; see lastError().
+     */
+    bool setVehicleTemplate(const QString& text);
+
+    /**
+     * @brief Replaces the built-in index page template (HTML only).
+     * @return false if the template does not parse; see lastError().
+     */
+    bool setIndexTemplate(const QString& text);
+
+    /**
+     * @brief Limits the rendering threads (default: QThread::idealThreadCount()).
+     */
+    void setMaxThreads(int threads);
+
+    /**
+     * @brief Number of scans rendered ahead of the writer (default 64).
+     */
+    void setWindowSize(int scans);
+
+    /**
+     * @brief Live PID statistics listed in the index, e.g.
+     * PidStatistics::snapshotAll(); empty (the default) leaves them out.
+     */
+    void setStatistics(const QVector<PidStatistics::Summary>& statistics) { m_statistics = statistics; }
+
+    /**
+     * @brief Writes the report for @p scans into @p outputDir, creating it if needed.
+     * @return false on the first I/O error; see lastError().
+     */
+    bool generate(const QVector<ScanResult>& scans, const QString& outputDir);
+
+    QString lastError() const { return m_lastError; }
+
+    /**
+     * @brief Files written by the last generate() call, index last.
+     */
+    QStringList writtenFiles() const { return m_writtenFiles; }
+
+    /**
+     * @brief Template values for one vehicle page.
+     */
+    static ReportTemplate::Context vehicleContext(const ScanResult& scan);
+
+    /**
+     * @brief Template values for one PID in the index statistics list.
+     */
+    static ReportTemplate::Context statisticsContext(const PidStatistics::Summary& summary);
+
+    /**
+     * @brief Page file name for the scan at @p index, e.g. "0007-1D4GP00R55B123456.html".
+     */
+    QString pageFileName(const ScanResult& scan, int index) const;
+
+private:
+    QByteArray renderPage(const ScanResult& scan) const;
+
+    Format m_format;
+    ReportTemplate m_vehicleTemplate;
+    ReportTemplate m_indexTemplate;
+    int m_maxThreads;
+    int m_windowSize = 64;
+    QVector<PidStatistics::Summary> m_statistics;
+    QString m_lastError;
+    QStringList m_writtenFiles;
+};
+
+#endif // REPORTGENERATOR_H
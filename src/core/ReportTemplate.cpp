@@ -0,0 +1,147 @@
+#include "ReportTemplate.h"
+
+ReportTemplate ReportTemplate::parse(const QString& text, QString* error)
+{
+    ReportTemplate result;
+
+    // Open sections, innermost last; the root holds the top-level nodes
+    QVector<Node> stack;
+    stack.append(Node());
+    stack.last().type = Node::Section;
+
+    auto fail = [&](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return ReportTemplate();
+    };
+
+    int pos = 0;
+    while (pos < text.size()) {
+        const int open = text.indexOf("{{", pos);
+        const int textEnd = open < 0 ? text.size() : open;
+        if (textEnd > pos) {
+            Node literal;
+            literal.text = text.mid(pos, textEnd - pos);
+            result.m_sizeHint += literal.text.size();
+            stack.last().children.append(literal);
+        }
+        if (open < 0) {
+            break;
+        }
+
+        const int close = text.indexOf("}}", open + 2);
+        if (close < 0) {
+            return fail(QString("Unclosed tag at offset %1").arg(open));
+        }
+        const QString tag = text.mid(open + 2, close - open - 2).trimmed();
+        pos = close + 2;
+        if (tag.isEmpty()) {
+            return fail(QString("Empty tag at offset %1").arg(open));
+        }
+
+        const QChar sigil = tag.at(0);
+        const QString name = tag.mid(1).trimmed();
+        if (sigil == '#' || sigil == '^') {
+            Node section;
+            section.type = sigil == '#' ? Node::Section : Node::InvertedSection;
+            section.text = name;
+            stack.append(section);
+        } else if (sigil == '/') {
+            if (stack.size() == 1 || stack.last().text != name) {
+                return fail(QString("Unexpected {{/%1}} at offset %2").arg(name).arg(open));
+            }
+            Node section = stack.takeLast();
+            stack.last().children.append(section);
+        } else {
+            Node variable;
+            variable.type = Node::Variable;
+            variable.text = tag;
+            stack.last().children.append(variable);
+        }
+    }
+
+    if (stack.size() != 1) {
+        return fail(QString("Unclosed section {{#%1}}").arg(stack.last().text));
+    }
+
+    result.m_nodes = stack.first().children;
+    result.m_valid = true;
+    if (error) {
+        error->clear();
+    }
+    return result;
+}
+
+QByteArray ReportTemplate::render(const Context& context) const
+{
+    QString out;
+    out.reserve(m_sizeHint * 2);
+
+    ContextStack stack;
+    stack.append(&context);
+    renderNodes(m_nodes, stack, out);
+    return out.toUtf8();
+}
+
+void ReportTemplate::renderNodes(const QVector<Node>& nodes, ContextStack& stack, QString& out)
+{
+    for (const Node& node : nodes) {
+        switch (node.type) {
+        case Node::Text:
+            out += node.text;
+            break;
+        case Node::Variable:
+            if (const QString* value = findValue(stack, node.text)) {
+                out += value->toHtmlEscaped();
+            }
+            break;
+        case Node::Section:
+            if (const QVector<Context>* list = findList(stack, node.text)) {
+                for (const Context& item : *list) {
+                    stack.append(&item);
+                    renderNodes(node.children, stack, out);
+                    stack.removeLast();
+                }
+            } else if (isTrue(findValue(stack, node.text))) {
+                renderNodes(node.children, stack, out);
+            }
+            break;
+        case Node::InvertedSection: {
+            const QVector<Context>* list = findList(stack, node.text);
+            const bool empty = list ? list->isEmpty() : !isTrue(findValue(stack, node.text));
+            if (empty) {
+                renderNodes(node.children, stack, out);
+            }
+            break;
+        }
+        }
+    }
+}
+
+const QString* ReportTemplate::findValue(const ContextStack& stack, const QString& name)
+{
+    for (int i = stack.size() - 1; i >= 0; --i) {
+        auto it = stack.at(i)->values.constFind(name);
+        if (it != stack.at(i)->values.constEnd()) {
+            return &it.value();
+        }
+    }
+    return nullptr;
+}
+
+const QVector<ReportTemplate::Context>* ReportTemplate::findList(const ContextStack& stack, const QString& name)
+{
+    for (int i = stack.size() - 1; i >= 0; --i) {
+        auto it = stack.at(i)->lists.constFind(name);
+        if (it != stack.at(i)->lists.constEnd()) {
+            return &it.value();
+        }
+    }
+    return nullptr;
+}
+
+bool ReportTemplate::isTrue(const QString* value)
+{
+    return value && !value->isEmpty() && *value != "false" && *value != "0";
+}
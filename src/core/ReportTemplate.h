@@ -0,0 +1,77 @@
+#ifndef REPORTTEMPLATE_H
+#define REPORTTEMPLATE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The ReportTemplate class
+ * A small logic-less template language for HTML reports, parsed once and
+ * rendered many times (rendering is const and safe from several threads).
+ *
+ * Syntax:
+ * - {{name}}                 value of "name", HTML-escaped
+ * - {{#name}}...{{/name}}    repeated for each item of list "name", or once if value "name" is true
+ * - {{^name}}...{{/name}}    rendered once if "name" is false, empty or an empty list
+ *
+ * Inside a section, names are looked up in the list item first and then in
+ * the enclosing contexts. A value is false if it is empty, "false" or "0".
+ */
+class ReportTemplate
+{
+public:
+    /**
+     * @brief Values and lists a template is rendered with.
+     */
+    struct Context {
+        QHash<QString, QString> values;
+        QHash<QString, QVector<Context>> lists;
+
+        void set(const QString& name, const QString& value) { values.insert(name, value); }
+        void setFlag(const QString& name, bool value) { values.insert(name, value ? "true" : "false"); }
+    };
+
+    ReportTemplate() = default;
+
+    /**
+     * @brief Parses template text.
+     * @param error Set to a description of the problem if parsing fails.
+     * @return An invalid template on failure (see isValid()).
+     */
+    static ReportTemplate parse(const QString& text, QString* error = nullptr);
+
+    bool isValid() const { return m_valid; }
+
+    /**
+     * @brief Renders the template as UTF-8.
+     */
+    QByteArray render(const Context& context) const;
+
+private:
+    struct Node {
+        enum Type {
+            Text,
+            Variable,
+            Section,
+            InvertedSection
+        };
+
+        Type type = Text;
+        QString text;           // Literal text, or the name of a variable or section
+        QVector<Node> children; // Section body
+    };
+
+    using ContextStack = QVector<const Context*>;
+
+    static void renderNodes(const QVector<Node>& nodes, ContextStack& stack, QString& out);
+    static const QString* findValue(const ContextStack& stack, const QString& name);
+    static const QVector<Context>* findList(const ContextStack& stack, const QString& name);
+    static bool isTrue(const QString* value);
+
+    QVector<Node> m_nodes;
+    int m_sizeHint = 0;         // Literal text length, used to size the output buffer
+    bool m_valid = false;
+};
+
+#endif // REPORTTEMPLATE_H
@@ -0,0 +1,67 @@
+#include "SampleClock.h"
+#include "MonotonicClock.h"
+
+qint64 SampleClock::now()
+{
+    return MonotonicClock::now();
+}
+
+qint64 SampleClock::timeOf(const PidSample& sample)
+{
+    return sample.sampleTimeNs != 0 ? sample.sampleTimeNs : now();
+}
+
+void SampleClock::anchor()
+{
+    anchorAt(QDateTime::currentMSecsSinceEpoch(), now());
+}
+
+void SampleClock::anchorAt(qint64 wallMs, qint64 monotonicNs)
+{
+    m_anchorWallMs = wallMs;
+    m_anchorNs = monotonicNs;
+    m_anchored = true;
+}
+
+void SampleClock::reset()
+{
+    *this = SampleClock();
+}
+
+void SampleClock::addAdapterRoundTrip(qint64 sentNs, qint64 receivedNs)
+{
+    if (sentNs <= 0 || receivedNs <= sentNs) {
+        return;
+    }
+    const qint64 roundTrip = receivedNs - sentNs;
+    if (m_adapterLatencyNs == 0 || roundTrip < m_adapterLatencyNs) {
+        m_adapterLatencyNs = roundTrip;
+    }
+}
+
+qint64 SampleClock::sampleTimeNs(qint64 sentNs, qint64 receivedNs) const
+{
+    if (sentNs <= 0 || receivedNs <= sentNs) {
+        return receivedNs;
+    }
+    // A round trip shorter than the calibration means the calibration was
+    // taken on a slow moment; fall back to the plain midpoint
+    const qint64 busStartNs = sentNs + m_adapterLatencyNs;
+    if (busStartNs >= receivedNs) {
+        return sentNs + (receivedNs - sentNs) / 2;
+    }
+    return busStartNs + (receivedNs - busStartNs) / 2;
+}
+
+qint64 SampleClock::toWallMs(qint64 monotonicNs) const
+{
+    // Round toward negative infinity so samples just before the anchor stay ordered
+    const qint64 deltaNs = monotonicNs - m_anchorNs;
+    const qint64 deltaMs = deltaNs >= 0 ? deltaNs / 1000000 : -((-deltaNs + 999999) / 1000000);
+    return m_anchorWallMs + deltaMs;
+}
+
+QDateTime SampleClock::toDateTime(qint64 monotonicNs) const
+{
+    return QDateTime::fromMSecsSinceEpoch(toWallMs(monotonicNs));
+}
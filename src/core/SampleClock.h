@@ -0,0 +1,94 @@
+#ifndef SAMPLECLOCK_H
+#define SAMPLECLOCK_H
+
+#include <QDateTime>
+#include "core/dto/PidSample.h"
+
+/**
+ * @brief The SampleClock class
+ * Turns transport timestamps into sample times for one adapter session.
+ *
+ * Transports stamp the moment a command is written and the moment the first
+ * byte of its reply arrives with now(), a monotonic nanosecond clock (the one
+ * Trace uses, so samples line up with the command timeline). NTP adjustments
+ * never move it backwards.
+ *
+ * A reply's sample time is the middle of the bus exchange: the adapter spends
+ * adapterLatencyNs() parsing the request and setting up the bus before the
+ * request goes out, so the exchange spans [sent + latency, received]. The
+ * latency is calibrated from the round trips of adapter-local AT commands,
+ * which never reach the bus; the smallest one is kept, as scheduling noise
+ * only ever adds time.
+ *
+ * The wall clock is read once per session, by anchor(); wall times of samples
+ * are derived from that anchor, so they stay consistent with each other to the
+ * millisecond even if the system clock is stepped during the session.
+ */
+class SampleClock
+{
+public:
+    SampleClock() = default;
+
+    /**
+     * @brief Monotonic time in nanoseconds. Same clock as Trace::now().
+     */
+    static qint64 now();
+
+    /**
+     * @brief Monotonic time of a sample: its sampleTimeNs, or now() for a
+     * sample built without one, which is thus timed when it is ingested.
+     * Never derived from the wall-clock timestamp, which is another time base.
+     */
+    static qint64 timeOf(const PidSample& sample);
+
+    /**
+     * @brief Pairs the current wall-clock time with now(). Call once per session.
+     */
+    void anchor();
+
+    /**
+     * @brief Sets the anchor explicitly, e.g. when replaying a recorded session.
+     */
+    void anchorAt(qint64 wallMs, qint64 monotonicNs);
+
+    bool isAnchored() const { return m_anchored; }
+
+    /**
+     * @brief Forgets the anchor and the calibration.
+     */
+    void reset();
+
+    /**
+     * @brief Adds the round trip of a command the adapter answers itself.
+     * Ignored unless @p receivedNs is after @p sentNs.
+     */
+    void addAdapterRoundTrip(qint64 sentNs, qint64 receivedNs);
+
+    /**
+     * @brief Calibrated time the adapter needs before a request reaches the bus,
+     * 0 until a round trip was added.
+     */
+    qint64 adapterLatencyNs() const { return m_adapterLatencyNs; }
+
+    /**
+     * @brief Sample time of a reply, in now() nanoseconds.
+     * @return The middle of the bus exchange, or @p receivedNs if the command
+     * was not stamped as sent.
+     */
+    qint64 sampleTimeNs(qint64 sentNs, qint64 receivedNs) const;
+
+    /**
+     * @brief Wall-clock time of a now() timestamp, in milliseconds since the epoch.
+     * @pre isAnchored()
+     */
+    qint64 toWallMs(qint64 monotonicNs) const;
+    QDateTime toDateTime(qint64 monotonicNs) const;
+
+private:
+    qint64 m_anchorWallMs = 0;
+    qint64 m_anchorNs = 0;
+    qint64 m_adapterLatencyNs = 0;
+    bool m_anchored = false;
+};
+
+#endif // SAMPLECLOCK_H
@@ -0,0 +1,161 @@
+#include "ScanDiffer.h"
+#include "DtcParser.h"
+#include <QHash>
+#include <QVarLengthArray>
+#include <algorithm>
+
+namespace {
+
+// Codes that are not standard 5-character DTCs sort after every valid code,
+// ordered by their text.
+constexpr quint32 NON_STANDARD_KEY = 0x10000;
+
+struct CodeKey {
+    quint32 key = NON_STANDARD_KEY;     // DtcParser::encodeDtc() value
+    quint8 flags = 0;                   // DtcStatusFlag bits
+    const QString* code = nullptr;
+};
+
+// Scans rarely report more than a handful of codes; keep them off the heap
+using CodeKeys = QVarLengthArray<CodeKey, 32>;
+
+int compareKeys(const CodeKey& a, const CodeKey& b)
+{
+    if (a.key != b.key) {
+        return a.key < b.key ? -1 : 1;
+    }
+    if (a.key == NON_STANDARD_KEY) {
+        return a.code->compare(*b.code);
+    }
+    return 0;
+}
+
+// One sorted entry per code, with the flags of every mode that reported it
+void collectKeys(const QVector<DtcEntry>& dtcs, CodeKeys* keys)
+{
+    keys->clear();
+    for (const DtcEntry& entry : dtcs) {
+        bool ok = false;
+        const quint16 wireCode = DtcParser::encodeDtc(entry.code, &ok);
+
+        CodeKey key;
+        key.key = ok ? wireCode : NON_STANDARD_KEY;
+        key.flags = dtcStatusFlag(entry.status);
+        key.code = &entry.code;
+        keys->append(key);
+    }
+
+    std::sort(keys->begin(), keys->end(), [](const CodeKey& a, const CodeKey& b) {
+        return compareKeys(a, b) < 0;
+    });
+
+    int kept = 0;
+    for (int i = 0; i < keys->size(); ++i) {
+        if (kept > 0 && compareKeys((*keys)[kept - 1], (*keys)[i]) == 0) {
+            (*keys)[kept - 1].flags |= (*keys)[i].flags;
+        } else {
+            (*keys)[kept++] = (*keys)[i];
+        }
+    }
+    keys->resize(kept);
+}
+
+void diffDtcs(const QVector<DtcEntry>& previous, const QVector<DtcEntry>& current, ScanDiff* diff)
+{
+    CodeKeys before;
+    CodeKeys after;
+    collectKeys(previous, &before);
+    collectKeys(current, &after);
+
+    int i = 0;
+    int j = 0;
+    while (i < before.size() || j < after.size()) {
+        int cmp = 0;
+        if (i == before.size()) {
+            cmp = 1;
+        } else if (j == after.size()) {
+            cmp = -1;
+        } else {
+            cmp = compareKeys(before[i], after[j]);
+        }
+
+        if (cmp < 0) {
+            diff->clearedDtcs.append(DtcChange(*before[i].code, before[i].flags, 0));
+            ++i;
+        } else if (cmp > 0) {
+            diff->addedDtcs.append(DtcChange(*after[j].code, 0, after[j].flags));
+            ++j;
+        } else {
+            if (before[i].flags != after[j].flags) {
+                diff->changedDtcs.append(DtcChange(*after[j].code, before[i].flags, after[j].flags));
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void diffMonitors(const ReadinessResult& previous, const ReadinessResult& current, ScanDiff* diff)
+{
+    // A monitor missing on one side reads as unsupported there
+    const quint16 candidates = previous.supportedMask | current.supportedMask;
+    for (quint16 remaining = candidates; remaining != 0; remaining &= quint16(remaining - 1)) {
+        const Monitor monitor = Monitor(qCountTrailingZeroBits(remaining));
+        const MonitorStatus before = previous.getMonitorStatus(monitor);
+        const MonitorStatus after = current.getMonitorStatus(monitor);
+        if (before != after) {
+            diff->monitorChanges.append(MonitorChange(QString::fromLatin1(ReadinessResult::monitorName(monitor)),
+                                                      before, after));
+        }
+    }
+}
+
+} // namespace
+
+ScanDiff ScanDiffer::diff(const ScanResult& previous, const ScanResult& current)
+{
+    ScanDiff diff = withoutBaseline(current);
+    diff.hasBaseline = true;
+    diff.baselineTime = previous.timestamp;
+    diff.milBefore = previous.milOn;
+
+    diffDtcs(previous.dtcs, current.dtcs, &diff);
+    diffMonitors(previous.readiness, current.readiness, &diff);
+    return diff;
+}
+
+ScanDiff ScanDiffer::withoutBaseline(const ScanResult& current)
+{
+    ScanDiff diff;
+    diff.vin = current.vin;
+    diff.scanTime = current.timestamp;
+    diff.milBefore = current.milOn;
+    diff.milAfter = current.milOn;
+    return diff;
+}
+
+QVector<ScanDiff> ScanDiffer::diffFleet(const QVector<ScanResult>& previous, const QVector<ScanResult>& current)
+{
+    // Latest previous scan per VIN
+    QHash<QString, const ScanResult*> baselines;
+    baselines.reserve(previous.size());
+    for (const ScanResult& scan : previous) {
+        if (scan.vin.isEmpty()) {
+            continue;
+        }
+        auto it = baselines.find(scan.vin);
+        if (it == baselines.end()) {
+            baselines.insert(scan.vin, &scan);
+        } else if (it.value()->timestamp < scan.timestamp) {
+            it.value() = &scan;
+        }
+    }
+
+    QVector<ScanDiff> diffs;
+    diffs.reserve(current.size());
+    for (const ScanResult& scan : current) {
+        const ScanResult* baseline = scan.vin.isEmpty() ? nullptr : baselines.value(scan.vin, nullptr);
+        diffs.append(baseline ? diff(*baseline, scan) : withoutBaseline(scan));
+    }
+    return diffs;
+}
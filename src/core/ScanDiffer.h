@@ -0,0 +1,42 @@
+#ifndef SCANDIFFER_H
+#define SCANDIFFER_H
+
+#include <QVector>
+#include "core/dto/ScanResult.h"
+#include "core/dto/ScanDiff.h"
+
+/**
+ * @brief The ScanDiffer class
+ * Compares a new scan with the previous scan of the same vehicle.
+ *
+ * DTCs are reduced to their 16-bit wire codes (see DtcParser::encodeDtc()),
+ * sorted once and merged in a single pass, so a diff costs O(n log n) in the
+ * number of codes with no pairwise string comparisons. Readiness monitors are
+ * compared through their bitmasks, in Monitor order.
+ */
+class ScanDiffer
+{
+public:
+    /**
+     * @brief Diffs two scans. The VIN is taken from the new scan.
+     */
+    static ScanDiff diff(const ScanResult& previous, const ScanResult& current);
+
+    /**
+     * @brief Diff for a scan with nothing to compare against (hasBaseline is false).
+     */
+    static ScanDiff withoutBaseline(const ScanResult& current);
+
+    /**
+     * @brief Diffs a batch of vehicles.
+     * Each scan in @p current is compared with the most recent scan in @p previous
+     * that has the same VIN. Scans without a VIN, or without a match, get a diff
+     * without baseline. The result is in the order of @p current.
+     */
+    static QVector<ScanDiff> diffFleet(const QVector<ScanResult>& previous, const QVector<ScanResult>& current);
+
+private:
+    ScanDiffer() = delete;  // Static class, prevent instantiation
+};
+
+#endif // SCANDIFFER_H
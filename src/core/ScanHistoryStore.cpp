@@ -0,0 +1,536 @@
+#include "ScanHistoryStore.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+
+const int SCHEMA_VERSION = 2;
+const int BATCH_SIZE = 64;          // Commit as soon as this many results are queued...
+const int BATCH_DELAY_MS = 250;     // ...or this long after the first one arrived
+
+// Times are stored as UTC milliseconds since the epoch. scan_dtcs repeats the
+// VIN and scan time so "which vehicles had code X since T" is answered from
+// its index alone. A freeze frame parameter belongs to the DTC at dtc_index
+// in its scan's scan_dtcs rows (in rowid order).
+const char* const SCHEMA[] = {
+    "CREATE TABLE IF NOT EXISTS scans ("
+    "  id INTEGER PRIMARY KEY,"
+    "  vin TEXT NOT NULL,"
+    "  scanned_at INTEGER NOT NULL,"
+    "  mil_on INTEGER NOT NULL,"
+    "  overall_ready INTEGER NOT NULL,"
+    "  complete INTEGER NOT NULL,"
+    "  received_items INTEGER NOT NULL,"
+    "  compression_ignition INTEGER NOT NULL DEFAULT 0,"
+    "  timed_out INTEGER NOT NULL DEFAULT 0)",
+    "CREATE TABLE IF NOT EXISTS scan_dtcs ("
+    "  scan_id INTEGER NOT NULL REFERENCES scans(id) ON DELETE CASCADE,"
+    "  code TEXT NOT NULL,"
+    "  status INTEGER NOT NULL,"
+    "  vin TEXT NOT NULL,"
+    "  scanned_at INTEGER NOT NULL,"
+    "  category INTEGER NOT NULL DEFAULT 0,"
+    "  short_text TEXT NOT NULL DEFAULT '',"
+    "  module TEXT NOT NULL DEFAULT '',"
+    "  frame_number INTEGER NOT NULL DEFAULT 0)",
+    "CREATE TABLE IF NOT EXISTS scan_monitors ("
+    "  scan_id INTEGER NOT NULL REFERENCES scans(id) ON DELETE CASCADE,"
+    "  monitor TEXT NOT NULL,"
+    "  status INTEGER NOT NULL)",
+    "CREATE TABLE IF NOT EXISTS scan_freeze_frames ("
+    "  scan_id INTEGER NOT NULL REFERENCES scans(id) ON DELETE CASCADE,"
+    "  dtc_index INTEGER NOT NULL,"
+    "  name TEXT NOT NULL,"
+    "  value TEXT NOT NULL)",
+    "CREATE TABLE IF NOT EXISTS scan_modules ("
+    "  scan_id INTEGER NOT NULL REFERENCES scans(id) ON DELETE CASCADE,"
+    "  name TEXT NOT NULL,"
+    "  address TEXT NOT NULL,"
+    "  responding INTEGER NOT NULL)",
+    "CREATE INDEX IF NOT EXISTS idx_scans_vin_time ON scans(vin, scanned_at)",
+    "CREATE INDEX IF NOT EXISTS idx_scans_time ON scans(scanned_at)",
+    "CREATE INDEX IF NOT EXISTS idx_scan_dtcs_code_time ON scan_dtcs(code, scanned_at, vin, scan_id)",
+    "CREATE INDEX IF NOT EXISTS idx_scan_dtcs_scan ON scan_dtcs(scan_id)",
+    "CREATE INDEX IF NOT EXISTS idx_scan_monitors_scan ON scan_monitors(scan_id)",
+    "CREATE INDEX IF NOT EXISTS idx_scan_freeze_frames_scan ON scan_freeze_frames(scan_id)",
+    "CREATE INDEX IF NOT EXISTS idx_scan_modules_scan ON scan_modules(scan_id)",
+};
+
+// Version 1 kept only codes, statuses and monitor states. Its DTCs get the
+// category of their code prefix; its scans get the diesel monitor layout if
+// they reported a monitor that only exists in it, as the version 1 reader
+// assumed.
+const char* const MIGRATE_FROM_V1[] = {
+    "ALTER TABLE scans ADD COLUMN compression_ignition INTEGER NOT NULL DEFAULT 0",
+    "ALTER TABLE scans ADD COLUMN timed_out INTEGER NOT NULL DEFAULT 0",
+    "ALTER TABLE scan_dtcs ADD COLUMN category INTEGER NOT NULL DEFAULT 0",
+    "ALTER TABLE scan_dtcs ADD COLUMN short_text TEXT NOT NULL DEFAULT ''",
+    "ALTER TABLE scan_dtcs ADD COLUMN module TEXT NOT NULL DEFAULT ''",
+    "ALTER TABLE scan_dtcs ADD COLUMN frame_number INTEGER NOT NULL DEFAULT 0",
+    "UPDATE scan_dtcs SET category = CASE substr(code, 1, 1) WHEN 'B' THEN 1 WHEN 'C' THEN 2 WHEN 'U' THEN 3 ELSE 0 END",
+    "UPDATE scans SET compression_ignition = 1 WHERE id IN (SELECT scan_id FROM scan_monitors "
+    "  WHERE monitor IN ('NMHC', 'NOX', 'BOOST', 'EGS', 'PM'))",
+};
+
+} // namespace
+
+/**
+ * @brief Owns the write connection; lives on the store's writer thread.
+ */
+class ScanHistoryWriter : public QObject
+{
+public:
+    ScanHistoryWriter(ScanHistoryStore* store, const QString& path, const QString& connectionName)
+        : m_store(store)
+        , m_path(path)
+        , m_connectionName(connectionName)
+        , m_batchTimer(new QTimer(this))
+    {
+        m_batchTimer->setSingleShot(true);
+        m_batchTimer->setInterval(BATCH_DELAY_MS);
+        connect(m_batchTimer, &QTimer::timeout, this, [this]() { flush(); });
+    }
+
+    ~ScanHistoryWriter() override
+    {
+        flush();
+
+        // Statements must be released before the connection is removed
+        m_insertScan = QSqlQuery();
+        m_insertDtc = QSqlQuery();
+        m_insertMonitor = QSqlQuery();
+        m_insertFreezeFrame = QSqlQuery();
+        m_insertModule = QSqlQuery();
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+    bool open(QString* error)
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        db.setDatabaseName(m_path);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        if (!db.open()) {
+            *error = db.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(db);
+        // WAL lets readers run while a batch is being committed; NORMAL sync is
+        // durable across application crashes and much cheaper per commit.
+        if (!query.exec("PRAGMA journal_mode=WAL") || !query.exec("PRAGMA synchronous=NORMAL") ||
+            !query.exec("PRAGMA foreign_keys=ON")) {
+            *error = query.lastError().text();
+            return false;
+        }
+
+        int version = 0;
+        if (query.exec("PRAGMA user_version") && query.next()) {
+            version = query.value(0).toInt();
+        }
+        if (version > SCHEMA_VERSION) {
+            *error = QString("History database schema %1 is newer than supported (%2)").arg(version).arg(SCHEMA_VERSION);
+            return false;
+        }
+
+        db.transaction();
+        if (version == 1) {
+            for (const char* statement : MIGRATE_FROM_V1) {
+                if (!query.exec(statement)) {
+                    *error = query.lastError().text();
+                    db.rollback();
+                    return false;
+                }
+            }
+        }
+        for (const char* statement : SCHEMA) {
+            if (!query.exec(statement)) {
+                *error = query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+        query.exec(QString("PRAGMA user_version=%1").arg(SCHEMA_VERSION));
+        db.commit();
+
+        m_insertScan = QSqlQuery(db);
+        m_insertDtc = QSqlQuery(db);
+        m_insertMonitor = QSqlQuery(db);
+        m_insertFreezeFrame = QSqlQuery(db);
+        m_insertModule = QSqlQuery(db);
+        if (!m_insertScan.prepare("INSERT INTO scans (vin, scanned_at, mil_on, overall_ready, complete, received_items, "
+                                  "compression_ignition, timed_out) VALUES (?, ?, ?, ?, ?, ?, ?, ?)") ||
+            !m_insertDtc.prepare("INSERT INTO scan_dtcs (scan_id, code, status, vin, scanned_at, category, short_text, "
+                                 "module, frame_number) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)") ||
+            !m_insertMonitor.prepare("INSERT INTO scan_monitors (scan_id, monitor, status) VALUES (?, ?, ?)") ||
+            !m_insertFreezeFrame.prepare("INSERT INTO scan_freeze_frames (scan_id, dtc_index, name, value) "
+                                         "VALUES (?, ?, ?, ?)") ||
+            !m_insertModule.prepare("INSERT INTO scan_modules (scan_id, name, address, responding) VALUES (?, ?, ?, ?)")) {
+            *error = db.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    void enqueue(const ScanResult& result)
+    {
+        m_pending.append(result);
+        if (m_pending.size() >= BATCH_SIZE) {
+            flush();
+        } else if (!m_batchTimer->isActive()) {
+            m_batchTimer->start();
+        }
+    }
+
+    void flush()
+    {
+        m_batchTimer->stop();
+        if (m_pending.isEmpty()) {
+            return;
+        }
+
+        // One transaction per batch: a single fsync instead of one per row
+        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+        const int count = m_pending.size();
+        QString error;
+        bool ok = db.transaction();
+        for (int i = 0; ok && i < count; ++i) {
+            ok = writeScan(m_pending.at(i), &error);
+        }
+        ok = ok && db.commit();
+        m_pending.clear();
+
+        if (!ok) {
+            if (error.isEmpty()) {
+                error = db.lastError().text();
+            }
+            const QString message = QString("Failed to write %1 scan(s) to history: %2").arg(count).arg(error);
+            qDebug() << "ScanHistoryStore:" << message;
+            db.rollback();
+            emit m_store->errorOccurred(message);
+            return;
+        }
+        emit m_store->batchWritten(count);
+    }
+
+private:
+    bool writeScan(const ScanResult& result, QString* error)
+    {
+        const qint64 scannedAt = result.timestamp.toMSecsSinceEpoch();
+
+        m_insertScan.addBindValue(result.vin);
+        m_insertScan.addBindValue(scannedAt);
+        m_insertScan.addBindValue(result.milOn);
+        m_insertScan.addBindValue(result.readiness.overallReady);
+        m_insertScan.addBindValue(result.complete);
+        m_insertScan.addBindValue(result.receivedItems);
+        m_insertScan.addBindValue(result.readiness.compressionIgnition);
+        m_insertScan.addBindValue(result.timedOut);
+        if (!m_insertScan.exec()) {
+            *error = m_insertScan.lastError().text();
+            return false;
+        }
+        const qint64 scanId = m_insertScan.lastInsertId().toLongLong();
+
+        for (int i = 0; i < result.dtcs.size(); ++i) {
+            const DtcEntry& dtc = result.dtcs.at(i);
+            m_insertDtc.addBindValue(scanId);
+            m_insertDtc.addBindValue(dtc.code);
+            m_insertDtc.addBindValue(static_cast<int>(dtc.status));
+            m_insertDtc.addBindValue(result.vin);
+            m_insertDtc.addBindValue(scannedAt);
+            m_insertDtc.addBindValue(static_cast<int>(dtc.category));
+            m_insertDtc.addBindValue(dtc.shortText);
+            m_insertDtc.addBindValue(dtc.module);
+            m_insertDtc.addBindValue(dtc.freezeFrame.frameNumber);
+            if (!m_insertDtc.exec()) {
+                *error = m_insertDtc.lastError().text();
+                return false;
+            }
+
+            for (auto it = dtc.freezeFrame.parameters.cbegin(); it != dtc.freezeFrame.parameters.cend(); ++it) {
+                m_insertFreezeFrame.addBindValue(scanId);
+                m_insertFreezeFrame.addBindValue(i);
+                m_insertFreezeFrame.addBindValue(it.key());
+                m_insertFreezeFrame.addBindValue(it.value());
+                if (!m_insertFreezeFrame.exec()) {
+                    *error = m_insertFreezeFrame.lastError().text();
+                    return false;
+                }
+            }
+        }
+
+        for (const ModuleInfo& module : result.modules) {
+            m_insertModule.addBindValue(scanId);
+            m_insertModule.addBindValue(module.name);
+            m_insertModule.addBindValue(module.address);
+            m_insertModule.addBindValue(module.responding);
+            if (!m_insertModule.exec()) {
+                *error = m_insertModule.lastError().text();
+                return false;
+            }
+        }
+
+        bool inserted = true;
+        result.readiness.forEachMonitor([&](Monitor monitor, MonitorStatus status) {
+            if (!inserted) {
+                return;
+            }
+            m_insertMonitor.addBindValue(scanId);
+            m_insertMonitor.addBindValue(QString::fromLatin1(ReadinessResult::monitorName(monitor)));
+            m_insertMonitor.addBindValue(static_cast<int>(status));
+            if (!m_insertMonitor.exec()) {
+                *error = m_insertMonitor.lastError().text();
+                inserted = false;
+            }
+        });
+        return inserted;
+    }
+
+    ScanHistoryStore* m_store;
+    QString m_path;
+    QString m_connectionName;
+    QTimer* m_batchTimer;
+    QVector<ScanResult> m_pending;
+    QSqlQuery m_insertScan;
+    QSqlQuery m_insertDtc;
+    QSqlQuery m_insertMonitor;
+    QSqlQuery m_insertFreezeFrame;
+    QSqlQuery m_insertModule;
+};
+
+ScanHistoryStore::ScanHistoryStore(const QString& databasePath, QObject *parent)
+    : QObject(parent)
+    , m_databasePath(databasePath)
+{
+    m_writerThread.setObjectName("ScanHistoryWriter");
+}
+
+ScanHistoryStore::~ScanHistoryStore()
+{
+    close();
+}
+
+bool ScanHistoryStore::open()
+{
+    if (m_writer) {
+        return true;
+    }
+    m_lastError.clear();
+
+    const QString connectionBase = QString("ScanHistoryStore-%1").arg(quintptr(this), 0, 16);
+    m_readConnection = connectionBase + "-read";
+
+    m_writer = new ScanHistoryWriter(this, m_databasePath, connectionBase + "-write");
+    m_writer->moveToThread(&m_writerThread);
+    m_writerThread.start();
+
+    // The writer creates the schema, so it has to be up before the reader opens
+    bool ok = false;
+    QString error;
+    ScanHistoryWriter* writer = m_writer;
+    QMetaObject::invokeMethod(writer, [writer, &ok, &error]() {
+        ok = writer->open(&error);
+    }, Qt::BlockingQueuedConnection);
+
+    if (ok) {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_readConnection);
+        db.setDatabaseName(m_databasePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+        ok = db.open();
+        if (!ok) {
+            error = db.lastError().text();
+        }
+    }
+
+    if (!ok) {
+        m_lastError = error;
+        qDebug() << "ScanHistoryStore: Cannot open" << m_databasePath << ":" << error;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ScanHistoryStore::close()
+{
+    if (m_writer) {
+        // The writer commits what is left and releases its connection on its own thread
+        ScanHistoryWriter* writer = m_writer;
+        m_writer = nullptr;
+        QMetaObject::invokeMethod(writer, [writer]() { delete writer; }, Qt::BlockingQueuedConnection);
+        m_writerThread.quit();
+        m_writerThread.wait();
+    }
+
+    if (!m_readConnection.isEmpty()) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_readConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_readConnection);
+        m_readConnection.clear();
+    }
+}
+
+void ScanHistoryStore::record(const ScanResult& result)
+{
+    if (!m_writer) {
+        qDebug() << "ScanHistoryStore: Not open, scan not recorded";
+        return;
+    }
+
+    ScanHistoryWriter* writer = m_writer;
+    QMetaObject::invokeMethod(writer, [writer, result]() {
+        writer->enqueue(result);
+    }, Qt::QueuedConnection);
+}
+
+void ScanHistoryStore::flush()
+{
+    if (!m_writer) {
+        return;
+    }
+
+    // Queued after every record() made so far, so all of them are committed on return
+    ScanHistoryWriter* writer = m_writer;
+    QMetaObject::invokeMethod(writer, [writer]() { writer->flush(); }, Qt::BlockingQueuedConnection);
+}
+
+QVector<ScanHistoryStore::DtcHit> ScanHistoryStore::vehiclesWithDtc(const QString& code, const QDateTime& since) const
+{
+    QVector<DtcHit> hits;
+    if (m_readConnection.isEmpty()) {
+        return hits;
+    }
+
+    QSqlQuery query(QSqlDatabase::database(m_readConnection, false));
+    query.prepare("SELECT vin, MIN(scanned_at), MAX(scanned_at), COUNT(DISTINCT scan_id) FROM scan_dtcs "
+                  "WHERE code = ? AND scanned_at >= ? GROUP BY vin ORDER BY MAX(scanned_at) DESC");
+    query.addBindValue(code.toUpper());
+    query.addBindValue(since.toMSecsSinceEpoch());
+    if (!query.exec()) {
+        qDebug() << "ScanHistoryStore: Query failed:" << query.lastError().text();
+        return hits;
+    }
+
+    while (query.next()) {
+        DtcHit hit;
+        hit.vin = query.value(0).toString();
+        hit.firstSeen = QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong());
+        hit.lastSeen = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        hit.scanCount = query.value(3).toInt();
+        hits.append(hit);
+    }
+    return hits;
+}
+
+QVector<ScanResult> ScanHistoryStore::scansForVehicle(const QString& vin, int limit) const
+{
+    QVector<ScanResult> scans;
+    if (m_readConnection.isEmpty()) {
+        return scans;
+    }
+
+    const QSqlDatabase db = QSqlDatabase::database(m_readConnection, false);
+    QSqlQuery scanQuery(db);
+    QSqlQuery dtcQuery(db);
+    QSqlQuery monitorQuery(db);
+    QSqlQuery freezeFrameQuery(db);
+    QSqlQuery moduleQuery(db);
+    scanQuery.prepare("SELECT id, scanned_at, mil_on, overall_ready, complete, received_items, compression_ignition, "
+                      "timed_out FROM scans WHERE vin = ? ORDER BY scanned_at DESC LIMIT ?");
+    dtcQuery.prepare("SELECT code, status, category, short_text, module, frame_number FROM scan_dtcs "
+                     "WHERE scan_id = ? ORDER BY rowid");
+    monitorQuery.prepare("SELECT monitor, status FROM scan_monitors WHERE scan_id = ?");
+    freezeFrameQuery.prepare("SELECT dtc_index, name, value FROM scan_freeze_frames WHERE scan_id = ?");
+    moduleQuery.prepare("SELECT name, address, responding FROM scan_modules WHERE scan_id = ? ORDER BY rowid");
+
+    scanQuery.addBindValue(vin);
+    scanQuery.addBindValue(limit);
+    if (!scanQuery.exec()) {
+        qDebug() << "ScanHistoryStore: Query failed:" << scanQuery.lastError().text();
+        return scans;
+    }
+
+    while (scanQuery.next()) {
+        const qint64 scanId = scanQuery.value(0).toLongLong();
+
+        ScanResult result;
+        result.vin = vin;
+        result.timestamp = QDateTime::fromMSecsSinceEpoch(scanQuery.value(1).toLongLong());
+        result.milOn = scanQuery.value(2).toBool();
+        result.complete = scanQuery.value(4).toBool();
+        result.receivedItems = scanQuery.value(5).toUInt();
+        result.timedOut = scanQuery.value(7).toBool();
+
+        dtcQuery.addBindValue(scanId);
+        if (dtcQuery.exec()) {
+            while (dtcQuery.next()) {
+                DtcEntry dtc(dtcQuery.value(0).toString(), static_cast<DtcStatus>(dtcQuery.value(1).toInt()));
+                dtc.category = static_cast<DtcCategory>(dtcQuery.value(2).toInt());
+                dtc.shortText = dtcQuery.value(3).toString();
+                dtc.module = dtcQuery.value(4).toString();
+                dtc.freezeFrame.frameNumber = dtcQuery.value(5).toInt();
+                result.dtcs.append(dtc);
+            }
+        }
+
+        freezeFrameQuery.addBindValue(scanId);
+        if (freezeFrameQuery.exec()) {
+            while (freezeFrameQuery.next()) {
+                const int index = freezeFrameQuery.value(0).toInt();
+                if (index >= 0 && index < result.dtcs.size()) {
+                    result.dtcs[index].freezeFrame.addParameter(freezeFrameQuery.value(1).toString(),
+                                                                freezeFrameQuery.value(2).toString());
+                }
+            }
+        }
+
+        moduleQuery.addBindValue(scanId);
+        if (moduleQuery.exec()) {
+            while (moduleQuery.next()) {
+                ModuleInfo module;
+                module.name = moduleQuery.value(0).toString();
+                module.address = moduleQuery.value(1).toString();
+                module.responding = moduleQuery.value(2).toBool();
+                result.modules.append(module);
+            }
+        }
+
+        monitorQuery.addBindValue(scanId);
+        if (monitorQuery.exec()) {
+            while (monitorQuery.next()) {
+                Monitor monitor = Monitor::Count;
+                if (ReadinessResult::monitorFromName(monitorQuery.value(0).toString(), &monitor)) {
+                    result.readiness.setMonitorStatus(monitor,
+                                                      static_cast<MonitorStatus>(monitorQuery.value(1).toInt()));
+                }
+            }
+        }
+        result.readiness.compressionIgnition = scanQuery.value(6).toBool();
+        result.readiness.overallReady = scanQuery.value(3).toBool();
+
+        scans.append(result);
+    }
+    return scans;
+}
+
+qint64 ScanHistoryStore::scanCount() const
+{
+    if (m_readConnection.isEmpty()) {
+        return 0;
+    }
+
+    QSqlQuery query(QSqlDatabase::database(m_readConnection, false));
+    if (query.exec("SELECT COUNT(*) FROM scans") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
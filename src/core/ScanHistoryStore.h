@@ -0,0 +1,106 @@
+#ifndef SCANHISTORYSTORE_H
+#define SCANHISTORYSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QDateTime>
+#include <QVector>
+#include <QThread>
+#include "core/dto/ScanResult.h"
+
+class ScanHistoryWriter;
+
+/**
+ * @brief The ScanHistoryStore class
+ * Persistent scan history in SQLite: every ScanResult with its DTCs (and
+ * their freeze frames), readiness monitor states and modules, keyed by VIN.
+ * scansForVehicle() reads back what record() was given, apart from the
+ * snapshot version.
+ *
+ * Writes never run on the caller's thread. record() hands the result to a
+ * writer thread, which commits queued results in batched transactions with
+ * prepared statements. The database runs in WAL mode, so queries (made on the
+ * thread that owns the store) read alongside the writer without blocking it.
+ */
+class ScanHistoryStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief One vehicle that reported a DTC in a queried time range.
+     */
+    struct DtcHit {
+        QString vin;
+        QDateTime firstSeen;
+        QDateTime lastSeen;
+        int scanCount = 0;      // Scans in the range that reported the code
+    };
+
+    explicit ScanHistoryStore(const QString& databasePath, QObject *parent = nullptr);
+    ~ScanHistoryStore();
+
+    /**
+     * @brief Opens (and if needed creates) the database and starts the writer thread.
+     * @return false on failure; see lastError().
+     */
+    bool open();
+
+    /**
+     * @brief Commits pending writes, stops the writer thread and closes the database.
+     */
+    void close();
+
+    bool isOpen() const { return m_writer != nullptr; }
+    QString lastError() const { return m_lastError; }
+    QString databasePath() const { return m_databasePath; }
+
+    /**
+     * @brief Queues a scan result for writing. Returns immediately.
+     * Results without a VIN are stored under an empty VIN.
+     */
+    void record(const ScanResult& result);
+
+    /**
+     * @brief Blocks until every queued result is committed.
+     */
+    void flush();
+
+    // --- Queries (run on the calling thread; must be the thread that owns the store) ---
+
+    /**
+     * @brief Vehicles that reported a DTC at or after a point in time, most recent first.
+     * Served from the (code, time, VIN) index without touching the scans table.
+     */
+    QVector<DtcHit> vehiclesWithDtc(const QString& code, const QDateTime& since) const;
+
+    /**
+     * @brief Most recent scans of one vehicle, newest first, with DTCs and monitors.
+     */
+    QVector<ScanResult> scansForVehicle(const QString& vin, int limit = 50) const;
+
+    /**
+     * @brief Total number of stored scans.
+     */
+    qint64 scanCount() const;
+
+signals:
+    /**
+     * @brief Emitted (from the writer thread) after a batch is committed.
+     */
+    void batchWritten(int scanCount);
+
+    /**
+     * @brief Emitted when a write fails; the batch is rolled back.
+     */
+    void errorOccurred(const QString& message);
+
+private:
+    QString m_databasePath;
+    QString m_readConnection;
+    QString m_lastError;
+    QThread m_writerThread;
+    ScanHistoryWriter* m_writer = nullptr;
+};
+
+#endif // SCANHISTORYSTORE_H
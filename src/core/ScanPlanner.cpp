@@ -0,0 +1,243 @@
+#include "ScanPlanner.h"
+#include <QList>
+#include <cctype>
+
+namespace {
+
+struct ItemDef {
+    ScanPlanner::Item item;
+    const char* command;        // Items with the same command share one reply
+    const char* what;           // Description without the verb, e.g. "stored DTCs"
+    const char* name;           // Machine-readable name, e.g. "storedDtcs"
+    quint32 dependsOn;          // Items that must be requested first
+    quint8 pidMode;             // PID support gate (0 = always sent)
+    quint8 pid;
+    int replyBytes;
+};
+
+// Declared in dependency order: every item comes after the items it requires,
+// so emitting in table order respects all dependencies. The VIN goes first so
+// anything keyed by vehicle (caches, history) can use it for the rest of the scan.
+const ItemDef ITEM_TABLE[] = {
+    { ScanPlanner::SupportedPids01, "01 00", "supported PIDs",       "supportedPids01", 0,                            0,    0,    6  },
+    { ScanPlanner::SupportedPids09, "09 00", "supported info types", "supportedPids09", 0,                            0,    0,    6  },
+    { ScanPlanner::Vin,             "09 02", "VIN",                  "vin",             ScanPlanner::SupportedPids09, 0x09, 0x02, 35 },
+    { ScanPlanner::MilStatus,       "01 01", "MIL status",           "milStatus",       ScanPlanner::SupportedPids01, 0x01, 0x01, 6  },
+    { ScanPlanner::Readiness,       "01 01", "readiness monitors",   "readiness",       ScanPlanner::SupportedPids01, 0x01, 0x01, 6  },
+    { ScanPlanner::StoredDtcs,      "03",    "stored DTCs",          "storedDtcs",      0,                            0,    0,    7  },
+    { ScanPlanner::PendingDtcs,     "07",    "pending DTCs",         "pendingDtcs",     0,                            0,    0,    7  },
+    { ScanPlanner::PermanentDtcs,   "0A",    "permanent DTCs",       "permanentDtcs",   0,                            0,    0,    7  },
+};
+
+// Support query that gates each mode's PIDs
+quint32 supportItemForMode(quint8 mode)
+{
+    switch (mode) {
+    case 0x01: return ScanPlanner::SupportedPids01;
+    case 0x09: return ScanPlanner::SupportedPids09;
+    default:   return 0;
+    }
+}
+
+struct BusTiming {
+    int roundTripMs;    // Adapter + ECU response time for a single-frame reply
+    double msPerByte;   // Wire time per payload byte
+};
+
+BusTiming busTiming(const QString& protocolName)
+{
+    // K-line (10.4 kbaud) replies are slow byte-by-byte and have long P2 timing;
+    // CAN replies arrive almost at once. Unknown protocols get the K-line figures.
+    if (protocolName.startsWith("CAN", Qt::CaseInsensitive)) {
+        return { 25, 0.1 };
+    }
+    if (protocolName.startsWith("J1850", Qt::CaseInsensitive)) {
+        return { 45, 0.5 };
+    }
+    return { 90, 1.5 };
+}
+
+} // namespace
+
+ScanPlanner::ScanPlan ScanPlanner::compile(Recipe recipe, const SupportedPids& supported, const QString& protocolName)
+{
+    ScanPlan plan = compileItems(recipeItems(recipe), supported, protocolName);
+    plan.recipe = recipe;
+    return plan;
+}
+
+ScanPlanner::ScanPlan ScanPlanner::compileItems(quint32 items, const SupportedPids& supported,
+                                                const QString& protocolName)
+{
+    ScanPlan plan;
+    plan.requestedItems = items;
+
+    // 1. Drop items the vehicle is known not to support
+    quint32 wanted = 0;
+    for (const ItemDef& def : ITEM_TABLE) {
+        if (!(items & def.item)) {
+            continue;
+        }
+        if (def.pidMode != 0 && supported.isKnown(def.pidMode) && !supported.isSupported(def.pidMode, def.pid)) {
+            plan.skippedItems |= def.item;
+        } else {
+            wanted |= def.item;
+        }
+    }
+
+    // 2. Add dependencies; support queries are only needed while support is unknown
+    for (const ItemDef& def : ITEM_TABLE) {
+        if (!(wanted & def.item)) {
+            continue;
+        }
+        quint32 dependsOn = def.dependsOn;
+        if (def.pidMode != 0 && supported.isKnown(def.pidMode)) {
+            dependsOn &= ~supportItemForMode(def.pidMode);
+        }
+        wanted |= dependsOn;
+    }
+
+    // 3. One command per distinct request, in table (dependency) order
+    for (const ItemDef& def : ITEM_TABLE) {
+        if (!(wanted & def.item)) {
+            continue;
+        }
+
+        const QByteArray data = QByteArray(def.command) + '\r';
+        PlannedCommand* shared = nullptr;
+        for (PlannedCommand& command : plan.commands) {
+            if (command.data == data) {
+                shared = &command;
+                break;
+            }
+        }
+
+        if (shared) {
+            // Same reply answers this item too; no extra round-trip
+            shared->items |= def.item;
+            shared->description += QString(", ") + def.what;
+            continue;
+        }
+
+        PlannedCommand command;
+        command.data = data;
+        command.description = QString("Get ") + def.what;
+        command.items = def.item;
+        if (def.pidMode != 0 && !supported.isKnown(def.pidMode)) {
+            command.gateMode = def.pidMode;
+            command.gatePid = def.pid;
+        }
+        command.expectedReplyBytes = def.replyBytes;
+        plan.commands.append(command);
+    }
+
+    for (const PlannedCommand& command : plan.commands) {
+        plan.estimatedBusTimeMs += estimateCommandMs(command, protocolName);
+    }
+
+    return plan;
+}
+
+quint32 ScanPlanner::recipeItems(Recipe recipe)
+{
+    const quint32 quick = MilStatus | Readiness | StoredDtcs | PendingDtcs;
+    switch (recipe) {
+    case Quick:             return quick;
+    case EmissionsPrecheck: return quick | PermanentDtcs;
+    case Full:              return quick | PermanentDtcs | Vin;
+    }
+    return quick;
+}
+
+QString ScanPlanner::recipeName(Recipe recipe)
+{
+    switch (recipe) {
+    case Quick:             return "quick";
+    case EmissionsPrecheck: return "emissions";
+    case Full:              return "full";
+    }
+    return "quick";
+}
+
+ScanPlanner::Recipe ScanPlanner::recipeFromName(const QString& name, bool* ok)
+{
+    if (ok) {
+        *ok = true;
+    }
+    for (Recipe recipe : {Quick, EmissionsPrecheck, Full}) {
+        if (name.compare(recipeName(recipe), Qt::CaseInsensitive) == 0) {
+            return recipe;
+        }
+    }
+    if (ok) {
+        *ok = false;
+    }
+    return Quick;
+}
+
+QStringList ScanPlanner::itemNames(quint32 items)
+{
+    QStringList names;
+    for (const ItemDef& def : ITEM_TABLE) {
+        if (items & def.item) {
+            names.append(def.name);
+        }
+    }
+    return names;
+}
+
+int ScanPlanner::estimateCommandMs(const PlannedCommand& command, const QString& protocolName)
+{
+    const BusTiming timing = busTiming(protocolName);
+    return timing.roundTripMs + qRound(command.expectedReplyBytes * timing.msPerByte);
+}
+
+bool ScanPlanner::parseSupportedPids(const QByteArray& response, quint8 mode, quint32* bitmap)
+{
+    const quint8 replyMode = quint8(0x40 + mode);
+    quint32 merged = 0;
+    bool found = false;
+
+    // One line per responding ECU; status lines such as "SEARCHING..." are skipped
+    const QList<QByteArray> lines = response.split('\r');
+    for (const QByteArray& line : lines) {
+        QByteArray clean = line.simplified();
+        clean.replace(">", "");
+
+        QByteArray bytes;
+        bool isHex = !clean.isEmpty();
+        for (const QByteArray& token : clean.split(' ')) {
+            for (char c : token) {
+                if (!std::isxdigit(static_cast<unsigned char>(c))) {
+                    isHex = false;
+                }
+            }
+            if (!isHex) {
+                break;
+            }
+            if (token.size() % 2 == 0) {
+                bytes.append(QByteArray::fromHex(token));
+            }
+            // Odd-length tokens are CAN header IDs (e.g. "7E8"), not payload
+        }
+        if (!isHex) {
+            continue;
+        }
+
+        for (int i = 0; i + 5 < bytes.size(); ++i) {
+            if (quint8(bytes.at(i)) == replyMode && bytes.at(i + 1) == 0x00) {
+                merged |= (quint32(quint8(bytes.at(i + 2))) << 24) |
+                          (quint32(quint8(bytes.at(i + 3))) << 16) |
+                          (quint32(quint8(bytes.at(i + 4))) << 8) |
+                          quint32(quint8(bytes.at(i + 5)));
+                found = true;
+                break;
+            }
+        }
+    }
+
+    if (found && bitmap) {
+        *bitmap = merged;
+    }
+    return found;
+}
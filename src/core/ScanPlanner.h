@@ -0,0 +1,116 @@
+#ifndef SCANPLANNER_H
+#define SCANPLANNER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "core/dto/SupportedPids.h"
+
+/**
+ * @brief The ScanPlanner class
+ * Compiles declarative scan recipes into the shortest command sequence.
+ *
+ * A recipe names the data items it wants (MIL status, readiness, stored DTCs, ...).
+ * The planner drops items the vehicle is known not to support, adds the queries
+ * they depend on, and emits one command per distinct request: items answered by
+ * the same reply (MIL status and readiness both come from "01 01") share a
+ * single round-trip.
+ */
+class ScanPlanner
+{
+public:
+    enum Recipe {
+        Quick,              // MIL, readiness, stored and pending DTCs
+        EmissionsPrecheck,  // Quick plus permanent DTCs
+        Full                // Everything, starting with the VIN
+    };
+
+    /**
+     * @brief Data items a recipe can request (bit flags).
+     */
+    enum Item : quint32 {
+        SupportedPids01 = 0x0001,  // Mode 01 PIDs 01-20 supported
+        SupportedPids09 = 0x0002,  // Mode 09 PIDs 01-20 supported
+        Vin             = 0x0004,  // Vehicle Identification Number
+        MilStatus       = 0x0008,
+        Readiness       = 0x0010,
+        StoredDtcs      = 0x0020,
+        PendingDtcs     = 0x0040,
+        PermanentDtcs   = 0x0080
+    };
+
+    /**
+     * @brief One request/reply round-trip.
+     */
+    struct PlannedCommand {
+        QByteArray data;            // Bytes to send, e.g. "01 01\r"
+        QString description;
+        quint32 items = 0;          // Items answered by this reply
+        quint8 gateMode = 0;        // If non-zero, skip when gatePid turns out to be
+        quint8 gatePid = 0;         // unsupported once the support query has run
+        int expectedReplyBytes = 0; // Payload bytes, used for the bus time estimate
+    };
+
+    struct ScanPlan {
+        Recipe recipe = Quick;
+        QVector<PlannedCommand> commands;
+        quint32 requestedItems = 0;     // Items the recipe asked for
+        quint32 skippedItems = 0;       // Items dropped because the vehicle does not support them
+        int estimatedBusTimeMs = 0;     // Expected time on the wire for all commands
+    };
+
+    /**
+     * @brief Compiles a recipe.
+     * @param recipe Recipe to compile.
+     * @param supported Supported-PID knowledge gathered so far (e.g. during connection).
+     * @param protocolName Detected protocol (ScanService naming), used for the bus time estimate.
+     */
+    static ScanPlan compile(Recipe recipe, const SupportedPids& supported = SupportedPids(),
+                            const QString& protocolName = QString());
+
+    /**
+     * @brief Compiles an arbitrary set of items.
+     */
+    static ScanPlan compileItems(quint32 items, const SupportedPids& supported = SupportedPids(),
+                                 const QString& protocolName = QString());
+
+    /**
+     * @brief Items requested by a recipe.
+     */
+    static quint32 recipeItems(Recipe recipe);
+
+    /**
+     * @brief Recipe name for display and the CLI ("quick", "emissions", "full").
+     */
+    static QString recipeName(Recipe recipe);
+
+    /**
+     * @brief Parses a recipe name.
+     * @param ok Set to false if the name is unknown.
+     */
+    static Recipe recipeFromName(const QString& name, bool* ok = nullptr);
+
+    /**
+     * @brief Names of the items in a flag set, in plan order (e.g. "milStatus", "storedDtcs").
+     */
+    static QStringList itemNames(quint32 items);
+
+    /**
+     * @brief Estimated round-trip time in ms for one command on the given protocol.
+     */
+    static int estimateCommandMs(const PlannedCommand& command, const QString& protocolName);
+
+    /**
+     * @brief Parses a "<40+mode> 00 XX XX XX XX" supported-PID reply.
+     * Replies from several ECUs are OR-ed together.
+     * @param bitmap Receives the bitmap (bit 31 = PID 0x01).
+     * @return false if the response holds no valid reply for the mode.
+     */
+    static bool parseSupportedPids(const QByteArray& response, quint8 mode, quint32* bitmap);
+
+private:
+    ScanPlanner() = delete;  // Static class, prevent instantiation
+};
+
+#endif // SCANPLANNER_H
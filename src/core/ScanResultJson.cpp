@@ -0,0 +1,218 @@
+#include "ScanResultJson.h"
+#include "ScanPlanner.h"
+#include <QJsonArray>
+
+QJsonObject ScanResultJson::toJson(const ScanResult& result)
+{
+    QJsonObject json;
+    json["timestamp"] = result.timestamp.toString(Qt::ISODateWithMs);
+    json["milOn"] = result.milOn;
+    if (!result.vin.isEmpty()) {
+        json["vin"] = result.vin;
+    }
+    if (!result.complete) {
+        // Progressive update: only the listed items have been read yet
+        json["complete"] = false;
+        json["received"] = QJsonArray::fromStringList(ScanPlanner::itemNames(result.receivedItems));
+    }
+    if (result.timedOut) {
+        // Cut short: only the listed items were read before the timeout
+        json["timedOut"] = true;
+        json["received"] = QJsonArray::fromStringList(ScanPlanner::itemNames(result.receivedItems));
+    }
+
+    QJsonArray dtcs;
+    for (const DtcEntry& entry : result.dtcs) {
+        dtcs.append(toJson(entry));
+    }
+    json["dtcs"] = dtcs;
+    json["readiness"] = toJson(result.readiness);
+
+    if (!result.modules.isEmpty()) {
+        QJsonArray modules;
+        for (const ModuleInfo& module : result.modules) {
+            QJsonObject moduleJson;
+            moduleJson["name"] = module.name;
+            moduleJson["address"] = module.address;
+            moduleJson["responding"] = module.responding;
+            modules.append(moduleJson);
+        }
+        json["modules"] = modules;
+    }
+
+    return json;
+}
+
+QJsonObject ScanResultJson::toJson(const DtcEntry& entry)
+{
+    QJsonObject json;
+    json["code"] = entry.code;
+    json["status"] = statusName(entry.status);
+    json["category"] = categoryName(entry.category);
+    if (!entry.shortText.isEmpty()) {
+        json["shortText"] = entry.shortText;
+    }
+    if (!entry.module.isEmpty()) {
+        json["module"] = entry.module;
+    }
+    if (!entry.freezeFrame.isEmpty()) {
+        QJsonObject parameters;
+        for (auto it = entry.freezeFrame.parameters.constBegin(); it != entry.freezeFrame.parameters.constEnd(); ++it) {
+            parameters[it.key()] = it.value();
+        }
+        QJsonObject freezeFrame;
+        freezeFrame["frameNumber"] = entry.freezeFrame.frameNumber;
+        freezeFrame["parameters"] = parameters;
+        json["freezeFrame"] = freezeFrame;
+    }
+    return json;
+}
+
+QJsonObject ScanResultJson::toJson(const ReadinessResult& readiness)
+{
+    QJsonObject monitors;
+    readiness.forEachMonitor([&monitors](Monitor monitor, MonitorStatus status) {
+        monitors[QLatin1String(ReadinessResult::monitorName(monitor))] = monitorStatusName(status);
+    });
+
+    QJsonObject json;
+    json["overallReady"] = readiness.overallReady;
+    if (!readiness.isEmpty()) {
+        json["ignition"] = QString(readiness.compressionIgnition ? "compression" : "spark");
+    }
+    json["monitors"] = monitors;
+    return json;
+}
+
+QJsonObject ScanResultJson::toJson(const ScanDiff& diff)
+{
+    QJsonObject json;
+    json["hasBaseline"] = diff.hasBaseline;
+    if (!diff.hasBaseline) {
+        return json;
+    }
+    json["baselineTime"] = diff.baselineTime.toString(Qt::ISODateWithMs);
+
+    auto dtcList = [](const QVector<DtcChange>& changes) {
+        QJsonArray list;
+        for (const DtcChange& change : changes) {
+            QJsonObject entry;
+            entry["code"] = change.code;
+            if (change.before != 0) {
+                entry["before"] = statusNames(change.before);
+            }
+            if (change.after != 0) {
+                entry["after"] = statusNames(change.after);
+            }
+            if (change.isPendingToConfirmed()) {
+                entry["pendingToConfirmed"] = true;
+            }
+            list.append(entry);
+        }
+        return list;
+    };
+    json["added"] = dtcList(diff.addedDtcs);
+    json["cleared"] = dtcList(diff.clearedDtcs);
+    json["changed"] = dtcList(diff.changedDtcs);
+
+    QJsonArray monitors;
+    for (const MonitorChange& change : diff.monitorChanges) {
+        QJsonObject entry;
+        entry["monitor"] = change.monitor;
+        entry["before"] = monitorStatusName(change.before);
+        entry["after"] = monitorStatusName(change.after);
+        monitors.append(entry);
+    }
+    json["monitors"] = monitors;
+
+    if (diff.milChanged()) {
+        QJsonObject mil;
+        mil["before"] = diff.milBefore;
+        mil["after"] = diff.milAfter;
+        json["mil"] = mil;
+    }
+    return json;
+}
+
+QJsonObject ScanResultJson::toJson(const PidStatistics::Summary& summary)
+{
+    QJsonObject json;
+    json["pid"] = summary.pidId;
+    json["count"] = double(summary.moments.count);
+    if (summary.isEmpty()) {
+        return json;
+    }
+
+    json["unit"] = summary.unit;
+    json["mean"] = summary.moments.mean;
+    json["stddev"] = summary.moments.stddev();
+    json["min"] = summary.moments.min;
+    json["max"] = summary.moments.max;
+    json["p50"] = summary.quantile(0.5);
+    json["p95"] = summary.quantile(0.95);
+    json["p99"] = summary.quantile(0.99);
+    json["durationMs"] = double(summary.lastTimeNs - summary.firstTimeNs) / 1e6;
+
+    QJsonArray counts;
+    for (quint64 count : summary.histogram.counts()) {
+        counts.append(double(count));
+    }
+    QJsonObject histogram;
+    histogram["lower"] = summary.histogram.lower();
+    histogram["binWidth"] = summary.histogram.binWidth();
+    histogram["counts"] = counts;
+    json["histogram"] = histogram;
+    return json;
+}
+
+QString ScanResultJson::statusName(DtcStatus status)
+{
+    switch (status) {
+    case DtcStatus::Confirmed:
+        return "confirmed";
+    case DtcStatus::Pending:
+        return "pending";
+    case DtcStatus::Permanent:
+        return "permanent";
+    }
+    return "unknown";
+}
+
+QString ScanResultJson::categoryName(DtcCategory category)
+{
+    switch (category) {
+    case DtcCategory::P:
+        return "P";
+    case DtcCategory::B:
+        return "B";
+    case DtcCategory::C:
+        return "C";
+    case DtcCategory::U:
+        return "U";
+    }
+    return "P";
+}
+
+QString ScanResultJson::monitorStatusName(MonitorStatus status)
+{
+    switch (status) {
+    case MonitorStatus::Complete:
+        return "complete";
+    case MonitorStatus::Incomplete:
+        return "incomplete";
+    case MonitorStatus::Unsupported:
+        return "unsupported";
+    }
+    return "unsupported";
+}
+
+QJsonArray ScanResultJson::statusNames(quint8 statusFlags)
+{
+    QJsonArray names;
+    for (DtcStatus status : {DtcStatus::Confirmed, DtcStatus::Pending, DtcStatus::Permanent}) {
+        if (statusFlags & dtcStatusFlag(status)) {
+            names.append(statusName(status));
+        }
+    }
+    return names;
+}
@@ -0,0 +1,54 @@
+#ifndef SCANRESULTJSON_H
+#define SCANRESULTJSON_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include "core/dto/ScanResult.h"
+#include "core/dto/DtcEntry.h"
+#include "core/dto/ReadinessResult.h"
+#include "core/dto/ScanDiff.h"
+#include "core/PidStatistics.h"
+
+/**
+ * @brief The ScanResultJson class
+ * Serializes scan DTOs and live PID statistics to JSON for the command-line
+ * tool and reports.
+ */
+class ScanResultJson
+{
+public:
+    /**
+     * @brief Converts a scan result to a JSON object.
+     * @return {"timestamp", "milOn", "dtcs": [...], "readiness": {...}, "modules": [...]}
+     */
+    static QJsonObject toJson(const ScanResult& result);
+
+    static QJsonObject toJson(const DtcEntry& entry);
+    static QJsonObject toJson(const ReadinessResult& readiness);
+
+    /**
+     * @brief Converts a scan diff to a JSON object.
+     * @return {"hasBaseline", "baselineTime", "added": [...], "cleared": [...],
+     *          "changed": [...], "monitors": [...], "mil": {...}}
+     */
+    static QJsonObject toJson(const ScanDiff& diff);
+
+    /**
+     * @brief Converts the statistics of one PID to a JSON object.
+     * @return {"pid", "unit", "count", "mean", "stddev", "min", "max", "p50",
+     *          "p95", "p99", "durationMs", "histogram": {"lower", "binWidth", "counts"}};
+     *          only "pid" and "count" if it is empty
+     */
+    static QJsonObject toJson(const PidStatistics::Summary& summary);
+
+    static QString statusName(DtcStatus status);
+    static QString categoryName(DtcCategory category);
+    static QString monitorStatusName(MonitorStatus status);
+    static QJsonArray statusNames(quint8 statusFlags);
+
+private:
+    ScanResultJson() = delete;  // Static class, prevent instantiation
+};
+
+#endif // SCANRESULTJSON_H
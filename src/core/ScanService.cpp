@@ -2,8 +2,24 @@
 #include "DtcParser.h"
 #include "ReadinessParser.h"
 #include "core/dto/ScanResult.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include "core/dto/DtcEntry.h"
-#include <QDebug>
+#include <atomic>
+
+namespace {
+
+// Shared by all services so that sequences stay unique in a multi-adapter trace
+std::atomic<quint32> s_nextSequence{1};
+
+// Commands the adapter answers without going on the bus. AT Z is left out:
+// the reset takes far longer than a normal command.
+bool isAdapterLocal(const QByteArray& command)
+{
+    return command.startsWith("AT") && !command.startsWith("AT Z");
+}
+
+} // namespace
 
 ScanService::ScanService(ObdTransporter* transporter, QObject *parent)
     : QObject(parent)
@@ -12,10 +28,6 @@ ScanService::ScanService(ObdTransporter* transporter, QObject *parent)
     , m_readinessParser(new ReadinessParser(this))
     , m_state(Idle)
     , m_currentOperation(CmdConnection)
-    , m_milStatusReceived(false)
-    , m_storedDtcReceived(false)
-    , m_pendingDtcReceived(false)
-    , m_readinessReceived(false)
     , m_ecuResponded(false)
     , m_timeoutTimer(new QTimer(this))
 {
@@ -33,48 +45,71 @@ ScanService::~ScanService()
 
 void ScanService::startConnection()
 {
-    if (m_state != Idle) {
-        qDebug() << "ScanService: Cannot start connection, already busy";
+    // A poll still in flight is abandoned (and failed); the adapter is reset anyway
+    if (m_state != Idle && m_state != Polling) {
+        OBD_TRACE(Scan, ScanBusy, 0);
         return;
     }
 
-    reset();
+    // Connecting first, so a client polling again from pollFailed() is refused
     m_state = Connecting;
+    reset();
     m_currentOperation = CmdConnection;
     m_ecuResponded = false;
     m_protocolName.clear();
-
-    // Build connection sequence
-    m_commandQueue.enqueue({QByteArray("AT Z\r"), "Reset adapter", CmdConnection});
-    m_commandQueue.enqueue({QByteArray("AT E0\r"), "Echo off", CmdConnection});
-    m_commandQueue.enqueue({QByteArray("AT SP 0\r"), "Auto-detect protocol", CmdConnection});
-    m_commandQueue.enqueue({QByteArray("01 00\r"), "Ping ECU", CmdConnection});
-    m_commandQueue.enqueue({QByteArray("AT DP\r"), "Get protocol name", CmdConnection});
+    m_supportedPids.clear();
+    m_sampleClock.reset();
+    m_sampleClock.anchor();
+    OBD_TRACE(Scan, ScanConnectStart);
+
+    // Build connection sequence; the ECU ping also tells the scan planner which
+    // Mode 01 PIDs exist
+    enqueueCommand({QByteArray("AT Z\r"), "Reset adapter", CmdConnection});
+    enqueueCommand({QByteArray("AT E0\r"), "Echo off", CmdConnection});
+    enqueueCommand({QByteArray("AT SP 0\r"), "Auto-detect protocol", CmdConnection});
+    enqueueCommand({QByteArray("01 00\r"), "Ping ECU", CmdConnection, ScanPlanner::SupportedPids01});
+    enqueueCommand({QByteArray("AT DP\r"), "Get protocol name", CmdConnection});
 
     emit scanProgress("Connecting to adapter...");
     processNextCommand();
 }
 
-void ScanService::startScan()
+void ScanService::startScan(ScanPlanner::Recipe recipe)
 {
-    if (m_state != Idle) {
-        qDebug() << "ScanService: Cannot start scan, already busy";
+    if (m_state != Idle && m_state != Polling) {
+        OBD_TRACE(Scan, ScanBusy, 1);
         return;
     }
 
-    reset();
+    // The reply to a poll in flight is still handled as a poll; the scan's
+    // commands follow it
+    const bool pollInFlight = m_state == Polling;
+    if (!pollInFlight) {
+        reset();
+    }
+    anchorClock();
     m_state = Scanning;
     m_currentOperation = CmdScan;
     m_currentScanResult = ScanResult();
+    m_currentScanResult.complete = false;
 
     // Build scan sequence
-    m_commandQueue.enqueue({QByteArray("01 01\r"), "Get MIL status", CmdScan});
-    m_commandQueue.enqueue({QByteArray("03\r"), "Get stored DTCs", CmdScan});
-    m_commandQueue.enqueue({QByteArray("07\r"), "Get pending DTCs", CmdScan});
-    m_commandQueue.enqueue({QByteArray("01 01\r"), "Get readiness monitors", CmdScan});
+    m_lastPlan = planScan(recipe);
+    for (const ScanPlanner::PlannedCommand& planned : m_lastPlan.commands) {
+        enqueueCommand({planned.data, planned.description, CmdScan,
+                        planned.items, planned.gateMode, planned.gatePid});
+    }
+    OBD_TRACE(Scan, ScanPlan, quint32(recipe), quint64(m_lastPlan.commands.size()), quint64(m_lastPlan.estimatedBusTimeMs));
 
     emit scanProgress("Starting scan...");
-    processNextCommand();
+    if (!pollInFlight) {
+        processNextCommand();
+    }
+}
+
+ScanPlanner::ScanPlan ScanService::planScan(ScanPlanner::Recipe recipe) const
+{
+    return ScanPlanner::compile(recipe, m_supportedPids, m_protocolName);
 }
 
 void ScanService::cancel()
@@ -83,10 +118,8 @@ void ScanService::cancel()
         return;
     }
 
-    m_timeoutTimer->stop();
-    m_commandQueue.clear();
-    m_responseBuffer.clear();
     m_state = Idle;
+    reset();
     emit scanProgress("Cancelled");
 }
 
@@ -96,6 +129,9 @@ void ScanService::onDataReceived(const QByteArray& data)
         return; // Not expecting data
     }
 
+    if (m_responseBuffer.isEmpty()) {
+        OBD_TRACE(Lifecycle, CommandFirstByte, m_currentCommand.sequence);
+    }
     m_responseBuffer.append(data);
 
     // Check if we have a complete response (ends with '>')
@@ -105,14 +141,35 @@ void ScanService::onDataReceived(const QByteArray& data)
         QByteArray response = m_responseBuffer.left(promptIndex);
         m_responseBuffer.remove(0, promptIndex + 1);
 
-        qDebug() << "ScanService: Received response:" << response;
+        OBD_TRACE(Scan, ScanResponse, quint32(response.size()), Trace::packText(response));
+        OBD_TRACE(Lifecycle, CommandPrompt, m_currentCommand.sequence, quint64(response.size()));
+        if (m_commandTimer.isValid()) {
+            Metrics::observeCommandRtt(m_commandTimer.nsecsElapsed());
+            m_commandTimer.invalidate();
+        }
+
+        // Transports that do not stamp their data get the time it was handled
+        const qint64 sentNs = m_transporter ? m_transporter->lastSentNs() : 0;
+        const qint64 receivedNs = m_transporter && m_transporter->firstReceivedNs() != 0
+            ? m_transporter->firstReceivedNs()
+            : SampleClock::now();
+        if (isAdapterLocal(m_currentCommand.data)) {
+            m_sampleClock.addAdapterRoundTrip(sentNs, receivedNs);
+        }
+        m_replySampleNs = m_sampleClock.sampleTimeNs(sentNs, receivedNs);
 
         // Process the response
-        if (m_currentOperation == CmdConnection) {
+        OBD_TRACE(Lifecycle, CommandParseBegin, m_currentCommand.sequence);
+        if (m_currentCommand.type == CmdPoll) {
+            OBD_TRACE(Lifecycle, ResultDeliverBegin, m_currentCommand.sequence, 0);
+            emit pollResponse(m_currentCommand.data, response, m_replySampleNs);
+            OBD_TRACE(Lifecycle, ResultDeliverEnd, m_currentCommand.sequence);
+        } else if (m_currentOperation == CmdConnection) {
             handleConnectionResponse(response);
         } else if (m_currentOperation == CmdScan) {
             handleScanResponse(response);
         }
+        OBD_TRACE(Lifecycle, CommandParseEnd, m_currentCommand.sequence);
 
         // Stop timeout timer
         m_timeoutTimer->stop();
@@ -124,7 +181,17 @@ void ScanService::onDataReceived(const QByteArray& data)
 
 void ScanService::onTimeout()
 {
-    qDebug() << "ScanService: Timeout waiting for response";
+    OBD_TRACE(Scan, ScanTimeout, m_currentOperation == CmdScan ? 1 : 0);
+    Metrics::commandTimedOut(m_currentCommand.data);
+
+    if (m_currentCommand.type == CmdPoll) {
+        // A lost poll reply only costs that sample; carry on with the queue
+        const QByteArray command = m_currentCommand.data;
+        m_responseBuffer.clear();
+        emit pollFailed(command);
+        processNextCommand();
+        return;
+    }
     
     if (m_currentOperation == CmdConnection) {
         // Check if we got adapter connection but no ECU response
@@ -135,20 +202,57 @@ void ScanService::onTimeout()
             m_state = Idle;
             emit connectionFailed("Connection timeout");
         }
+        reset();
     } else if (m_currentOperation == CmdScan) {
-        // Partial scan results are acceptable
-        qDebug() << "ScanService: Scan timeout, finishing with partial results";
-        finishScan();
+        // Partial scan results are acceptable; finishScan() resets before it
+        // emits, so polls queued from scanComplete are kept
+        finishScan(true);
+    } else {
+        reset();
     }
+}
 
-    reset();
+bool ScanService::enqueuePoll(const QByteArray& command)
+{
+    if (m_state == Connecting || m_state == Error) {
+        OBD_TRACE(Scan, ScanBusy, 2);
+        return false;
+    }
+
+    anchorClock();
+    enqueueCommand({command, "Poll", CmdPoll});
+    if (m_state == Idle) {
+        m_state = Polling;
+        processNextCommand();
+    }
+    return true;
+}
+
+void ScanService::enqueueCommand(Command command)
+{
+    command.sequence = s_nextSequence.fetch_add(1, std::memory_order_relaxed);
+    OBD_TRACE(Lifecycle, CommandEnqueued, command.sequence, Trace::packText(command.data));
+    m_commandQueue.enqueue(command);
 }
 
 void ScanService::processNextCommand()
 {
+    // Drop commands the support query has since shown to be unsupported
+    while (!m_commandQueue.isEmpty()) {
+        const Command& next = m_commandQueue.head();
+        if (next.gateMode == 0 || !m_supportedPids.isKnown(next.gateMode) ||
+            m_supportedPids.isSupported(next.gateMode, next.gatePid)) {
+            break;
+        }
+        OBD_TRACE(Scan, ScanCommandSkipped, next.sequence, Trace::packText(next.data));
+        m_commandQueue.dequeue();
+    }
+
     if (m_commandQueue.isEmpty()) {
         // All commands processed
-        if (m_currentOperation == CmdConnection) {
+        if (m_state == Polling) {
+            m_state = Idle;
+        } else if (m_currentOperation == CmdConnection) {
             if (m_ecuResponded) {
                 m_state = Idle;
                 emit connectionComplete(m_protocolName.isEmpty() ? "Auto" : m_protocolName);
@@ -157,27 +261,36 @@ void ScanService::processNextCommand()
                 emit adapterConnectedNoEcu();
             }
         } else if (m_currentOperation == CmdScan) {
-            finishScan();
+            finishScan(false);
         }
         return;
     }
 
     Command cmd = m_commandQueue.dequeue();
+    m_currentCommand = cmd;
     m_responseBuffer.clear();
+    OBD_TRACE(Lifecycle, CommandDequeued, cmd.sequence);
 
     if (m_transporter && m_transporter->isConnected()) {
-        qDebug() << "ScanService: Sending" << cmd.description << ":" << cmd.data;
+        OBD_TRACE(Scan, ScanCommandSent, cmd.items, Trace::packText(cmd.data));
         m_transporter->sendCommand(cmd.data);
+        OBD_TRACE(Lifecycle, CommandWritten, cmd.sequence);
+        Metrics::increment(Metrics::CommandsSent);
+        m_commandTimer.start();
         
         // Start timeout timer
         m_timeoutTimer->start(TIMEOUT_MS);
     } else {
-        qDebug() << "ScanService: Cannot send command, not connected";
-        if (m_currentOperation == CmdConnection) {
+        OBD_TRACE(Scan, ScanNotConnected);
+        if (m_state == Polling) {
+            m_state = Idle;
+            emit pollFailed(cmd.data);
+        } else if (m_currentOperation == CmdConnection) {
             m_state = Idle;
             emit connectionFailed("Not connected to adapter");
         } else {
             m_state = Idle;
+            Metrics::increment(Metrics::ScansFailed);
             emit scanFailed("Not connected to adapter");
         }
         reset();
@@ -193,6 +306,10 @@ void ScanService::handleConnectionResponse(const QByteArray& response)
         m_ecuResponded = true;
         emit scanProgress("ECU responding");
     }
+
+    if (m_currentCommand.items & ScanPlanner::SupportedPids01) {
+        parseSupportedPidsResponse(response, 0x01);
+    }
     
     // Check for protocol name (AT DP response)
     if (clean.contains("AT DP") || clean.toUpper().contains("PROTOCOL")) {
@@ -202,33 +319,53 @@ void ScanService::handleConnectionResponse(const QByteArray& response)
 
 void ScanService::handleScanResponse(const QByteArray& response)
 {
-    QByteArray clean = response.simplified();
-    
-    // Determine which command this response is for based on response content
-    // This is a bit fragile, but we process in order
-    
-    if (clean.contains("41 01") || clean.contains("4101")) {
-        // MIL status response
-        if (!m_milStatusReceived) {
-            parseMilStatus(response);
-            m_milStatusReceived = true;
-            emit scanProgress("MIL status received");
-        }
-    } else if (clean.contains("43") && !m_storedDtcReceived) {
-        // Mode 03 response (stored DTCs)
+    // The plan tells us what this reply answers; one reply may answer several
+    // items (e.g. "01 01" carries both MIL status and readiness)
+    const quint32 items = m_currentCommand.items;
+
+    if (items & ScanPlanner::SupportedPids01) {
+        parseSupportedPidsResponse(response, 0x01);
+    }
+    if (items & ScanPlanner::SupportedPids09) {
+        parseSupportedPidsResponse(response, 0x09);
+    }
+    if (items & ScanPlanner::Vin) {
+        parseVinResponse(response);
+        emit scanProgress("VIN received");
+    }
+    if (items & ScanPlanner::MilStatus) {
+        parseMilStatus(response);
+        emit scanProgress("MIL status received");
+    }
+    if (items & ScanPlanner::Readiness) {
+        parseReadinessResponse(response);
+        emit scanProgress("Readiness monitors received");
+    }
+    if (items & ScanPlanner::StoredDtcs) {
         parseDtcResponse(response, DtcStatus::Confirmed);
-        m_storedDtcReceived = true;
         emit scanProgress("Stored DTCs received");
-    } else if (clean.contains("47") && !m_pendingDtcReceived) {
-        // Mode 07 response (pending DTCs)
+    }
+    if (items & ScanPlanner::PendingDtcs) {
         parseDtcResponse(response, DtcStatus::Pending);
-        m_pendingDtcReceived = true;
         emit scanProgress("Pending DTCs received");
-    } else if (clean.contains("41 01") && m_milStatusReceived && !m_readinessReceived) {
-        // Second 01 01 response is for readiness
-        parseReadinessResponse(response);
-        m_readinessReceived = true;
-        emit scanProgress("Readiness monitors received");
+    }
+    if (items & ScanPlanner::PermanentDtcs) {
+        parseDtcResponse(response, DtcStatus::Permanent);
+        emit scanProgress("Permanent DTCs received");
+    }
+
+    // Publish what we have now; Qt containers are implicitly shared, so the
+    // copy handed to receivers is cheap
+    const quint32 dataItems = items & ~quint32(ScanPlanner::SupportedPids01 | ScanPlanner::SupportedPids09);
+    if (dataItems != 0) {
+        // The scan is dated by its first reply
+        if (!m_currentScanResult.timestamp.isValid()) {
+            m_currentScanResult.timestamp = m_sampleClock.toDateTime(m_replySampleNs);
+        }
+        m_currentScanResult.receivedItems |= dataItems;
+        OBD_TRACE(Lifecycle, ResultDeliverBegin, m_currentCommand.sequence, dataItems);
+        emit scanUpdated(m_currentScanResult, dataItems);
+        OBD_TRACE(Lifecycle, ResultDeliverEnd, m_currentCommand.sequence);
     }
 }
 
@@ -260,7 +397,7 @@ void ScanService::parseProtocolName(const QByteArray& response)
     }
     
     if (!m_protocolName.isEmpty()) {
-        qDebug() << "ScanService: Detected protocol:" << m_protocolName;
+        OBD_TRACE(Scan, ScanProtocolDetected, 0, Trace::packText(m_protocolName));
     }
 }
 
@@ -287,7 +424,12 @@ void ScanService::parseDtcResponse(const QByteArray& response, DtcStatus status)
     QStringList dtcCodes;
     
     // Determine mode from response
-    int mode = (status == DtcStatus::Pending) ? 7 : 3;
+    int mode = 3;
+    if (status == DtcStatus::Pending) {
+        mode = 7;
+    } else if (status == DtcStatus::Permanent) {
+        mode = 0x0A;
+    }
     dtcCodes = m_dtcParser->parseDtcResponse(response, mode);
     
     // Convert to DtcEntry objects
@@ -303,21 +445,113 @@ void ScanService::parseReadinessResponse(const QByteArray& response)
     m_currentScanResult.readiness = readiness;
 }
 
-void ScanService::finishScan()
+void ScanService::parseSupportedPidsResponse(const QByteArray& response, quint8 mode)
+{
+    quint32 bitmap = 0;
+    if (ScanPlanner::parseSupportedPids(response, mode, &bitmap)) {
+        m_supportedPids.setBitmap(mode, bitmap);
+    } else if (!m_supportedPids.isKnown(mode) && response.toUpper().contains("NO DATA")) {
+        // Service not implemented at all: nothing in it is supported
+        m_supportedPids.setBitmap(mode, 0);
+    }
+}
+
+void ScanService::parseVinResponse(const QByteArray& response)
+{
+    // Mode 09 PID 02 reply. On CAN it is one multi-frame message whose lines
+    // carry a frame index ("0: 49 02 01 31 44 34"); on K-line every line is a
+    // separate "49 02 NN" message with four VIN bytes.
+    QByteArray payload;
+    const QList<QByteArray> lines = response.split('\r');
+    for (QByteArray line : lines) {
+        line = line.simplified();
+        const int colon = line.indexOf(':');
+        if (colon >= 0) {
+            line = line.mid(colon + 1);
+        }
+        line.replace(">", "");
+        line.replace(" ", "");
+        if (line.size() < 4 || line.size() % 2 != 0) {
+            continue; // Empty, or the CAN byte count line ("014")
+        }
+
+        const QByteArray bytes = QByteArray::fromHex(line);
+        if (bytes.size() >= 3 && quint8(bytes.at(0)) == 0x49 && bytes.at(1) == 0x02) {
+            payload.append(bytes.mid(3));
+        } else {
+            payload.append(bytes);
+        }
+    }
+
+    // Keep VIN characters only (drops K-line zero padding; I, O and Q are never used)
+    QString vin;
+    for (char c : payload) {
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z' && c != 'I' && c != 'O' && c != 'Q')) {
+            vin.append(QLatin1Char(c));
+        }
+    }
+
+    if (vin.size() >= 17) {
+        m_currentScanResult.vin = vin.right(17);
+    } else {
+        OBD_TRACE(Scan, ScanVinUnreadable, quint32(response.size()));
+    }
+}
+
+void ScanService::finishScan(bool timedOut)
 {
     m_state = Idle;
-    m_currentScanResult.timestamp = QDateTime::currentDateTime();
-    emit scanComplete(m_currentScanResult);
+    ScanResult result = m_currentScanResult;
+    if (!result.timestamp.isValid()) {
+        result.timestamp = m_sampleClock.toDateTime(SampleClock::now());
+    }
+    result.complete = true;
+    result.timedOut = timedOut;
+    // Counted from the flag the result carries, so the metric and the
+    // delivered result cannot disagree
+    Metrics::increment(timedOut ? Metrics::ScansFailed : Metrics::ScansCompleted);
+    OBD_TRACE(Scan, ScanComplete, quint32(result.dtcs.size()), result.receivedItems);
+
+    // Reset before emitting: a receiver may queue a poll or start the next
+    // scan, and a reset after the signal would drop it
+    const quint32 sequence = m_currentCommand.sequence;
     reset();
+    OBD_TRACE(Lifecycle, ResultDeliverBegin, sequence, result.receivedItems);
+    emit scanComplete(result);
+    OBD_TRACE(Lifecycle, ResultDeliverEnd, sequence);
 }
 
 void ScanService::reset()
 {
+    // Polls dropped here are failed, or their clients would wait for a reply
+    // that never comes. The current command is only in flight while its
+    // timeout runs.
+    QVector<QByteArray> droppedPolls;
+    if (m_currentCommand.type == CmdPoll && m_timeoutTimer->isActive()) {
+        droppedPolls.append(m_currentCommand.data);
+    }
+    for (const Command& command : std::as_const(m_commandQueue)) {
+        if (command.type == CmdPoll) {
+            droppedPolls.append(command.data);
+        }
+    }
+
+    m_timeoutTimer->stop();
     m_commandQueue.clear();
     m_responseBuffer.clear();
-    m_milStatusReceived = false;
-    m_storedDtcReceived = false;
-    m_pendingDtcReceived = false;
-    m_readinessReceived = false;
+    m_currentCommand = Command();
+    m_commandTimer.invalidate();
     m_currentScanResult = ScanResult();
+
+    for (const QByteArray& command : droppedPolls) {
+        emit pollFailed(command);
+    }
+}
+
+void ScanService::anchorClock()
+{
+    // Scans and polls on a service that never ran the connection sequence
+    if (!m_sampleClock.isAnchored()) {
+        m_sampleClock.anchor();
+    }
 }
@@ -4,9 +4,13 @@
 #include <QObject>
 #include <QQueue>
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QTimer>
 #include "core/dto/ScanResult.h"
 #include "core/dto/DtcEntry.h"
+#include "core/dto/SupportedPids.h"
+#include "core/ScanPlanner.h"
+#include "core/SampleClock.h"
 #include "hardware/ObdTransporter.h"
 
 class DtcParser;
@@ -25,6 +29,7 @@ public:
         Idle,
         Connecting,
         Scanning,
+        Polling,    // Only single poll requests (see enqueuePoll()) are in flight
         Error
     };
 
@@ -38,9 +43,41 @@ public:
 
     /**
      * @brief Start a diagnostic scan.
+     * @param recipe What to read; compiled by ScanPlanner into the commands sent.
      * @pre Must be connected to ECU (ConnectedEcu state).
      */
-    void startScan();
+    void startScan(ScanPlanner::Recipe recipe = ScanPlanner::Quick);
+
+    /**
+     * @brief Returns the plan startScan() would run for a recipe, including its
+     * estimated bus time, based on what the connection sequence learned.
+     */
+    ScanPlanner::ScanPlan planScan(ScanPlanner::Recipe recipe) const;
+
+    /**
+     * @brief The plan the last startScan() queued.
+     */
+    const ScanPlanner::ScanPlan& lastPlan() const { return m_lastPlan; }
+
+    /**
+     * @brief PIDs the connected vehicle reported as supported.
+     */
+    const SupportedPids& supportedPids() const { return m_supportedPids; }
+
+    /**
+     * @brief Clock of the current session: anchored when the connection
+     * sequence starts and calibrated on its AT commands.
+     */
+    const SampleClock& sampleClock() const { return m_sampleClock; }
+
+    /**
+     * @brief Queues one request that is not part of a scan, e.g. a monitoring poll.
+     * Sent at once when idle, otherwise after the commands a running scan has
+     * already queued. The reply arrives through pollResponse(). A scan started
+     * while a poll is in flight waits for its reply.
+     * @return false while the connection sequence runs.
+     */
+    bool enqueuePoll(const QByteArray& command);
 
     /**
      * @brief Cancel current operation (connection or scan).
@@ -57,6 +94,11 @@ public:
      */
     bool isConnecting() const { return m_state == Connecting; }
 
+    /**
+     * @brief Check if only poll requests are in flight.
+     */
+    bool isPolling() const { return m_state == Polling; }
+
 signals:
     /**
      * @brief Emitted when connection sequence completes successfully.
@@ -76,8 +118,18 @@ signals:
     void adapterConnectedNoEcu();
 
     /**
-     * @brief Emitted when scan completes successfully.
-     * @param result The scan results.
+     * @brief Emitted after each scan reply that added data, so results can be
+     * shown before the slowest command returns.
+     * @param partial Everything read so far (partial.complete is false).
+     * @param changedItems ScanPlanner::Item flags this reply filled in.
+     */
+    void scanUpdated(const ScanResult& partial, quint32 changedItems);
+
+    /**
+     * @brief Emitted when a scan ends, whether every command was answered or
+     * one timed out.
+     * @param result The scan results; result.timedOut marks a scan that was
+     * cut short and holds only what was read before the timeout.
      */
     void scanComplete(const ScanResult& result);
 
@@ -93,6 +145,20 @@ signals:
      */
     void scanProgress(const QString& message);
 
+    /**
+     * @brief Emitted with the reply to a request queued by enqueuePoll().
+     * @param command The request as queued.
+     * @param sampleTimeNs When the ECU answered, in SampleClock::now() time;
+     * sampleClock().toWallMs() gives the wall-clock time.
+     */
+    void pollResponse(const QByteArray& command, const QByteArray& response, qint64 sampleTimeNs);
+
+    /**
+     * @brief Emitted when a poll request timed out, could not be sent or was
+     * dropped with the queue (cancel(), a failed scan, startConnection()).
+     */
+    void pollFailed(const QByteArray& command);
+
 private slots:
     void onDataReceived(const QByteArray& data);
     void onTimeout();
@@ -100,15 +166,21 @@ private slots:
 private:
     enum CommandType {
         CmdConnection,
-        CmdScan
+        CmdScan,
+        CmdPoll
     };
 
     struct Command {
         QByteArray data;
         QString description;
-        CommandType type;
+        CommandType type = CmdConnection;
+        quint32 items = 0;      // ScanPlanner::Item flags answered by the reply
+        quint8 gateMode = 0;    // Skipped if this PID turns out to be unsupported
+        quint8 gatePid = 0;
+        quint32 sequence = 0;   // Process-wide number tying the command's Lifecycle trace events together
     };
 
+    void enqueueCommand(Command command);
     void processNextCommand();
     void handleConnectionResponse(const QByteArray& response);
     void handleScanResponse(const QByteArray& response);
@@ -116,30 +188,35 @@ private:
     void parseMilStatus(const QByteArray& response);
     void parseDtcResponse(const QByteArray& response, DtcStatus status);
     void parseReadinessResponse(const QByteArray& response);
-    void finishScan();
+    void parseSupportedPidsResponse(const QByteArray& response, quint8 mode);
+    void parseVinResponse(const QByteArray& response);
+    void finishScan(bool timedOut);
     void reset();
+    void anchorClock();
 
     ObdTransporter* m_transporter;
     DtcParser* m_dtcParser;
     ReadinessParser* m_readinessParser;
     
     QQueue<Command> m_commandQueue;
+    Command m_currentCommand;
     QByteArray m_responseBuffer;
     ScanState m_state;
     CommandType m_currentOperation;
     
     // Scan state
     ScanResult m_currentScanResult;
-    bool m_milStatusReceived;
-    bool m_storedDtcReceived;
-    bool m_pendingDtcReceived;
-    bool m_readinessReceived;
+    ScanPlanner::ScanPlan m_lastPlan;
     
     // Connection state
     QString m_protocolName;
     bool m_ecuResponded;
+    SupportedPids m_supportedPids;
+    SampleClock m_sampleClock;
+    qint64 m_replySampleNs = 0;     // Sample time of the reply being handled
     
     QTimer* m_timeoutTimer;
+    QElapsedTimer m_commandTimer;   // Started when the current command is written
     static const int TIMEOUT_MS = 5000; // 5 second timeout
 };
 
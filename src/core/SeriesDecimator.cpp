@@ -0,0 +1,267 @@
+#include "SeriesDecimator.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+SeriesDecimator::SeriesDecimator(Mode mode, int targetBuckets)
+    : m_mode(mode)
+    , m_targetBuckets(qMax(2, targetBuckets))
+{
+}
+
+void SeriesDecimator::setMode(Mode mode)
+{
+    if (m_mode != mode) {
+        m_mode = mode;
+        reset();
+    }
+}
+
+void SeriesDecimator::setTargetBuckets(int targetBuckets)
+{
+    targetBuckets = qMax(2, targetBuckets);
+    if (m_targetBuckets != targetBuckets) {
+        m_targetBuckets = targetBuckets;
+        reset();
+    }
+}
+
+void SeriesDecimator::reset()
+{
+    m_bucketWidth = 1;
+    m_sourceCount = 0;
+    m_buckets.clear();
+    m_points.clear();
+    m_pointsDirty = false;
+}
+
+void SeriesDecimator::update(const PidSeries& series)
+{
+    update(series.times.constData(), series.values.constData(), qMin(series.times.size(), series.values.size()));
+}
+
+void SeriesDecimator::update(const double* times, const double* values, int count)
+{
+    if (count < m_sourceCount) {
+        reset();
+    }
+    if (count == m_sourceCount) {
+        return;
+    }
+
+    if (m_sourceCount == 0) {
+        m_first = QPointF(times[0], values[0]);
+    }
+
+    // The bucket receiving the first new sample and its predecessor need a new
+    // LTTB selection; everything before them is final.
+    int firstChanged = m_buckets.isEmpty() ? 0 : m_buckets.size() - 1;
+
+    int index = m_sourceCount;
+    while (index < count) {
+        if (m_buckets.isEmpty() || (m_buckets.last().end - m_buckets.last().begin) >= m_bucketWidth) {
+            if (m_buckets.size() >= m_targetBuckets) {
+                mergePairs();
+                firstChanged = 0;
+                continue; // The last bucket may have room again
+            }
+            Bucket bucket;
+            bucket.begin = index;
+            bucket.end = index;
+            m_buckets.append(bucket);
+        }
+
+        Bucket& bucket = m_buckets.last();
+        int take = qMin(m_bucketWidth - (bucket.end - bucket.begin), count - index);
+        accumulate(bucket, times + index, values + index, take);
+        bucket.end += take;
+        index += take;
+    }
+
+    m_sourceCount = count;
+    m_last = QPointF(times[count - 1], values[count - 1]);
+
+    if (m_mode == Lttb) {
+        selectLttb(times, values, qMax(0, firstChanged - 1));
+    }
+    m_pointsDirty = true;
+}
+
+const QVector<QPointF>& SeriesDecimator::points() const
+{
+    if (m_pointsDirty) {
+        rebuildPoints();
+        m_pointsDirty = false;
+    }
+    return m_points;
+}
+
+QVector<QPointF> SeriesDecimator::decimateMinMax(const double* times, const double* values, int count, int buckets)
+{
+    SeriesDecimator decimator(MinMaxEnvelope, buckets);
+    decimator.update(times, values, count);
+    return decimator.points();
+}
+
+QVector<QPointF> SeriesDecimator::decimateLttb(const double* times, const double* values, int count, int buckets)
+{
+    SeriesDecimator decimator(Lttb, buckets);
+    decimator.update(times, values, count);
+    return decimator.points();
+}
+
+void SeriesDecimator::accumulate(Bucket& bucket, const double* times, const double* values, int count) const
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // Reduction pass: one loop over the contiguous columns with no index
+    // bookkeeping; indexes are only looked up when an extreme moves.
+    double lo = values[0];
+    double hi = values[0];
+    double sumTime = 0.0;
+    double sumValue = 0.0;
+    for (int i = 0; i < count; ++i) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+        sumTime += times[i];
+        sumValue += values[i];
+    }
+
+    const bool empty = bucket.end == bucket.begin;
+    const int base = bucket.end;
+
+    // Locate pass: only runs when the batch actually moves an extreme.
+    if (empty || lo < bucket.minValue) {
+        const int offset = int(std::find(values, values + count, lo) - values);
+        bucket.minIndex = base + offset;
+        bucket.minTime = times[offset];
+        bucket.minValue = lo;
+    }
+    if (empty || hi > bucket.maxValue) {
+        const int offset = int(std::find(values, values + count, hi) - values);
+        bucket.maxIndex = base + offset;
+        bucket.maxTime = times[offset];
+        bucket.maxValue = hi;
+    }
+
+    bucket.sumTime += sumTime;
+    bucket.sumValue += sumValue;
+}
+
+void SeriesDecimator::mergePairs()
+{
+    const int count = m_buckets.size();
+    int out = 0;
+    for (int i = 0; i < count; i += 2, ++out) {
+        Bucket merged = m_buckets[i];
+        if (i + 1 < count) {
+            const Bucket& next = m_buckets[i + 1];
+            merged.end = next.end;
+            if (next.minValue < merged.minValue) {
+                merged.minIndex = next.minIndex;
+                merged.minTime = next.minTime;
+                merged.minValue = next.minValue;
+            }
+            if (next.maxValue > merged.maxValue) {
+                merged.maxIndex = next.maxIndex;
+                merged.maxTime = next.maxTime;
+                merged.maxValue = next.maxValue;
+            }
+            merged.sumTime += next.sumTime;
+            merged.sumValue += next.sumValue;
+        }
+        m_buckets[out] = merged;
+    }
+    m_buckets.resize(out);
+    m_bucketWidth *= 2;
+}
+
+void SeriesDecimator::selectLttb(const double* times, const double* values, int firstBucket)
+{
+    const int bucketCount = m_buckets.size();
+    for (int b = firstBucket; b < bucketCount; ++b) {
+        Bucket& bucket = m_buckets[b];
+
+        // Point A: the previously selected point (or the first sample)
+        double ax = m_first.x();
+        double ay = m_first.y();
+        if (b > 0) {
+            const int prev = m_buckets[b - 1].selected;
+            ax = times[prev];
+            ay = values[prev];
+        }
+
+        // Point C: average of the next bucket (or the last sample)
+        double cx = m_last.x();
+        double cy = m_last.y();
+        if (b + 1 < bucketCount) {
+            const Bucket& next = m_buckets[b + 1];
+            const double n = double(next.end - next.begin);
+            cx = next.sumTime / n;
+            cy = next.sumValue / n;
+        }
+
+        // Pick the sample in this bucket that forms the largest triangle with A and C.
+        // Twice the area is |(ax - cx) * (y - ay) - (ax - x) * (cy - ay)|.
+        const double dx = ax - cx;
+        const double dy = cy - ay;
+        double bestArea = -1.0;
+        int best = bucket.begin;
+        for (int i = bucket.begin; i < bucket.end; ++i) {
+            const double area = std::fabs(dx * (values[i] - ay) - (ax - times[i]) * dy);
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+        bucket.selected = best;
+        bucket.selectedTime = times[best];
+        bucket.selectedValue = values[best];
+    }
+}
+
+void SeriesDecimator::rebuildPoints() const
+{
+    m_points.clear();
+    if (m_sourceCount == 0) {
+        return;
+    }
+
+    // The raw columns are not retained; buckets carry the coordinates of the
+    // samples they selected.
+    m_points.reserve(m_mode == MinMaxEnvelope ? m_buckets.size() * 2 + 2 : m_buckets.size() + 2);
+    m_points.append(m_first);
+
+    if (m_mode == MinMaxEnvelope) {
+        for (const Bucket& bucket : m_buckets) {
+            if (bucket.minIndex <= bucket.maxIndex) {
+                appendPoint(bucket.minIndex, bucket.minTime, bucket.minValue);
+                if (bucket.maxIndex != bucket.minIndex) {
+                    appendPoint(bucket.maxIndex, bucket.maxTime, bucket.maxValue);
+                }
+            } else {
+                appendPoint(bucket.maxIndex, bucket.maxTime, bucket.maxValue);
+                appendPoint(bucket.minIndex, bucket.minTime, bucket.minValue);
+            }
+        }
+    } else {
+        for (const Bucket& bucket : m_buckets) {
+            appendPoint(bucket.selected, bucket.selectedTime, bucket.selectedValue);
+        }
+    }
+
+    if (m_sourceCount > 1) {
+        m_points.append(m_last);
+    }
+}
+
+void SeriesDecimator::appendPoint(int index, double time, double value) const
+{
+    // First and last samples are emitted explicitly
+    if (index == 0 || index == m_sourceCount - 1) {
+        return;
+    }
+    m_points.append(QPointF(time, value));
+}
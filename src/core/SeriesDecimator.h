@@ -0,0 +1,120 @@
+#ifndef SERIESDECIMATOR_H
+#define SERIESDECIMATOR_H
+
+#include <QVector>
+#include <QPointF>
+#include "core/dto/PidSeries.h"
+
+/**
+ * @brief The SeriesDecimator class
+ * Reduces a long PID series to roughly one point per horizontal pixel for plotting.
+ *
+ * Samples are grouped into buckets of a fixed sample count. When the number of
+ * buckets exceeds the target, neighbouring buckets are merged and the bucket width
+ * doubles, so appending samples costs amortised O(1) per sample and the output
+ * size stays bounded no matter how long the session runs.
+ *
+ * Two reduction modes are supported:
+ * - MinMaxEnvelope: emits the minimum and maximum of every bucket (keeps spikes).
+ * - Lttb: Largest-Triangle-Three-Buckets, emits one point per bucket (keeps shape).
+ */
+class SeriesDecimator
+{
+public:
+    enum Mode {
+        MinMaxEnvelope,
+        Lttb
+    };
+
+    explicit SeriesDecimator(Mode mode = MinMaxEnvelope, int targetBuckets = 1000);
+
+    /**
+     * @brief Sets the reduction mode. Clears all consumed samples.
+     */
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+    /**
+     * @brief Sets the maximum number of buckets (usually the plot width in pixels).
+     * Clears all consumed samples.
+     */
+    void setTargetBuckets(int targetBuckets);
+    int targetBuckets() const { return m_targetBuckets; }
+
+    /**
+     * @brief Forgets all consumed samples.
+     */
+    void reset();
+
+    /**
+     * @brief Consumes samples appended to the series since the previous call.
+     * The series may only grow between calls; if it shrinks the decimator resets.
+     * @param series Columnar series to read from.
+     */
+    void update(const PidSeries& series);
+
+    /**
+     * @brief Consumes samples appended to the columns since the previous call.
+     * @param times Pointer to the full time column (ascending).
+     * @param values Pointer to the full value column.
+     * @param count Total number of samples in the columns.
+     */
+    void update(const double* times, const double* values, int count);
+
+    /**
+     * @brief Returns the decimated points (x = time, y = value) in time order.
+     */
+    const QVector<QPointF>& points() const;
+
+    int sourceCount() const { return m_sourceCount; }
+    int bucketCount() const { return m_buckets.size(); }
+    int samplesPerBucket() const { return m_bucketWidth; }
+
+    /**
+     * @brief One-shot min/max envelope of a whole series.
+     */
+    static QVector<QPointF> decimateMinMax(const double* times, const double* values, int count, int buckets);
+
+    /**
+     * @brief One-shot LTTB reduction of a whole series.
+     */
+    static QVector<QPointF> decimateLttb(const double* times, const double* values, int count, int buckets);
+
+private:
+    struct Bucket {
+        int begin = 0;          // First sample index
+        int end = 0;            // One past the last sample index
+        int minIndex = 0;
+        double minTime = 0.0;
+        double minValue = 0.0;
+        int maxIndex = 0;
+        double maxTime = 0.0;
+        double maxValue = 0.0;
+        double sumTime = 0.0;   // For the LTTB bucket average
+        double sumValue = 0.0;
+        int selected = 0;       // LTTB selected sample index
+        double selectedTime = 0.0;
+        double selectedValue = 0.0;
+    };
+
+    void accumulate(Bucket& bucket, const double* times, const double* values, int count) const;
+    void mergePairs();
+    void selectLttb(const double* times, const double* values, int firstBucket);
+    void rebuildPoints() const;
+    void appendPoint(int index, double time, double value) const;
+
+    Mode m_mode;
+    int m_targetBuckets;
+    int m_bucketWidth = 1;
+    int m_sourceCount = 0;
+    QVector<Bucket> m_buckets;
+
+    // First and last consumed samples (always part of the output)
+    QPointF m_first;
+    QPointF m_last;
+
+    mutable QVector<QPointF> m_points;
+    mutable bool m_pointsDirty = false;
+};
+
+#endif // SERIESDECIMATOR_H
@@ -0,0 +1,136 @@
+#include "StartupProfiler.h"
+#include "Trace.h"
+#include <QStringList>
+
+namespace {
+
+struct ProfilerState {
+    bool started = false;
+    qint64 startNs = 0;
+    qint64 lastMarkNs = 0;
+    qint64 firstPaintNs = -1;
+    qint64 interactiveNs = -1;
+    QVector<StartupProfiler::Phase> phases;
+};
+
+ProfilerState& profilerState()
+{
+    static ProfilerState state;
+    return state;
+}
+
+// Closes the phase that began at the last mark; false once the start is over
+bool closePhase(const QString& name, qint64 timeNs)
+{
+    ProfilerState& state = profilerState();
+    if (!state.started) {
+        StartupProfiler::start(timeNs);
+    }
+    if (state.interactiveNs >= 0) {
+        return false;
+    }
+
+    StartupProfiler::Phase phase;
+    phase.name = name;
+    phase.startNs = state.lastMarkNs - state.startNs;
+    phase.durationNs = qMax(qint64(0), timeNs - state.lastMarkNs);
+    state.phases.append(phase);
+    state.lastMarkNs = qMax(state.lastMarkNs, timeNs);
+    return true;
+}
+
+QString milliseconds(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 1) + " ms";
+}
+
+} // namespace
+
+void StartupProfiler::start()
+{
+    start(Trace::now());
+}
+
+void StartupProfiler::start(qint64 timeNs)
+{
+    ProfilerState& state = profilerState();
+    state = ProfilerState();
+    state.started = true;
+    state.startNs = timeNs;
+    state.lastMarkNs = timeNs;
+}
+
+void StartupProfiler::mark(const QString& phase)
+{
+    mark(phase, Trace::now());
+}
+
+void StartupProfiler::mark(const QString& phase, qint64 timeNs)
+{
+    closePhase(phase, timeNs);
+}
+
+void StartupProfiler::markFirstPaint()
+{
+    markFirstPaint(Trace::now());
+}
+
+void StartupProfiler::markFirstPaint(qint64 timeNs)
+{
+    ProfilerState& state = profilerState();
+    if (state.firstPaintNs >= 0) {
+        return;
+    }
+    if (closePhase("first paint", timeNs)) {
+        state.firstPaintNs = state.lastMarkNs - state.startNs;
+    }
+}
+
+void StartupProfiler::markInteractive()
+{
+    markInteractive(Trace::now());
+}
+
+void StartupProfiler::markInteractive(qint64 timeNs)
+{
+    ProfilerState& state = profilerState();
+    if (closePhase("interactive", timeNs)) {
+        state.interactiveNs = state.lastMarkNs - state.startNs;
+    }
+}
+
+QVector<StartupProfiler::Phase> StartupProfiler::phases()
+{
+    return profilerState().phases;
+}
+
+qint64 StartupProfiler::firstPaintNs()
+{
+    return profilerState().firstPaintNs;
+}
+
+qint64 StartupProfiler::interactiveNs()
+{
+    return profilerState().interactiveNs;
+}
+
+QString StartupProfiler::report()
+{
+    const ProfilerState& state = profilerState();
+
+    QStringList lines;
+    if (state.interactiveNs < 0) {
+        lines.append("Startup: not interactive yet");
+    } else {
+        QString summary = QString("Startup: interactive after %1").arg(milliseconds(state.interactiveNs));
+        if (state.firstPaintNs >= 0) {
+            summary += QString(", first paint after %1").arg(milliseconds(state.firstPaintNs));
+        }
+        summary += QString(" (budget %1 ms%2)").arg(BUDGET_MS).arg(isOverBudget() ? ", exceeded" : "");
+        lines.append(summary);
+    }
+    for (const Phase& phase : state.phases) {
+        lines.append(QString("  %1 %2").arg(phase.name, -24).arg(milliseconds(phase.durationNs), 10));
+    }
+    return lines.join('\n');
+}
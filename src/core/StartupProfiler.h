@@ -0,0 +1,65 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The StartupProfiler class
+ * Times application startup, phase by phase, up to the first paint of the
+ * main window and up to the point the event loop is idle (interactive).
+ *
+ * start() is called first thing in main(); every mark() ends the phase that
+ * began at the previous mark. markFirstPaint() and markInteractive() close the
+ * last two phases and only count the first time. Marks after interactive are
+ * ignored, so the report always describes the cold start.
+ *
+ * Times are Trace::now() nanoseconds. GUI thread only.
+ */
+class StartupProfiler
+{
+public:
+    StartupProfiler() = delete;  // Static class, prevent instantiation
+
+    struct Phase {
+        QString name;
+        qint64 startNs = 0;         // Since start()
+        qint64 durationNs = 0;
+    };
+
+    static constexpr int BUDGET_MS = 300;       // Cold start to interactive on a shop PC
+
+    /**
+     * @brief Starts timing and forgets earlier phases.
+     */
+    static void start();
+    static void start(qint64 timeNs);
+
+    /**
+     * @brief Ends @p phase, which began at the previous mark (or at start()).
+     */
+    static void mark(const QString& phase);
+    static void mark(const QString& phase, qint64 timeNs);
+
+    static void markFirstPaint();
+    static void markFirstPaint(qint64 timeNs);
+    static void markInteractive();
+    static void markInteractive(qint64 timeNs);
+
+    static QVector<Phase> phases();
+
+    /**
+     * @brief Time from start() to the first paint or to interactive, -1 if not reached yet.
+     */
+    static qint64 firstPaintNs();
+    static qint64 interactiveNs();
+    static bool isInteractive() { return interactiveNs() >= 0; }
+    static bool isOverBudget() { return interactiveNs() > qint64(BUDGET_MS) * 1000000; }
+
+    /**
+     * @brief One line per phase, then the totals against BUDGET_MS.
+     */
+    static QString report();
+};
+
+#endif // STARTUPPROFILER_H
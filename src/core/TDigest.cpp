@@ -0,0 +1,186 @@
+#include "TDigest.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TDigest::TDigest(double compression)
+    : m_compression(qMax(10.0, compression))
+    , m_bufferLimit(qMax(16, int(5 * m_compression)))
+{
+}
+
+void TDigest::add(double value, double weight)
+{
+    if (!std::isfinite(value) || !(weight > 0.0)) {
+        return;
+    }
+
+    if (isEmpty()) {
+        m_min = value;
+        m_max = value;
+    } else {
+        m_min = qMin(m_min, value);
+        m_max = qMax(m_max, value);
+    }
+    m_count += weight;
+    m_buffer.append({value, weight});
+    if (m_buffer.size() >= m_bufferLimit) {
+        compress();
+    }
+}
+
+void TDigest::merge(const TDigest& other)
+{
+    if (other.isEmpty()) {
+        return;
+    }
+
+    const bool wasEmpty = isEmpty();
+    for (const Centroid& centroid : other.m_centroids) {
+        add(centroid.mean, centroid.weight);
+    }
+    for (const Centroid& centroid : other.m_buffer) {
+        add(centroid.mean, centroid.weight);
+    }
+
+    // Centroid means lie inside the range; keep the exact extremes
+    m_min = wasEmpty ? other.m_min : qMin(m_min, other.m_min);
+    m_max = wasEmpty ? other.m_max : qMax(m_max, other.m_max);
+}
+
+void TDigest::compress()
+{
+    if (m_buffer.isEmpty()) {
+        return;
+    }
+
+    QVector<Centroid> all;
+    all.reserve(m_centroids.size() + m_buffer.size());
+    all += m_centroids;
+    all += m_buffer;
+    m_buffer.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid& a, const Centroid& b) {
+        return a.mean < b.mean;
+    });
+
+    // A centroid may hold at most 4 * n * q * (1 - q) / compression values,
+    // so centroids shrink towards the tails where quantiles need detail
+    m_centroids.clear();
+    double before = 0.0;
+    Centroid current = all.first();
+    for (int i = 1; i < all.size(); ++i) {
+        const Centroid& next = all[i];
+        const double proposed = current.weight + next.weight;
+        const double q0 = before / m_count;
+        const double q2 = (before + proposed) / m_count;
+        const double limit = 4.0 * m_count * qMin(q0 * (1.0 - q0), q2 * (1.0 - q2)) / m_compression;
+        if (proposed <= limit) {
+            current.mean += (next.mean - current.mean) * next.weight / proposed;
+            current.weight = proposed;
+        } else {
+            before += current.weight;
+            m_centroids.append(current);
+            current = next;
+        }
+    }
+    m_centroids.append(current);
+}
+
+double TDigest::quantile(double q) const
+{
+    if (isEmpty() || std::isnan(q)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (m_buffer.isEmpty()) {
+        return quantileCompressed(q);
+    }
+    TDigest compressed = *this;
+    compressed.compress();
+    return compressed.quantileCompressed(q);
+}
+
+double TDigest::cdf(double value) const
+{
+    if (isEmpty() || std::isnan(value)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (m_buffer.isEmpty()) {
+        return cdfCompressed(value);
+    }
+    TDigest compressed = *this;
+    compressed.compress();
+    return compressed.cdfCompressed(value);
+}
+
+void TDigest::clear()
+{
+    m_centroids.clear();
+    m_buffer.clear();
+    m_count = 0.0;
+    m_min = 0.0;
+    m_max = 0.0;
+}
+
+double TDigest::quantileCompressed(double q) const
+{
+    if (q <= 0.0) {
+        return m_min;
+    }
+    if (q >= 1.0 || m_centroids.size() == 1) {
+        return q >= 1.0 ? m_max : m_centroids.first().mean;
+    }
+
+    // Each centroid's weight is spread evenly around its mean; interpolate
+    // between neighbouring centres, and between the outer centres and min/max
+    const double index = q * m_count;
+    const Centroid& first = m_centroids.first();
+    if (index < first.weight / 2.0) {
+        return m_min + (first.mean - m_min) * index / (first.weight / 2.0);
+    }
+
+    double before = first.weight / 2.0;
+    for (int i = 0; i + 1 < m_centroids.size(); ++i) {
+        const Centroid& left = m_centroids[i];
+        const Centroid& right = m_centroids[i + 1];
+        const double step = (left.weight + right.weight) / 2.0;
+        if (before + step > index) {
+            return left.mean + (right.mean - left.mean) * (index - before) / step;
+        }
+        before += step;
+    }
+
+    const Centroid& last = m_centroids.last();
+    return last.mean + (m_max - last.mean) * qMin(1.0, (index - before) / (last.weight / 2.0));
+}
+
+double TDigest::cdfCompressed(double value) const
+{
+    if (value < m_min) {
+        return 0.0;
+    }
+    if (value >= m_max) {
+        return 1.0;
+    }
+    if (m_centroids.size() == 1) {
+        return (value - m_min) / (m_max - m_min);
+    }
+
+    const Centroid& first = m_centroids.first();
+    if (value < first.mean) {
+        return first.weight / 2.0 * (value - m_min) / (first.mean - m_min) / m_count;
+    }
+
+    double before = first.weight / 2.0;
+    for (int i = 0; i + 1 < m_centroids.size(); ++i) {
+        const Centroid& left = m_centroids[i];
+        const Centroid& right = m_centroids[i + 1];
+        const double step = (left.weight + right.weight) / 2.0;
+        if (value < right.mean) {
+            return (before + step * (value - left.mean) / (right.mean - left.mean)) / m_count;
+        }
+        before += step;
+    }
+
+    const Centroid& last = m_centroids.last();
+    return (before + last.weight / 2.0 * (value - last.mean) / (m_max - last.mean)) / m_count;
+}
@@ -0,0 +1,76 @@
+#ifndef TDIGEST_H
+#define TDIGEST_H
+
+#include <QVector>
+
+/**
+ * @brief The TDigest class
+ * Merging t-digest (Dunning): an approximation of a distribution that answers
+ * quantile queries from a small number of weighted centroids.
+ *
+ * Centroids near the median are large and centroids near the tails are small,
+ * so p1 and p99 stay accurate to a fraction of a percent. The size bound
+ * (4 n q (1 - q) / compression) lets the centroid count grow with the
+ * compression times roughly log n: about 750 for a million values at the
+ * default compression. New values go into a buffer that is merged into the
+ * centroids when it fills up, which makes add() amortised O(1). Digests merge, so a window can be assembled
+ * from digests of its parts.
+ */
+class TDigest
+{
+public:
+    static constexpr double DEFAULT_COMPRESSION = 100.0;
+
+    explicit TDigest(double compression = DEFAULT_COMPRESSION);
+
+    void add(double value, double weight = 1.0);
+
+    /**
+     * @brief Adds every value @p other has seen.
+     */
+    void merge(const TDigest& other);
+
+    /**
+     * @brief Merges buffered values into the centroids.
+     */
+    void compress();
+
+    /**
+     * @brief Estimated value at quantile @p q (0..1); NaN if empty.
+     * q = 0 and q = 1 return the exact minimum and maximum.
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Estimated fraction of values <= @p value.
+     */
+    double cdf(double value) const;
+
+    void clear();
+
+    double count() const { return m_count; }
+    bool isEmpty() const { return m_count <= 0.0; }
+    double min() const { return m_min; }
+    double max() const { return m_max; }
+    double compression() const { return m_compression; }
+    int centroidCount() const { return m_centroids.size() + m_buffer.size(); }   // Grows ~log n
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double quantileCompressed(double q) const;
+    double cdfCompressed(double value) const;
+
+    double m_compression;
+    QVector<Centroid> m_centroids;      // Sorted by mean
+    QVector<Centroid> m_buffer;         // Not merged yet
+    int m_bufferLimit;
+    double m_count = 0.0;
+    double m_min = 0.0;
+    double m_max = 0.0;
+};
+
+#endif // TDIGEST_H
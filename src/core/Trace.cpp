@@ -0,0 +1,357 @@
+#include "Trace.h"
+#include "MonotonicClock.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// One thread's events. Only the owning thread writes; readers copy a range and
+// then drop whatever the writer may have overwritten meanwhile.
+struct ThreadRing {
+    std::atomic<quint64> head{0};       // Total events written
+    std::atomic<quint64> floor{0};      // Events before this index were cleared
+    std::atomic<bool> finished{false};  // Owning thread has exited
+    quint32 thread = 0;
+    QString threadName;
+    TraceEvent events[Trace::RING_SIZE];
+};
+
+static_assert((Trace::RING_SIZE & (Trace::RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+
+struct Registry {
+    QMutex mutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    quint32 nextThread = 1;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+std::atomic<bool> g_enabled{true};
+std::atomic<quint8> g_categories{Trace::Scan | Trace::Transport};
+
+// Marks the ring as finished when its thread exits; the events stay readable
+struct RingOwner {
+    std::shared_ptr<ThreadRing> ring;
+
+    ~RingOwner() {
+        if (ring) {
+            ring->finished.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local RingOwner t_owner;
+thread_local ThreadRing* t_ring = nullptr;
+
+ThreadRing* attachThread()
+{
+    auto ring = std::make_shared<ThreadRing>();
+    if (QThread* thread = QThread::currentThread()) {
+        ring->threadName = thread->objectName();
+    }
+
+    Registry& reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        ring->thread = reg.nextThread++;
+        reg.rings.push_back(ring);
+    }
+
+    t_owner.ring = ring;
+    t_ring = ring.get();
+    return t_ring;
+}
+
+} // namespace
+
+void Trace::setEnabled(bool enabled)
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Trace::isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::setCategoriesEnabled(quint8 categories)
+{
+    g_categories.store(categories, std::memory_order_relaxed);
+}
+
+quint8 Trace::enabledCategories()
+{
+    return g_categories.load(std::memory_order_relaxed);
+}
+
+qint64 Trace::now()
+{
+    return MonotonicClock::now();
+}
+
+void Trace::record(EventId id, Category category, quint32 arg0, quint64 arg1, quint64 arg2)
+{
+    if (!g_enabled.load(std::memory_order_relaxed) ||
+        !(g_categories.load(std::memory_order_relaxed) & category)) {
+        return;
+    }
+
+    ThreadRing* ring = t_ring ? t_ring : attachThread();
+    const quint64 index = ring->head.load(std::memory_order_relaxed);
+
+    TraceEvent& event = ring->events[index & (RING_SIZE - 1)];
+    event.timestampNs = now();
+    event.id = id;
+    event.category = category;
+    event.arg0 = arg0;
+    event.arg1 = arg1;
+    event.arg2 = arg2;
+
+    // Publish after the record is complete
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+quint64 Trace::packText(const QByteArray& data)
+{
+    quint64 packed = 0;
+    std::memcpy(&packed, data.constData(), size_t(qMin<qsizetype>(data.size(), sizeof(packed))));
+    return packed;
+}
+
+quint64 Trace::packText(const QString& text)
+{
+    return packText(text.left(8).toLatin1());
+}
+
+QByteArray Trace::unpackText(quint64 packed)
+{
+    char bytes[sizeof(packed)];
+    std::memcpy(bytes, &packed, sizeof(packed));
+    int length = 0;
+    while (length < int(sizeof(packed)) && bytes[length] != '\0') {
+        ++length;
+    }
+    return QByteArray(bytes, length);
+}
+
+QVector<Trace::ThreadEvent> Trace::snapshot()
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        Registry& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        rings = reg.rings;
+    }
+
+    QVector<ThreadEvent> events;
+    for (const auto& ring : rings) {
+        const quint64 head = ring->head.load(std::memory_order_acquire);
+        const quint64 floor = ring->floor.load(std::memory_order_relaxed);
+        quint64 first = head > quint64(RING_SIZE) ? head - RING_SIZE : 0;
+        first = qMax(first, floor);
+
+        QVector<TraceEvent> copied;
+        copied.reserve(int(head - first));
+        for (quint64 i = first; i < head; ++i) {
+            copied.append(ring->events[i & (RING_SIZE - 1)]);
+        }
+
+        // Anything the writer reached while we were copying may be torn,
+        // including the slot of event headAfter, which it may be writing now
+        const quint64 headAfter = ring->head.load(std::memory_order_acquire);
+        const quint64 overwritten = headAfter + 1 > quint64(RING_SIZE) ? headAfter + 1 - RING_SIZE : 0;
+        const int skip = overwritten > first ? int(qMin(overwritten - first, quint64(copied.size()))) : 0;
+
+        for (int i = skip; i < copied.size(); ++i) {
+            ThreadEvent entry;
+            entry.event = copied.at(i);
+            entry.thread = ring->thread;
+            entry.threadName = ring->threadName;
+            events.append(entry);
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const ThreadEvent& a, const ThreadEvent& b) {
+        return a.event.timestampNs < b.event.timestampNs;
+    });
+    return events;
+}
+
+void Trace::clear()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    std::vector<std::shared_ptr<ThreadRing>> live;
+    for (const auto& ring : reg.rings) {
+        if (!ring->finished.load(std::memory_order_acquire)) {
+            ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+            live.push_back(ring);
+        }
+    }
+    reg.rings.swap(live);
+}
+
+const char* Trace::eventName(quint16 id)
+{
+    switch (id) {
+    case ScanBusy:              return "scan.busy";
+    case ScanConnectStart:      return "scan.connect_start";
+    case ScanPlan:              return "scan.plan";
+    case ScanCommandSent:       return "scan.command_sent";
+    case ScanResponse:          return "scan.response";
+    case ScanCommandSkipped:    return "scan.command_skipped";
+    case ScanTimeout:           return "scan.timeout";
+    case ScanNotConnected:      return "scan.not_connected";
+    case ScanProtocolDetected:  return "scan.protocol_detected";
+    case ScanVinUnreadable:     return "scan.vin_unreadable";
+    case ScanComplete:          return "scan.complete";
+    case TransportConnecting:   return "transport.connecting";
+    case TransportConnected:    return "transport.connected";
+    case TransportDisconnected: return "transport.disconnected";
+    case TransportError:        return "transport.error";
+    case TransportSend:         return "transport.send";
+    case TransportReceive:      return "transport.receive";
+    case CommandEnqueued:       return "command.enqueued";
+    case CommandDequeued:       return "command.dequeued";
+    case CommandWritten:        return "command.written";
+    case CommandFirstByte:      return "command.first_byte";
+    case CommandPrompt:         return "command.prompt";
+    case CommandParseBegin:     return "command.parse_begin";
+    case CommandParseEnd:       return "command.parse_end";
+    case ResultDeliverBegin:    return "result.deliver_begin";
+    case ResultDeliverEnd:      return "result.deliver_end";
+    case ViewUpdateBegin:       return "view.update_begin";
+    case ViewUpdateEnd:         return "view.update_end";
+    }
+    return "unknown";
+}
+
+const char* Trace::categoryName(quint8 category)
+{
+    switch (category) {
+    case Scan:      return "scan";
+    case Transport: return "transport";
+    case Lifecycle: return "lifecycle";
+    }
+    return "unknown";
+}
+
+QString Trace::describe(const TraceEvent& e)
+{
+    // Control characters such as the trailing '\r' are shown escaped
+    auto text = [](quint64 packed) {
+        QString shown;
+        for (char c : unpackText(packed)) {
+            if (c == '\r') {
+                shown += "\\r";
+            } else if (c == '\n') {
+                shown += "\\n";
+            } else if (quint8(c) < 0x20 || quint8(c) > 0x7E) {
+                shown += QString("\\x%1").arg(quint8(c), 2, 16, QChar('0'));
+            } else {
+                shown += QLatin1Char(c);
+            }
+        }
+        return shown;
+    };
+
+    QString details;
+    switch (e.id) {
+    case ScanBusy:
+        details = e.arg0 == 2 ? "poll rejected" : e.arg0 ? "scan rejected" : "connect rejected";
+        break;
+    case ScanPlan:
+        details = QString("recipe=%1 commands=%2 estimatedMs=%3").arg(e.arg0).arg(e.arg1).arg(e.arg2);
+        break;
+    case ScanCommandSent:
+        details = QString("%1 items=0x%2").arg(text(e.arg1)).arg(e.arg0, 0, 16);
+        break;
+    case ScanResponse:
+    case TransportSend:
+    case TransportReceive:
+        details = QString("%1 bytes: %2%3").arg(e.arg0).arg(text(e.arg1)).arg(e.arg0 > 8 ? "..." : "");
+        break;
+    case ScanCommandSkipped:
+        details = QString("#%1 %2").arg(e.arg0).arg(text(e.arg1));
+        break;
+    case ScanProtocolDetected:
+        details = text(e.arg1);
+        break;
+    case ScanTimeout:
+        details = e.arg0 ? "during scan" : "during connection";
+        break;
+    case ScanVinUnreadable:
+        details = QString("%1 bytes").arg(e.arg0);
+        break;
+    case ScanComplete:
+        details = QString("dtcs=%1 items=0x%2").arg(e.arg0).arg(e.arg1, 0, 16);
+        break;
+    case TransportConnecting:
+        details = e.arg0 ? QString("%1:%2").arg(text(e.arg1)).arg(e.arg0) : text(e.arg1);
+        break;
+    case TransportError:
+        details = QString("code=%1").arg(e.arg0);
+        break;
+    case CommandEnqueued:
+        details = QString("#%1 %2").arg(e.arg0).arg(text(e.arg1));
+        break;
+    case CommandPrompt:
+        details = QString("#%1 %2 bytes").arg(e.arg0).arg(e.arg1);
+        break;
+    case ResultDeliverBegin:
+        details = QString("#%1 items=0x%2").arg(e.arg0).arg(e.arg1, 0, 16);
+        break;
+    case CommandDequeued:
+    case CommandWritten:
+    case CommandFirstByte:
+    case CommandParseBegin:
+    case CommandParseEnd:
+    case ResultDeliverEnd:
+        details = QString("#%1").arg(e.arg0);
+        break;
+    case ViewUpdateBegin:
+    case ViewUpdateEnd:
+        details = QString("%1 version=%2").arg(text(e.arg1)).arg(e.arg0);
+        break;
+    default:
+        break;
+    }
+    if (e.category == Transport && e.arg2 != 0) {
+        details = QString("(%1) %2").arg(QLatin1Char(char(e.arg2))).arg(details);
+    }
+
+    return details;
+}
+
+QString Trace::format(const ThreadEvent& entry, qint64 origin)
+{
+    return QString("+%1 ms [T%2] %3 %4")
+        .arg((entry.event.timestampNs - origin) / 1e6, 0, 'f', 3)
+        .arg(entry.thread)
+        .arg(eventName(entry.event.id))
+        .arg(describe(entry.event))
+        .trimmed();
+}
+
+QStringList Trace::formatAll()
+{
+    const QVector<ThreadEvent> events = snapshot();
+    QStringList lines;
+    lines.reserve(events.size());
+    const qint64 origin = events.isEmpty() ? 0 : events.first().event.timestampNs;
+    for (const ThreadEvent& event : events) {
+        lines.append(format(event, origin));
+    }
+    return lines;
+}
@@ -0,0 +1,177 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Categories compiled into the build. Events of a category that is not in this
+// mask compile to nothing, e.g. -DOBD_TRACE_CATEGORIES=0x01 keeps scan events only.
+#ifndef OBD_TRACE_CATEGORIES
+#define OBD_TRACE_CATEGORIES 0xFFu
+#endif
+
+/**
+ * @brief One fixed-size trace record.
+ * Arguments are raw numbers (or up to 8 bytes of text, see Trace::packText());
+ * they are only turned into text when the trace is dumped.
+ */
+struct TraceEvent {
+    qint64 timestampNs = 0;     // Trace::now() when recorded
+    quint16 id = 0;             // Trace::EventId
+    quint8 category = 0;        // Trace::Category
+    quint8 reserved = 0;
+    quint32 arg0 = 0;
+    quint64 arg1 = 0;
+    quint64 arg2 = 0;
+};
+
+static_assert(sizeof(TraceEvent) == 32, "TraceEvent must stay one half cache line");
+
+/**
+ * @brief The Trace class
+ * Always-on structured tracing for the scan pipeline and transporters.
+ *
+ * Every thread records into its own ring buffer of RING_SIZE events, so
+ * recording takes no lock and never allocates after the thread's first event:
+ * it stores a timestamp and three integers and bumps an index. Old events are
+ * overwritten. snapshot() and formatAll() collect the rings of all threads,
+ * and only they format anything.
+ *
+ * Use the OBD_TRACE macro rather than record(), so that categories outside
+ * OBD_TRACE_CATEGORIES are removed at compile time.
+ */
+class Trace
+{
+public:
+    enum Category : quint8 {
+        Scan      = 0x01,   // ScanService commands, replies and state changes
+        Transport = 0x02,   // Adapter connections, errors and raw traffic
+        Lifecycle = 0x04    // Per-command phase timestamps for timeline export (off by default)
+    };
+
+    enum EventId : quint16 {
+        // Scan (arg0, arg1, arg2)
+        ScanBusy = 1,           // Operation rejected: 0 = connect, 1 = scan, 2 = poll
+        ScanConnectStart,       // -
+        ScanPlan,               // Recipe, command count, estimated bus time (ms)
+        ScanCommandSent,        // ScanPlanner items, command text
+        ScanResponse,           // Reply length, reply text (first 8 bytes)
+        ScanCommandSkipped,     // Command sequence, command text
+        ScanTimeout,            // 0 = during connection, 1 = during scan
+        ScanNotConnected,       // -
+        ScanProtocolDetected,   // -, protocol name (first 8 bytes)
+        ScanVinUnreadable,      // Reply length
+        ScanComplete,           // DTC count, received items
+
+        // Transport (arg2 is always the transport: 'S'erial, 'T'cp)
+        TransportConnecting = 100,  // TCP port, address (first 8 bytes)
+        TransportConnected,         // -
+        TransportDisconnected,      // -
+        TransportError,             // Qt error code
+        TransportSend,              // Length, data (first 8 bytes)
+        TransportReceive,           // Length, data (first 8 bytes)
+
+        // Lifecycle (arg0 is always the command sequence number from ScanService)
+        CommandEnqueued = 200,      // Sequence, command text
+        CommandDequeued,            // Sequence
+        CommandWritten,             // Sequence
+        CommandFirstByte,           // Sequence
+        CommandPrompt,              // Sequence, reply length
+        CommandParseBegin,          // Sequence
+        CommandParseEnd,            // Sequence
+        ResultDeliverBegin,         // Sequence, ScanPlanner items delivered
+        ResultDeliverEnd,           // Sequence
+        ViewUpdateBegin,            // Snapshot version, view name (first 8 bytes)
+        ViewUpdateEnd               // Snapshot version, view name (first 8 bytes)
+    };
+
+    /**
+     * @brief An event together with the thread that recorded it.
+     */
+    struct ThreadEvent {
+        TraceEvent event;
+        quint32 thread = 0;     // Small per-process thread number, starting at 1
+        QString threadName;     // QThread object name at the thread's first event (may be empty)
+    };
+
+    static constexpr int RING_SIZE = 4096;     // Events kept per thread; a power of two
+
+    static constexpr bool compiledIn(quint8 category) {
+        return (OBD_TRACE_CATEGORIES & category) != 0;
+    }
+
+    /**
+     * @brief Turns recording on or off at runtime (on by default).
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * @brief Selects the categories recorded at runtime (default: Scan | Transport).
+     * Categories that are not compiled in stay off regardless.
+     */
+    static void setCategoriesEnabled(quint8 categories);
+    static quint8 enabledCategories();
+
+    /**
+     * @brief Records one event on the calling thread's ring.
+     */
+    static void record(EventId id, Category category, quint32 arg0 = 0, quint64 arg1 = 0, quint64 arg2 = 0);
+
+    /**
+     * @brief Monotonic nanoseconds used for event timestamps.
+     */
+    static qint64 now();
+
+    /**
+     * @brief Packs up to the first 8 bytes of @p data into an argument.
+     */
+    static quint64 packText(const QByteArray& data);
+    static quint64 packText(const QString& text);
+    static QByteArray unpackText(quint64 packed);
+
+    /**
+     * @brief Events still held by all rings, oldest first.
+     * A full ring yields RING_SIZE - 1 events: the slot its writer fills next
+     * may be torn and is skipped.
+     */
+    static QVector<ThreadEvent> snapshot();
+
+    /**
+     * @brief Drops every recorded event and the rings of finished threads.
+     */
+    static void clear();
+
+    static const char* eventName(quint16 id);
+    static const char* categoryName(quint8 category);
+
+    /**
+     * @brief The event's arguments as text, e.g. "01 00\r items=0x1".
+     */
+    static QString describe(const TraceEvent& event);
+
+    /**
+     * @brief One line per event: "+12.345 ms [T1] scan.command_sent 01 00\r items=0x1".
+     * @param origin Timestamp shown as zero; defaults to the first event.
+     */
+    static QString format(const ThreadEvent& event, qint64 origin);
+    static QStringList formatAll();
+
+private:
+    Trace() = delete;  // Static class, prevent instantiation
+};
+
+/**
+ * @brief Records a trace event if its category is compiled in.
+ * Usage: OBD_TRACE(Scan, ScanCommandSent, items, Trace::packText(data));
+ */
+#define OBD_TRACE(category, id, ...) \
+    do { \
+        if constexpr (Trace::compiledIn(Trace::category)) { \
+            Trace::record(Trace::id, Trace::category, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#endif // TRACE_H
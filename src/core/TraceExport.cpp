@@ -0,0 +1,203 @@
+#include "TraceExport.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSet>
+
+namespace {
+
+const int PROCESS_ID = 1;
+
+// Timestamps of one command's phases; -1 where the event was not recorded
+struct CommandPhases {
+    QString text;
+    quint32 thread = 0;
+    qint64 enqueued = -1;
+    qint64 dequeued = -1;
+    qint64 written = -1;
+    qint64 firstByte = -1;
+    qint64 prompt = -1;
+    qint64 parseBegin = -1;
+    qint64 parseEnd = -1;
+    qint64 deliverBegin = -1;
+    qint64 deliverEnd = -1;
+    qint64 skipped = -1;
+    qint64 last = -1;
+};
+
+QString commandText(quint64 packed)
+{
+    return QString::fromLatin1(Trace::unpackText(packed)).trimmed();
+}
+
+QJsonObject traceEvent(const char* phase, const QString& name, const QString& category,
+                       double ts, quint32 thread)
+{
+    QJsonObject json;
+    json["ph"] = QString::fromLatin1(phase);
+    json["name"] = name;
+    json["cat"] = category;
+    json["ts"] = ts;
+    json["pid"] = PROCESS_ID;
+    json["tid"] = qint64(thread);
+    return json;
+}
+
+} // namespace
+
+QByteArray TraceExport::toChromeJson(const QVector<Trace::ThreadEvent>& events)
+{
+    QJsonArray traceEvents;
+    const qint64 origin = events.isEmpty() ? 0 : events.first().event.timestampNs;
+    auto micros = [origin](qint64 timestampNs) {
+        return double(timestampNs - origin) / 1000.0;
+    };
+
+    QJsonObject process = traceEvent("M", "process_name", "__metadata", 0, 0);
+    process["args"] = QJsonObject{{"name", "OBDRead"}};
+    traceEvents.append(process);
+
+    QSet<quint32> namedThreads;
+    QMap<quint32, CommandPhases> commands;     // Ordered by sequence for stable output
+
+    for (const Trace::ThreadEvent& entry : events) {
+        const TraceEvent& e = entry.event;
+        const double ts = micros(e.timestampNs);
+
+        if (!namedThreads.contains(entry.thread)) {
+            namedThreads.insert(entry.thread);
+            QJsonObject thread = traceEvent("M", "thread_name", "__metadata", 0, entry.thread);
+            const QString name = entry.threadName.isEmpty() ? QString("thread %1").arg(entry.thread)
+                                                            : entry.threadName;
+            thread["args"] = QJsonObject{{"name", name}};
+            traceEvents.append(thread);
+        }
+
+        if (e.category != Trace::Lifecycle) {
+            QJsonObject instant = traceEvent("i", Trace::eventName(e.id), Trace::categoryName(e.category),
+                                             ts, entry.thread);
+            instant["s"] = QString("t");
+            const QString detail = Trace::describe(e);
+            if (!detail.isEmpty()) {
+                instant["args"] = QJsonObject{{"detail", detail}};
+            }
+            traceEvents.append(instant);
+
+            if (e.id == Trace::ScanCommandSkipped && e.arg0 != 0) {
+                CommandPhases& command = commands[e.arg0];
+                command.skipped = e.timestampNs;
+                command.last = qMax(command.last, e.timestampNs);
+            }
+            continue;
+        }
+
+        // Work done on a thread is also a slice on that thread's track
+        switch (e.id) {
+        case Trace::CommandParseBegin:
+        case Trace::CommandParseEnd:
+            traceEvents.append(traceEvent(e.id == Trace::CommandParseBegin ? "B" : "E",
+                                          "parse", "lifecycle", ts, entry.thread));
+            break;
+        case Trace::ResultDeliverBegin:
+        case Trace::ResultDeliverEnd:
+            traceEvents.append(traceEvent(e.id == Trace::ResultDeliverBegin ? "B" : "E",
+                                          "deliver", "lifecycle", ts, entry.thread));
+            break;
+        case Trace::ViewUpdateBegin:
+        case Trace::ViewUpdateEnd: {
+            QJsonObject slice = traceEvent(e.id == Trace::ViewUpdateBegin ? "B" : "E",
+                                           QString("update %1").arg(commandText(e.arg1)),
+                                           "lifecycle", ts, entry.thread);
+            if (e.id == Trace::ViewUpdateBegin) {
+                slice["args"] = QJsonObject{{"version", qint64(e.arg0)}};
+            }
+            traceEvents.append(slice);
+            continue;   // arg0 is a snapshot version, not a command
+        }
+        default:
+            break;
+        }
+
+        CommandPhases& command = commands[e.arg0];
+        command.last = qMax(command.last, e.timestampNs);
+        switch (e.id) {
+        case Trace::CommandEnqueued:
+            command.text = commandText(e.arg1);
+            command.thread = entry.thread;
+            command.enqueued = e.timestampNs;
+            break;
+        case Trace::CommandDequeued:    command.dequeued = e.timestampNs; break;
+        case Trace::CommandWritten:     command.written = e.timestampNs; break;
+        case Trace::CommandFirstByte:   command.firstByte = e.timestampNs; break;
+        case Trace::CommandPrompt:      command.prompt = e.timestampNs; break;
+        case Trace::CommandParseBegin:  command.parseBegin = e.timestampNs; break;
+        case Trace::CommandParseEnd:    command.parseEnd = e.timestampNs; break;
+        case Trace::ResultDeliverBegin: command.deliverBegin = e.timestampNs; break;
+        case Trace::ResultDeliverEnd:   command.deliverEnd = e.timestampNs; break;
+        default: break;
+        }
+    }
+
+    // One async track per command; nested slices must close before their parent
+    for (auto it = commands.constBegin(); it != commands.constEnd(); ++it) {
+        const CommandPhases& command = it.value();
+        if (command.enqueued < 0) {
+            continue;   // Enqueued before the ring's oldest event
+        }
+
+        auto span = [&](const QString& name, qint64 begin, qint64 end) {
+            if (begin < 0 || end < begin) {
+                return;
+            }
+            QJsonObject b = traceEvent("b", name, "command", micros(begin), command.thread);
+            b["id"] = qint64(it.key());
+            QJsonObject e = traceEvent("e", name, "command", micros(end), command.thread);
+            e["id"] = qint64(it.key());
+            traceEvents.append(b);
+            traceEvents.append(e);
+        };
+
+        const QString name = command.text.isEmpty() ? QString("#%1").arg(it.key()) : command.text;
+        QJsonObject args{{"sequence", qint64(it.key())}};
+        if (command.skipped >= 0) {
+            args["skipped"] = true;
+        }
+
+        QJsonObject b = traceEvent("b", name, "command", micros(command.enqueued), command.thread);
+        b["id"] = qint64(it.key());
+        b["args"] = args;
+        traceEvents.append(b);
+
+        span("queued", command.enqueued, command.dequeued >= 0 ? command.dequeued : command.skipped);
+        span("write", command.dequeued, command.written);
+        span("wait", command.written, command.firstByte);
+        span("receive", command.firstByte, command.prompt);
+        span("parse", command.parseBegin, command.parseEnd);
+        span("deliver", command.deliverBegin, command.deliverEnd);
+
+        QJsonObject e = traceEvent("e", name, "command", micros(command.last), command.thread);
+        e["id"] = qint64(it.key());
+        traceEvents.append(e);
+    }
+
+    QJsonObject document;
+    document["displayTimeUnit"] = QString("ms");
+    document["traceEvents"] = traceEvents;
+    return QJsonDocument(document).toJson(QJsonDocument::Compact);
+}
+
+bool TraceExport::writeChromeJson(const QString& path, QString* error)
+{
+    const QByteArray json = toChromeJson(Trace::snapshot());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
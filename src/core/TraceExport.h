@@ -0,0 +1,40 @@
+#ifndef TRACEEXPORT_H
+#define TRACEEXPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "Trace.h"
+
+/**
+ * @brief The TraceExport class
+ * Writes recorded trace events as Chrome trace-event JSON, which both
+ * chrome://tracing and the Perfetto UI (ui.perfetto.dev) open directly.
+ *
+ * Lifecycle events become one async track per command, named after the
+ * command text, with nested "queued", "write", "wait", "receive", "parse" and
+ * "deliver" slices. Parse, delivery and view updates also appear as slices on
+ * the thread that ran them, so a slow slot shows up under its command. All
+ * other events are instant markers carrying Trace::describe() as an argument.
+ */
+class TraceExport
+{
+public:
+    /**
+     * @brief Converts events (oldest first, as from Trace::snapshot()) to a
+     * {"traceEvents": [...]} document. Timestamps are microseconds from the
+     * first event.
+     */
+    static QByteArray toChromeJson(const QVector<Trace::ThreadEvent>& events);
+
+    /**
+     * @brief Writes the current Trace::snapshot() to @p path.
+     * @return false with @p error set if the file cannot be written.
+     */
+    static bool writeChromeJson(const QString& path, QString* error = nullptr);
+
+private:
+    TraceExport() = delete;  // Static class, prevent instantiation
+};
+
+#endif // TRACEEXPORT_H
@@ -0,0 +1,329 @@
+#include "TriggerEngine.h"
+#include "CaptureWriter.h"
+#include "SampleClock.h"
+#include <QDir>
+
+namespace {
+
+int roundUpToPowerOfTwo(int value)
+{
+    int result = 1;
+    while (result < value && result < (1 << 30)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+constexpr int MAX_PIDS = 0xFFFF;
+
+} // namespace
+
+TriggerEngine::TriggerEngine(int capacity, QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<TriggerEngine::Capture>();
+
+    m_capacity = roundUpToPowerOfTwo(qMax(2, capacity));
+    m_ring.resize(qMin(m_capacity, int(INITIAL_CAPACITY)));
+    m_mask = quint64(m_ring.size() - 1);
+
+    // One writer keeps files in trigger order
+    m_writerPool.setMaxThreadCount(1);
+}
+
+TriggerEngine::~TriggerEngine()
+{
+    m_writerPool.waitForDone();
+}
+
+bool TriggerEngine::addRule(const Rule& rule, QString* error)
+{
+    auto reject = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (rule.conditions.isEmpty()) {
+        return reject("Rule has no conditions");
+    }
+    if (rule.conditions.size() > MAX_CONDITIONS) {
+        return reject(QString("Rule has more than %1 conditions").arg(MAX_CONDITIONS));
+    }
+    QVector<int> pidSlots;
+    for (const Condition& condition : rule.conditions) {
+        if (condition.type == DtcAppeared) {
+            pidSlots.append(-1);
+            continue;
+        }
+        if (condition.pidId.isEmpty()) {
+            return reject("Condition has no PID");
+        }
+        const int slot = slotFor(condition.pidId);
+        if (slot < 0) {
+            return reject("Too many PIDs");
+        }
+        pidSlots.append(slot);
+    }
+
+    const int ruleIndex = m_rules.size();
+    RuleState state;
+    state.rule = rule;
+    for (int i = 0; i < rule.conditions.size(); ++i) {
+        state.allMask |= 1u << i;
+        if (pidSlots[i] < 0) {
+            m_dtcConditions.append({ruleIndex, i});
+        } else {
+            m_conditionsByPid[pidSlots[i]].append({ruleIndex, i});
+        }
+    }
+    m_rules.append(state);
+
+    if (error) {
+        error->clear();
+    }
+    return true;
+}
+
+void TriggerEngine::clearRules()
+{
+    m_rules.clear();
+    for (QVector<ConditionRef>& conditions : m_conditionsByPid) {
+        conditions.clear();
+    }
+    m_dtcConditions.clear();
+}
+
+void TriggerEngine::ingest(const PidSample& sample)
+{
+    const int slot = slotFor(sample.pidId);
+    if (slot < 0) {
+        return;
+    }
+
+    const qint64 timeNs = SampleClock::timeOf(sample);
+    makeRoom(timeNs);
+    CapturedSample& entry = m_ring[int(m_head & m_mask)];
+    entry.timeNs = timeNs;
+    entry.value = sample.value;
+    entry.pid = quint16(slot);
+    ++m_head;
+
+    // Only the conditions on this PID can change
+    PidState& state = m_pidStates[slot];
+    const QVector<ConditionRef>& conditions = m_conditionsByPid[slot];
+    if (!conditions.isEmpty()) {
+        const qint64 wallMs = sample.timestamp.isValid() ? sample.timestamp.toMSecsSinceEpoch() : 0;
+        for (const ConditionRef& ref : conditions) {
+            RuleState& rule = m_rules[ref.rule];
+            const bool holds = conditionHolds(rule.rule.conditions[ref.condition], state, sample.value, timeNs);
+            updateRule(rule, ref.condition, holds, timeNs, wallMs);
+        }
+    }
+    state.value = sample.value;
+    state.timeNs = timeNs;
+    state.seen = true;
+
+    if (m_capturing && timeNs - m_triggerTimeNs >= m_postTriggerNs) {
+        finishCapture();
+    }
+}
+
+void TriggerEngine::ingestDtcs(const QVector<DtcEntry>& dtcs, qint64 timeNs, qint64 wallMs)
+{
+    for (const DtcEntry& dtc : dtcs) {
+        if (m_knownDtcs.contains(dtc.code)) {
+            continue;
+        }
+        m_knownDtcs.insert(dtc.code);
+
+        // An appearance is an event: the condition holds for this instant only
+        for (const ConditionRef& ref : m_dtcConditions) {
+            RuleState& rule = m_rules[ref.rule];
+            const QString& code = rule.rule.conditions[ref.condition].dtcCode;
+            if (!code.isEmpty() && code.compare(dtc.code, Qt::CaseInsensitive) != 0) {
+                continue;
+            }
+            updateRule(rule, ref.condition, true, timeNs, wallMs);
+            updateRule(rule, ref.condition, false, timeNs, wallMs);
+        }
+    }
+
+    if (m_capturing && timeNs - m_triggerTimeNs >= m_postTriggerNs) {
+        finishCapture();
+    }
+}
+
+void TriggerEngine::finishCapture()
+{
+    if (!m_capturing) {
+        return;
+    }
+    m_capturing = false;
+
+    // Walk back from the trigger to the start of the pre-trigger window, as
+    // far as the ring still holds
+    const quint64 oldest = m_tail;
+    quint64 start = qMax(m_triggerHead, oldest);
+    const qint64 windowStartNs = m_triggerTimeNs - m_preTriggerNs;
+    while (start > oldest && m_ring[int((start - 1) & m_mask)].timeNs >= windowStartNs) {
+        --start;
+    }
+
+    Capture capture;
+    capture.ruleName = m_captureRule;
+    capture.triggerTimeNs = m_triggerTimeNs;
+    capture.triggerWallMs = m_triggerWallMs;
+    capture.preTriggerNs = m_preTriggerNs;
+    capture.postTriggerNs = m_postTriggerNs;
+    capture.pids = m_pidNames;
+    capture.truncated = m_droppedNs != 0 && m_droppedNs >= windowStartNs;
+    capture.suppressedTriggers = m_suppressedTriggers;
+    capture.samples.reserve(int(m_head - start));
+    for (quint64 i = start; i < m_head; ++i) {
+        capture.samples.append(m_ring[int(i & m_mask)]);
+    }
+
+    emit captureComplete(capture);
+    if (!m_captureDirectory.isEmpty()) {
+        writeCapture(capture);
+    }
+}
+
+void TriggerEngine::reset()
+{
+    finishCapture();
+    m_head = 0;
+    m_tail = 0;
+    m_droppedNs = 0;
+    for (PidState& state : m_pidStates) {
+        state = PidState();
+    }
+    for (RuleState& rule : m_rules) {
+        rule.trueMask = 0;
+        rule.active = false;
+    }
+    m_knownDtcs.clear();
+}
+
+void TriggerEngine::waitForWrites()
+{
+    m_writerPool.waitForDone();
+}
+
+int TriggerEngine::slotFor(const QString& pidId)
+{
+    const auto it = m_pidSlots.constFind(pidId);
+    if (it != m_pidSlots.constEnd()) {
+        return it.value();
+    }
+    if (m_pidNames.size() >= MAX_PIDS) {
+        return -1;
+    }
+
+    const int slot = m_pidNames.size();
+    m_pidSlots.insert(pidId, quint16(slot));
+    m_pidNames.append(pidId);
+    m_pidStates.append(PidState());
+    m_conditionsByPid.append(QVector<ConditionRef>());
+    return slot;
+}
+
+bool TriggerEngine::conditionHolds(const Condition& condition, const PidState& previous, double value, qint64 timeNs) const
+{
+    switch (condition.type) {
+    case Above:
+        return value > condition.threshold;
+    case Below:
+        return value < condition.threshold;
+    case InsideWindow:
+        return value >= condition.threshold && value <= condition.upper;
+    case OutsideWindow:
+        return value < condition.threshold || value > condition.upper;
+    case RisingFaster:
+    case FallingFaster: {
+        if (!previous.seen || timeNs <= previous.timeNs) {
+            return false;
+        }
+        const double rate = (value - previous.value) / ((timeNs - previous.timeNs) / 1e9);
+        return condition.type == RisingFaster ? rate > condition.threshold : rate < -condition.threshold;
+    }
+    case DtcAppeared:
+        break;
+    }
+    return false;
+}
+
+void TriggerEngine::updateRule(RuleState& state, int condition, bool holds, qint64 timeNs, qint64 wallMs)
+{
+    const quint32 bit = 1u << condition;
+    state.trueMask = holds ? (state.trueMask | bit) : (state.trueMask & ~bit);
+
+    // Fires on the transition to true, like an edge trigger
+    const bool active = state.rule.combine == All ? state.trueMask == state.allMask : state.trueMask != 0;
+    if (active && !state.active) {
+        fire(state.rule.name, timeNs, wallMs);
+    }
+    state.active = active;
+}
+
+void TriggerEngine::fire(const QString& ruleName, qint64 timeNs, qint64 wallMs)
+{
+    emit triggered(ruleName, timeNs);
+
+    if (m_capturing) {
+        ++m_suppressedTriggers;
+        return;
+    }
+    m_capturing = true;
+    m_captureRule = ruleName;
+    m_triggerTimeNs = timeNs;
+    m_triggerWallMs = wallMs;
+    m_triggerHead = m_head;
+    m_suppressedTriggers = 0;
+}
+
+void TriggerEngine::makeRoom(qint64 timeNs)
+{
+    // Drop what is older than any window still wanted: the pre-trigger time
+    // before this sample, or the window of the capture in progress
+    const qint64 horizonNs = (m_capturing ? m_triggerTimeNs : timeNs) - m_preTriggerNs;
+    while (m_tail < m_head && m_ring[int(m_tail & m_mask)].timeNs < horizonNs) {
+        ++m_tail;
+    }
+    if (m_head - m_tail < quint64(m_ring.size())) {
+        return;
+    }
+
+    // Full with samples still inside the window: grow, or past capacity()
+    // give up the oldest
+    if (m_ring.size() < m_capacity) {
+        QVector<CapturedSample> grown(m_ring.size() * 2);
+        const quint64 grownMask = quint64(grown.size() - 1);
+        for (quint64 i = m_tail; i < m_head; ++i) {
+            grown[int(i & grownMask)] = m_ring[int(i & m_mask)];
+        }
+        m_ring.swap(grown);
+        m_mask = grownMask;
+        return;
+    }
+    m_droppedNs = qMax(m_droppedNs, m_ring[int(m_tail & m_mask)].timeNs);
+    ++m_tail;
+}
+
+void TriggerEngine::writeCapture(const Capture& capture)
+{
+    const QString path = QDir(m_captureDirectory).filePath(CaptureWriter::fileName(capture));
+    m_writerPool.start([this, capture, path]() {
+        QString error;
+        const bool ok = CaptureWriter::write(capture, path, &error);
+        QMetaObject::invokeMethod(this, [this, ok, path, error]() {
+            if (ok) {
+                emit captureWritten(path);
+            } else {
+                emit captureWriteFailed(error);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,229 @@
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include "core/dto/DtcEntry.h"
+#include "core/dto/PidSample.h"
+
+/**
+ * @brief The TriggerEngine class
+ * Oscilloscope-style capture of intermittent faults from streamed PIDs.
+ *
+ * Every sample goes into a ring that holds the pre-trigger time of all
+ * streamed PIDs, trimmed by sample time (SampleClock::timeOf()), not by
+ * count: entries older than the pre-trigger window are dropped as new ones
+ * arrive, and while a capture records, everything since the start of its
+ * window is kept. The ring grows to fit the window at the stream's rate, up
+ * to capacity() entries, which bounds memory; a window that needs more is
+ * truncated. Rules combine conditions (threshold, window, rate of change, DTC
+ * appearance) with AND or OR. A sample only re-evaluates the conditions on
+ * its own PID, against their last state, so the cost per sample is constant.
+ *
+ * When a rule becomes true, the engine keeps recording for the post-trigger
+ * time, then copies the pre- and post-trigger samples out of the ring into a
+ * Capture. If a capture directory is set, the Capture is written there as CSV
+ * (see CaptureWriter) on a background thread. Triggers during a capture are
+ * counted, not captured.
+ *
+ * ingest() takes no lock and allocates nothing, except the first time a PID
+ * is seen, while the ring grows to fit the window and when a capture
+ * completes. Configure rules before streaming starts and feed samples from
+ * one thread at a time.
+ */
+class TriggerEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ConditionType : quint8 {
+        Above,          // value > threshold
+        Below,          // value < threshold
+        InsideWindow,   // threshold <= value <= upper
+        OutsideWindow,  // value < threshold or value > upper
+        RisingFaster,   // Change per second > threshold
+        FallingFaster,  // Change per second < -threshold
+        DtcAppeared     // dtcCode (any code if empty) reported for the first time
+    };
+
+    struct Condition {
+        ConditionType type = Above;
+        QString pidId;              // Not used by DtcAppeared
+        double threshold = 0.0;
+        double upper = 0.0;         // Window conditions only
+        QString dtcCode;            // DtcAppeared only
+    };
+
+    enum Combine : quint8 {
+        All,    // Every condition holds
+        Any     // At least one holds
+    };
+
+    struct Rule {
+        QString name;
+        QVector<Condition> conditions;
+        Combine combine = All;
+    };
+
+    /**
+     * @brief One ring entry.
+     */
+    struct CapturedSample {
+        qint64 timeNs = 0;      // SampleClock::timeOf(sample)
+        double value = 0.0;
+        quint16 pid = 0;        // Index into Capture::pids
+    };
+
+    struct Capture {
+        QString ruleName;
+        qint64 triggerTimeNs = 0;
+        qint64 triggerWallMs = 0;       // 0 if the trigger sample had no wall-clock time
+        qint64 preTriggerNs = 0;
+        qint64 postTriggerNs = 0;
+        QStringList pids;               // PID ids by CapturedSample::pid
+        QVector<CapturedSample> samples; // Oldest first
+        bool truncated = false;         // The ring hit capacity() and dropped samples inside the window
+        int suppressedTriggers = 0;     // Triggers that fired while this capture was recording
+    };
+
+    static constexpr int DEFAULT_CAPACITY = 1 << 16;    // ~1.5 MB at most; a 15 s window at 4000 samples/s
+    static constexpr int INITIAL_CAPACITY = 1 << 10;    // Doubled as the window needs
+    static constexpr int MAX_CONDITIONS = 32;           // Per rule
+    static constexpr int DEFAULT_PRE_TRIGGER_MS = 10000;
+    static constexpr int DEFAULT_POST_TRIGGER_MS = 5000;
+
+    /**
+     * @param capacity Most ring entries, rounded up to a power of two.
+     */
+    explicit TriggerEngine(int capacity = DEFAULT_CAPACITY, QObject *parent = nullptr);
+    ~TriggerEngine() override;
+
+    /**
+     * @brief Adds a rule.
+     * @param error Set to a description of the problem if the rule is rejected.
+     * @return false if it has no or more than MAX_CONDITIONS conditions, or a
+     * PID condition without a PID.
+     */
+    bool addRule(const Rule& rule, QString* error = nullptr);
+    void clearRules();
+    int ruleCount() const { return m_rules.size(); }
+
+    void setPreTriggerMs(int ms) { m_preTriggerNs = qint64(qMax(0, ms)) * 1000000; }
+    void setPostTriggerMs(int ms) { m_postTriggerNs = qint64(qMax(0, ms)) * 1000000; }
+    int preTriggerMs() const { return int(m_preTriggerNs / 1000000); }
+    int postTriggerMs() const { return int(m_postTriggerNs / 1000000); }
+
+    /**
+     * @brief Directory completed captures are written to; empty = not written.
+     */
+    void setCaptureDirectory(const QString& directory) { m_captureDirectory = directory; }
+    QString captureDirectory() const { return m_captureDirectory; }
+
+    int capacity() const { return m_capacity; }
+    quint64 samplesIngested() const { return m_head; }
+
+    /**
+     * @brief Samples in the ring: the pre-trigger window, or everything since
+     * the start of the window of a capture in progress.
+     */
+    int bufferedSamples() const { return int(m_head - m_tail); }
+    bool isCapturing() const { return m_capturing; }
+
+    /**
+     * @brief Records a sample and evaluates the conditions on its PID.
+     * An unstamped sample is timed now (SampleClock::timeOf()).
+     */
+    void ingest(const PidSample& sample);
+
+    /**
+     * @brief Evaluates DtcAppeared conditions against the codes of a scan or poll.
+     * @param timeNs When the codes were read, on the sample clock.
+     * @param wallMs Wall-clock time of the read, 0 if unknown.
+     */
+    void ingestDtcs(const QVector<DtcEntry>& dtcs, qint64 timeNs, qint64 wallMs = 0);
+
+    /**
+     * @brief Completes a capture in progress with what was recorded so far,
+     * e.g. when streaming stops.
+     */
+    void finishCapture();
+
+    /**
+     * @brief Empties the ring and forgets PID and rule state; rules are kept.
+     */
+    void reset();
+
+    /**
+     * @brief Blocks until every capture handed to the writer is on disk.
+     */
+    void waitForWrites();
+
+signals:
+    void triggered(const QString& ruleName, qint64 timeNs);
+    void captureComplete(const TriggerEngine::Capture& capture);
+    void captureWritten(const QString& path);
+    void captureWriteFailed(const QString& error);
+
+private:
+    struct RuleState {
+        Rule rule;
+        quint32 allMask = 0;
+        quint32 trueMask = 0;
+        bool active = false;
+    };
+
+    struct ConditionRef {
+        int rule;
+        int condition;
+    };
+
+    struct PidState {
+        double value = 0.0;
+        qint64 timeNs = 0;
+        bool seen = false;
+    };
+
+    int slotFor(const QString& pidId);          // -1 once 65535 PIDs were seen
+    bool conditionHolds(const Condition& condition, const PidState& previous, double value, qint64 timeNs) const;
+    void updateRule(RuleState& state, int condition, bool holds, qint64 timeNs, qint64 wallMs);
+    void fire(const QString& ruleName, qint64 timeNs, qint64 wallMs);
+    void makeRoom(qint64 timeNs);
+    void writeCapture(const Capture& capture);
+
+    QVector<CapturedSample> m_ring;
+    quint64 m_head = 0;                         // Entries ever written; next index is m_head & mask
+    quint64 m_tail = 0;                         // Oldest entry still held
+    quint64 m_mask = 0;
+    int m_capacity = 0;
+    qint64 m_droppedNs = 0;                     // Newest entry dropped for lack of room, 0 = none
+
+    QHash<QString, quint16> m_pidSlots;
+    QStringList m_pidNames;
+    QVector<PidState> m_pidStates;
+    QVector<QVector<ConditionRef>> m_conditionsByPid;   // By PID slot
+    QVector<ConditionRef> m_dtcConditions;
+    QSet<QString> m_knownDtcs;
+
+    QVector<RuleState> m_rules;
+    qint64 m_preTriggerNs = qint64(DEFAULT_PRE_TRIGGER_MS) * 1000000;
+    qint64 m_postTriggerNs = qint64(DEFAULT_POST_TRIGGER_MS) * 1000000;
+
+    // Capture in progress
+    bool m_capturing = false;
+    QString m_captureRule;
+    qint64 m_triggerTimeNs = 0;
+    qint64 m_triggerWallMs = 0;
+    quint64 m_triggerHead = 0;                  // m_head when the trigger fired
+    int m_suppressedTriggers = 0;
+
+    QString m_captureDirectory;
+    QThreadPool m_writerPool;
+};
+
+Q_DECLARE_METATYPE(TriggerEngine::Capture)
+
+#endif // TRIGGERENGINE_H
@@ -0,0 +1,290 @@
+#include "VirtualPidEngine.h"
+#include "SampleClock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct Output {
+    int sample;         // Index of the producing sample
+    int channel;
+    double value;
+    qint64 timeNs;      // Time the filter ran at
+};
+
+} // namespace
+
+bool VirtualPidEngine::define(const Definition& definition, QString* error)
+{
+    auto reject = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (definition.pidId.isEmpty()) {
+        return reject("Virtual PID id is empty");
+    }
+    if (m_inputs.contains(definition.pidId)) {
+        return reject(QString("'%1' is read as a real PID").arg(definition.pidId));
+    }
+
+    QString parseError;
+    const PidExpression expression = PidExpression::parse(definition.expression, &parseError);
+    if (!expression.isValid()) {
+        return reject(parseError);
+    }
+    if (expression.inputs().isEmpty()) {
+        return reject("Expression reads no PID");
+    }
+    for (const QString& input : expression.inputs()) {
+        if (input == definition.pidId || m_index.contains(input)) {
+            return reject(QString("'%1' is a virtual PID").arg(input));
+        }
+    }
+
+    Channel channel;
+    channel.definition = definition;
+    channel.expression = expression;
+
+    auto it = m_index.constFind(definition.pidId);
+    if (it != m_index.constEnd()) {
+        m_channels[it.value()] = channel;
+    } else {
+        m_index.insert(definition.pidId, m_channels.size());
+        m_channels.append(channel);
+    }
+    rebuildInputs();
+
+    if (error) {
+        error->clear();
+    }
+    return true;
+}
+
+bool VirtualPidEngine::remove(const QString& pidId)
+{
+    const int index = m_index.value(pidId, -1);
+    if (index < 0) {
+        return false;
+    }
+
+    m_channels.remove(index);
+    m_index.clear();
+    for (int i = 0; i < m_channels.size(); ++i) {
+        m_index.insert(m_channels[i].definition.pidId, i);
+    }
+    rebuildInputs();
+    return true;
+}
+
+void VirtualPidEngine::clear()
+{
+    m_channels.clear();
+    m_index.clear();
+    rebuildInputs();
+}
+
+QVector<PidMeta> VirtualPidEngine::pidMetas(const QStringList& availablePids) const
+{
+    QVector<PidMeta> metas;
+    metas.reserve(m_channels.size());
+    for (const Channel& channel : m_channels) {
+        PidMeta meta(channel.definition.pidId, channel.definition.name, channel.definition.unit);
+        meta.category = channel.definition.category;
+        meta.isVirtual = true;
+        meta.supported = std::all_of(channel.expression.inputs().cbegin(), channel.expression.inputs().cend(),
+                                     [&availablePids](const QString& input) {
+                                         return availablePids.isEmpty() || availablePids.contains(input);
+                                     });
+        metas.append(meta);
+    }
+    return metas;
+}
+
+QStringList VirtualPidEngine::inputPids() const
+{
+    return m_inputPids;
+}
+
+QVector<PidSample> VirtualPidEngine::process(const QVector<PidSample>& samples)
+{
+    QVector<PidSample> result;
+    if (m_channels.isEmpty()) {
+        return result;
+    }
+
+    for (Channel& channel : m_channels) {
+        for (QVector<double>& column : channel.columns) {
+            column.clear();     // Keeps the capacity of earlier batches
+        }
+        channel.rowSamples.clear();
+    }
+
+    // Gather: one row per input sample, holding the other inputs at their latest value
+    for (int i = 0; i < samples.size(); ++i) {
+        const auto input = m_inputs.constFind(samples[i].pidId);
+        if (input == m_inputs.constEnd()) {
+            continue;
+        }
+        m_latest[input->slot] = samples[i].value;
+        m_seen[input->slot] = true;
+
+        for (int channelIndex : input->channels) {
+            Channel& channel = m_channels[channelIndex];
+            const bool ready = std::all_of(channel.inputSlots.cbegin(), channel.inputSlots.cend(),
+                                           [this](int slot) { return m_seen[slot]; });
+            if (!ready) {
+                continue;
+            }
+            for (int k = 0; k < channel.inputSlots.size(); ++k) {
+                channel.columns[k].append(m_latest[channel.inputSlots[k]]);
+            }
+            channel.rowSamples.append(i);
+        }
+    }
+
+    // Evaluate each expression once over all its rows, then filter in time order
+    QVector<Output> outputs;
+    for (int c = 0; c < m_channels.size(); ++c) {
+        Channel& channel = m_channels[c];
+        const int rows = channel.rowSamples.size();
+        if (rows == 0) {
+            continue;
+        }
+
+        m_results.resize(rows);
+        m_scratch.resize(channel.expression.scratchSize(rows));
+        m_columnPointers.resize(channel.columns.size());
+        for (int k = 0; k < channel.columns.size(); ++k) {
+            m_columnPointers[k] = channel.columns[k].constData();
+        }
+        channel.expression.evaluateBatch(m_columnPointers.constData(), rows, m_results.data(), m_scratch.data());
+
+        for (int row = 0; row < rows; ++row) {
+            const double value = m_results[row];
+            if (!std::isfinite(value)) {
+                continue;
+            }
+            const int sample = channel.rowSamples[row];
+            bool emitValue = true;
+            const qint64 timeNs = SampleClock::timeOf(samples[sample]);
+            const double filtered = applyFilter(channel, value, timeNs, &emitValue);
+            if (emitValue) {
+                outputs.append({sample, c, filtered, timeNs});
+            }
+        }
+    }
+
+    std::stable_sort(outputs.begin(), outputs.end(), [](const Output& a, const Output& b) {
+        return a.sample < b.sample;
+    });
+    result.reserve(outputs.size());
+    for (const Output& output : outputs) {
+        const PidSample& source = samples[output.sample];
+        const Definition& definition = m_channels[output.channel].definition;
+        result.append(PidSample(definition.pidId, output.value, definition.unit,
+                                source.timestamp, output.timeNs));
+    }
+    return result;
+}
+
+void VirtualPidEngine::reset()
+{
+    std::fill(m_latest.begin(), m_latest.end(), 0.0);
+    std::fill(m_seen.begin(), m_seen.end(), false);
+    for (Channel& channel : m_channels) {
+        channel.hasPrevious = false;
+        channel.previousValue = 0.0;
+        channel.previousRaw = 0.0;
+        channel.previousTimeNs = 0;
+    }
+}
+
+void VirtualPidEngine::rebuildInputs()
+{
+    // Latest values survive redefinitions for the PIDs still read
+    QHash<QString, double> latest;
+    for (int slot = 0; slot < m_inputPids.size(); ++slot) {
+        if (m_seen[slot]) {
+            latest.insert(m_inputPids[slot], m_latest[slot]);
+        }
+    }
+
+    m_inputPids.clear();
+    m_inputs.clear();
+    for (int c = 0; c < m_channels.size(); ++c) {
+        Channel& channel = m_channels[c];
+        const QStringList& inputs = channel.expression.inputs();
+        channel.inputSlots.clear();
+        channel.columns.resize(inputs.size());
+        for (const QString& pidId : inputs) {
+            auto it = m_inputs.find(pidId);
+            if (it == m_inputs.end()) {
+                Input input;
+                input.slot = m_inputPids.size();
+                m_inputPids.append(pidId);
+                it = m_inputs.insert(pidId, input);
+            }
+            it->channels.append(c);
+            channel.inputSlots.append(it->slot);
+        }
+    }
+
+    m_latest.fill(0.0, m_inputPids.size());
+    m_seen.fill(false, m_inputPids.size());
+    for (int slot = 0; slot < m_inputPids.size(); ++slot) {
+        auto it = latest.constFind(m_inputPids[slot]);
+        if (it != latest.constEnd()) {
+            m_latest[slot] = it.value();
+            m_seen[slot] = true;
+        }
+    }
+}
+
+double VirtualPidEngine::applyFilter(Channel& channel, double value, qint64 timeNs, bool* emitValue)
+{
+    const Definition& definition = channel.definition;
+    if (definition.filter == NoFilter) {
+        return value;
+    }
+
+    const double dt = channel.hasPrevious ? (timeNs - channel.previousTimeNs) / 1e9 : 0.0;
+    double output = value;
+    switch (definition.filter) {
+    case Ema:
+        if (channel.hasPrevious && definition.timeConstantS > 0.0) {
+            const double alpha = dt > 0.0 ? 1.0 - std::exp(-dt / definition.timeConstantS) : 0.0;
+            output = channel.previousValue + alpha * (value - channel.previousValue);
+        }
+        break;
+    case Derivative:
+        // Needs two samples at different times; a second one at the same
+        // time is ignored
+        if (channel.hasPrevious && dt <= 0.0) {
+            *emitValue = false;
+            return value;
+        }
+        if (!channel.hasPrevious) {
+            *emitValue = false;
+            output = 0.0;
+        } else {
+            output = (value - channel.previousRaw) / dt;
+        }
+        break;
+    case Integral:
+        output = channel.hasPrevious
+            ? channel.previousValue + std::max(0.0, dt) * (value + channel.previousRaw) / 2.0
+            : 0.0;
+        break;
+    case NoFilter:
+        break;
+    }
+
+    channel.hasPrevious = true;
+    channel.previousValue = output;
+    channel.previousRaw = value;
+    channel.previousTimeNs = timeNs;
+    return output;
+}
@@ -0,0 +1,125 @@
+#ifndef VIRTUALPIDENGINE_H
+#define VIRTUALPIDENGINE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "core/PidExpression.h"
+#include "core/dto/PidMeta.h"
+#include "core/dto/PidSample.h"
+
+/**
+ * @brief The VirtualPidEngine class
+ * Derived channels computed from live samples, e.g. fuel economy from speed
+ * and MAF. They are never requested from the vehicle: they only consume the
+ * samples of the PIDs that are already being read, so they add no bus load.
+ *
+ * Every definition is parsed once into a PidExpression. process() takes a
+ * batch of new samples. Each sample of one of a virtual PID's inputs adds a
+ * row, using the latest value of its other inputs, once all of them have
+ * been seen. The expression is then evaluated over all rows of the batch at
+ * once. An optional filter runs over the results in time order; filter state
+ * carries over from one batch to the next.
+ *
+ * Not thread-safe; feed it from the thread that receives the samples.
+ */
+class VirtualPidEngine
+{
+public:
+    enum Filter : quint8 {
+        NoFilter,
+        Ema,            // Exponential moving average with time constant timeConstantS
+        Derivative,     // Change per second
+        Integral        // Trapezoidal integral over seconds, e.g. fuel used from fuel rate
+    };
+
+    struct Definition {
+        QString pidId;              // Id samples and PidMeta use, e.g. "V_MPG"
+        QString name;
+        QString unit;
+        QString expression;         // See PidExpression
+        Filter filter = NoFilter;
+        double timeConstantS = 1.0; // Ema only
+        PidCategory category = PidCategory::Other;
+    };
+
+    VirtualPidEngine() = default;
+
+    /**
+     * @brief Adds a virtual PID, or replaces the one with the same id.
+     * @param error Set to a description of the problem if the definition is rejected.
+     * @return false if the id is empty or already read as a real PID, or the
+     * expression does not parse or reads a virtual PID.
+     */
+    bool define(const Definition& definition, QString* error = nullptr);
+    bool remove(const QString& pidId);
+    void clear();
+
+    int count() const { return m_channels.size(); }
+    bool isVirtual(const QString& pidId) const { return m_index.contains(pidId); }
+
+    /**
+     * @brief Metadata for every virtual PID, marked PidMeta::isVirtual.
+     * @param availablePids Real PIDs the vehicle supports; a virtual PID is
+     * supported if all its inputs are. Empty = assume they all are.
+     */
+    QVector<PidMeta> pidMetas(const QStringList& availablePids = QStringList()) const;
+
+    /**
+     * @brief Real PIDs read by at least one definition.
+     */
+    QStringList inputPids() const;
+
+    /**
+     * @brief Computes virtual samples for a batch of new samples.
+     * @param samples New samples in arrival order. Samples of PIDs no definition
+     * reads are skipped at the cost of one hash lookup.
+     * @return Virtual samples in the same order, stamped with the time of the
+     * sample that produced them (SampleClock::timeOf()). Rows whose result is not finite (e.g. a
+     * division by zero at idle) are dropped.
+     */
+    QVector<PidSample> process(const QVector<PidSample>& samples);
+
+    /**
+     * @brief Forgets the latest input values and the filter state, e.g. for a new session.
+     */
+    void reset();
+
+private:
+    struct Channel {
+        Definition definition;
+        PidExpression expression;
+        QVector<int> inputSlots;        // Per expression input: index into m_latest
+        QVector<QVector<double>> columns; // Per expression input: values of this batch's rows
+        QVector<int> rowSamples;        // Per row: index of the producing sample in the batch
+
+        // Filter state
+        bool hasPrevious = false;
+        double previousValue = 0.0;     // Last filter output
+        double previousRaw = 0.0;       // Last expression result
+        qint64 previousTimeNs = 0;
+    };
+
+    struct Input {
+        int slot = 0;                   // Index into m_latest
+        QVector<int> channels;          // Channels reading this PID
+    };
+
+    void rebuildInputs();
+    static double applyFilter(Channel& channel, double value, qint64 timeNs, bool* emitValue);
+
+    QVector<Channel> m_channels;
+    QHash<QString, int> m_index;                // Virtual PID id -> m_channels index
+
+    QStringList m_inputPids;                    // Real PIDs read, slot = position
+    QHash<QString, Input> m_inputs;             // Real PID id -> slot and readers
+    QVector<double> m_latest;                   // Latest value per input slot
+    QVector<bool> m_seen;                       // Whether a value arrived for the slot
+
+    QVector<double> m_results;                  // Reused between batches
+    QVector<double> m_scratch;
+    QVector<const double*> m_columnPointers;
+};
+
+#endif // VIRTUALPIDENGINE_H
@@ -29,6 +29,7 @@ struct PidMeta {
     QString unit;                   // Unit of measurement (e.g., "rpm", "Centigrade", "kPa")
     PidCategory category = PidCategory::Other;
     bool supported = false;         // Whether PID is supported by vehicle
+    bool isVirtual = false;         // Computed from other PIDs by VirtualPidEngine, never requested
 
     PidMeta() = default;
     
@@ -44,7 +45,8 @@ struct PidMeta {
                name == other.name &&
                unit == other.unit &&
                category == other.category &&
-               supported == other.supported;
+               supported == other.supported &&
+               isVirtual == other.isVirtual;
     }
 };
 
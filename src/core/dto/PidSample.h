@@ -8,21 +8,23 @@
 /**
  * @brief The PidSample struct
  * Represents a single sample of PID data.
+ * Timestamps come from the transport (see SampleClock); a sample built
+ * without one has an invalid timestamp and sampleTimeNs 0.
  */
 struct PidSample {
-    QDateTime timestamp;    // When the sample was taken
+    QDateTime timestamp;    // When the ECU answered (wall clock, from the session anchor)
+    qint64 sampleTimeNs = 0; // Same instant on the monotonic SampleClock, for correlating PIDs
     QString pidId;          // PID identifier
     double value = 0.0;     // Sample value
     QString unit;           // Unit of measurement
 
-    PidSample() {
-        timestamp = QDateTime::currentDateTime();
-    }
+    PidSample() = default;
     
     PidSample(const QString& id, double val, const QString& u)
-        : pidId(id), value(val), unit(u) {
-        timestamp = QDateTime::currentDateTime();
-    }
+        : pidId(id), value(val), unit(u) {}
+
+    PidSample(const QString& id, double val, const QString& u, const QDateTime& time, qint64 timeNs)
+        : timestamp(time), sampleTimeNs(timeNs), pidId(id), value(val), unit(u) {}
     
     bool isValid() const {
         return !pidId.isEmpty();
@@ -30,6 +32,7 @@ struct PidSample {
     
     bool operator==(const PidSample& other) const {
         return timestamp == other.timestamp &&
+               sampleTimeNs == other.sampleTimeNs &&
                pidId == other.pidId &&
                qAbs(value - other.value) < 0.0001 &&
                unit == other.unit;
@@ -0,0 +1,58 @@
+#ifndef PIDSERIES_H
+#define PIDSERIES_H
+
+#include <QString>
+#include <QVector>
+#include <QMetaType>
+
+/**
+ * @brief The PidSeries struct
+ * Columnar time series for a single PID.
+ * Times and values are stored in separate contiguous buffers so that
+ * plotting and statistics code can scan them without touching PidSample objects.
+ */
+struct PidSeries {
+    QString pidId;              // PID identifier
+    QString unit;               // Unit of measurement
+    QVector<double> times;      // Sample times in seconds since session start (ascending)
+    QVector<double> values;     // Sample values (same length as times)
+
+    PidSeries() = default;
+
+    PidSeries(const QString& id, const QString& u)
+        : pidId(id), unit(u) {}
+
+    void append(double time, double value) {
+        times.append(time);
+        values.append(value);
+    }
+
+    void reserve(int count) {
+        times.reserve(count);
+        values.reserve(count);
+    }
+
+    void clear() {
+        times.clear();
+        values.clear();
+    }
+
+    int size() const {
+        return times.size();
+    }
+
+    bool isEmpty() const {
+        return times.isEmpty();
+    }
+
+    bool operator==(const PidSeries& other) const {
+        return pidId == other.pidId &&
+               unit == other.unit &&
+               times == other.times &&
+               values == other.values;
+    }
+};
+
+Q_DECLARE_METATYPE(PidSeries)
+
+#endif // PIDSERIES_H
@@ -2,14 +2,14 @@
 #define READINESSRESULT_H
 
 #include <QString>
-#include <QMap>
 #include <QMetaType>
+#include <QtAlgorithms>
 
 /**
  * @brief The MonitorStatus enum
  * Represents the status of an emissions monitor.
  */
-enum class MonitorStatus {
+enum class MonitorStatus : quint8 {
     Complete,     // Monitor test complete
     Incomplete,   // Monitor test incomplete
     Unsupported   // Monitor not supported by vehicle
@@ -17,47 +17,145 @@ enum class MonitorStatus {
 
 Q_DECLARE_METATYPE(MonitorStatus)
 
+/**
+ * @brief The Monitor enum
+ * Every readiness monitor of Mode 01 PID 01. The value is the monitor's bit in
+ * the ReadinessResult masks.
+ */
+enum class Monitor : quint8 {
+    // Common tests (byte B)
+    Misfire,            // MIS
+    FuelSystem,         // FUEL
+    Components,         // CCM - Comprehensive component
+
+    // Spark ignition (bytes C/D)
+    Catalyst,           // CAT
+    HeatedCatalyst,     // HCAT
+    EvapSystem,         // EVAP
+    SecondaryAir,       // SAS
+    GasParticulate,     // GPF - Gasoline particulate filter
+    OxygenSensor,       // O2S
+    OxygenSensorHeater, // O2SH
+
+    // Both layouts (C7/D7)
+    Egr,                // EGR - EGR and/or VVT system
+
+    // Compression ignition (bytes C/D)
+    NmhcCatalyst,       // NMHC
+    NoxScr,             // NOX - NOx/SCR monitor
+    BoostPressure,      // BOOST
+    ExhaustGasSensor,   // EGS
+    PmFilter,           // PM
+
+    Count
+};
+
+Q_DECLARE_METATYPE(Monitor)
+
 /**
  * @brief The ReadinessResult struct
  * Contains readiness test results for emissions monitors.
+ *
+ * Monitors are kept as three bitmasks indexed by Monitor, so the struct is a
+ * few bytes, copies without allocating and answers overallReady from the masks.
  */
 struct ReadinessResult {
-    bool overallReady = false;  // Overall readiness status
-    QMap<QString, MonitorStatus> monitors;  // Monitor name -> status
+    static constexpr int MONITOR_COUNT = int(Monitor::Count);
+
+    bool overallReady = false;          // Every supported monitor is complete
+    bool compressionIgnition = false;   // Bit B3: bytes C/D use the diesel layout
+    quint16 reportedMask = 0;           // Monitors present in the response
+    quint16 supportedMask = 0;          // Monitors the vehicle supports
+    quint16 incompleteMask = 0;         // Supported monitors that are not complete
+
+    static_assert(MONITOR_COUNT <= 16, "Monitor masks are 16 bits");
 
     ReadinessResult() = default;
-    
-    void setMonitorStatus(const QString& monitorName, MonitorStatus status) {
-        monitors[monitorName] = status;
+
+    static constexpr quint16 bit(Monitor monitor) {
+        return quint16(1u << int(monitor));
+    }
+
+    /**
+     * @brief Short name of a monitor, e.g. "CAT".
+     */
+    static const char* monitorName(Monitor monitor) {
+        static constexpr const char* names[MONITOR_COUNT] = {
+            "MIS", "FUEL", "CCM",
+            "CAT", "HCAT", "EVAP", "SAS", "GPF", "O2S", "O2SH",
+            "EGR",
+            "NMHC", "NOX", "BOOST", "EGS", "PM"
+        };
+        return int(monitor) < MONITOR_COUNT ? names[int(monitor)] : "";
+    }
+
+    /**
+     * @brief Monitor for a name returned by monitorName().
+     * @return false if the name is unknown.
+     */
+    static bool monitorFromName(const QString& name, Monitor* monitor) {
+        for (int i = 0; i < MONITOR_COUNT; ++i) {
+            if (name == QLatin1String(monitorName(Monitor(i)))) {
+                *monitor = Monitor(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void setMonitorStatus(Monitor monitor, MonitorStatus status) {
+        const quint16 mask = bit(monitor);
+        reportedMask |= mask;
+        supportedMask = quint16(status == MonitorStatus::Unsupported ? supportedMask & ~mask : supportedMask | mask);
+        incompleteMask = quint16(status == MonitorStatus::Incomplete ? incompleteMask | mask : incompleteMask & ~mask);
         updateOverallReady();
     }
-    
-    MonitorStatus getMonitorStatus(const QString& monitorName) const {
-        return monitors.value(monitorName, MonitorStatus::Unsupported);
+
+    MonitorStatus getMonitorStatus(Monitor monitor) const {
+        const quint16 mask = bit(monitor);
+        if (!(supportedMask & mask)) {
+            return MonitorStatus::Unsupported;
+        }
+        return (incompleteMask & mask) ? MonitorStatus::Incomplete : MonitorStatus::Complete;
     }
-    
-    void updateOverallReady() {
-        if (monitors.isEmpty()) {
-            overallReady = false;
-            return;
+
+    bool isReported(Monitor monitor) const {
+        return (reportedMask & bit(monitor)) != 0;
+    }
+
+    /**
+     * @brief True until a response has been decoded or a status set.
+     */
+    bool isEmpty() const {
+        return reportedMask == 0;
+    }
+
+    int monitorCount() const {
+        return qPopulationCount(reportedMask);
+    }
+
+    /**
+     * @brief Calls @p visit(Monitor, MonitorStatus) for every reported monitor, in enum order.
+     */
+    template<typename Visitor>
+    void forEachMonitor(Visitor visit) const {
+        for (quint16 remaining = reportedMask; remaining != 0; remaining &= quint16(remaining - 1)) {
+            const Monitor monitor = Monitor(qCountTrailingZeroBits(remaining));
+            visit(monitor, getMonitorStatus(monitor));
         }
-        
+    }
+
+    void updateOverallReady() {
         // Overall ready if all supported monitors are complete
-        overallReady = true;
-        for (auto it = monitors.begin(); it != monitors.end(); ++it) {
-            if (it.value() == MonitorStatus::Unsupported) {
-                continue; // Skip unsupported monitors
-            }
-            if (it.value() != MonitorStatus::Complete) {
-                overallReady = false;
-                break;
-            }
-        }
+        overallReady = reportedMask != 0 && incompleteMask == 0;
     }
-    
+
     bool operator==(const ReadinessResult& other) const {
         return overallReady == other.overallReady &&
-               monitors == other.monitors;
+               compressionIgnition == other.compressionIgnition &&
+               reportedMask == other.reportedMask &&
+               supportedMask == other.supportedMask &&
+               incompleteMask == other.incompleteMask;
     }
 };
 
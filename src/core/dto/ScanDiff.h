@@ -0,0 +1,134 @@
+#ifndef SCANDIFF_H
+#define SCANDIFF_H
+
+#include <QDateTime>
+#include <QVector>
+#include <QString>
+#include <QMetaType>
+#include "core/dto/DtcEntry.h"
+#include "core/dto/ReadinessResult.h"
+
+/**
+ * @brief The DtcStatusFlag enum
+ * Bit per DtcStatus; a code can be reported by more than one mode in one scan
+ * (e.g. stored in Mode 03 and permanent in Mode 0A).
+ */
+enum DtcStatusFlag : quint8 {
+    DtcConfirmedFlag = 0x01,
+    DtcPendingFlag   = 0x02,
+    DtcPermanentFlag = 0x04
+};
+
+inline quint8 dtcStatusFlag(DtcStatus status) {
+    switch (status) {
+    case DtcStatus::Confirmed: return DtcConfirmedFlag;
+    case DtcStatus::Pending:   return DtcPendingFlag;
+    case DtcStatus::Permanent: return DtcPermanentFlag;
+    }
+    return DtcConfirmedFlag;
+}
+
+/**
+ * @brief The DtcChange struct
+ * One DTC that differs between two scans, with its status flags before and after.
+ */
+struct DtcChange {
+    QString code;               // DTC code (e.g., "P0420")
+    quint8 before = 0;          // DtcStatusFlag bits in the previous scan (0 = absent)
+    quint8 after = 0;           // DtcStatusFlag bits in the new scan (0 = absent)
+
+    DtcChange() = default;
+
+    DtcChange(const QString& c, quint8 b, quint8 a)
+        : code(c), before(b), after(a) {}
+
+    bool isAdded() const { return before == 0 && after != 0; }
+    bool isCleared() const { return before != 0 && after == 0; }
+
+    // Pending in the previous scan, confirmed now
+    bool isPendingToConfirmed() const {
+        return (before & DtcPendingFlag) && !(before & DtcConfirmedFlag) && (after & DtcConfirmedFlag);
+    }
+
+    bool operator==(const DtcChange& other) const {
+        return code == other.code && before == other.before && after == other.after;
+    }
+};
+
+Q_DECLARE_METATYPE(DtcChange)
+
+/**
+ * @brief The MonitorChange struct
+ * One readiness monitor whose status differs between two scans.
+ */
+struct MonitorChange {
+    QString monitor;
+    MonitorStatus before = MonitorStatus::Unsupported;
+    MonitorStatus after = MonitorStatus::Unsupported;
+
+    MonitorChange() = default;
+
+    MonitorChange(const QString& m, MonitorStatus b, MonitorStatus a)
+        : monitor(m), before(b), after(a) {}
+
+    bool operator==(const MonitorChange& other) const {
+        return monitor == other.monitor && before == other.before && after == other.after;
+    }
+};
+
+Q_DECLARE_METATYPE(MonitorChange)
+
+/**
+ * @brief The ScanDiff struct
+ * What changed between two scans of the same vehicle.
+ * DTC lists are ordered by code key (P, C, B, U, then number), monitor
+ * changes by the Monitor enum.
+ */
+struct ScanDiff {
+    QString vin;                            // Vehicle both scans belong to
+    bool hasBaseline = false;               // False if there was no previous scan to compare with
+    QDateTime baselineTime;                 // Timestamp of the previous scan
+    QDateTime scanTime;                     // Timestamp of the new scan
+
+    QVector<DtcChange> addedDtcs;           // Absent before, present now
+    QVector<DtcChange> clearedDtcs;         // Present before, absent now
+    QVector<DtcChange> changedDtcs;         // Present in both with different status flags
+    QVector<MonitorChange> monitorChanges;  // Monitors whose status changed
+
+    bool milBefore = false;
+    bool milAfter = false;
+
+    bool milChanged() const { return hasBaseline && milBefore != milAfter; }
+
+    bool isEmpty() const {
+        return addedDtcs.isEmpty() && clearedDtcs.isEmpty() && changedDtcs.isEmpty() &&
+               monitorChanges.isEmpty() && !milChanged();
+    }
+
+    int pendingToConfirmedCount() const {
+        int count = 0;
+        for (const auto& change : changedDtcs) {
+            if (change.isPendingToConfirmed()) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    bool operator==(const ScanDiff& other) const {
+        return vin == other.vin &&
+               hasBaseline == other.hasBaseline &&
+               baselineTime == other.baselineTime &&
+               scanTime == other.scanTime &&
+               addedDtcs == other.addedDtcs &&
+               clearedDtcs == other.clearedDtcs &&
+               changedDtcs == other.changedDtcs &&
+               monitorChanges == other.monitorChanges &&
+               milBefore == other.milBefore &&
+               milAfter == other.milAfter;
+    }
+};
+
+Q_DECLARE_METATYPE(ScanDiff)
+
+#endif // SCANDIFF_H
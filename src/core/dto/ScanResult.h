@@ -5,6 +5,7 @@
 #include <QVector>
 #include <QString>
 #include <QMetaType>
+#include <memory>
 #include "core/dto/DtcEntry.h"
 #include "core/dto/ReadinessResult.h"
 
@@ -36,15 +37,18 @@ Q_DECLARE_METATYPE(ModuleInfo)
  * Contains the results of a diagnostic scan.
  */
 struct ScanResult {
-    QDateTime timestamp;                    // When the scan was performed
+    QDateTime timestamp;                    // When the first reply of the scan arrived (invalid until then)
     bool milOn = false;                     // MIL (Malfunction Indicator Lamp) status
     QVector<DtcEntry> dtcs;                 // List of DTCs found
     ReadinessResult readiness;              // Readiness test results
     QVector<ModuleInfo> modules;            // Detected modules (optional)
+    QString vin;                            // Vehicle Identification Number (empty if not read)
+    bool complete = true;                   // False for progressive updates while the scan runs
+    bool timedOut = false;                  // The scan ended on a command timeout; holds what was read before it
+    quint32 receivedItems = 0;              // ScanPlanner::Item flags read so far (0 = not tracked)
+    quint64 version = 0;                    // Snapshot version assigned when published (0 = unpublished)
 
-    ScanResult() {
-        timestamp = QDateTime::currentDateTime();
-    }
+    ScanResult() = default;
     
     int getDtcCount(DtcStatus status) const {
         int count = 0;
@@ -65,10 +69,23 @@ struct ScanResult {
                milOn == other.milOn &&
                dtcs == other.dtcs &&
                readiness == other.readiness &&
-               modules == other.modules;
+               modules == other.modules &&
+               vin == other.vin &&
+               complete == other.complete &&
+               timedOut == other.timedOut &&
+               receivedItems == other.receivedItems;
     }
 };
 
 Q_DECLARE_METATYPE(ScanResult)
 
+/**
+ * @brief Immutable, shared scan result.
+ * Published by AppState on the GUI thread; readers on any thread can hold
+ * on to a snapshot without copying it, and compare versions instead of contents.
+ */
+using ScanResultSnapshot = std::shared_ptr<const ScanResult>;
+
+Q_DECLARE_METATYPE(ScanResultSnapshot)
+
 #endif // SCANRESULT_H
@@ -0,0 +1,50 @@
+#ifndef SUPPORTEDPIDS_H
+#define SUPPORTEDPIDS_H
+
+#include <QHash>
+#include <QMetaType>
+
+/**
+ * @brief The SupportedPids struct
+ * PIDs 0x01-0x20 a vehicle reports as supported, per service (mode).
+ * Filled from the "01 00" / "09 00" replies; modes that were never queried are unknown.
+ */
+struct SupportedPids {
+    QHash<quint8, quint32> bitmaps;  // Mode -> bitmap, bit 31 = PID 0x01 ... bit 0 = PID 0x20
+
+    SupportedPids() = default;
+
+    bool isKnown(quint8 mode) const {
+        return bitmaps.contains(mode);
+    }
+
+    void setBitmap(quint8 mode, quint32 bitmap) {
+        bitmaps[mode] = bitmap;
+    }
+
+    /**
+     * @brief Returns true if the PID is supported. PID 0x00 is always supported;
+     * PIDs outside 0x01-0x20 and unknown modes report false.
+     */
+    bool isSupported(quint8 mode, quint8 pid) const {
+        if (pid == 0x00) {
+            return true;
+        }
+        if (pid > 0x20 || !bitmaps.contains(mode)) {
+            return false;
+        }
+        return (bitmaps.value(mode) >> (32 - pid)) & 0x1;
+    }
+
+    void clear() {
+        bitmaps.clear();
+    }
+
+    bool operator==(const SupportedPids& other) const {
+        return bitmaps == other.bitmaps;
+    }
+};
+
+Q_DECLARE_METATYPE(SupportedPids)
+
+#endif // SUPPORTEDPIDS_H
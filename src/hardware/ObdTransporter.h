@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QByteArray>
 #include <QString>
+#include "core/MonotonicClock.h"
 
 /**
  * @brief The ObdTransporter class
@@ -42,6 +43,18 @@ public:
      */
     virtual bool isConnected() const = 0;
 
+    /**
+     * @brief MonotonicClock::now() (which SampleClock::now() returns) when the
+     * last command was written, 0 if none.
+     */
+    qint64 lastSentNs() const { return m_lastSentNs; }
+
+    /**
+     * @brief MonotonicClock::now() when the first data after the last command
+     * arrived, 0 if none has yet.
+     */
+    qint64 firstReceivedNs() const { return m_firstReceivedNs; }
+
 signals:
     // --- Signals for the UI to subscribe to ---
 
@@ -53,6 +66,26 @@ signals:
      * @brief Emitted when raw data arrives from the adapter.
      */
     void dataReceived(const QByteArray &data);
+
+protected:
+    // Implementations call these right before writing a command and right
+    // before emitting dataReceived(), so the stamps are taken at the transport
+    void stampSent()
+    {
+        m_lastSentNs = MonotonicClock::now();
+        m_firstReceivedNs = 0;
+    }
+
+    void stampReceived()
+    {
+        if (m_firstReceivedNs == 0) {
+            m_firstReceivedNs = MonotonicClock::now();
+        }
+    }
+
+private:
+    qint64 m_lastSentNs = 0;
+    qint64 m_firstReceivedNs = 0;
 };
 
 #endif // OBDTRANSPORTER_H
@@ -1,5 +1,6 @@
 #include "SerialTransporter.h"
-#include <QDebug>
+#include "core/Metrics.h"
+#include "core/Trace.h"
 
 SerialTransporter::SerialTransporter(QObject *parent)
     : ObdTransporter(parent)
@@ -26,7 +27,7 @@ void SerialTransporter::connectToDevice(const QString &identifier)
         m_serial->close();
     }
 
-    qDebug() << "Attempting to connect to serial device:" << path;
+    OBD_TRACE(Transport, TransportConnecting, 0, Trace::packText(path.right(8)), 'S');
 
     m_serial->setPortName(path);
     m_serial->setBaudRate(QSerialPort::Baud38400);
@@ -36,11 +37,13 @@ void SerialTransporter::connectToDevice(const QString &identifier)
     m_serial->setFlowControl(QSerialPort::NoFlowControl);
 
     if (m_serial->open(QIODevice::ReadWrite)) {
-        qDebug() << "Serial connected!";
+        OBD_TRACE(Transport, TransportConnected, 0, 0, 'S');
+        Metrics::transportConnected(Metrics::Serial, m_hasConnected);
+        m_hasConnected = true;
         emit connected();
     } else {
         QString err = m_serial->errorString();
-        qDebug() << "Serial open failed:" << err;
+        OBD_TRACE(Transport, TransportError, quint32(m_serial->error()), 0, 'S');
         emit errorOccurred(err);
     }
 }
@@ -49,7 +52,7 @@ void SerialTransporter::disconnectFromDevice()
 {
     if (m_serial->isOpen()) {
         m_serial->close();
-        qDebug() << "Serial disconnected!";
+        OBD_TRACE(Transport, TransportDisconnected, 0, 0, 'S');
         emit disconnected();
     }
 }
@@ -61,6 +64,9 @@ void SerialTransporter::sendCommand(const QByteArray &cmd)
         return;
     }
 
+    OBD_TRACE(Transport, TransportSend, quint32(cmd.size()), Trace::packText(cmd), 'S');
+    Metrics::addTransportBytes(Metrics::Serial, Metrics::Sent, quint64(cmd.size()));
+    stampSent();
     m_serial->write(cmd);
     m_serial->flush();
 }
@@ -72,7 +78,10 @@ bool SerialTransporter::isConnected() const
 
 void SerialTransporter::onSerialReadyRead()
 {
+    stampReceived();
     QByteArray data = m_serial->readAll();
+    OBD_TRACE(Transport, TransportReceive, quint32(data.size()), Trace::packText(data), 'S');
+    Metrics::addTransportBytes(Metrics::Serial, Metrics::Received, quint64(data.size()));
     emit dataReceived(data);
 }
 
@@ -83,6 +92,7 @@ void SerialTransporter::onSerialErrorOccurred(QSerialPort::SerialPortError error
     }
 
     QString msg = m_serial->errorString();
+    OBD_TRACE(Transport, TransportError, quint32(error), 0, 'S');
     if (m_serial->isOpen()) {
         m_serial->close();
         emit disconnected();
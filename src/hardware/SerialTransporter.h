@@ -28,6 +28,7 @@ private slots:
 
 private:
     QSerialPort *m_serial;
+    bool m_hasConnected = false;    // A later connection counts as a reconnect
 };
 
 #endif // SERIALTRANSPORTER_H
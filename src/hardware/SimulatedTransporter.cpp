@@ -0,0 +1,83 @@
+#include "SimulatedTransporter.h"
+#include <QTimer>
+
+SimulatedTransporter::SimulatedTransporter(QObject *parent)
+    : ObdTransporter(parent)
+{
+    // A 2005-era ISO 9141-2 vehicle with MIL on, one stored DTC (P0133)
+    // and no pending DTCs. The EVAP monitor has not completed since the codes
+    // were cleared, nor in this drive cycle.
+    setResponse("AT Z", "ELM327 v1.5");
+    setResponse("AT E0", "OK");
+    setResponse("AT SP 0", "OK");
+    setResponse("AT DP", "AUTO, ISO 9141-2");
+    setResponse("01 00", "41 00 BE 1F A8 13");
+    setResponse("01 01", "41 01 81 07 65 04");
+    setResponse("01 41", "41 41 00 07 65 04");
+    setResponse("03", "43 01 33 00 00 00 00");
+    setResponse("07", "47 00 00 00 00 00 00");
+}
+
+SimulatedTransporter::~SimulatedTransporter()
+{
+}
+
+void SimulatedTransporter::connectToDevice(const QString &identifier)
+{
+    Q_UNUSED(identifier);
+    m_connected = true;
+    m_commandCount = 0;
+    QTimer::singleShot(0, this, [this]() {
+        if (m_connected) {
+            emit connected();
+        }
+    });
+}
+
+void SimulatedTransporter::disconnectFromDevice()
+{
+    if (!m_connected) {
+        return;
+    }
+    m_connected = false;
+    emit disconnected();
+}
+
+void SimulatedTransporter::sendCommand(const QByteArray &cmd)
+{
+    if (!m_connected) {
+        return;
+    }
+    ++m_commandCount;
+    stampSent();
+
+    // Unknown commands get the ELM327 error reply
+    QByteArray response = m_responses.value(normalize(cmd), "?");
+    response.append("\r\r>");
+
+    QTimer::singleShot(m_latencyMs, this, [this, response]() {
+        if (m_connected) {
+            stampReceived();
+            emit dataReceived(response);
+        }
+    });
+}
+
+bool SimulatedTransporter::isConnected() const
+{
+    return m_connected;
+}
+
+void SimulatedTransporter::setResponse(const QByteArray &command, const QByteArray &response)
+{
+    m_responses.insert(normalize(command), response);
+}
+
+QByteArray SimulatedTransporter::normalize(const QByteArray &command)
+{
+    QByteArray key = command.toUpper();
+    key.replace(' ', "");
+    key.replace('\r', "");
+    key.replace('\n', "");
+    return key;
+}
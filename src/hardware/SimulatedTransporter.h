@@ -0,0 +1,53 @@
+#ifndef SIMULATEDTRANSPORTER_H
+#define SIMULATEDTRANSPORTER_H
+
+#include "ObdTransporter.h"
+#include <QHash>
+
+/**
+ * @brief The SimulatedTransporter class
+ * In-process ELM327 stand-in that answers commands from a response table.
+ * Used by benchmarks and offline runs; replies are always delivered from the
+ * event loop, like real hardware, never from inside sendCommand().
+ */
+class SimulatedTransporter : public ObdTransporter
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedTransporter(QObject *parent = nullptr);
+    ~SimulatedTransporter() override;
+
+    void connectToDevice(const QString &identifier) override; // identifier is ignored
+    void disconnectFromDevice() override;
+    void sendCommand(const QByteArray &cmd) override;
+    bool isConnected() const override;
+
+    /**
+     * @brief Sets the reply for a command. Spaces and case in the command are ignored.
+     * @param command Command as sent, e.g. "01 01".
+     * @param response Reply without the trailing prompt, e.g. "41 01 81 07 65 04".
+     */
+    void setResponse(const QByteArray &command, const QByteArray &response);
+
+    /**
+     * @brief Sets the delay before each reply (0 = next event loop iteration).
+     */
+    void setLatency(int ms) { m_latencyMs = qMax(0, ms); }
+    int latency() const { return m_latencyMs; }
+
+    /**
+     * @brief Number of commands received since connecting.
+     */
+    int commandCount() const { return m_commandCount; }
+
+private:
+    static QByteArray normalize(const QByteArray &command);
+
+    QHash<QByteArray, QByteArray> m_responses;
+    bool m_connected = false;
+    int m_latencyMs = 0;
+    int m_commandCount = 0;
+};
+
+#endif // SIMULATEDTRANSPORTER_H
@@ -1,6 +1,7 @@
 #include "TcpTransporter.h"
 #include <QStringList>
-#include <QDebug>
+#include "core/Metrics.h"
+#include "core/Trace.h"
 
 TcpTransporter::TcpTransporter(QObject *parent)
     : ObdTransporter(parent)
@@ -24,7 +25,7 @@ void TcpTransporter::connectToDevice(const QString &identifier)
     QString ip = parts.first();
     quint16 port = (parts.size() > 1) ? parts[1].toUShort() : 35000; // default to 35000 if no port
 
-    qDebug() << "Attempting to connect to Emulator at" << ip << "on port" << port;
+    OBD_TRACE(Transport, TransportConnecting, port, Trace::packText(ip.right(8)), 'T');
     m_socket->connectToHost(ip, port);
 }
 
@@ -42,6 +43,9 @@ void TcpTransporter::sendCommand(const QByteArray &cmd)
         return;
     }
 
+    OBD_TRACE(Transport, TransportSend, quint32(cmd.size()), Trace::packText(cmd), 'T');
+    Metrics::addTransportBytes(Metrics::Tcp, Metrics::Sent, quint64(cmd.size()));
+    stampSent();
     m_socket->write(cmd);
     m_socket->flush(); // ensure data is sent immediately
 }
@@ -55,24 +59,30 @@ bool TcpTransporter::isConnected() const
 
 void TcpTransporter::onSocketConnected()
 {
-    qDebug() << "TCP Connected!";
+    OBD_TRACE(Transport, TransportConnected, 0, 0, 'T');
+    Metrics::transportConnected(Metrics::Tcp, m_hasConnected);
+    m_hasConnected = true;
     emit connected();
 }
 
 void TcpTransporter::onSocketDisconnected()
 {
-    qDebug() << "TCP Disconnected!";
+    OBD_TRACE(Transport, TransportDisconnected, 0, 0, 'T');
     emit disconnected();
 }
 
 void TcpTransporter::onSocketReadyRead()
 {
+    stampReceived();
     QByteArray data = m_socket->readAll();
+    OBD_TRACE(Transport, TransportReceive, quint32(data.size()), Trace::packText(data), 'T');
+    Metrics::addTransportBytes(Metrics::Tcp, Metrics::Received, quint64(data.size()));
     // forward the raw data to the main app/parser
     emit dataReceived(data);
 }
 
-void TcpTransporter::onSocketError(QAbstractSocket::SocketError)
+void TcpTransporter::onSocketError(QAbstractSocket::SocketError error)
 {
+    OBD_TRACE(Transport, TransportError, quint32(error), 0, 'T');
     emit errorOccurred(m_socket->errorString());
 }
@@ -26,6 +26,7 @@ private slots:
 
 private:
     QTcpSocket *m_socket;
+    bool m_hasConnected = false;    // A later connection counts as a reconnect
 };
 
 #endif // TCPTRANSPORTER_H
@@ -0,0 +1,24 @@
+#include "TransporterFactory.h"
+#include "SerialTransporter.h"
+#include "TcpTransporter.h"
+
+ObdTransporter* TransporterFactory::create(const QString& address, QObject* parent)
+{
+    if (isTcpAddress(address)) {
+        return new TcpTransporter(parent);
+    }
+    return new SerialTransporter(parent);
+}
+
+bool TransporterFactory::isTcpAddress(const QString& address)
+{
+    // Serial paths never contain a ':' followed by a numeric port
+    const int colon = address.lastIndexOf(':');
+    if (colon <= 0 || colon == address.size() - 1) {
+        return false;
+    }
+
+    bool isNumber = false;
+    address.mid(colon + 1).toUShort(&isNumber);
+    return isNumber;
+}
@@ -0,0 +1,34 @@
+#ifndef TRANSPORTERFACTORY_H
+#define TRANSPORTERFACTORY_H
+
+#include <QObject>
+#include <QString>
+
+class ObdTransporter;
+
+/**
+ * @brief The TransporterFactory class
+ * Picks a transporter implementation from a connection address.
+ * "IP:PORT" selects TcpTransporter; anything else (e.g. /dev/ttyUSB0, COM3)
+ * selects SerialTransporter.
+ */
+class TransporterFactory
+{
+public:
+    /**
+     * @brief Creates an unconnected transporter for the address.
+     * @param address Device path or "IP:PORT".
+     * @param parent QObject parent of the new transporter.
+     */
+    static ObdTransporter* create(const QString& address, QObject* parent = nullptr);
+
+    /**
+     * @brief Returns true if the address names a TCP endpoint ("host:port").
+     */
+    static bool isTcpAddress(const QString& address);
+
+private:
+    TransporterFactory() = delete;  // Static class, prevent instantiation
+};
+
+#endif // TRANSPORTERFACTORY_H
@@ -1,11 +1,59 @@
 #include "mainwindow.h"
+#include "core/MetricsServer.h"
+#include "core/StartupProfiler.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <cstdio>
 
 int main(int argc, char *argv[])
 {
+    StartupProfiler::start();
     QApplication a(argc, argv);
+    StartupProfiler::mark("application");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption metricsPortOption("metrics-port", "Serve Prometheus metrics at http://<address>:<port>/metrics.",
+                                         "port");
+    QCommandLineOption metricsAddressOption("metrics-address", "Address the metrics endpoint binds to.",
+                                            "address", "127.0.0.1");
+    QCommandLineOption startupReportOption("startup-report",
+                                           "Print the time spent in each startup phase once the window is interactive.");
+    parser.addOption(metricsPortOption);
+    parser.addOption(metricsAddressOption);
+    parser.addOption(startupReportOption);
+    parser.process(a);
+
+    // Optional; bay stations scrape it instead of reading logs
+    MetricsServer metricsServer;
+    if (parser.isSet(metricsPortOption)) {
+        bool portOk = false;
+        const quint16 port = parser.value(metricsPortOption).toUShort(&portOk);
+        const QHostAddress address(parser.value(metricsAddressOption));
+        if (!portOk || address.isNull()) {
+            qWarning("Invalid --metrics-port or --metrics-address");
+            return 2;
+        }
+        if (!metricsServer.listen(port, address)) {
+            qWarning("%s", qPrintable(metricsServer.lastError()));
+            return 2;
+        }
+    }
+
+    StartupProfiler::mark("metrics server");
+
     MainWindow w;
+    const bool startupReport = parser.isSet(startupReportOption);
+    QObject::connect(&w, &MainWindow::interactive, [startupReport]() {
+        if (startupReport) {
+            fprintf(stderr, "%s\n", qPrintable(StartupProfiler::report()));
+        } else if (StartupProfiler::isOverBudget()) {
+            qWarning("Startup took %lld ms (budget %d ms); run with --startup-report for the phases",
+                     StartupProfiler::interactiveNs() / 1000000, StartupProfiler::BUDGET_MS);
+        }
+    });
     w.show();
+    StartupProfiler::mark("show");
     return a.exec();
 }
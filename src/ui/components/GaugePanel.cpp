@@ -0,0 +1,133 @@
+#include "GaugePanel.h"
+#include "GaugeWidget.h"
+#include <QGridLayout>
+#include <QScreen>
+#include <QTimer>
+
+GaugePanel::GaugePanel(QWidget *parent)
+    : QWidget(parent)
+    , m_layout(new QGridLayout(this))
+    , m_frameTimer(new QTimer(this))
+{
+    m_layout->setContentsMargins(0, 0, 0, 0);
+
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+    connect(m_frameTimer, &QTimer::timeout, this, &GaugePanel::onFrameTick);
+
+    // Takes no room until the first gauge
+    hide();
+}
+
+GaugeWidget* GaugePanel::addGauge(const QString& pidId, const QString& label, const QString& unit,
+                                  double minValue, double maxValue)
+{
+    if (GaugeWidget* existing = gauge(pidId)) {
+        return existing;
+    }
+
+    GaugeWidget* gauge = new GaugeWidget(this);
+    gauge->setLabel(label);
+    gauge->setUnit(unit);
+    gauge->setRange(minValue, maxValue);
+
+    m_gaugeIndex.insert(pidId, m_gauges.size());
+    m_gauges.append(gauge);
+    relayout();
+    show();
+    return gauge;
+}
+
+GaugeWidget* GaugePanel::gauge(const QString& pidId) const
+{
+    const int index = m_gaugeIndex.value(pidId, -1);
+    return index >= 0 ? m_gauges[index] : nullptr;
+}
+
+void GaugePanel::clearGauges()
+{
+    qDeleteAll(m_gauges);
+    m_gauges.clear();
+    m_gaugeIndex.clear();
+    m_frameTimer->stop();
+    hide();
+}
+
+void GaugePanel::setValue(const QString& pidId, double value)
+{
+    GaugeWidget* target = gauge(pidId);
+    if (!target) {
+        return;
+    }
+
+    target->setValue(value);
+    if (isVisible() && !m_frameTimer->isActive()) {
+        m_idleTicks = 0;
+        m_frameTimer->start();
+    }
+}
+
+void GaugePanel::setEnlarged(bool enlarged)
+{
+    if (m_enlarged != enlarged) {
+        m_enlarged = enlarged;
+        relayout();
+    }
+}
+
+void GaugePanel::setFrameRate(int hz)
+{
+    m_frameRateSet = true;
+    m_frameRate = qBound(1, hz, 240);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+}
+
+void GaugePanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    // Never faster than the display shows frames
+    if (!m_frameRateSet && screen()) {
+        m_frameRate = qBound(1, qRound(screen()->refreshRate()), 240);
+        m_frameTimer->setInterval(1000 / m_frameRate);
+    }
+    if (!m_gauges.isEmpty()) {
+        m_idleTicks = 0;
+        m_frameTimer->start();
+    }
+}
+
+void GaugePanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_frameTimer->stop();
+}
+
+void GaugePanel::onFrameTick()
+{
+    bool pending = false;
+    for (GaugeWidget* gauge : m_gauges) {
+        if (gauge->hasPendingValue()) {
+            pending = true;
+            gauge->flush();
+        }
+    }
+
+    if (pending) {
+        m_idleTicks = 0;
+    } else if (++m_idleTicks > m_frameRate) {
+        m_frameTimer->stop();
+    }
+}
+
+void GaugePanel::relayout()
+{
+    for (GaugeWidget* gauge : m_gauges) {
+        m_layout->removeWidget(gauge);
+    }
+
+    const int columns = m_enlarged ? ENLARGED_COLUMNS : COLUMNS;
+    for (int i = 0; i < m_gauges.size(); ++i) {
+        m_layout->addWidget(m_gauges[i], i / columns, i % columns);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef GAUGEPANEL_H
+#define GAUGEPANEL_H
+
+#include <QWidget>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+class QGridLayout;
+class QTimer;
+class GaugeWidget;
+
+/**
+ * @brief The GaugePanel class
+ * Grid of GaugeWidgets driven by one frame timer.
+ *
+ * setValue() only records values; once per frame every gauge with a new value
+ * is flushed, so a PID arriving faster than the display costs no more paints
+ * than one arriving at the display rate. The frame rate defaults to the
+ * refresh rate of the panel's screen, and the timer stops while the panel is
+ * hidden or no values arrive. The panel is hidden while it has no gauges.
+ *
+ * Enlarged mode (Driving Mode) halves the columns, so each gauge is about
+ * twice as wide. The dials are re-rendered once for the new size; the
+ * per-frame work stays a needle and a readout per gauge.
+ */
+class GaugePanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GaugePanel(QWidget *parent = nullptr);
+    ~GaugePanel() = default;
+
+    /**
+     * @brief Adds a gauge, or returns the existing one for @p pidId.
+     */
+    GaugeWidget* addGauge(const QString& pidId, const QString& label, const QString& unit,
+                          double minValue, double maxValue);
+    GaugeWidget* gauge(const QString& pidId) const;
+    bool hasGauge(const QString& pidId) const { return m_gaugeIndex.contains(pidId); }
+    int gaugeCount() const { return m_gauges.size(); }
+    QStringList gaugePids() const { return m_gaugeIndex.keys(); }
+    void clearGauges();
+
+    /**
+     * @brief Records a value; it is drawn on the next frame.
+     */
+    void setValue(const QString& pidId, double value);
+
+    void setEnlarged(bool enlarged);
+    bool isEnlarged() const { return m_enlarged; }
+
+    /**
+     * @brief Overrides the screen's refresh rate as the frame rate.
+     */
+    void setFrameRate(int hz);
+    int frameRate() const { return m_frameRate; }
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onFrameTick();
+
+private:
+    void relayout();
+
+    QGridLayout* m_layout = nullptr;
+    QVector<GaugeWidget*> m_gauges;
+    QHash<QString, int> m_gaugeIndex;
+    QTimer* m_frameTimer = nullptr;
+    int m_frameRate = 60;
+    bool m_frameRateSet = false;        // Set by setFrameRate(); otherwise follows the screen
+    int m_idleTicks = 0;
+    bool m_enlarged = false;
+
+    static constexpr int COLUMNS = 4;
+    static constexpr int ENLARGED_COLUMNS = 2;
+};
+
+#endif // GAUGEPANEL_H
@@ -0,0 +1,327 @@
+#include "GaugeWidget.h"
+#include <QEvent>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPolygonF>
+#include <QRadialGradient>
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 1, 2 or 5 times a power of ten, giving about targetTicks intervals
+double niceStep(double span, int targetTicks)
+{
+    const double raw = span / qMax(1, targetTicks);
+    const double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    const double normalized = raw / magnitude;
+    if (normalized < 1.5) {
+        return magnitude;
+    }
+    if (normalized < 3.0) {
+        return 2.0 * magnitude;
+    }
+    if (normalized < 7.0) {
+        return 5.0 * magnitude;
+    }
+    return 10.0 * magnitude;
+}
+
+QPointF polar(const QPointF& center, double radius, double angleDegrees)
+{
+    const double radians = qDegreesToRadians(angleDegrees);
+    return QPointF(center.x() + radius * std::cos(radians), center.y() - radius * std::sin(radians));
+}
+
+} // namespace
+
+GaugeWidget::GaugeWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_warningValue(std::numeric_limits<double>::quiet_NaN())
+{
+    // The dial pixmap covers every pixel of any exposed region
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    m_angle = valueToAngle(m_value);
+    m_readout = readoutText(m_value);
+}
+
+void GaugeWidget::setLabel(const QString& label)
+{
+    if (m_label != label) {
+        m_label = label;
+        invalidateDial();
+    }
+}
+
+void GaugeWidget::setUnit(const QString& unit)
+{
+    if (m_unit != unit) {
+        m_unit = unit;
+        m_readout = readoutText(m_value);
+        update(readoutRect());
+    }
+}
+
+void GaugeWidget::setRange(double minValue, double maxValue)
+{
+    m_minValue = minValue;
+    m_maxValue = (maxValue > minValue) ? maxValue : minValue + 1.0;
+    m_angle = valueToAngle(m_value);
+    invalidateDial();
+}
+
+void GaugeWidget::setWarningValue(double value)
+{
+    m_warningValue = value;
+    invalidateDial();
+}
+
+void GaugeWidget::setDecimals(int decimals)
+{
+    m_decimals = qBound(0, decimals, 6);
+    m_readout = readoutText(m_value);
+    update(readoutRect());
+}
+
+void GaugeWidget::setValue(double value)
+{
+    if (std::isfinite(value)) {
+        m_pendingValue = value;
+        m_hasPending = true;
+    }
+}
+
+bool GaugeWidget::flush()
+{
+    if (!m_hasPending) {
+        return false;
+    }
+    m_hasPending = false;
+    m_value = m_pendingValue;
+
+    // Skip the repaint unless the needle tip moves a visible amount or the text changes
+    const double angle = valueToAngle(m_value);
+    const QString readout = readoutText(m_value);
+    const bool needleMoved = qAbs(qDegreesToRadians(angle - m_angle)) * m_radius >= MIN_NEEDLE_STEP;
+    const bool readoutChanged = readout != m_readout;
+    if (!needleMoved && !readoutChanged) {
+        return false;
+    }
+
+    QRegion dirty;
+    if (needleMoved) {
+        dirty += needleRect(m_angle);
+        dirty += needleRect(angle);
+        m_angle = angle;
+    }
+    if (readoutChanged) {
+        dirty += readoutRect();
+        m_readout = readout;
+    }
+    update(dirty);
+    return true;
+}
+
+QSize GaugeWidget::sizeHint() const
+{
+    return QSize(180, 180);
+}
+
+QSize GaugeWidget::minimumSizeHint() const
+{
+    return QSize(100, 100);
+}
+
+void GaugeWidget::paintEvent(QPaintEvent *event)
+{
+    const qreal dpr = devicePixelRatioF();
+    if (m_dial.isNull() || m_dialSize != size() || !qFuzzyCompare(m_dial.devicePixelRatio(), dpr)) {
+        renderDial();
+    }
+
+    QPainter painter(this);
+
+    // Static layers: a blit of just the dirty rectangles
+    for (const QRect& rect : event->region()) {
+        painter.drawPixmap(QRectF(rect), m_dial,
+                           QRectF(rect.x() * dpr, rect.y() * dpr, rect.width() * dpr, rect.height() * dpr));
+    }
+
+    painter.setClipRegion(event->region());
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (event->region().intersects(readoutRect())) {
+        drawReadout(painter);
+    }
+    drawNeedle(painter, m_angle);
+}
+
+void GaugeWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    const int side = qMin(width(), height());
+    m_center = QPointF(width() / 2.0, height() / 2.0);
+    m_radius = side / 2.0 - 2.0;
+    invalidateDial();
+}
+
+void GaugeWidget::changeEvent(QEvent *event)
+{
+    QWidget::changeEvent(event);
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        invalidateDial();
+    }
+}
+
+void GaugeWidget::invalidateDial()
+{
+    // Rendered lazily by the next paint, so several changes cost one render
+    m_dial = QPixmap();
+    update();
+}
+
+void GaugeWidget::renderDial()
+{
+    const qreal dpr = devicePixelRatioF();
+    m_dialSize = size();
+    m_dial = QPixmap(qMax(1, qCeil(width() * dpr)), qMax(1, qCeil(height() * dpr)));
+    m_dial.setDevicePixelRatio(dpr);
+    m_dial.fill(palette().color(QPalette::Window));
+    if (m_radius <= 0.0) {
+        return;
+    }
+
+    QPainter painter(&m_dial);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // Face
+    const QColor base = palette().color(QPalette::Base);
+    QRadialGradient face(m_center, m_radius);
+    face.setColorAt(0.0, base);
+    face.setColorAt(1.0, base.darker(115));
+    painter.setPen(QPen(palette().color(QPalette::Mid), 2.0));
+    painter.setBrush(face);
+    painter.drawEllipse(m_center, m_radius, m_radius);
+
+    // Warning arc
+    const double arcRadius = m_radius * 0.86;
+    const QRectF arcRect(m_center.x() - arcRadius, m_center.y() - arcRadius, 2 * arcRadius, 2 * arcRadius);
+    if (std::isfinite(m_warningValue) && m_warningValue < m_maxValue) {
+        const double from = valueToAngle(qMax(m_warningValue, m_minValue));
+        const double to = valueToAngle(m_maxValue);
+        painter.setPen(QPen(QColor(220, 50, 40), m_radius * 0.06, Qt::SolidLine, Qt::FlatCap));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawArc(arcRect, qRound(from * 16), qRound((to - from) * 16));
+    }
+
+    // Ticks and labels; large scales are labelled in thousands
+    const double span = m_maxValue - m_minValue;
+    const double major = niceStep(span, 8);
+    const double minor = major / 5.0;
+    const double labelScale = (qAbs(m_maxValue) >= 10000.0 || qAbs(m_minValue) >= 10000.0) ? 1000.0 : 1.0;
+    const QColor ink = palette().color(QPalette::Text);
+
+    QFont labelFont = font();
+    labelFont.setPixelSize(qMax(8, qRound(m_radius * 0.12)));
+    painter.setFont(labelFont);
+    const QFontMetricsF metrics(labelFont);
+
+    const double epsilon = minor * 1e-6;
+    for (double tick = std::ceil(m_minValue / minor) * minor; tick <= m_maxValue + epsilon; tick += minor) {
+        const double angle = valueToAngle(tick);
+        const bool isMajor = qAbs(std::remainder(tick, major)) < epsilon * 10;
+        const double inner = m_radius * (isMajor ? 0.76 : 0.82);
+        painter.setPen(QPen(ink, isMajor ? 2.0 : 1.0));
+        painter.drawLine(polar(m_center, inner, angle), polar(m_center, m_radius * 0.9, angle));
+
+        if (isMajor) {
+            const QString text = QString::number(tick / labelScale, 'g', 6);
+            const QSizeF textSize = metrics.size(Qt::TextSingleLine, text);
+            const QPointF anchor = polar(m_center, m_radius * 0.62, angle);
+            painter.drawText(QRectF(anchor.x() - textSize.width() / 2, anchor.y() - textSize.height() / 2,
+                                    textSize.width(), textSize.height()),
+                             Qt::AlignCenter, text);
+        }
+    }
+
+    // Name, and the label scale above the hub
+    QFont nameFont = font();
+    nameFont.setPixelSize(qMax(8, qRound(m_radius * 0.13)));
+    nameFont.setBold(true);
+    painter.setFont(nameFont);
+    painter.setPen(ink);
+    const QRectF nameRect(m_center.x() - m_radius * 0.6, m_center.y() - m_radius * 0.42,
+                          m_radius * 1.2, m_radius * 0.2);
+    painter.drawText(nameRect, Qt::AlignCenter, m_label);
+    if (labelScale > 1.0) {
+        painter.setFont(labelFont);
+        painter.drawText(nameRect.translated(0, m_radius * 0.18), Qt::AlignCenter, "x1000");
+    }
+}
+
+void GaugeWidget::drawNeedle(QPainter& painter, double angle) const
+{
+    if (m_radius <= 0.0) {
+        return;
+    }
+
+    const double halfWidth = m_radius * 0.035;
+    QPolygonF needle;
+    needle << polar(m_center, m_radius * 0.84, angle)
+           << polar(m_center, halfWidth, angle + 90.0)
+           << polar(m_center, m_radius * 0.12, angle + 180.0)
+           << polar(m_center, halfWidth, angle - 90.0);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(230, 70, 30));
+    painter.drawPolygon(needle);
+    painter.setBrush(palette().color(QPalette::Dark));
+    painter.drawEllipse(m_center, m_radius * 0.07, m_radius * 0.07);
+}
+
+void GaugeWidget::drawReadout(QPainter& painter) const
+{
+    QFont readoutFont = font();
+    readoutFont.setPixelSize(qMax(9, qRound(m_radius * 0.18)));
+    readoutFont.setBold(true);
+    painter.setFont(readoutFont);
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(readoutRect(), Qt::AlignCenter, m_readout);
+}
+
+QRect GaugeWidget::needleRect(double angle) const
+{
+    QPolygonF outline;
+    outline << polar(m_center, m_radius * 0.84, angle)
+            << polar(m_center, m_radius * 0.12, angle + 180.0);
+    const double hub = m_radius * 0.07;
+    const QRectF bounds = outline.boundingRect()
+        .united(QRectF(m_center.x() - hub, m_center.y() - hub, 2 * hub, 2 * hub));
+
+    // Room for the needle's width and antialiasing
+    const int margin = qCeil(m_radius * 0.035) + 2;
+    return bounds.toAlignedRect().adjusted(-margin, -margin, margin, margin);
+}
+
+QRect GaugeWidget::readoutRect() const
+{
+    return QRectF(m_center.x() - m_radius * 0.55, m_center.y() + m_radius * 0.36,
+                  m_radius * 1.1, m_radius * 0.3).toAlignedRect();
+}
+
+double GaugeWidget::valueToAngle(double value) const
+{
+    const double fraction = qBound(0.0, (value - m_minValue) / (m_maxValue - m_minValue), 1.0);
+    return START_ANGLE - SWEEP * fraction;
+}
+
+QString GaugeWidget::readoutText(double value) const
+{
+    const QString number = QString::number(value, 'f', m_decimals);
+    return m_unit.isEmpty() ? number : number + ' ' + m_unit;
+}
@@ -0,0 +1,102 @@
+#ifndef GAUGEWIDGET_H
+#define GAUGEWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QString>
+
+class QPainter;
+
+/**
+ * @brief The GaugeWidget class
+ * Round dial gauge for one PID.
+ *
+ * The dial (face, ticks, labels, warning arc) is rendered once into a QPixmap
+ * at the screen's device pixel ratio and only re-rendered when the size,
+ * range, palette, font or pixel ratio changes. setValue() only records the
+ * value; flush(), called once per frame by GaugePanel, invalidates just the
+ * old and new needle and the readout, and paintEvent() blits the dial under
+ * that region and draws the needle and readout on top.
+ */
+class GaugeWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GaugeWidget(QWidget *parent = nullptr);
+    ~GaugeWidget() = default;
+
+    void setLabel(const QString& label);
+    QString label() const { return m_label; }
+    void setUnit(const QString& unit);
+    QString unit() const { return m_unit; }
+
+    /**
+     * @brief Sets the value at the start and end of the scale.
+     */
+    void setRange(double minValue, double maxValue);
+    double minValue() const { return m_minValue; }
+    double maxValue() const { return m_maxValue; }
+
+    /**
+     * @brief Values from @p value up to the maximum get a red arc; NaN = none.
+     */
+    void setWarningValue(double value);
+    void setDecimals(int decimals);
+
+    /**
+     * @brief Records a value; it is shown by the next flush().
+     */
+    void setValue(double value);
+    double value() const { return m_value; }
+
+    /**
+     * @brief Applies the value from setValue() and schedules a repaint of the
+     * needle and readout if anything visible changed.
+     * @return true if a repaint was scheduled.
+     */
+    bool flush();
+    bool hasPendingValue() const { return m_hasPending; }
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    void invalidateDial();
+    void renderDial();
+    void drawNeedle(QPainter& painter, double angle) const;
+    void drawReadout(QPainter& painter) const;
+    QRect needleRect(double angle) const;
+    QRect readoutRect() const;
+    double valueToAngle(double value) const;
+    QString readoutText(double value) const;
+
+    QString m_label;
+    QString m_unit;
+    double m_minValue = 0.0;
+    double m_maxValue = 100.0;
+    double m_warningValue;
+    int m_decimals = 0;
+
+    double m_value = 0.0;
+    double m_pendingValue = 0.0;
+    bool m_hasPending = false;
+    double m_angle = 0.0;               // Needle angle of m_value, degrees
+    QString m_readout;                  // Text of m_value
+
+    QPixmap m_dial;                     // Static layers, device pixels
+    QSize m_dialSize;                   // Widget size m_dial was rendered for
+    QPointF m_center;
+    double m_radius = 0.0;
+
+    static constexpr double START_ANGLE = 225.0;    // Minimum, lower left
+    static constexpr double SWEEP = 270.0;          // Clockwise to lower right
+    static constexpr double MIN_NEEDLE_STEP = 0.25; // Pixels at the tip; smaller moves are not repainted
+};
+
+#endif // GAUGEWIDGET_H
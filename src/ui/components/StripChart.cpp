@@ -0,0 +1,376 @@
+#include "StripChart.h"
+#include <QPainter>
+#include <QFontMetrics>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QMap>
+#include <QtMath>
+
+StripChart::StripChart(QWidget *parent)
+    : QWidget(parent)
+    , m_frameTimer(new QTimer(this))
+{
+    // Every exposed pixel is painted, which lets scroll() blit the backing store
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(120);
+
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+    connect(m_frameTimer, &QTimer::timeout, this, &StripChart::onFrameTick);
+}
+
+void StripChart::addTrace(const QString& pidId, const QString& label, const QColor& color,
+                          double minValue, double maxValue, int group)
+{
+    if (m_traceIndex.contains(pidId)) {
+        return;
+    }
+
+    Trace trace;
+    trace.pidId = pidId;
+    trace.label = label;
+    trace.color = color;
+    trace.minValue = minValue;
+    trace.maxValue = (maxValue > minValue) ? maxValue : minValue + 1.0;
+    trace.group = group;
+
+    m_traceIndex.insert(pidId, m_traces.size());
+    m_traces.append(trace);
+
+    // New bands: redraw them whole on the next tick, as after a resize
+    layoutGroups();
+    clearImages();
+    m_drawnColumn = -1;
+    for (Trace& existing : m_traces) {
+        existing.lastColumn = -1;
+    }
+    update();
+}
+
+void StripChart::clearTraces()
+{
+    m_traces.clear();
+    m_traceIndex.clear();
+    m_groups.clear();
+    m_headColumn = -1;
+    m_drawnColumn = -1;
+    m_frameTimer->stop();
+    update();
+}
+
+void StripChart::setSecondsPerPixel(double secondsPerPixel)
+{
+    if (secondsPerPixel <= 0.0 || qFuzzyCompare(secondsPerPixel, m_secondsPerPixel)) {
+        return;
+    }
+
+    m_secondsPerPixel = secondsPerPixel;
+    m_headColumn = -1;
+    m_drawnColumn = -1;
+    for (Trace& trace : m_traces) {
+        trace.pending.clear();
+        trace.lastColumn = -1;
+    }
+    clearImages();
+    update();
+}
+
+void StripChart::setFrameRate(int hz)
+{
+    m_frameRate = qBound(1, hz, 240);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+}
+
+void StripChart::appendSample(const QString& pidId, double time, double value)
+{
+    auto it = m_traceIndex.constFind(pidId);
+    if (it == m_traceIndex.constEnd()) {
+        return;
+    }
+
+    const qint64 column = qFloor(time / m_secondsPerPixel);
+    if (column <= m_drawnColumn) {
+        return; // Arrived after its column was drawn
+    }
+
+    Trace& trace = m_traces[it.value()];
+    if (!trace.pending.isEmpty() && trace.pending.last().column == column) {
+        ColumnSpan& span = trace.pending.last();
+        span.last = value;
+        span.min = qMin(span.min, value);
+        span.max = qMax(span.max, value);
+    } else if (trace.pending.isEmpty() || column > trace.pending.last().column) {
+        ColumnSpan span;
+        span.column = column;
+        span.last = value;
+        span.min = value;
+        span.max = value;
+        trace.pending.append(span);
+
+        // Keep the backlog bounded while the chart is hidden
+        const int limit = qMax(64, plotRect().width());
+        if (trace.pending.size() > 2 * limit) {
+            trace.pending.remove(0, trace.pending.size() - limit);
+        }
+    }
+
+    m_headColumn = qMax(m_headColumn, column);
+
+    if (isVisible() && !m_frameTimer->isActive()) {
+        m_idleTicks = 0;
+        m_frameTimer->start();
+    }
+}
+
+void StripChart::onFrameTick()
+{
+    const QRect plot = plotRect();
+    if (plot.width() <= 0 || m_groups.isEmpty()) {
+        return;
+    }
+
+    // The newest column may still receive samples; only completed columns are drawn
+    const qint64 target = m_headColumn - 1;
+    if (target <= m_drawnColumn) {
+        if (++m_idleTicks > m_frameRate) {
+            m_frameTimer->stop();
+        }
+        return;
+    }
+    m_idleTicks = 0;
+
+    const int width = plot.width();
+    const bool fullRedraw = (m_drawnColumn < 0) || (target - m_drawnColumn >= width);
+    const qint64 firstColumn = fullRedraw ? target - width + 1 : m_drawnColumn + 1;
+    const int shift = int(target - m_drawnColumn);
+
+    if (fullRedraw) {
+        clearImages();
+    }
+    for (TraceGroup& group : m_groups) {
+        renderColumns(group, firstColumn, target);
+    }
+    m_drawnColumn = target;
+
+    if (fullRedraw) {
+        update(plot);
+    } else {
+        // Blit the existing pixels left; only the exposed columns get a paint event
+        scroll(-shift, 0, plot);
+    }
+}
+
+void StripChart::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    const QRect plot = plotRect();
+    const QColor background = palette().color(QPalette::Base);
+
+    // Legend and scale are static; only repaint them when exposed
+    if (!plot.contains(dirty)) {
+        painter.fillRect(QRect(0, 0, LEGEND_WIDTH, height()), palette().color(QPalette::Window));
+        painter.fillRect(QRect(plot.left(), plot.bottom() + 1, plot.width(), height() - plot.bottom() - 1),
+                         palette().color(QPalette::Window));
+        for (const TraceGroup& group : m_groups) {
+            paintLegend(painter, group);
+        }
+        painter.setPen(palette().color(QPalette::WindowText));
+        painter.drawText(QRect(plot.left(), plot.bottom() + 1, plot.width(), height() - plot.bottom() - 1),
+                         Qt::AlignRight | Qt::AlignVCenter,
+                         QString("grid: %1 s").arg(m_gridSeconds));
+    }
+
+    const QRect plotDirty = dirty.intersected(plot);
+    if (plotDirty.isEmpty()) {
+        return;
+    }
+    painter.fillRect(plotDirty, background);
+
+    if (m_drawnColumn < 0) {
+        return;
+    }
+
+    for (const TraceGroup& group : m_groups) {
+        const QRect band = group.rect.intersected(plotDirty);
+        if (band.isEmpty() || group.image.isNull()) {
+            continue;
+        }
+
+        // Screen columns map onto at most two contiguous runs of the ring image
+        const int imageWidth = group.image.width();
+        int x = band.left();
+        while (x <= band.right()) {
+            const qint64 column = m_drawnColumn - (plot.right() - x);
+            const int rx = ringX(column);
+            const int run = qMin(band.right() - x + 1, imageWidth - rx);
+            painter.drawImage(QRect(x, band.top(), run, band.height()), group.image,
+                              QRect(rx, band.top() - group.rect.top(), run, band.height()));
+            x += run;
+        }
+    }
+}
+
+void StripChart::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    // Ring contents depend on the plot width; restart from the next tick
+    layoutGroups();
+    clearImages();
+    m_drawnColumn = -1;
+    for (Trace& trace : m_traces) {
+        trace.lastColumn = -1;
+    }
+}
+
+void StripChart::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (!m_traces.isEmpty()) {
+        m_idleTicks = 0;
+        m_frameTimer->start();
+    }
+}
+
+void StripChart::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_frameTimer->stop();
+}
+
+void StripChart::layoutGroups()
+{
+    // Distinct group ids in ascending order, one band each
+    QMap<int, QVector<int>> byGroup;
+    for (int i = 0; i < m_traces.size(); ++i) {
+        byGroup[m_traces[i].group].append(i);
+    }
+
+    m_groups.clear();
+    const QRect plot = plotRect();
+    const int count = byGroup.size();
+    if (count == 0 || plot.width() <= 0 || plot.height() <= 0) {
+        return;
+    }
+
+    const int spacing = 4;
+    const int bandHeight = qMax(1, (plot.height() - spacing * (count - 1)) / count);
+    int top = plot.top();
+    for (auto it = byGroup.constBegin(); it != byGroup.constEnd(); ++it) {
+        TraceGroup group;
+        group.traces = it.value();
+        group.rect = QRect(plot.left(), top, plot.width(), bandHeight);
+        group.image = QImage(plot.width(), bandHeight, QImage::Format_RGB32);
+        m_groups.append(group);
+        top += bandHeight + spacing;
+    }
+}
+
+void StripChart::clearImages()
+{
+    const QColor background = palette().color(QPalette::Base);
+    for (TraceGroup& group : m_groups) {
+        group.image.fill(background);
+    }
+}
+
+void StripChart::renderColumns(TraceGroup& group, qint64 firstColumn, qint64 lastColumn)
+{
+    const int height = group.image.height();
+    const QColor background = palette().color(QPalette::Base);
+    const QColor grid = palette().color(QPalette::Midlight);
+    const double columnsPerGrid = m_gridSeconds / m_secondsPerPixel;
+
+    QPainter painter(&group.image);
+
+    // Background and grid for the new columns
+    for (qint64 column = firstColumn; column <= lastColumn; ++column) {
+        const int x = ringX(column);
+        painter.fillRect(x, 0, 1, height, background);
+        if (qFloor(column / columnsPerGrid) != qFloor((column - 1) / columnsPerGrid)) {
+            painter.fillRect(x, 0, 1, height, grid);
+        } else {
+            painter.setPen(grid);
+            painter.drawPoint(x, height / 4);
+            painter.drawPoint(x, height / 2);
+            painter.drawPoint(x, 3 * height / 4);
+        }
+    }
+
+    // Traces: one vertical stroke per column covering the samples in it, joined to
+    // the previous column so the line stays continuous
+    for (int traceIdx : group.traces) {
+        Trace& trace = m_traces[traceIdx];
+        painter.setPen(trace.color);
+
+        int consumed = 0;
+        for (qint64 column = firstColumn; column <= lastColumn; ++column) {
+            while (consumed < trace.pending.size() && trace.pending[consumed].column < column) {
+                ++consumed; // Stale span from before the visible window
+            }
+
+            const int x = ringX(column);
+            if (consumed < trace.pending.size() && trace.pending[consumed].column == column) {
+                const ColumnSpan& span = trace.pending[consumed++];
+                double lo = span.min;
+                double hi = span.max;
+                if (trace.lastColumn >= 0 && column - trace.lastColumn <= MAX_HOLD_COLUMNS) {
+                    lo = qMin(lo, trace.lastValue);
+                    hi = qMax(hi, trace.lastValue);
+                }
+                painter.drawLine(x, valueToY(trace, hi, height), x, valueToY(trace, lo, height));
+                trace.lastColumn = column;
+                trace.lastValue = span.last;
+            } else if (trace.lastColumn >= 0 && column - trace.lastColumn <= MAX_HOLD_COLUMNS) {
+                // Hold the last value until the next (slower) sample arrives
+                painter.drawPoint(x, valueToY(trace, trace.lastValue, height));
+            }
+        }
+
+        if (consumed > 0) {
+            trace.pending.remove(0, consumed);
+        }
+    }
+}
+
+void StripChart::paintLegend(QPainter& painter, const TraceGroup& group)
+{
+    const QFontMetrics metrics = painter.fontMetrics();
+    int y = group.rect.top() + metrics.ascent() + 2;
+
+    for (int traceIdx : group.traces) {
+        const Trace& trace = m_traces[traceIdx];
+        if (y > group.rect.bottom()) {
+            break;
+        }
+        painter.setPen(trace.color);
+        painter.drawText(6, y, metrics.elidedText(trace.label, Qt::ElideRight, LEGEND_WIDTH - 12));
+        y += metrics.height();
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(6, y, QString("%1 .. %2").arg(trace.minValue).arg(trace.maxValue));
+        y += metrics.height() + 2;
+    }
+}
+
+int StripChart::ringX(qint64 column) const
+{
+    const qint64 width = m_groups.isEmpty() ? 1 : qMax(1, m_groups.first().image.width());
+    qint64 x = column % width;
+    if (x < 0) {
+        x += width;
+    }
+    return int(x);
+}
+
+int StripChart::valueToY(const Trace& trace, double value, int height) const
+{
+    const double ratio = (value - trace.minValue) / (trace.maxValue - trace.minValue);
+    const int y = qRound((1.0 - qBound(0.0, ratio, 1.0)) * (height - 1));
+    return y;
+}
+
+QRect StripChart::plotRect() const
+{
+    return rect().adjusted(LEGEND_WIDTH, 0, 0, -18);
+}
@@ -0,0 +1,130 @@
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include <QWidget>
+#include <QImage>
+#include <QColor>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+
+class QPainter;
+
+/**
+ * @brief The StripChart class
+ * Real-time scrolling chart for live PID data.
+ *
+ * Traces are grouped into horizontal bands that share one time axis; one pixel
+ * column covers a fixed time slice. Each band is backed by a ring-buffer QImage,
+ * so new samples only ever draw the columns that just completed. Samples are
+ * buffered and flushed once per frame tick, the widget content is scrolled with
+ * QWidget::scroll(), and only the exposed columns are repainted.
+ */
+class StripChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StripChart(QWidget *parent = nullptr);
+    ~StripChart() = default;
+
+    /**
+     * @brief Adds a trace.
+     * @param pidId PID identifier used by appendSample().
+     * @param label Legend text.
+     * @param color Trace color.
+     * @param minValue Value drawn at the bottom of the band.
+     * @param maxValue Value drawn at the top of the band.
+     * @param group Band the trace is overlaid in (traces in one group share a band).
+     */
+    void addTrace(const QString& pidId, const QString& label, const QColor& color,
+                  double minValue, double maxValue, int group = 0);
+
+    /**
+     * @brief Removes all traces and clears the chart.
+     */
+    void clearTraces();
+
+    bool hasTrace(const QString& pidId) const { return m_traceIndex.contains(pidId); }
+
+    /**
+     * @brief Sets the horizontal scale shared by all traces. Clears the chart.
+     */
+    void setSecondsPerPixel(double secondsPerPixel);
+    double secondsPerPixel() const { return m_secondsPerPixel; }
+
+    /**
+     * @brief Sets how often buffered samples are flushed to the screen.
+     */
+    void setFrameRate(int hz);
+    int frameRate() const { return m_frameRate; }
+
+    /**
+     * @brief Buffers a sample; it is drawn on the next frame tick.
+     * @param pidId PID identifier of a trace added with addTrace().
+     * @param time Sample time in seconds since session start (ascending per trace).
+     * @param value Sample value.
+     */
+    void appendSample(const QString& pidId, double time, double value);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onFrameTick();
+
+private:
+    // Samples that fell into one pixel column
+    struct ColumnSpan {
+        qint64 column = 0;
+        double last = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+    };
+
+    struct Trace {
+        QString pidId;
+        QString label;
+        QColor color;
+        double minValue = 0.0;
+        double maxValue = 1.0;
+        int group = 0;
+        QVector<ColumnSpan> pending;   // Not yet drawn
+        qint64 lastColumn = -1;        // Last drawn column
+        double lastValue = 0.0;        // Last drawn value
+    };
+
+    struct TraceGroup {
+        QImage image;                  // Ring buffer, one pixel column per time slice
+        QVector<int> traces;
+        QRect rect;                    // Band rectangle in widget coordinates
+    };
+
+    void layoutGroups();
+    void clearImages();
+    void renderColumns(TraceGroup& group, qint64 firstColumn, qint64 lastColumn);
+    void paintLegend(QPainter& painter, const TraceGroup& group);
+    int ringX(qint64 column) const;
+    int valueToY(const Trace& trace, double value, int height) const;
+    QRect plotRect() const;
+
+    QVector<Trace> m_traces;
+    QHash<QString, int> m_traceIndex;
+    QVector<TraceGroup> m_groups;
+
+    double m_secondsPerPixel = 0.05;
+    int m_gridSeconds = 5;
+    int m_frameRate = 60;
+    qint64 m_headColumn = -1;          // Newest column that has data
+    qint64 m_drawnColumn = -1;         // Rightmost column rendered into the rings
+    QTimer* m_frameTimer = nullptr;
+    int m_idleTicks = 0;
+
+    static constexpr int LEGEND_WIDTH = 110;
+    static constexpr int MAX_HOLD_COLUMNS = 40;  // Bridge gaps between slow samples
+};
+
+#endif // STRIPCHART_H
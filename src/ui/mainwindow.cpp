@@ -4,7 +4,12 @@
 #include "core/dto/ConnectionState.h"
 #include "core/dto/ScanResult.h"
 #include "core/ScanService.h"
+#include "core/StartupProfiler.h"
+#include "core/TriggerEngine.h"
 #include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QVBoxLayout>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -13,11 +18,16 @@ MainWindow::MainWindow(QWidget *parent)
 {
     // Initialize base UI widgets
     ui->setupUi(this);
+    StartupProfiler::mark("main window ui");
 
     // Create backend objects
     m_appState = new AppState(this); // Create AppState
     m_transporter = new SerialTransporter(this); // Create transporter
     m_scanService = new ScanService(m_transporter, this); // Create scan service
+    m_readinessTracker = new ReadinessTracker(m_scanService, this); // Drive cycle polling shares the scan queue
+    m_appState->triggers()->setCaptureDirectory(
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/captures");
+    StartupProfiler::mark("backend");
 
     // Setup UI (tabs, status bar, etc.)
     setupUI();
@@ -25,6 +35,7 @@ MainWindow::MainWindow(QWidget *parent)
     // Final wiring
     setupConnections(); // Setup signal connections
     updateConnectionState(); // Initial connection state
+    StartupProfiler::mark("connections");
 }
 
 MainWindow::~MainWindow()
@@ -40,34 +51,15 @@ void MainWindow::setupUI()
     m_tabWidget = new QTabWidget(this);
     setCentralWidget(m_tabWidget);
 
-    // Create all views
-    m_homeView = new HomeView(this);
-    m_codesView = new CodesView(this);
-    m_liveDataView = new LiveDataView(this);
-    m_readinessView = new ReadinessView(this);
-    m_advancedView = new AdvancedView(this);
-    m_logsView = new LogsView(this);
-    m_settingsView = new SettingsView(this);
-
-    // Set AppState on all views
-    m_homeView->setAppState(m_appState);
-    m_homeView->setScanService(m_scanService);
-    m_homeView->setTransporter(m_transporter);
-    m_codesView->setAppState(m_appState);
-    m_liveDataView->setAppState(m_appState);
-    m_readinessView->setAppState(m_appState);
-    m_advancedView->setAppState(m_appState);
-    m_logsView->setAppState(m_appState);
-    m_settingsView->setAppState(m_appState);
-
-    // Add tabs
-    m_tabWidget->addTab(m_homeView, "Home/Health");
-    m_tabWidget->addTab(m_codesView, "Codes");
-    m_tabWidget->addTab(m_liveDataView, "Live Data");
-    m_tabWidget->addTab(m_readinessView, "Readiness");
-    m_tabWidget->addTab(m_advancedView, "Advanced");
-    m_tabWidget->addTab(m_logsView, "Logs");
-    m_tabWidget->addTab(m_settingsView, "Settings");
+    // One empty page per tab; views are built when their tab is first shown
+    const QStringList titles = {"Home/Health", "Codes", "Live Data", "Readiness", "Advanced", "Logs", "Settings"};
+    for (const QString& title : titles) {
+        QWidget* page = new QWidget(m_tabWidget);
+        QVBoxLayout* layout = new QVBoxLayout(page);
+        layout->setContentsMargins(0, 0, 0, 0);
+        m_tabWidget->addTab(page, title);
+        m_tabPages.append(page);
+    }
 
     // Create and add status bar component
     m_statusBar = new StatusBar(this);
@@ -75,6 +67,167 @@ void MainWindow::setupUI()
     
     // Add status bar to main window's status bar area
     statusBar()->addPermanentWidget(m_statusBar, 1);
+    StartupProfiler::mark("tabs");
+
+    // Only the view on screen is built before the first paint
+    onCurrentTabChanged(m_tabWidget->currentIndex());
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onCurrentTabChanged);
+}
+
+void MainWindow::onCurrentTabChanged(int index)
+{
+    if (index == m_currentTab) {
+        return;
+    }
+
+    // Hidden views hold no AppState subscriptions; setAppState() brings a
+    // view up to date when it is shown again
+    if (m_currentTab >= 0) {
+        setViewAppState(m_currentTab, nullptr);
+    }
+    m_currentTab = index;
+    if (index < 0) {
+        return;
+    }
+
+    ensureView(index);
+    setViewAppState(index, m_appState);
+}
+
+void MainWindow::ensureView(int tab)
+{
+    QWidget* page = m_tabPages.value(tab);
+    if (!page || page->layout()->count() > 0) {
+        return;
+    }
+
+    QWidget* view = nullptr;
+    switch (tab) {
+    case HomeTab:
+        m_homeView = new HomeView(page);
+        m_homeView->setScanService(m_scanService);
+        m_homeView->setTransporter(m_transporter);
+        view = m_homeView;
+        break;
+    case CodesTab:
+        m_codesView = new CodesView(page);
+        m_codesView->setDtcModel(m_appState->dtcModel());
+        view = m_codesView;
+        break;
+    case LiveDataTab:
+        view = m_liveDataView = new LiveDataView(page);
+        break;
+    case ReadinessTab:
+        m_readinessView = new ReadinessView(page);
+        m_readinessView->setReadinessTracker(m_readinessTracker);
+        view = m_readinessView;
+        break;
+    case AdvancedTab:
+        view = m_advancedView = new AdvancedView(page);
+        break;
+    case LogsTab:
+        m_logsView = new LogsView(page);
+        m_logsView->setLogCatalog(logCatalog());
+        view = m_logsView;
+        break;
+    case SettingsTab:
+        view = m_settingsView = new SettingsView(page);
+        break;
+    default:
+        return;
+    }
+    page->layout()->addWidget(view);
+
+    // Part of the startup profile for the first tab; ignored once interactive
+    StartupProfiler::mark(m_tabWidget->tabText(tab) + " view");
+}
+
+ScanHistoryStore* MainWindow::historyStore()
+{
+    if (!m_historyStore) {
+        // Scan history lives next to the other per-user application data
+        const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dataDir);
+        m_historyStore = new ScanHistoryStore(dataDir + "/history.sqlite", this);
+        if (!m_historyStore->open()) {
+            qDebug() << "Scan history unavailable:" << m_historyStore->lastError();
+            delete m_historyStore;
+            m_historyStore = nullptr;
+        }
+    }
+    return m_historyStore;
+}
+
+LogCatalog* MainWindow::logCatalog()
+{
+    if (!m_logCatalog) {
+        // The catalog sits next to the log directory, not in it, so its own
+        // writes do not wake the directory watcher
+        const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dataDir + "/logs");
+        m_logCatalog = new LogCatalog(dataDir + "/logs", dataDir + "/log-catalog.sqlite", this);
+        if (!m_logCatalog->open()) {
+            qDebug() << "Log catalog unavailable:" << m_logCatalog->lastError();
+            delete m_logCatalog;
+            m_logCatalog = nullptr;
+        }
+    }
+    return m_logCatalog;
+}
+
+void MainWindow::setViewAppState(int tab, AppState* appState)
+{
+    switch (tab) {
+    case HomeTab:
+        if (m_homeView) {
+            m_homeView->setAppState(appState);
+        }
+        break;
+    case CodesTab:
+        break;      // CodesView reads AppState::dtcModel(), which is fed while hidden too
+    case LiveDataTab:
+        if (m_liveDataView) {
+            m_liveDataView->setAppState(appState);
+        }
+        break;
+    case ReadinessTab:
+        if (m_readinessView) {
+            m_readinessView->setAppState(appState);
+        }
+        break;
+    case AdvancedTab:
+        if (m_advancedView) {
+            m_advancedView->setAppState(appState);
+        }
+        break;
+    case LogsTab:
+        if (m_logsView) {
+            m_logsView->setAppState(appState);
+        }
+        break;
+    case SettingsTab:
+        if (m_settingsView) {
+            m_settingsView->setAppState(appState);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool MainWindow::event(QEvent *event)
+{
+    const bool handled = QMainWindow::event(event);
+
+    if (event->type() == QEvent::Paint && StartupProfiler::firstPaintNs() < 0) {
+        StartupProfiler::markFirstPaint();
+        // Runs once the event loop has nothing left from startup
+        QTimer::singleShot(0, this, [this]() {
+            StartupProfiler::markInteractive();
+            emit interactive();
+        });
+    }
+    return handled;
 }
 
 void MainWindow::setupConnections()
@@ -88,6 +241,7 @@ void MainWindow::setupConnections()
     connect(m_scanService, &ScanService::connectionComplete, this, &MainWindow::onConnectionComplete);
     connect(m_scanService, &ScanService::connectionFailed, this, &MainWindow::onConnectionFailed);
     connect(m_scanService, &ScanService::adapterConnectedNoEcu, this, &MainWindow::onAdapterConnectedNoEcu);
+    connect(m_scanService, &ScanService::scanUpdated, this, &MainWindow::onScanUpdated);
     connect(m_scanService, &ScanService::scanComplete, this, &MainWindow::onScanComplete);
     connect(m_scanService, &ScanService::scanFailed, this, &MainWindow::onScanFailed);
 }
@@ -129,6 +283,7 @@ void MainWindow::onTransporterConnected()
 void MainWindow::onTransporterDisconnected()
 {
     qDebug() << "Disconnected.";
+    m_readinessTracker->stop();
     ConnectionStateInfo info;
     info.state = ConnectionState::Disconnected;
     info.protocolName.clear();
@@ -170,10 +325,44 @@ void MainWindow::onAdapterConnectedNoEcu()
     m_appState->setConnectionState(info);
 }
 
+void MainWindow::onScanUpdated(const ScanResult& partial, quint32 changedItems)
+{
+    Q_UNUSED(changedItems);
+
+    // Each reply becomes a new snapshot version, so views show data as it arrives
+    m_appState->setLastScanResult(partial);
+}
+
 void MainWindow::onScanComplete(const ScanResult& result)
 {
     qDebug() << "Scan complete, DTCs found:" << result.dtcs.size();
-    m_appState->setLastScanResult(result);
+
+    ScanResult entry = result;
+    if (entry.vin.isEmpty()) {
+        entry.vin = m_appState->selectedVehicleProfile().vin;
+    }
+
+    // First scan of this vehicle in this session: compare with its last stored scan
+    ScanHistoryStore* history = historyStore();
+    if (history && !entry.vin.isEmpty() && !m_appState->hasScanBaseline(entry.vin)) {
+        const QVector<ScanResult> previous = history->scansForVehicle(entry.vin, 1);
+        if (!previous.isEmpty()) {
+            m_appState->setScanBaseline(previous.first());
+        }
+    }
+
+    m_appState->setLastScanResult(entry);
+
+    if (result.timedOut) {
+        // Shown, but not stored: a later scan would be compared with it
+        ConnectionStateInfo info = m_appState->connectionState();
+        info.lastError = "Scan timed out; showing the items read before the timeout";
+        m_appState->setConnectionState(info);
+        return;
+    }
+    if (history) {
+        history->record(entry);
+    }
 }
 
 void MainWindow::onScanFailed(const QString& errorMessage)
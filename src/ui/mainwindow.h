@@ -5,9 +5,13 @@
 #include <QQueue>
 #include <QByteArray>
 #include <QTabWidget>
+#include <QVector>
 
 #include "hardware/ObdTransporter.h"
 #include "core/ScanService.h"
+#include "core/ReadinessTracker.h"
+#include "core/ScanHistoryStore.h"
+#include "core/LogCatalog.h"
 #include "ui/state/AppState.h"
 #include "ui/components/StatusBar.h"
 #include "ui/views/HomeView.h"
@@ -33,6 +37,7 @@ public:
     ~MainWindow();
     ObdTransporter* m_transporter;
     ScanService* m_scanService;
+    ReadinessTracker* m_readinessTracker;
 
 private slots:
     void onTransporterConnected();
@@ -41,18 +46,44 @@ private slots:
     void onConnectionComplete(const QString& protocolName);
     void onConnectionFailed(const QString& errorMessage);
     void onAdapterConnectedNoEcu();
+    void onScanUpdated(const ScanResult& partial, quint32 changedItems);
     void onScanComplete(const ScanResult& result);
     void onScanFailed(const QString& errorMessage);
+    void onCurrentTabChanged(int index);
+
+signals:
+    /**
+     * @brief Emitted once, when the event loop is idle after the first paint.
+     */
+    void interactive();
+
+protected:
+    bool event(QEvent *event) override;
 
 private:
+    enum Tab {
+        HomeTab,
+        CodesTab,
+        LiveDataTab,
+        ReadinessTab,
+        AdvancedTab,
+        LogsTab,
+        SettingsTab,
+        TabCount
+    };
+
     Ui::MainWindow *ui;
 
     // App state and UI components
     AppState* m_appState = nullptr;
+    ScanHistoryStore* m_historyStore = nullptr;  // Opened with the first completed scan
+    LogCatalog* m_logCatalog = nullptr;        // Opened with the Logs tab
     StatusBar* m_statusBar = nullptr;
     QTabWidget* m_tabWidget = nullptr;
     
-    // Views
+    // Views; each is built into its tab page on first activation
+    QVector<QWidget*> m_tabPages;
+    int m_currentTab = -1;
     HomeView* m_homeView = nullptr;
     CodesView* m_codesView = nullptr;
     LiveDataView* m_liveDataView = nullptr;
@@ -64,6 +95,10 @@ private:
     void setupUI();
     void setupConnections();
     void updateConnectionState();
+    void ensureView(int tab);
+    ScanHistoryStore* historyStore();
+    LogCatalog* logCatalog();
+    void setViewAppState(int tab, AppState* appState);
 };
 
 #endif // MAINWINDOW_H
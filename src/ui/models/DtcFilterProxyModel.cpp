@@ -0,0 +1,86 @@
+#include "DtcFilterProxyModel.h"
+#include "DtcTableModel.h"
+
+DtcFilterProxyModel::DtcFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    // Rows are re-filtered as the model inserts them
+    setDynamicSortFilter(true);
+}
+
+void DtcFilterProxyModel::setDtcModel(DtcTableModel* model)
+{
+    if (m_model == model) {
+        return;
+    }
+
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+
+    m_model = model;
+    m_selected = m_model && !m_filter.isEmpty() ? m_model->store().select(m_filter) : DtcStore::RowSet();
+
+    // Connected before setSourceModel() so it runs ahead of the proxy's own
+    // reset handling, which re-filters every row
+    if (m_model) {
+        connect(m_model, &QAbstractItemModel::modelReset, this, [this]() {
+            m_selected = m_filter.isEmpty() ? DtcStore::RowSet() : m_model->store().select(m_filter);
+        });
+    }
+    setSourceModel(m_model);
+}
+
+void DtcFilterProxyModel::setStatusFilter(quint8 statuses)
+{
+    statuses &= DtcStore::ALL_STATUSES;
+    if (m_filter.statuses != statuses) {
+        m_filter.statuses = statuses;
+        refilter();
+    }
+}
+
+void DtcFilterProxyModel::setCategoryFilter(quint8 categories)
+{
+    categories &= DtcStore::ALL_CATEGORIES;
+    if (m_filter.categories != categories) {
+        m_filter.categories = categories;
+        refilter();
+    }
+}
+
+void DtcFilterProxyModel::setTextFilter(const QString& text)
+{
+    const QString trimmed = text.trimmed();
+    if (m_filter.text != trimmed) {
+        m_filter.text = trimmed;
+        refilter();
+    }
+}
+
+void DtcFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    if (m_model) {
+        m_model->sort(column, order);
+    }
+}
+
+bool DtcFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+
+    if (!m_model || m_filter.isEmpty()) {
+        return true;
+    }
+    const int storeRow = m_model->storeRow(sourceRow);
+    if (storeRow < m_selected.size) {
+        return m_selected.test(storeRow);
+    }
+    return m_model->store().matches(storeRow, m_filter);
+}
+
+void DtcFilterProxyModel::refilter()
+{
+    m_selected = m_model && !m_filter.isEmpty() ? m_model->store().select(m_filter) : DtcStore::RowSet();
+    invalidate();
+}
@@ -0,0 +1,55 @@
+#ifndef DTCFILTERPROXYMODEL_H
+#define DTCFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include "core/DtcStore.h"
+
+class DtcTableModel;
+
+/**
+ * @brief The DtcFilterProxyModel class
+ * Filters a DtcTableModel by status, category and text without formatting a
+ * single cell.
+ *
+ * A filter change asks the store for the matching rows once (see
+ * DtcStore::select()); filterAcceptsRow() is then a bit test. Rows the model
+ * inserts later are checked one by one with DtcStore::matches(). A filter
+ * change rebuilds the mapping in one pass: removing thousands of scattered
+ * rows one interval at a time costs far more than re-testing every bit.
+ *
+ * sort() is passed on to the model, which sorts its own rows, so the proxy
+ * keeps source order.
+ */
+class DtcFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit DtcFilterProxyModel(QObject *parent = nullptr);
+    ~DtcFilterProxyModel() = default;
+
+    /**
+     * @brief The model to filter; the proxy only accepts a DtcTableModel.
+     */
+    void setDtcModel(DtcTableModel* model);
+    DtcTableModel* dtcModel() const { return m_model; }
+
+    void setStatusFilter(quint8 statuses);
+    void setCategoryFilter(quint8 categories);
+    void setTextFilter(const QString& text);
+    DtcStore::Filter filter() const { return m_filter; }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    void refilter();
+
+    DtcTableModel* m_model = nullptr;
+    DtcStore::Filter m_filter;
+    DtcStore::RowSet m_selected;        // Store rows that matched m_filter when it was set
+};
+
+#endif // DTCFILTERPROXYMODEL_H
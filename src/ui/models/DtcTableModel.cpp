@@ -0,0 +1,207 @@
+#include "DtcTableModel.h"
+#include <QDateTime>
+#include <algorithm>
+#include <numeric>
+
+DtcTableModel::DtcTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void DtcTableModel::appendScan(const ScanResult& result)
+{
+    const qint64 timestampMs = result.timestamp.isValid() ? result.timestamp.toMSecsSinceEpoch() : 0;
+    appendDtcs(result.vin, result.dtcs, timestampMs);
+}
+
+void DtcTableModel::appendDtcs(const QString& vin, const QVector<DtcEntry>& dtcs, qint64 timestampMs)
+{
+    if (dtcs.isEmpty()) {
+        return;
+    }
+
+    if (m_sortColumn < 0) {
+        const int first = m_store.rowCount();
+        beginInsertRows(QModelIndex(), first, first + dtcs.size() - 1);
+        m_store.append(vin, dtcs, timestampMs);
+        endInsertRows();
+        return;
+    }
+
+    // Sorted: each new row goes after the rows that sort equal to it
+    const int first = m_store.append(vin, dtcs, timestampMs);
+    for (int storeRow = first; storeRow < m_store.rowCount(); ++storeRow) {
+        const auto position = std::upper_bound(m_order.begin(), m_order.end(), storeRow,
+                                               [this](int a, int b) { return rowLessThan(a, b); });
+        const int row = int(position - m_order.begin());
+        beginInsertRows(QModelIndex(), row, row);
+        m_order.insert(row, storeRow);
+        endInsertRows();
+    }
+}
+
+void DtcTableModel::clear()
+{
+    beginResetModel();
+    m_store.clear();
+    m_order.clear();
+    endResetModel();
+}
+
+void DtcTableModel::sort(int column, Qt::SortOrder order)
+{
+    if (column >= ColumnCount) {
+        return;
+    }
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList persistent = persistentIndexList();
+    QVector<int> persistentStoreRows;
+    persistentStoreRows.reserve(persistent.size());
+    for (const QModelIndex& index : persistent) {
+        persistentStoreRows.append(storeRow(index.row()));
+    }
+
+    m_sortColumn = qMax(-1, column);
+    m_sortOrder = order;
+    if (m_sortColumn < 0) {
+        m_order.clear();
+    } else {
+        m_order.resize(m_store.rowCount());
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::stable_sort(m_order.begin(), m_order.end(), [this](int a, int b) { return rowLessThan(a, b); });
+    }
+
+    // Selections and the proxy's mapping follow their rows to the new positions
+    QVector<int> rowOf(m_store.rowCount());
+    for (int row = 0; row < rowOf.size(); ++row) {
+        rowOf[storeRow(row)] = row;
+    }
+    QModelIndexList moved;
+    moved.reserve(persistent.size());
+    for (int i = 0; i < persistent.size(); ++i) {
+        moved.append(index(rowOf[persistentStoreRows[i]], persistent[i].column()));
+    }
+    changePersistentIndexList(persistent, moved);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+bool DtcTableModel::rowLessThan(int a, int b) const
+{
+    if (m_sortOrder == Qt::DescendingOrder) {
+        std::swap(a, b);
+    }
+
+    switch (m_sortColumn) {
+    case CodeColumn:
+        return m_store.codeRank(a) < m_store.codeRank(b);
+    case StatusColumn:
+        return m_store.status(a) < m_store.status(b);
+    case CategoryColumn:
+        return m_store.category(a) < m_store.category(b);
+    case ModuleColumn:
+        return m_store.moduleRank(a) < m_store.moduleRank(b);
+    case VinColumn:
+        return m_store.vinRank(a) < m_store.vinRank(b);
+    case TimeColumn:
+        return m_store.timestampMs(a) < m_store.timestampMs(b);
+    default:
+        return false;
+    }
+}
+
+int DtcTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_sortColumn < 0 ? m_store.rowCount() : m_order.size();
+}
+
+int DtcTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant DtcTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const int row = storeRow(index.row());
+    switch (index.column()) {
+    case CodeColumn:
+        return m_store.code(row);
+    case StatusColumn:
+        return statusText(m_store.status(row));
+    case CategoryColumn:
+        return categoryText(m_store.category(row));
+    case ModuleColumn:
+        return m_store.module(row);
+    case VinColumn:
+        return m_store.vin(row);
+    case TimeColumn: {
+        const qint64 timestampMs = m_store.timestampMs(row);
+        if (timestampMs == 0) {
+            return QVariant();
+        }
+        return QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyy-MM-dd hh:mm");
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant DtcTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case CodeColumn:
+        return "Code";
+    case StatusColumn:
+        return "Status";
+    case CategoryColumn:
+        return "Category";
+    case ModuleColumn:
+        return "Module";
+    case VinColumn:
+        return "VIN";
+    case TimeColumn:
+        return "Time";
+    default:
+        return QVariant();
+    }
+}
+
+QString DtcTableModel::statusText(DtcStatus status)
+{
+    switch (status) {
+    case DtcStatus::Confirmed:
+        return "Confirmed";
+    case DtcStatus::Pending:
+        return "Pending";
+    case DtcStatus::Permanent:
+        return "Permanent";
+    }
+    return QString();
+}
+
+QString DtcTableModel::categoryText(DtcCategory category)
+{
+    switch (category) {
+    case DtcCategory::P:
+        return "Powertrain";
+    case DtcCategory::B:
+        return "Body";
+    case DtcCategory::C:
+        return "Chassis";
+    case DtcCategory::U:
+        return "Network";
+    }
+    return QString();
+}
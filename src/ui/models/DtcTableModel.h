@@ -0,0 +1,78 @@
+#ifndef DTCTABLEMODEL_H
+#define DTCTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include "core/DtcStore.h"
+#include "core/dto/ScanResult.h"
+
+/**
+ * @brief The DtcTableModel class
+ * Table of DTC occurrences over a DtcStore, one row per code per scan.
+ *
+ * New scans are added with beginInsertRows()/endInsertRows(), never with a
+ * model reset, so views and proxies keep their selection and scroll position
+ * and only process the new rows. Cells are formatted in data(), which views
+ * only call for the rows on screen.
+ *
+ * The model sorts itself: sort() orders a permutation of store rows by the
+ * store's columns and string ranks, and new rows are inserted at their sorted
+ * position. A QSortFilterProxyModel sorting 100k rows would build two model
+ * indexes per comparison; DtcFilterProxyModel only filters.
+ */
+class DtcTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        CodeColumn,
+        StatusColumn,
+        CategoryColumn,
+        ModuleColumn,
+        VinColumn,
+        TimeColumn,
+        ColumnCount
+    };
+
+    explicit DtcTableModel(QObject *parent = nullptr);
+    ~DtcTableModel() = default;
+
+    const DtcStore& store() const { return m_store; }
+
+    /**
+     * @brief Appends the DTCs of a scan under its VIN and time.
+     */
+    void appendScan(const ScanResult& result);
+    void appendDtcs(const QString& vin, const QVector<DtcEntry>& dtcs, qint64 timestampMs);
+    void clear();
+
+    /**
+     * @brief Store row shown at model row @p row.
+     */
+    int storeRow(int row) const { return m_sortColumn < 0 ? row : m_order[row]; }
+
+    /**
+     * @brief Orders the rows by @p column; a column of -1 restores insertion order.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    int sortColumn() const { return m_sortColumn; }
+    Qt::SortOrder sortOrder() const { return m_sortOrder; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    static QString statusText(DtcStatus status);
+    static QString categoryText(DtcCategory category);
+
+private:
+    bool rowLessThan(int a, int b) const;      // Store rows, in the current sort order
+
+    DtcStore m_store;
+    QVector<int> m_order;                       // Store rows by model row while sorted
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+};
+
+#endif // DTCTABLEMODEL_H
@@ -0,0 +1,147 @@
+#include "LogCatalogModel.h"
+
+LogCatalogModel::LogCatalogModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_pages(MAX_PAGES)
+{
+}
+
+void LogCatalogModel::setCatalog(LogCatalog* catalog)
+{
+    if (m_catalog == catalog) {
+        return;
+    }
+
+    if (m_catalog) {
+        disconnect(m_catalog, nullptr, this, nullptr);
+    }
+
+    m_catalog = catalog;
+
+    if (m_catalog) {
+        connect(m_catalog, &LogCatalog::changed, this, &LogCatalogModel::refresh);
+        connect(m_catalog, &QObject::destroyed, this, [this]() {
+            m_catalog = nullptr;
+            refresh();
+        });
+    }
+    refresh();
+}
+
+void LogCatalogModel::refresh()
+{
+    beginResetModel();
+    m_pages.clear();
+    m_count = m_catalog ? m_catalog->count() : 0;
+    endResetModel();
+}
+
+LogCatalog::Entry LogCatalogModel::entry(int row) const
+{
+    const LogCatalog::Entry* cached = cachedEntry(row);
+    return cached ? *cached : LogCatalog::Entry();
+}
+
+const LogCatalog::Entry* LogCatalogModel::cachedEntry(int row) const
+{
+    if (!m_catalog || row < 0 || row >= m_count) {
+        return nullptr;
+    }
+
+    const int page = row / PAGE_SIZE;
+    QVector<LogCatalog::Entry>* entries = m_pages.object(page);
+    if (!entries) {
+        entries = new QVector<LogCatalog::Entry>(m_catalog->entries(page * PAGE_SIZE, PAGE_SIZE));
+        ++m_pageLoads;
+        m_pages.insert(page, entries);
+    }
+
+    // Rows can be missing if the catalog changed and the reset is still queued
+    const int offset = row % PAGE_SIZE;
+    return offset < entries->size() ? &entries->at(offset) : nullptr;
+}
+
+int LogCatalogModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+int LogCatalogModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant LogCatalogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) {
+        return QVariant();
+    }
+
+    const LogCatalog::Entry* entry = cachedEntry(index.row());
+    if (!entry) {
+        return QVariant();
+    }
+    if (role == Qt::ToolTipRole) {
+        return entry->fileName;
+    }
+
+    const LogMeta& meta = entry->meta;
+    switch (index.column()) {
+    case StartedColumn:
+        return meta.timestamp.toLocalTime().toString("yyyy-MM-dd hh:mm");
+    case DurationColumn:
+        return durationText(meta.duration);
+    case VehicleColumn: {
+        const VehicleProfile& vehicle = meta.vehicleProfile;
+        if (!vehicle.isValid()) {
+            return vehicle.vin;
+        }
+        return QString("%1 %2 %3").arg(vehicle.year).arg(vehicle.make, vehicle.model);
+    }
+    case PidsColumn:
+        return meta.pidCount;
+    case RateColumn:
+        return meta.sampleRate > 0.0 ? QString("%1 Hz").arg(meta.sampleRate, 0, 'f', 1) : QString();
+    case FileColumn:
+        return entry->fileName;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant LogCatalogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case StartedColumn:
+        return "Started";
+    case DurationColumn:
+        return "Duration";
+    case VehicleColumn:
+        return "Vehicle";
+    case PidsColumn:
+        return "PIDs";
+    case RateColumn:
+        return "Rate";
+    case FileColumn:
+        return "File";
+    default:
+        return QVariant();
+    }
+}
+
+QString LogCatalogModel::durationText(qint64 seconds)
+{
+    if (seconds <= 0) {
+        return QString();
+    }
+    if (seconds < 3600) {
+        return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    }
+    return QString("%1:%2:%3").arg(seconds / 3600)
+                               .arg((seconds % 3600) / 60, 2, 10, QChar('0'))
+                               .arg(seconds % 60, 2, 10, QChar('0'));
+}
@@ -0,0 +1,75 @@
+#ifndef LOGCATALOGMODEL_H
+#define LOGCATALOGMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QVector>
+#include "core/LogCatalog.h"
+
+/**
+ * @brief The LogCatalogModel class
+ * Table of the logs in a LogCatalog, newest first, read one page at a time.
+ *
+ * rowCount() is the catalog's count; data() loads the PAGE_SIZE rows around
+ * the requested one and keeps the last MAX_PAGES pages. Views with fixed row
+ * heights only ask for the rows on screen, so showing the list costs one
+ * COUNT(*) and one page, whatever the number of logs. Any change to the
+ * catalog resets the model.
+ */
+class LogCatalogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        StartedColumn,
+        DurationColumn,
+        VehicleColumn,
+        PidsColumn,
+        RateColumn,
+        FileColumn,
+        ColumnCount
+    };
+
+    static constexpr int PAGE_SIZE = 128;
+    static constexpr int MAX_PAGES = 16;
+
+    explicit LogCatalogModel(QObject *parent = nullptr);
+    ~LogCatalogModel() = default;
+
+    void setCatalog(LogCatalog* catalog);
+    LogCatalog* catalog() const { return m_catalog; }
+
+    /**
+     * @brief Catalog entry shown at @p row; a default Entry if out of range.
+     */
+    LogCatalog::Entry entry(int row) const;
+
+    /**
+     * @brief Number of pages read from the catalog so far.
+     */
+    int pageLoads() const { return m_pageLoads; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    static QString durationText(qint64 seconds);
+
+public slots:
+    /**
+     * @brief Drops the cached count and pages and resets the model.
+     */
+    void refresh();
+
+private:
+    const LogCatalog::Entry* cachedEntry(int row) const;
+
+    LogCatalog* m_catalog = nullptr;
+    int m_count = 0;
+    mutable QCache<int, QVector<LogCatalog::Entry>> m_pages;   // By page index
+    mutable int m_pageLoads = 0;
+};
+
+#endif // LOGCATALOGMODEL_H
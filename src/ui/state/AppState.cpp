@@ -1,12 +1,32 @@
 #include "AppState.h"
+#include "NotificationCoalescer.h"
+#include "ui/models/DtcTableModel.h"
+#include "core/Metrics.h"
+#include "core/SampleClock.h"
+#include "core/ScanDiffer.h"
+#include "core/TriggerEngine.h"
 #include <QDebug>
+#include <algorithm>
 
 AppState::AppState(QObject *parent)
     : QObject(parent)
     , m_connectionState(ConnectionState::Disconnected)
     , m_drivingMode(false)  // Start in Parked Mode
+    , m_lastScanSnapshot(std::make_shared<const ScanResult>())
     , m_expertMode(false)
+    , m_dtcModel(new DtcTableModel(this))
+    , m_coalescer(new NotificationCoalescer(this))
+    , m_triggers(new TriggerEngine(TriggerEngine::DEFAULT_CAPACITY, this))
 {
+    connect(m_coalescer, &NotificationCoalescer::propertyReady, this, &AppState::onPropertyReady);
+    Metrics::setRequestedSampleRate(m_coalescer->frameRate());
+}
+
+ScanResultSnapshot AppState::lastScanSnapshot() const
+{
+    // Safe from any thread, but not lock-free: the standard library guards
+    // shared_ptr atomics with a mutex pool
+    return std::atomic_load_explicit(&m_lastScanSnapshot, std::memory_order_acquire);
 }
 
 void AppState::setConnectionState(const ConnectionStateInfo& state)
@@ -47,10 +67,55 @@ void AppState::setDrivingMode(bool driving)
 
 void AppState::setLastScanResult(const ScanResult& result)
 {
-    if (!(m_lastScanResult == result)) {
-        m_lastScanResult = result;
-        emit lastScanResultChanged(m_lastScanResult);
+    // Copying is cheap: the containers inside ScanResult are implicitly shared
+    publishScanResult(result);
+}
+
+void AppState::publishScanResult(ScanResult result)
+{
+    // Every publish is a new version; observers compare versions instead of
+    // running a deep comparison over DTCs, freeze frames and monitors.
+    // Published from the GUI thread only; the version is still taken with
+    // fetch_add so no two snapshots can share one.
+    result.version = m_lastScanVersion.fetch_add(1, std::memory_order_acq_rel) + 1;
+    ScanResultSnapshot snapshot = std::make_shared<const ScanResult>(std::move(result));
+
+    std::atomic_store_explicit(&m_lastScanSnapshot, snapshot, std::memory_order_release);
+
+    // Complete scans are compared with the previous complete scan of the same
+    // vehicle. A timed-out scan is neither compared nor kept as a baseline: the
+    // items it never read would show up as cleared codes and monitors. Nor is
+    // a scan without a VIN, which could belong to any vehicle.
+    const bool newDiff = snapshot->complete && !snapshot->timedOut;
+    if (newDiff && snapshot->vin.isEmpty()) {
+        m_lastScanDiff = ScanDiffer::withoutBaseline(*snapshot);
+    } else if (newDiff) {
+        const ScanResultSnapshot baseline = m_scanBaselines.value(snapshot->vin);
+        m_lastScanDiff = baseline ? ScanDiffer::diff(*baseline, *snapshot)
+                                  : ScanDiffer::withoutBaseline(*snapshot);
+        m_scanBaselines.insert(snapshot->vin, snapshot);
+    }
+    if (snapshot->complete) {
+        m_dtcModel->appendScan(*snapshot);
+        if (m_triggers->ruleCount() > 0) {
+            const qint64 wallMs = snapshot->timestamp.isValid() ? snapshot->timestamp.toMSecsSinceEpoch() : 0;
+            m_triggers->ingestDtcs(snapshot->dtcs, SampleClock::now(), wallMs);
+        }
+    }
+
+    emit lastScanSnapshotChanged(snapshot);
+    emit lastScanResultChanged(*snapshot);
+    if (newDiff) {
+        emit lastScanDiffChanged(m_lastScanDiff);
+    }
+}
+
+void AppState::setScanBaseline(const ScanResult& result)
+{
+    if (result.vin.isEmpty()) {
+        return;
     }
+    m_scanBaselines.insert(result.vin, std::make_shared<const ScanResult>(result));
 }
 
 void AppState::setExpertMode(bool expert)
@@ -60,3 +125,124 @@ void AppState::setExpertMode(bool expert)
         emit expertModeChanged(m_expertMode);
     }
 }
+
+void AppState::setLiveSample(const PidSample& sample)
+{
+    if (sample.sampleTimeNs == 0) {
+        PidSample stamped = sample;
+        stamped.sampleTimeNs = SampleClock::now();
+        setLiveSample(stamped);
+        return;
+    }
+
+    storeLiveSample(sample);
+    if (m_virtualPids.count() > 0 && sample.isValid()) {
+        for (const PidSample& derived : m_virtualPids.process({sample})) {
+            storeLiveSample(derived);
+        }
+    }
+}
+
+void AppState::setLiveSamples(const QVector<PidSample>& samples)
+{
+    // Stamp once here, so every consumer sees the same monotonic time
+    const bool unstamped = std::any_of(samples.cbegin(), samples.cend(),
+                                       [](const PidSample& sample) { return sample.sampleTimeNs == 0; });
+    if (unstamped) {
+        const qint64 nowNs = SampleClock::now();
+        QVector<PidSample> stamped = samples;
+        for (PidSample& sample : stamped) {
+            if (sample.sampleTimeNs == 0) {
+                sample.sampleTimeNs = nowNs;
+            }
+        }
+        setLiveSamples(stamped);
+        return;
+    }
+
+    for (const PidSample& sample : samples) {
+        storeLiveSample(sample);
+    }
+    for (const PidSample& derived : m_virtualPids.process(samples)) {
+        storeLiveSample(derived);
+    }
+}
+
+void AppState::storeLiveSample(const PidSample& sample)
+{
+    if (!sample.isValid()) {
+        return;
+    }
+
+    auto stored = m_liveSamples.find(sample.pidId);
+    const bool firstSample = stored == m_liveSamples.end();
+    if (firstSample) {
+        m_liveSamples.insert(sample.pidId, sample);
+    } else {
+        *stored = sample;
+    }
+    LiveFrame& frame = m_pendingFrames[sample.pidId];
+    if (!frame.min.isValid() || sample.value < frame.min.value) {
+        frame.min = sample;
+    }
+    if (!frame.max.isValid() || sample.value > frame.max.value) {
+        frame.max = sample;
+    }
+    m_statistics.add(sample);
+    if (m_triggers->ruleCount() > 0) {
+        m_triggers->ingest(sample);
+    }
+    m_coalescer->markDirty(sample.pidId);
+    Metrics::increment(Metrics::LiveSamples);
+    if (firstSample) {
+        emit pidMetasChanged();
+    }
+}
+
+QVector<PidMeta> AppState::pidMetas() const
+{
+    // There is no PID catalogue yet: a real PID is known by its id and the
+    // unit of its samples
+    QStringList realPids;
+    for (auto it = m_liveSamples.cbegin(); it != m_liveSamples.cend(); ++it) {
+        if (!m_virtualPids.isVirtual(it.key())) {
+            realPids.append(it.key());
+        }
+    }
+    realPids.sort();
+
+    QVector<PidMeta> metas;
+    metas.reserve(realPids.size() + m_virtualPids.count());
+    for (const QString& pidId : std::as_const(realPids)) {
+        PidMeta meta(pidId, pidId, m_liveSamples.value(pidId).unit);
+        meta.supported = true;
+        metas.append(meta);
+    }
+    for (PidMeta meta : m_virtualPids.pidMetas(realPids)) {
+        // pidMetas() takes an empty list as "all available"; here nothing has reported yet
+        meta.supported = meta.supported && !realPids.isEmpty();
+        metas.append(meta);
+    }
+    return metas;
+}
+
+void AppState::setNotificationRate(int hz)
+{
+    m_coalescer->setFrameRate(hz);
+    Metrics::setRequestedSampleRate(m_coalescer->frameRate());
+}
+
+int AppState::notificationRate() const
+{
+    return m_coalescer->frameRate();
+}
+
+void AppState::onPropertyReady(const QString& key, int coalescedCount)
+{
+    auto it = m_liveSamples.constFind(key);
+    if (it != m_liveSamples.constEnd()) {
+        Metrics::increment(Metrics::LiveNotifications);
+        m_notifiedFrames.insert(key, m_pendingFrames.take(key));
+        emit liveSampleChanged(it.value(), coalescedCount);
+    }
+}
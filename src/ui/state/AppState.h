@@ -3,9 +3,20 @@
 
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <atomic>
 #include "core/dto/ConnectionState.h"
 #include "core/dto/VehicleProfile.h"
 #include "core/dto/ScanResult.h"
+#include "core/dto/ScanDiff.h"
+#include "core/dto/PidMeta.h"
+#include "core/dto/PidSample.h"
+#include "core/PidStatistics.h"
+#include "core/VirtualPidEngine.h"
+
+class DtcTableModel;
+class NotificationCoalescer;
+class TriggerEngine;
 
 // Forward declarations to avoid circular includes
 class AppState;
@@ -25,6 +36,15 @@ class AppState : public QObject
     Q_PROPERTY(bool expertMode READ expertMode NOTIFY expertModeChanged)
 
 public:
+    /**
+     * @brief Lowest and highest sample of a PID among those coalesced into
+     * one liveSampleChanged() notification.
+     */
+    struct LiveFrame {
+        PidSample min;
+        PidSample max;
+    };
+
     explicit AppState(QObject *parent = nullptr);
     ~AppState() = default;
 
@@ -32,8 +52,51 @@ public:
     ConnectionStateInfo connectionState() const { return m_connectionState; }
     VehicleProfile selectedVehicleProfile() const { return m_selectedVehicleProfile; }
     bool drivingMode() const { return m_drivingMode; }
-    ScanResult lastScanResult() const { return m_lastScanResult; }
+    ScanResult lastScanResult() const { return *lastScanSnapshot(); }
+    ScanResultSnapshot lastScanSnapshot() const;
+    quint64 lastScanVersion() const { return m_lastScanVersion.load(std::memory_order_acquire); }
+    ScanDiff lastScanDiff() const { return m_lastScanDiff; }
+    bool hasScanBaseline(const QString& vin) const { return m_scanBaselines.contains(vin); }
     bool expertMode() const { return m_expertMode; }
+    PidSample liveSample(const QString& pidId) const { return m_liveSamples.value(pidId); }
+
+    /**
+     * @brief Extremes of the samples behind the PID's last liveSampleChanged(),
+     * so charts can draw spikes that were not the frame's latest value.
+     */
+    LiveFrame liveFrame(const QString& pidId) const { return m_notifiedFrames.value(pidId); }
+
+    /**
+     * @brief Virtual PIDs computed from live samples as they are stored.
+     */
+    VirtualPidEngine& virtualPids() { return m_virtualPids; }
+    const VirtualPidEngine& virtualPids() const { return m_virtualPids; }
+
+    /**
+     * @brief The PIDs live data can show: every real PID that has delivered a
+     * sample, by id, then every virtual PID, supported if all its inputs have.
+     */
+    QVector<PidMeta> pidMetas() const;
+
+    /**
+     * @brief Running statistics of every stored live sample, virtual PIDs included.
+     */
+    PidStatistics& statistics() { return m_statistics; }
+    const PidStatistics& statistics() const { return m_statistics; }
+
+    /**
+     * @brief Every DTC of every complete scan published, whether or not a
+     * view shows them.
+     */
+    DtcTableModel* dtcModel() const { return m_dtcModel; }
+
+    /**
+     * @brief Trigger rules evaluated against every stored live sample, virtual
+     * PIDs included, and the DTCs of every complete scan. Nothing is buffered
+     * while there are no rules.
+     */
+    TriggerEngine* triggers() const { return m_triggers; }
+    int notificationRate() const;
 
     // Setters
     void setConnectionState(const ConnectionStateInfo& state);
@@ -41,21 +104,76 @@ public:
     void setSelectedVehicleProfile(const VehicleProfile& profile);
     void setDrivingMode(bool driving);
     void setLastScanResult(const ScanResult& result);
+    void publishScanResult(ScanResult result);
+
+    /**
+     * @brief Sets the scan that the next complete scan of the same VIN is compared with.
+     * Used to seed the comparison from stored history; afterwards every complete
+     * scan becomes the baseline for the next one.
+     */
+    void setScanBaseline(const ScanResult& result);
     void setExpertMode(bool expert);
 
+    /**
+     * @brief Stores the latest sample for a PID.
+     * Live data arrives at data rate; liveSampleChanged() is delivered at most once
+     * per PID per UI frame (see setNotificationRate()). A sample without a
+     * sampleTimeNs is stamped with SampleClock::now() on arrival.
+     */
+    void setLiveSample(const PidSample& sample);
+
+    /**
+     * @brief Stores a batch of samples, then the virtual PID samples computed
+     * from it. Preferred over setLiveSample() at high rates: virtual PIDs are
+     * evaluated once per batch.
+     */
+    void setLiveSamples(const QVector<PidSample>& samples);
+    void setNotificationRate(int hz);
+
 signals:
     void connectionStateChanged(const ConnectionStateInfo& state);
     void selectedVehicleProfileChanged(const VehicleProfile& profile);
     void drivingModeChanged(bool driving);
     void lastScanResultChanged(const ScanResult& result);
+    void lastScanSnapshotChanged(const ScanResultSnapshot& snapshot);
+    void lastScanDiffChanged(const ScanDiff& diff);
     void expertModeChanged(bool expert);
 
+    /**
+     * @brief Frame-paced live data notification.
+     * @param sample The latest sample for the PID.
+     * @param coalescedCount Number of samples stored since the previous notification.
+     */
+    void liveSampleChanged(const PidSample& sample, int coalescedCount);
+
+    /**
+     * @brief A PID delivered its first sample, so pidMetas() has changed.
+     */
+    void pidMetasChanged();
+
+private slots:
+    void onPropertyReady(const QString& key, int coalescedCount);
+
 private:
+    void storeLiveSample(const PidSample& sample);
+
     ConnectionStateInfo m_connectionState;
     VehicleProfile m_selectedVehicleProfile;
     bool m_drivingMode = false;  // false = Parked Mode, true = Driving Mode
-    ScanResult m_lastScanResult;
+    ScanResultSnapshot m_lastScanSnapshot;   // Stored on the GUI thread; std::atomic_load from any thread
+    std::atomic<quint64> m_lastScanVersion{0};
+    ScanDiff m_lastScanDiff;
+    QHash<QString, ScanResultSnapshot> m_scanBaselines;   // VIN -> last complete scan
     bool m_expertMode = false;
+
+    QHash<QString, PidSample> m_liveSamples;  // PID id -> latest sample
+    QHash<QString, LiveFrame> m_pendingFrames;    // PID id -> extremes since the last notification
+    QHash<QString, LiveFrame> m_notifiedFrames;   // PID id -> extremes of the last notification
+    VirtualPidEngine m_virtualPids;
+    PidStatistics m_statistics;
+    DtcTableModel* m_dtcModel = nullptr;
+    NotificationCoalescer* m_coalescer = nullptr;
+    TriggerEngine* m_triggers = nullptr;
 };
 
 #endif // APPSTATE_H
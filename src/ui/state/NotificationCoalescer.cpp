@@ -0,0 +1,51 @@
+#include "NotificationCoalescer.h"
+
+NotificationCoalescer::NotificationCoalescer(QObject *parent)
+    : QObject(parent)
+    , m_frameTimer(new QTimer(this))
+{
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+    connect(m_frameTimer, &QTimer::timeout, this, &NotificationCoalescer::flush);
+}
+
+void NotificationCoalescer::setFrameRate(int hz)
+{
+    m_frameRate = qBound(1, hz, 240);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+}
+
+void NotificationCoalescer::markDirty(const QString& key)
+{
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+        ++it.value();
+        return;
+    }
+
+    m_pending.insert(key, 1);
+    m_order.append(key);
+
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+void NotificationCoalescer::flush()
+{
+    if (m_pending.isEmpty()) {
+        // Nothing arrived during the last frame; sleep until the next change
+        m_frameTimer->stop();
+        return;
+    }
+
+    // Swap out first so receivers may mark keys dirty again for the next frame
+    QHash<QString, int> pending;
+    QStringList order;
+    pending.swap(m_pending);
+    order.swap(m_order);
+
+    for (const QString& key : order) {
+        emit propertyReady(key, pending.value(key));
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef NOTIFICATIONCOALESCER_H
+#define NOTIFICATIONCOALESCER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+/**
+ * @brief The NotificationCoalescer class
+ * Collapses bursts of property changes into at most one notification per
+ * property per UI frame.
+ *
+ * Producers call markDirty() as often as data arrives; on the next frame tick
+ * propertyReady() is emitted once for every dirty key together with the number
+ * of changes that were folded into it. The frame timer only runs while there
+ * are pending keys.
+ */
+class NotificationCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NotificationCoalescer(QObject *parent = nullptr);
+    ~NotificationCoalescer() = default;
+
+    /**
+     * @brief Sets the delivery rate (notifications per second per key).
+     */
+    void setFrameRate(int hz);
+    int frameRate() const { return m_frameRate; }
+
+    /**
+     * @brief Marks a property as changed. Delivery happens on the next frame tick.
+     */
+    void markDirty(const QString& key);
+
+    /**
+     * @brief Delivers all pending notifications immediately.
+     */
+    void flush();
+
+    int pendingCount() const { return m_pending.size(); }
+
+signals:
+    /**
+     * @brief Emitted once per dirty key per frame.
+     * @param key The property key passed to markDirty().
+     * @param coalescedCount Number of markDirty() calls folded into this notification.
+     */
+    void propertyReady(const QString& key, int coalescedCount);
+
+private:
+    QHash<QString, int> m_pending;  // Key -> changes since last delivery
+    QStringList m_order;            // Keys in first-dirty order, for stable delivery
+    QTimer* m_frameTimer;
+    int m_frameRate = 60;
+};
+
+#endif // NOTIFICATIONCOALESCER_H
@@ -1,5 +1,12 @@
 #include "AdvancedView.h"
 #include "ui/state/AppState.h"
+#include "core/Trace.h"
+#include "core/TraceExport.h"
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QPushButton>
 #include <QVBoxLayout>
 
 AdvancedView::AdvancedView(QWidget *parent)
@@ -7,12 +14,35 @@ AdvancedView::AdvancedView(QWidget *parent)
     , m_appState(nullptr)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
 
-    m_placeholderLabel = new QLabel("Advanced - Coming in Phase 7", this);
+    // Command timeline: queue, write, reply, parse and UI update of every command
+    QGroupBox* traceGroup = new QGroupBox("Command Timeline", this);
+    QVBoxLayout* traceLayout = new QVBoxLayout(traceGroup);
+
+    m_captureCheckBox = new QCheckBox("Capture command timeline", traceGroup);
+    m_captureCheckBox->setToolTip("Records when each command is queued, sent, answered, parsed and shown.");
+    m_captureCheckBox->setChecked(Trace::enabledCategories() & Trace::Lifecycle);
+    m_captureCheckBox->setEnabled(Trace::compiledIn(Trace::Lifecycle));
+    traceLayout->addWidget(m_captureCheckBox);
+
+    QHBoxLayout* exportLayout = new QHBoxLayout();
+    m_exportButton = new QPushButton("Export Trace...", traceGroup);
+    m_exportButton->setToolTip("Save as Chrome trace JSON for chrome://tracing or ui.perfetto.dev.");
+    exportLayout->addWidget(m_exportButton);
+    m_traceStatusLabel = new QLabel(traceGroup);
+    m_traceStatusLabel->setStyleSheet("color: gray;");
+    exportLayout->addWidget(m_traceStatusLabel, 1);
+    traceLayout->addLayout(exportLayout);
+
+    layout->addWidget(traceGroup);
+
+    m_placeholderLabel = new QLabel("Mode $06 and expert features - Coming in Phase 7", this);
     m_placeholderLabel->setAlignment(Qt::AlignCenter);
     m_placeholderLabel->setStyleSheet("font-size: 16px; color: gray;");
-    layout->addWidget(m_placeholderLabel);
+    layout->addWidget(m_placeholderLabel, 1);
+
+    connect(m_captureCheckBox, &QCheckBox::toggled, this, &AdvancedView::onCaptureToggled);
+    connect(m_exportButton, &QPushButton::clicked, this, &AdvancedView::onExportClicked);
 }
 
 void AdvancedView::setAppState(AppState* appState)
@@ -20,3 +50,33 @@ void AdvancedView::setAppState(AppState* appState)
     m_appState = appState;
     // Will be used in Phase 7 for Mode $06 and expert features
 }
+
+void AdvancedView::onCaptureToggled(bool enabled)
+{
+    const quint8 categories = Trace::enabledCategories();
+    if (enabled) {
+        // Start a fresh timeline so the export holds only what follows
+        Trace::clear();
+        Trace::setCategoriesEnabled(categories | Trace::Lifecycle);
+        m_traceStatusLabel->setText("Capturing...");
+    } else {
+        Trace::setCategoriesEnabled(categories & ~quint8(Trace::Lifecycle));
+        m_traceStatusLabel->setText("Capture stopped");
+    }
+}
+
+void AdvancedView::onExportClicked()
+{
+    const QString path = QFileDialog::getSaveFileName(this, "Export Trace", "obdread-trace.json",
+                                                      "Chrome trace (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (TraceExport::writeChromeJson(path, &error)) {
+        m_traceStatusLabel->setText(QString("Saved %1").arg(path));
+    } else {
+        m_traceStatusLabel->setText(error);
+    }
+}
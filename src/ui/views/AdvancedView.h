@@ -6,10 +6,14 @@
 #include <QVBoxLayout>
 
 class AppState;
+class QCheckBox;
+class QPushButton;
 
 /**
  * @brief The AdvancedView class
- * Advanced screen placeholder (to be implemented in Phase 7).
+ * Advanced screen. For now it holds the command timeline capture (Lifecycle
+ * trace events, exported as Chrome trace JSON); Mode $06 and other expert
+ * features follow in Phase 7.
  */
 class AdvancedView : public QWidget
 {
@@ -19,8 +23,15 @@ public:
     explicit AdvancedView(QWidget *parent = nullptr);
     void setAppState(AppState* appState);
 
+private slots:
+    void onCaptureToggled(bool enabled);
+    void onExportClicked();
+
 private:
     AppState* m_appState = nullptr;
+    QCheckBox* m_captureCheckBox = nullptr;
+    QPushButton* m_exportButton = nullptr;
+    QLabel* m_traceStatusLabel = nullptr;
     QLabel* m_placeholderLabel = nullptr;
 };
 
@@ -1,22 +1,116 @@
 #include "CodesView.h"
-#include "ui/state/AppState.h"
+#include "ui/models/DtcTableModel.h"
+#include "ui/models/DtcFilterProxyModel.h"
+#include <QHBoxLayout>
+#include <QHeaderView>
 #include <QVBoxLayout>
 
 CodesView::CodesView(QWidget *parent)
     : QWidget(parent)
-    , m_appState(nullptr)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
 
-    m_placeholderLabel = new QLabel("Codes - Coming in Phase 3", this);
-    m_placeholderLabel->setAlignment(Qt::AlignCenter);
-    m_placeholderLabel->setStyleSheet("font-size: 16px; color: gray;");
-    layout->addWidget(m_placeholderLabel);
+    m_proxyModel = new DtcFilterProxyModel(this);
+
+    // Filters: search, then one checkbox per status and per category
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search code, module or VIN");
+    m_searchEdit->setClearButtonEnabled(true);
+    filterLayout->addWidget(m_searchEdit, 1);
+
+    for (DtcStatus status : {DtcStatus::Confirmed, DtcStatus::Pending, DtcStatus::Permanent}) {
+        QCheckBox* check = new QCheckBox(DtcTableModel::statusText(status), this);
+        check->setChecked(true);
+        connect(check, &QCheckBox::toggled, this, &CodesView::onFiltersChanged);
+        filterLayout->addWidget(check);
+        m_statusChecks.append(check);
+    }
+    filterLayout->addSpacing(12);
+    for (DtcCategory category : {DtcCategory::P, DtcCategory::B, DtcCategory::C, DtcCategory::U}) {
+        QCheckBox* check = new QCheckBox(DtcTableModel::categoryText(category), this);
+        check->setChecked(true);
+        connect(check, &QCheckBox::toggled, this, &CodesView::onFiltersChanged);
+        filterLayout->addWidget(check);
+        m_categoryChecks.append(check);
+    }
+    layout->addLayout(filterLayout);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &CodesView::onFiltersChanged);
+
+    // Fixed row heights and column widths: the view never measures off-screen rows
+    m_tableView = new QTableView(this);
+    m_tableView->setModel(m_proxyModel);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableView->setWordWrap(false);
+    m_tableView->verticalHeader()->hide();
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->verticalHeader()->setDefaultSectionSize(m_tableView->fontMetrics().height() + 6);
+    m_tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_tableView->horizontalHeader()->setStretchLastSection(true);
+    m_tableView->setSortingEnabled(true);
+    layout->addWidget(m_tableView, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setStyleSheet("color: gray;");
+    layout->addWidget(m_countLabel);
+
+    connect(m_proxyModel, &QAbstractItemModel::rowsInserted, this, &CodesView::updateCountLabel);
+    connect(m_proxyModel, &QAbstractItemModel::rowsRemoved, this, &CodesView::updateCountLabel);
+    connect(m_proxyModel, &QAbstractItemModel::modelReset, this, &CodesView::updateCountLabel);
+    connect(m_proxyModel, &QAbstractItemModel::layoutChanged, this, &CodesView::updateCountLabel);
+    updateCountLabel();
+}
+
+void CodesView::setDtcModel(DtcTableModel* model)
+{
+    if (m_proxyModel->dtcModel() == model) {
+        return;
+    }
+
+    m_proxyModel->setDtcModel(model);
+    if (model) {
+        // Columns exist only once there is a model
+        m_tableView->setColumnWidth(DtcTableModel::VinColumn, m_tableView->fontMetrics().horizontalAdvance("W") * 18);
+        m_tableView->sortByColumn(DtcTableModel::TimeColumn, Qt::DescendingOrder);
+    }
+    updateCountLabel();
+}
+
+DtcTableModel* CodesView::model() const
+{
+    return m_proxyModel->dtcModel();
+}
+
+void CodesView::onFiltersChanged()
+{
+    quint8 statuses = 0;
+    for (int i = 0; i < m_statusChecks.size(); ++i) {
+        if (m_statusChecks[i]->isChecked()) {
+            statuses |= quint8(1u << i);
+        }
+    }
+    quint8 categories = 0;
+    for (int i = 0; i < m_categoryChecks.size(); ++i) {
+        if (m_categoryChecks[i]->isChecked()) {
+            categories |= quint8(1u << i);
+        }
+    }
+
+    m_proxyModel->setStatusFilter(statuses);
+    m_proxyModel->setCategoryFilter(categories);
+    m_proxyModel->setTextFilter(m_searchEdit->text());
 }
 
-void CodesView::setAppState(AppState* appState)
+void CodesView::updateCountLabel()
 {
-    m_appState = appState;
-    // Will be used in Phase 3 to display DTC list
+    const DtcTableModel* model = m_proxyModel->dtcModel();
+    const int total = model ? model->rowCount() : 0;
+    const int shown = m_proxyModel->rowCount();
+    const int vehicles = model ? model->store().vehicleCount() : 0;
+    if (shown == total) {
+        m_countLabel->setText(QString("%1 codes from %2 vehicles").arg(total).arg(vehicles));
+    } else {
+        m_countLabel->setText(QString("%1 of %2 codes from %3 vehicles").arg(shown).arg(total).arg(vehicles));
+    }
 }
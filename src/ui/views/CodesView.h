@@ -2,14 +2,23 @@
 #define CODESVIEW_H
 
 #include <QWidget>
+#include <QCheckBox>
 #include <QLabel>
+#include <QLineEdit>
+#include <QTableView>
 #include <QVBoxLayout>
+#include <QVector>
 
-class AppState;
+class DtcTableModel;
+class DtcFilterProxyModel;
 
 /**
  * @brief The CodesView class
- * Codes list screen placeholder (to be implemented in Phase 3).
+ * Codes list screen: every DTC of every completed scan, with status and
+ * category filters and a search over code, module and VIN.
+ *
+ * The codes come from AppState::dtcModel(), which collects scans whether or
+ * not this view exists, so the view needs no AppState subscription.
  */
 class CodesView : public QWidget
 {
@@ -17,11 +26,26 @@ class CodesView : public QWidget
 
 public:
     explicit CodesView(QWidget *parent = nullptr);
-    void setAppState(AppState* appState);
+
+    /**
+     * @brief Sets the codes to show, sorted newest first.
+     */
+    void setDtcModel(DtcTableModel* model);
+    DtcTableModel* model() const;
+    DtcFilterProxyModel* proxyModel() const { return m_proxyModel; }
+
+private slots:
+    void onFiltersChanged();
+    void updateCountLabel();
 
 private:
-    AppState* m_appState = nullptr;
-    QLabel* m_placeholderLabel = nullptr;
+    DtcFilterProxyModel* m_proxyModel = nullptr;
+
+    QLineEdit* m_searchEdit = nullptr;
+    QVector<QCheckBox*> m_statusChecks;     // By DtcStatus
+    QVector<QCheckBox*> m_categoryChecks;   // By DtcCategory
+    QTableView* m_tableView = nullptr;
+    QLabel* m_countLabel = nullptr;
 };
 
 #endif // CODESVIEW_H
@@ -5,6 +5,7 @@
 #include "core/dto/ScanResult.h"
 #include "core/dto/DtcEntry.h"
 #include "hardware/ObdTransporter.h"
+#include "core/Trace.h"
 #include <QDebug>
 
 HomeView::HomeView(QWidget *parent)
@@ -287,10 +288,26 @@ void HomeView::updateSummaryTiles()
         return;
     }
 
-    ScanResult result = m_appState->lastScanResult();
+    // Snapshots are immutable; skip the refresh if this version is already shown
+    ScanResultSnapshot snapshot = m_appState->lastScanSnapshot();
+    if (snapshot->version != 0 && snapshot->version == m_displayedScanVersion) {
+        return;
+    }
+    m_displayedScanVersion = snapshot->version;
+    const ScanResult& result = *snapshot;
+    OBD_TRACE(Lifecycle, ViewUpdateBegin, quint32(snapshot->version), Trace::packText(QByteArray("HomeView")));
+
+    // While a scan runs, tiles whose reply has not arrived yet show a placeholder
+    auto received = [&result](quint32 items) {
+        return result.complete || (result.receivedItems & items) == items;
+    };
+    const QString waitingStyle("font-weight: bold; font-size: 14px; color: gray;");
 
     // MIL status
-    if (result.milOn) {
+    if (!received(ScanPlanner::MilStatus)) {
+        m_milValueLabel->setText("...");
+        m_milValueLabel->setStyleSheet(waitingStyle);
+    } else if (result.milOn) {
         m_milValueLabel->setText("ON");
         m_milValueLabel->setStyleSheet("font-weight: bold; font-size: 14px; color: red;");
     } else {
@@ -305,7 +322,10 @@ void HomeView::updateSummaryTiles()
     int totalCount = result.dtcs.size();
 
     QString codesText;
-    if (totalCount == 0) {
+    if (!received(ScanPlanner::StoredDtcs)) {
+        codesText = totalCount > 0 ? QString("%1 ...").arg(totalCount) : QString("...");
+        m_codesValueLabel->setStyleSheet(waitingStyle);
+    } else if (totalCount == 0) {
         codesText = "0";
         m_codesValueLabel->setStyleSheet("font-weight: bold; font-size: 14px; color: green;");
     } else {
@@ -327,7 +347,10 @@ void HomeView::updateSummaryTiles()
     m_codesValueLabel->setText(codesText);
 
     // Readiness status
-    if (result.readiness.monitors.isEmpty()) {
+    if (!received(ScanPlanner::Readiness)) {
+        m_readinessValueLabel->setText("...");
+        m_readinessValueLabel->setStyleSheet(waitingStyle);
+    } else if (result.readiness.isEmpty()) {
         m_readinessValueLabel->setText("Unknown");
         m_readinessValueLabel->setStyleSheet("font-weight: bold; font-size: 14px; color: gray;");
     } else if (result.readiness.overallReady) {
@@ -339,11 +362,14 @@ void HomeView::updateSummaryTiles()
     }
 
     // Last scan time
-    if (result.timestamp.isValid()) {
+    if (!result.complete) {
+        m_lastScanTimeLabel->setText("Scanning...");
+    } else if (result.timestamp.isValid()) {
         m_lastScanTimeLabel->setText(result.timestamp.toString("yyyy-MM-dd hh:mm:ss"));
     } else {
         m_lastScanTimeLabel->setText("Never");
     }
+    OBD_TRACE(Lifecycle, ViewUpdateEnd, quint32(snapshot->version), Trace::packText(QByteArray("HomeView")));
 }
 
 void HomeView::updateButtonStates()
@@ -73,6 +73,8 @@ private:
     // Error display
     QLabel* m_errorLabel = nullptr;
     QLabel* m_progressLabel = nullptr;
+
+    quint64 m_displayedScanVersion = 0;  // Version of the scan snapshot in the tiles
 };
 
 #endif // HOMEVIEW_H
@@ -1,18 +1,50 @@
 #include "LiveDataView.h"
 #include "ui/state/AppState.h"
+#include "ui/components/GaugePanel.h"
+#include "ui/components/StripChart.h"
+#include <QStandardItemModel>
 #include <QVBoxLayout>
+#include <iterator>
+
+namespace {
+
+// Trace colours, cycled per chart band
+const QColor TRACE_COLORS[] = {
+    QColor(0x1f, 0x77, 0xb4), QColor(0xff, 0x7f, 0x0e), QColor(0x2c, 0xa0, 0x2c),
+    QColor(0xd6, 0x27, 0x28), QColor(0x94, 0x67, 0xbd), QColor(0x8c, 0x56, 0x4b)
+};
+
+} // namespace
 
 LiveDataView::LiveDataView(QWidget *parent)
     : QWidget(parent)
     , m_appState(nullptr)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
 
-    m_placeholderLabel = new QLabel("Live Data - Coming in Phase 4", this);
+    m_placeholderLabel = new QLabel("Live Data - PID streaming coming in Phase 4", this);
     m_placeholderLabel->setAlignment(Qt::AlignCenter);
     m_placeholderLabel->setStyleSheet("font-size: 16px; color: gray;");
     layout->addWidget(m_placeholderLabel);
+
+    // Real PIDs that have reported and the virtual PIDs derived from them
+    m_pidPicker = new QComboBox(this);
+    m_pidPicker->setPlaceholderText("Add PID...");
+    m_pidPicker->setEnabled(false);
+    connect(m_pidPicker, QOverload<int>::of(&QComboBox::activated), this, &LiveDataView::onPidPicked);
+    layout->addWidget(m_pidPicker);
+
+    // Gauges and graph traces are added by the PID stream as PIDs are selected
+    m_gaugePanel = new GaugePanel(this);
+    layout->addWidget(m_gaugePanel, 1);
+
+    m_stripChart = new StripChart(this);
+    layout->addWidget(m_stripChart, 1);
+
+    // Min/mean/p95/max of the charted PIDs over the statistics window
+    m_statisticsLabel = new QLabel(this);
+    m_statisticsLabel->setStyleSheet("font-family: monospace; color: gray;");
+    layout->addWidget(m_statisticsLabel);
 }
 
 void LiveDataView::setAppState(AppState* appState)
@@ -29,12 +61,142 @@ void LiveDataView::setAppState(AppState* appState)
 
     if (m_appState) {
         connect(m_appState, &AppState::drivingModeChanged, this, &LiveDataView::onDrivingModeChanged);
+        connect(m_appState, &AppState::liveSampleChanged, this, &LiveDataView::onLiveSampleChanged);
+        connect(m_appState, &AppState::pidMetasChanged, this, &LiveDataView::onPidMetasChanged);
         onDrivingModeChanged(m_appState->drivingMode());
+        onPidMetasChanged();
+
+        // Values that arrived while the view was detached
+        for (const QString& pidId : m_gaugePanel->gaugePids()) {
+            const PidSample sample = m_appState->liveSample(pidId);
+            if (!sample.pidId.isEmpty()) {
+                m_gaugePanel->setValue(pidId, sample.value);
+            }
+        }
     }
 }
 
 void LiveDataView::onDrivingModeChanged(bool driving)
 {
-    Q_UNUSED(driving);
-    // In Phase 4, this will disable editing controls when in Driving Mode
+    // Larger gauges for reading at a glance; in Phase 4 this will also disable
+    // editing controls
+    m_gaugePanel->setEnlarged(driving);
+}
+
+void LiveDataView::onPidMetasChanged()
+{
+    m_pidMetas = m_appState->pidMetas();
+    m_pidPicker->clear();
+    for (const PidMeta& meta : std::as_const(m_pidMetas)) {
+        QString text = meta.unit.isEmpty() ? meta.name : QString("%1 (%2)").arg(meta.name, meta.unit);
+        if (meta.isVirtual) {
+            text += " - virtual";
+        }
+        m_pidPicker->addItem(text, meta.pidId);
+
+        // A virtual PID some of whose inputs never reported cannot be computed
+        QStandardItemModel* items = qobject_cast<QStandardItemModel*>(m_pidPicker->model());
+        if (!meta.supported && items) {
+            items->item(m_pidPicker->count() - 1)->setEnabled(false);
+        }
+    }
+    m_pidPicker->setCurrentIndex(-1);
+    m_pidPicker->setEnabled(!m_pidMetas.isEmpty());
+}
+
+void LiveDataView::onPidPicked(int index)
+{
+    if (index >= 0 && index < m_pidMetas.size()) {
+        showPid(m_pidMetas.at(index));
+    }
+    m_pidPicker->setCurrentIndex(-1);
+}
+
+void LiveDataView::showPid(const PidMeta& meta)
+{
+    if (m_gaugePanel->hasGauge(meta.pidId)) {
+        return;
+    }
+
+    // Scaled to what the PID has read this session, with some headroom
+    double minValue = 0.0;
+    double maxValue = 100.0;
+    if (m_appState) {
+        const PidStatistics::Summary session = m_appState->statistics().snapshot(meta.pidId);
+        if (!session.isEmpty()) {
+            const PidStatistics::Moments& moments = session.moments;
+            const double span = qMax(moments.max - moments.min, qMax(qAbs(moments.max), 1.0));
+            minValue = moments.min - span * 0.25;
+            maxValue = moments.max + span * 0.25;
+        }
+    }
+
+    const int group = m_gaugePanel->gaugeCount();
+    m_gaugePanel->addGauge(meta.pidId, meta.name, meta.unit, minValue, maxValue);
+    if (!m_stripChart->hasTrace(meta.pidId)) {
+        m_stripChart->addTrace(meta.pidId, meta.name, TRACE_COLORS[group % std::size(TRACE_COLORS)],
+                               minValue, maxValue, group);
+    }
+    if (m_appState) {
+        const PidSample latest = m_appState->liveSample(meta.pidId);
+        if (!latest.pidId.isEmpty()) {
+            m_gaugePanel->setValue(meta.pidId, latest.value);
+        }
+    }
+}
+
+void LiveDataView::onLiveSampleChanged(const PidSample& sample, int coalescedCount)
+{
+    Q_UNUSED(coalescedCount);
+
+    // Delivered at display rate by AppState, at most once per PID per frame
+    m_gaugePanel->setValue(sample.pidId, sample.value);
+    if (!m_stripChart->hasTrace(sample.pidId)) {
+        return;
+    }
+
+    // Monotonic transport time: PIDs sampled in one session share the axis exactly
+    if (m_sessionStartNs < 0) {
+        m_sessionStartNs = sample.sampleTimeNs;
+        m_placeholderLabel->hide();
+    }
+
+    // The frame's extremes in time order, then the latest value, so spikes
+    // between notifications still reach the chart's min/max envelope
+    const AppState::LiveFrame frame = m_appState->liveFrame(sample.pidId);
+    const bool minFirst = frame.min.sampleTimeNs <= frame.max.sampleTimeNs;
+    qint64 appendedNs = -1;
+    for (const PidSample& extreme : {minFirst ? frame.min : frame.max, minFirst ? frame.max : frame.min}) {
+        if (extreme.isValid() && extreme.sampleTimeNs < sample.sampleTimeNs && extreme.sampleTimeNs != appendedNs) {
+            m_stripChart->appendSample(sample.pidId, (extreme.sampleTimeNs - m_sessionStartNs) / 1e9, extreme.value);
+            appendedNs = extreme.sampleTimeNs;
+        }
+    }
+    m_stripChart->appendSample(sample.pidId, (sample.sampleTimeNs - m_sessionStartNs) / 1e9, sample.value);
+    updateStatistics(sample);
+}
+
+void LiveDataView::updateStatistics(const PidSample& sample)
+{
+    auto updated = m_statisticsUpdatedNs.constFind(sample.pidId);
+    if (updated != m_statisticsUpdatedNs.constEnd() && sample.sampleTimeNs - updated.value() < STATISTICS_INTERVAL_NS) {
+        return;
+    }
+    m_statisticsUpdatedNs.insert(sample.pidId, sample.sampleTimeNs);
+
+    // Read from the running aggregates; never from the samples
+    const PidStatistics& statistics = m_appState->statistics();
+    const PidStatistics::Summary summary = statistics.snapshot(sample.pidId, PidStatistics::Window);
+    if (summary.isEmpty()) {
+        return;
+    }
+    m_statisticsLines.insert(sample.pidId, QString("%1  min %2  mean %3  p95 %4  max %5 %6 (last %7 s)")
+        .arg(sample.pidId)
+        .arg(summary.moments.min, 0, 'f', 1)
+        .arg(summary.moments.mean, 0, 'f', 1)
+        .arg(summary.quantile(0.95), 0, 'f', 1)
+        .arg(summary.moments.max, 0, 'f', 1)
+        .arg(summary.unit)
+        .arg(statistics.windowMs() / 1000));
+    m_statisticsLabel->setText(QStringList(m_statisticsLines.values()).join('\n'));
 }
@@ -2,14 +2,22 @@
 #define LIVEDATAVIEW_H
 
 #include <QWidget>
+#include <QComboBox>
+#include <QHash>
 #include <QLabel>
+#include <QMap>
 #include <QVBoxLayout>
+#include "core/dto/PidMeta.h"
+#include "core/dto/PidSample.h"
 
 class AppState;
+class GaugePanel;
+class StripChart;
 
 /**
  * @brief The LiveDataView class
- * Live Data screen placeholder (to be implemented in Phase 4).
+ * Live Data screen with gauges and a real-time strip chart (PID streaming follows
+ * in Phase 4). Driving Mode enlarges the gauges.
  */
 class LiveDataView : public QWidget
 {
@@ -19,12 +27,36 @@ public:
     explicit LiveDataView(QWidget *parent = nullptr);
     void setAppState(AppState* appState);
 
+    GaugePanel* gaugePanel() const { return m_gaugePanel; }
+    StripChart* stripChart() const { return m_stripChart; }
+    QComboBox* pidPicker() const { return m_pidPicker; }
+
+    /**
+     * @brief Adds a gauge and a chart band for a PID from AppState::pidMetas().
+     */
+    void showPid(const PidMeta& meta);
+
 private slots:
     void onDrivingModeChanged(bool driving);
+    void onLiveSampleChanged(const PidSample& sample, int coalescedCount);
+    void onPidMetasChanged();
+    void onPidPicked(int index);
 
 private:
+    void updateStatistics(const PidSample& sample);
+
     AppState* m_appState = nullptr;
     QLabel* m_placeholderLabel = nullptr;
+    QComboBox* m_pidPicker = nullptr;
+    QVector<PidMeta> m_pidMetas;                    // Picker entries, in picker order
+    GaugePanel* m_gaugePanel = nullptr;
+    StripChart* m_stripChart = nullptr;
+    QLabel* m_statisticsLabel = nullptr;
+    QMap<QString, QString> m_statisticsLines;       // PID id -> summary of the last window
+    QHash<QString, qint64> m_statisticsUpdatedNs;   // PID id -> sample time of the last refresh
+    qint64 m_sessionStartNs = -1;  // Time origin of the chart (PidSample::sampleTimeNs), -1 until the first sample
+
+    static constexpr qint64 STATISTICS_INTERVAL_NS = 250000000;  // Readable, and a snapshot per PID at 4 Hz at most
 };
 
 #endif // LIVEDATAVIEW_H
@@ -1,5 +1,8 @@
 #include "LogsView.h"
+#include "core/LogCatalog.h"
 #include "ui/state/AppState.h"
+#include "ui/models/LogCatalogModel.h"
+#include <QHeaderView>
 #include <QVBoxLayout>
 
 LogsView::LogsView(QWidget *parent)
@@ -7,16 +10,57 @@ LogsView::LogsView(QWidget *parent)
     , m_appState(nullptr)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
 
-    m_placeholderLabel = new QLabel("Logs - Coming in Phase 5", this);
+    m_model = new LogCatalogModel(this);
+
+    // Fixed row heights: the view only asks the model for the rows on screen,
+    // so scrolling reads one catalog page at a time
+    m_tableView = new QTableView(this);
+    m_tableView->setModel(m_model);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableView->setWordWrap(false);
+    m_tableView->verticalHeader()->hide();
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->verticalHeader()->setDefaultSectionSize(m_tableView->fontMetrics().height() + 6);
+    m_tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_tableView->horizontalHeader()->setStretchLastSection(true);
+    m_tableView->setColumnWidth(LogCatalogModel::VehicleColumn, m_tableView->fontMetrics().horizontalAdvance("W") * 16);
+    layout->addWidget(m_tableView, 1);
+
+    m_placeholderLabel = new QLabel("No recorded logs", this);
     m_placeholderLabel->setAlignment(Qt::AlignCenter);
     m_placeholderLabel->setStyleSheet("font-size: 16px; color: gray;");
-    layout->addWidget(m_placeholderLabel);
+    layout->addWidget(m_placeholderLabel, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setStyleSheet("color: gray;");
+    layout->addWidget(m_countLabel);
+
+    connect(m_model, &QAbstractItemModel::modelReset, this, &LogsView::updateCountLabel);
+    updateCountLabel();
 }
 
 void LogsView::setAppState(AppState* appState)
 {
     m_appState = appState;
-    // Will be used in Phase 5 for log management and playback
+    // Will be used in Phase 5 for log playback
+}
+
+void LogsView::setLogCatalog(LogCatalog* catalog)
+{
+    m_catalog = catalog;
+    m_model->setCatalog(catalog);
+}
+
+void LogsView::updateCountLabel()
+{
+    const int count = m_model->rowCount();
+    m_tableView->setVisible(count > 0);
+    m_placeholderLabel->setVisible(count == 0);
+    if (!m_catalog) {
+        m_countLabel->setText("Log catalog unavailable");
+    } else {
+        m_countLabel->setText(count == 1 ? QString("1 log") : QString("%1 logs").arg(count));
+    }
 }
@@ -3,13 +3,17 @@
 
 #include <QWidget>
 #include <QLabel>
+#include <QTableView>
 #include <QVBoxLayout>
 
 class AppState;
+class LogCatalog;
+class LogCatalogModel;
 
 /**
  * @brief The LogsView class
- * Logs screen placeholder (to be implemented in Phase 5).
+ * Logs screen: every recording in the log directory, newest first, listed
+ * from the LogCatalog without opening the logs.
  */
 class LogsView : public QWidget
 {
@@ -18,10 +22,21 @@ class LogsView : public QWidget
 public:
     explicit LogsView(QWidget *parent = nullptr);
     void setAppState(AppState* appState);
+    void setLogCatalog(LogCatalog* catalog);
+
+    LogCatalogModel* model() const { return m_model; }
+
+private slots:
+    void updateCountLabel();
 
 private:
     AppState* m_appState = nullptr;
+    LogCatalog* m_catalog = nullptr;
+    LogCatalogModel* m_model = nullptr;
+
+    QTableView* m_tableView = nullptr;
     QLabel* m_placeholderLabel = nullptr;
+    QLabel* m_countLabel = nullptr;
 };
 
 #endif // LOGSVIEW_H
@@ -1,22 +1,229 @@
 #include "ReadinessView.h"
 #include "ui/state/AppState.h"
+#include "core/ScanResultJson.h"
+#include <QDateTime>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
 #include <QVBoxLayout>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+QString monitorLabel(Monitor monitor)
+{
+    return QString::fromLatin1(ReadinessResult::monitorName(monitor));
+}
+
+QString estimateText(const ReadinessTracker::Estimate& estimate)
+{
+    if (estimate.percent == 100) {
+        return "Done";
+    }
+    if (estimate.runningMs == 0) {
+        return "-";
+    }
+    const qint64 runningMinutes = estimate.runningMs / 60000;
+    if (estimate.remainingMs < 0) {
+        return QString("Running %1 min, longer than usual").arg(runningMinutes);
+    }
+    return QString("~%1 min left (%2%)").arg((estimate.remainingMs + 59999) / 60000).arg(estimate.percent);
+}
+
+} // namespace
 
 ReadinessView::ReadinessView(QWidget *parent)
     : QWidget(parent)
     , m_appState(nullptr)
 {
+    std::fill(std::begin(m_rows), std::end(m_rows), -1);
+
     QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
 
-    m_placeholderLabel = new QLabel("Readiness - Coming in Phase 6", this);
-    m_placeholderLabel->setAlignment(Qt::AlignCenter);
-    m_placeholderLabel->setStyleSheet("font-size: 16px; color: gray;");
-    layout->addWidget(m_placeholderLabel);
+    // Tracking controls
+    QHBoxLayout* controlsLayout = new QHBoxLayout();
+    m_trackButton = new QPushButton("Track Drive Cycle", this);
+    m_trackButton->setCheckable(true);
+    m_trackButton->setEnabled(false);
+    m_trackButton->setToolTip("Polls monitor status (Mode 01 PID 41 and PID 01) while you drive.");
+    controlsLayout->addWidget(m_trackButton);
+
+    controlsLayout->addWidget(new QLabel("Every", this));
+    m_intervalSpinBox = new QSpinBox(this);
+    m_intervalSpinBox->setRange(ReadinessTracker::MIN_INTERVAL_MS / 1000, 60);
+    m_intervalSpinBox->setValue(ReadinessTracker::DEFAULT_INTERVAL_MS / 1000);
+    m_intervalSpinBox->setSuffix(" s");
+    controlsLayout->addWidget(m_intervalSpinBox);
+
+    m_summaryLabel = new QLabel("Not tracking", this);
+    m_summaryLabel->setStyleSheet("color: gray;");
+    controlsLayout->addWidget(m_summaryLabel, 1);
+    layout->addLayout(controlsLayout);
+
+    // One row per monitor the vehicle reports
+    m_monitorTable = new QTableWidget(0, ColumnCount, this);
+    m_monitorTable->setHorizontalHeaderLabels({"Monitor", "Since Cleared", "This Drive", "Estimate"});
+    m_monitorTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_monitorTable->verticalHeader()->setVisible(false);
+    m_monitorTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_monitorTable->setSelectionMode(QAbstractItemView::NoSelection);
+    layout->addWidget(m_monitorTable, 2);
+
+    // Transitions, newest first
+    QGroupBox* timelineGroup = new QGroupBox("Transitions", this);
+    QVBoxLayout* timelineLayout = new QVBoxLayout(timelineGroup);
+    m_timelineList = new QListWidget(timelineGroup);
+    timelineLayout->addWidget(m_timelineList);
+    layout->addWidget(timelineGroup, 1);
+
+    connect(m_trackButton, &QPushButton::toggled, this, &ReadinessView::onTrackToggled);
+    connect(m_intervalSpinBox, &QSpinBox::valueChanged, this, &ReadinessView::onIntervalChanged);
 }
 
 void ReadinessView::setAppState(AppState* appState)
 {
+    if (m_appState) {
+        disconnect(m_appState, &AppState::connectionStateChanged, this, &ReadinessView::onConnectionStateChanged);
+    }
+
     m_appState = appState;
-    // Will be used in Phase 6 to display readiness results
+
+    if (m_appState) {
+        connect(m_appState, &AppState::connectionStateChanged, this, &ReadinessView::onConnectionStateChanged);
+        onConnectionStateChanged(m_appState->connectionState());
+    }
+}
+
+void ReadinessView::setReadinessTracker(ReadinessTracker* tracker)
+{
+    if (m_tracker) {
+        disconnect(m_tracker, nullptr, this, nullptr);
+    }
+
+    m_tracker = tracker;
+
+    if (m_tracker) {
+        connect(m_tracker, &ReadinessTracker::statusUpdated, this, &ReadinessView::onStatusUpdated);
+        connect(m_tracker, &ReadinessTracker::transitionRecorded, this, &ReadinessView::onTransitionRecorded);
+        m_tracker->setIntervalMs(m_intervalSpinBox->value() * 1000);
+    }
+}
+
+void ReadinessView::onTrackToggled(bool track)
+{
+    if (!m_tracker) {
+        return;
+    }
+
+    if (track) {
+        m_trackButton->setText("Stop Tracking");
+        m_tracker->start();
+    } else {
+        m_trackButton->setText("Track Drive Cycle");
+        m_tracker->stop();
+    }
+    updateSummary();
+}
+
+void ReadinessView::onIntervalChanged(int seconds)
+{
+    if (m_tracker) {
+        m_tracker->setIntervalMs(seconds * 1000);
+    }
+}
+
+void ReadinessView::onConnectionStateChanged(const ConnectionStateInfo& state)
+{
+    const bool connected = state.state == ConnectionState::ConnectedEcu;
+    m_trackButton->setEnabled(connected);
+    if (!connected && m_trackButton->isChecked()) {
+        m_trackButton->setChecked(false);
+    }
+}
+
+void ReadinessView::onStatusUpdated(ReadinessTracker::Scope scope, quint16 changedMonitors)
+{
+    const ReadinessResult& result = scope == ReadinessTracker::ThisDriveCycle
+        ? m_tracker->thisDriveCycle()
+        : m_tracker->sinceCleared();
+
+    // Status cells change only for the monitors in changedMonitors; estimates
+    // move with time, so every shown row gets its estimate refreshed
+    result.forEachMonitor([this, changedMonitors](Monitor monitor, MonitorStatus) {
+        if (m_rows[int(monitor)] < 0 || (changedMonitors & ReadinessResult::bit(monitor))) {
+            rowFor(monitor);
+            updateRow(monitor);
+        }
+    });
+    for (int i = 0; i < ReadinessResult::MONITOR_COUNT; ++i) {
+        if (m_rows[i] >= 0) {
+            const ReadinessTracker::Estimate estimate = m_tracker->estimate(Monitor(i));
+            m_monitorTable->item(m_rows[i], EstimateColumn)->setText(estimateText(estimate));
+        }
+    }
+    updateSummary();
+}
+
+void ReadinessView::onTransitionRecorded(const ReadinessTracker::Transition& transition)
+{
+    m_timelineList->insertItem(0, QString("%1  %2  %3: %4 -> %5")
+        .arg(QDateTime::fromMSecsSinceEpoch(transition.timestampMs).toString("hh:mm:ss"))
+        .arg(monitorLabel(transition.monitor))
+        .arg(transition.scope == ReadinessTracker::ThisDriveCycle ? "this drive" : "since cleared")
+        .arg(ScanResultJson::monitorStatusName(transition.before))
+        .arg(ScanResultJson::monitorStatusName(transition.after)));
+}
+
+int ReadinessView::rowFor(Monitor monitor)
+{
+    int& row = m_rows[int(monitor)];
+    if (row < 0) {
+        row = m_monitorTable->rowCount();
+        m_monitorTable->insertRow(row);
+        m_monitorTable->setItem(row, MonitorColumn, new QTableWidgetItem(monitorLabel(monitor)));
+        for (int column = SinceClearedColumn; column < ColumnCount; ++column) {
+            m_monitorTable->setItem(row, column, new QTableWidgetItem());
+        }
+    }
+    return row;
+}
+
+void ReadinessView::updateRow(Monitor monitor)
+{
+    const int row = m_rows[int(monitor)];
+    const ReadinessTracker::Estimate estimate = m_tracker->estimate(monitor);
+
+    auto statusText = [monitor](const ReadinessResult& result) {
+        return result.isReported(monitor) ? ScanResultJson::monitorStatusName(result.getMonitorStatus(monitor))
+                                          : QString("-");
+    };
+    m_monitorTable->item(row, SinceClearedColumn)->setText(statusText(m_tracker->sinceCleared()));
+
+    // In PID 41 an unavailable monitor is one not enabled this drive cycle
+    const bool disabled = m_tracker->thisDriveCycle().isReported(monitor) &&
+                          m_tracker->thisDriveCycle().getMonitorStatus(monitor) == MonitorStatus::Unsupported;
+    m_monitorTable->item(row, DriveCycleColumn)->setText(disabled ? QString("not enabled")
+                                                                  : statusText(m_tracker->thisDriveCycle()));
+    m_monitorTable->item(row, EstimateColumn)->setText(estimateText(estimate));
+}
+
+void ReadinessView::updateSummary()
+{
+    if (!m_tracker) {
+        return;
+    }
+
+    QString text = m_tracker->isRunning() ? "Tracking" : "Not tracking";
+    if (!m_tracker->sinceCleared().isEmpty()) {
+        text += m_tracker->sinceCleared().overallReady ? " - Ready" : " - Not Ready";
+    }
+    text += QString(" (%1 requests, %2 transitions)")
+        .arg(m_tracker->requestsSent())
+        .arg(m_tracker->transitions().size());
+    m_summaryLabel->setText(text);
 }
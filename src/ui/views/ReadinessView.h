@@ -4,12 +4,21 @@
 #include <QWidget>
 #include <QLabel>
 #include <QVBoxLayout>
+#include "core/ReadinessTracker.h"
+#include "core/dto/ConnectionState.h"
 
 class AppState;
+class QListWidget;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
 
 /**
  * @brief The ReadinessView class
- * Readiness screen placeholder (to be implemented in Phase 6).
+ * Drive cycle readiness screen. Shows every monitor's status since DTCs were
+ * cleared and in this drive cycle, with an estimate of how far it is from
+ * completing, and the transitions recorded by ReadinessTracker. Rows are
+ * updated as the tracker reports changes, not rebuilt.
  */
 class ReadinessView : public QWidget
 {
@@ -18,10 +27,36 @@ class ReadinessView : public QWidget
 public:
     explicit ReadinessView(QWidget *parent = nullptr);
     void setAppState(AppState* appState);
+    void setReadinessTracker(ReadinessTracker* tracker);
+
+private slots:
+    void onTrackToggled(bool track);
+    void onIntervalChanged(int seconds);
+    void onConnectionStateChanged(const ConnectionStateInfo& state);
+    void onStatusUpdated(ReadinessTracker::Scope scope, quint16 changedMonitors);
+    void onTransitionRecorded(const ReadinessTracker::Transition& transition);
 
 private:
+    enum Column {
+        MonitorColumn,
+        SinceClearedColumn,
+        DriveCycleColumn,
+        EstimateColumn,
+        ColumnCount
+    };
+
+    int rowFor(Monitor monitor);
+    void updateRow(Monitor monitor);
+    void updateSummary();
+
     AppState* m_appState = nullptr;
-    QLabel* m_placeholderLabel = nullptr;
+    ReadinessTracker* m_tracker = nullptr;
+    QPushButton* m_trackButton = nullptr;
+    QSpinBox* m_intervalSpinBox = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    QTableWidget* m_monitorTable = nullptr;
+    QListWidget* m_timelineList = nullptr;
+    int m_rows[ReadinessResult::MONITOR_COUNT];     // Table row per monitor, -1 if not shown yet
 };
 
 #endif // READINESSVIEW_H
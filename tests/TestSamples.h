@@ -0,0 +1,27 @@
+#ifndef TESTSAMPLES_H
+#define TESTSAMPLES_H
+
+#include <QDateTime>
+#include <QString>
+#include "core/dto/PidSample.h"
+
+/**
+ * @brief PidSample factory shared by the live-data tests.
+ * Sample time 0 of a test is START_NS on the monotonic clock and START_MS on
+ * the wall clock. START_NS is not 0, because a sampleTimeNs of 0 means
+ * unstamped and would be replaced with SampleClock::now().
+ */
+namespace TestSamples {
+
+constexpr qint64 START_NS = qint64(3600) * 1000000000;
+constexpr qint64 START_MS = 1700000000000;
+
+inline PidSample sample(const QString& pidId, double value, qint64 timeMs, const QString& unit = QString())
+{
+    return PidSample(pidId, value, unit, QDateTime::fromMSecsSinceEpoch(START_MS + timeMs),
+                     START_NS + timeMs * 1000000);
+}
+
+} // namespace TestSamples
+
+#endif // TESTSAMPLES_H
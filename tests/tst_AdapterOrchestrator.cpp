@@ -0,0 +1,241 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QThread>
+#include <atomic>
+#include "core/AdapterOrchestrator.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestAdapterOrchestrator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testScanManyAdapters();
+    void testJobsOnOnePortShareConnection();
+    void testStream();
+    void testFailures();
+    void testCancel();
+    void testParallelThroughput();
+
+private:
+    // Simulated adapters; ports named "noecu..." have no ECU behind them
+    static AdapterOrchestrator::TransporterCreator simulated(int latencyMs, std::atomic<int>* created = nullptr);
+    static QList<AdapterOrchestrator::Result> runUntilIdle(AdapterOrchestrator& orchestrator, int timeoutMs = 10000);
+};
+
+AdapterOrchestrator::TransporterCreator TestAdapterOrchestrator::simulated(int latencyMs, std::atomic<int>* created)
+{
+    return [latencyMs, created](const QString& port, QObject* parent) -> ObdTransporter* {
+        if (created) {
+            created->fetch_add(1);
+        }
+        SimulatedTransporter* transporter = new SimulatedTransporter(parent);
+        transporter->setLatency(latencyMs);
+        if (port.startsWith("noecu")) {
+            transporter->setResponse("01 00", "NO DATA");
+        }
+        return transporter;
+    };
+}
+
+QList<AdapterOrchestrator::Result> TestAdapterOrchestrator::runUntilIdle(AdapterOrchestrator& orchestrator, int timeoutMs)
+{
+    QList<AdapterOrchestrator::Result> results;
+    bool idle = false;
+    QObject context;
+    connect(&orchestrator, &AdapterOrchestrator::resultReady, &context,
+            [&](const AdapterOrchestrator::Result& result) { results.append(result); });
+    connect(&orchestrator, &AdapterOrchestrator::idle, &context, [&]() { idle = true; });
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!idle && timer.elapsed() < timeoutMs) {
+        QTest::qWait(5);
+    }
+    return results;
+}
+
+void TestAdapterOrchestrator::testScanManyAdapters()
+{
+    AdapterOrchestrator orchestrator;
+    orchestrator.setTransporterCreator(simulated(2));
+
+    QSet<int> jobIds;
+    for (int i = 0; i < 8; ++i) {
+        AdapterOrchestrator::Job job;
+        job.port = QString("sim%1").arg(i);
+        jobIds.insert(orchestrator.submit(job));
+    }
+    QCOMPARE(orchestrator.adapterCount(), 8);
+    QCOMPARE(orchestrator.pendingJobs(), 8);
+
+    const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+    QCOMPARE(results.size(), 8);
+    QCOMPARE(orchestrator.pendingJobs(), 0);
+
+    QSet<QString> ports;
+    for (const AdapterOrchestrator::Result& result : results) {
+        QVERIFY2(result.ok, qPrintable(result.error));
+        QVERIFY(result.last);
+        QVERIFY(result.hasResult);
+        QVERIFY(jobIds.remove(result.jobId));
+        QCOMPARE(result.protocol, QString("ISO 9141-2"));
+        QVERIFY(result.plannedCommands > 0);
+        QVERIFY(result.result.milOn);
+        QCOMPARE(result.json.value("dtcs").toArray().size(), 1);
+        ports.insert(result.port);
+    }
+    QCOMPARE(ports.size(), 8);
+}
+
+void TestAdapterOrchestrator::testJobsOnOnePortShareConnection()
+{
+    std::atomic<int> created{0};
+    AdapterOrchestrator orchestrator;
+    orchestrator.setTransporterCreator(simulated(0, &created));
+
+    AdapterOrchestrator::Job job;
+    job.port = "sim";
+    job.type = AdapterOrchestrator::Job::Connect;
+    const int connectId = orchestrator.submit(job);
+    job.type = AdapterOrchestrator::Job::Scan;
+    const int firstScan = orchestrator.submit(job);
+    job.recipe = ScanPlanner::EmissionsPrecheck;
+    const int secondScan = orchestrator.submit(job);
+    QCOMPARE(orchestrator.adapterCount(), 1);
+
+    // Jobs on one port run in submission order
+    const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+    QCOMPARE(results.size(), 3);
+    QCOMPARE(results[0].jobId, connectId);
+    QVERIFY(results[0].ok);
+    QVERIFY(!results[0].hasResult);
+    QCOMPARE(results[0].protocol, QString("ISO 9141-2"));
+    QCOMPARE(results[1].jobId, firstScan);
+    QCOMPARE(results[2].jobId, secondScan);
+    QVERIFY(results[1].ok && results[2].ok);
+
+    // The scans reuse the connection made by the first job
+    QCOMPARE(results[2].protocol, QString("ISO 9141-2"));
+    QCOMPARE(created.load(), 1);
+}
+
+void TestAdapterOrchestrator::testStream()
+{
+    AdapterOrchestrator orchestrator;
+    orchestrator.setTransporterCreator(simulated(0));
+
+    AdapterOrchestrator::Job job;
+    job.port = "sim";
+    job.type = AdapterOrchestrator::Job::Stream;
+    job.repeat = 3;
+    job.intervalMs = 10;
+    orchestrator.submit(job);
+
+    const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+    QCOMPARE(results.size(), 3);
+    QList<int> iterations;
+    for (const AdapterOrchestrator::Result& result : results) {
+        QVERIFY(result.ok);
+        QVERIFY(result.hasResult);
+        QCOMPARE(result.type, AdapterOrchestrator::Job::Stream);
+        iterations.append(result.iteration);
+        QCOMPARE(result.last, result.iteration == 2);
+    }
+    std::sort(iterations.begin(), iterations.end());
+    QCOMPARE(iterations, QList<int>({0, 1, 2}));
+}
+
+void TestAdapterOrchestrator::testFailures()
+{
+    AdapterOrchestrator orchestrator;
+    orchestrator.setTransporterCreator(simulated(50));
+
+    AdapterOrchestrator::Job noEcu;
+    noEcu.port = "noecu";
+    const int noEcuId = orchestrator.submit(noEcu);
+
+    AdapterOrchestrator::Job slow;
+    slow.port = "slow";
+    slow.timeoutMs = 120;     // Not enough for the five connection commands at 50 ms each
+    const int slowId = orchestrator.submit(slow);
+
+    const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+    QCOMPARE(results.size(), 2);
+    for (const AdapterOrchestrator::Result& result : results) {
+        QVERIFY(!result.ok);
+        QVERIFY(result.last);
+        if (result.jobId == noEcuId) {
+            QCOMPARE(result.error, QString("Adapter connected but ECU not responding"));
+        } else {
+            QCOMPARE(result.jobId, slowId);
+            QCOMPARE(result.error, QString("Timed out"));
+        }
+    }
+}
+
+void TestAdapterOrchestrator::testCancel()
+{
+    AdapterOrchestrator orchestrator;
+    orchestrator.setTransporterCreator(simulated(0));
+
+    AdapterOrchestrator::Job stream;
+    stream.port = "sim";
+    stream.type = AdapterOrchestrator::Job::Stream;
+    stream.intervalMs = 20;       // Until cancelled
+    orchestrator.submit(stream);
+    AdapterOrchestrator::Job queued;
+    queued.port = "sim";
+    orchestrator.submit(queued);
+
+    bool firstResult = false;
+    connect(&orchestrator, &AdapterOrchestrator::resultReady, this, [&]() {
+        if (!firstResult) {
+            firstResult = true;
+            orchestrator.cancel();
+        }
+    });
+
+    const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+    QVERIFY(firstResult);
+    QVERIFY(results.size() >= 3);
+    QCOMPARE(orchestrator.pendingJobs(), 0);
+
+    int cancelled = 0;
+    for (const AdapterOrchestrator::Result& result : results) {
+        if (result.error == "Cancelled") {
+            QVERIFY(result.last);
+            ++cancelled;
+        }
+    }
+    QCOMPARE(cancelled, 2);
+}
+
+void TestAdapterOrchestrator::testParallelThroughput()
+{
+    // Each scan spends most of its time waiting on adapter replies; with one
+    // thread per adapter, 8 adapters take about as long as one
+    auto timeScans = [](int adapters) {
+        AdapterOrchestrator orchestrator;
+        orchestrator.setTransporterCreator(simulated(10));
+        for (int i = 0; i < adapters; ++i) {
+            AdapterOrchestrator::Job job;
+            job.port = QString("sim%1").arg(i);
+            orchestrator.submit(job);
+        }
+        QElapsedTimer timer;
+        timer.start();
+        const QList<AdapterOrchestrator::Result> results = runUntilIdle(orchestrator);
+        return results.size() == adapters ? timer.elapsed() : qint64(-1);
+    };
+
+    const qint64 one = timeScans(1);
+    const qint64 eight = timeScans(8);
+    QVERIFY(one > 0);
+    QVERIFY(eight > 0);
+    QVERIFY2(eight < one * 3, qPrintable(QString("1 adapter: %1 ms, 8 adapters: %2 ms").arg(one).arg(eight)));
+}
+
+QTEST_MAIN(TestAdapterOrchestrator)
+#include "tst_AdapterOrchestrator.moc"
@@ -1,8 +1,15 @@
 #include <QtTest/QtTest>
 #include "ui/state/AppState.h"
+#include "ui/models/DtcTableModel.h"
 #include "core/dto/ConnectionState.h"
 #include "core/dto/VehicleProfile.h"
 #include "core/dto/ScanResult.h"
+#include "core/dto/PidSample.h"
+#include "core/TriggerEngine.h"
+#include "TestSamples.h"
+
+using TestSamples::sample;
+using TestSamples::START_NS;
 
 class TestAppState : public QObject
 {
@@ -17,6 +24,13 @@ private slots:
     void testDrivingModeToggle();
     void testVehicleProfile();
     void testScanResult();
+    void testScanResultSnapshots();
+    void testScanDiff();
+    void testDtcModel();
+    void testLiveSampleCoalescing();
+    void testVirtualPidSamples();
+    void testLiveStatistics();
+    void testTriggerCaptures();
     void testExpertMode();
     void testSignalEmission();
 
@@ -133,6 +147,299 @@ void TestAppState::testScanResult()
     QCOMPARE(retrieved.dtcs[0].code, QString("P0420"));
 }
 
+void TestAppState::testScanResultSnapshots()
+{
+    quint64 versionBefore = m_appState->lastScanVersion();
+    ScanResultSnapshot before = m_appState->lastScanSnapshot();
+    QVERIFY(before != nullptr);
+
+    QSignalSpy snapshotSpy(m_appState, &AppState::lastScanSnapshotChanged);
+
+    ScanResult result;
+    result.dtcs.append(DtcEntry("P0171", DtcStatus::Pending));
+    m_appState->setLastScanResult(result);
+
+    // Each publish bumps the version by one
+    QCOMPARE(m_appState->lastScanVersion(), versionBefore + 1);
+    QCOMPARE(snapshotSpy.count(), 1);
+
+    ScanResultSnapshot after = m_appState->lastScanSnapshot();
+    QCOMPARE(after->version, versionBefore + 1);
+    QCOMPARE(after->dtcs.size(), 1);
+    QCOMPARE(after->dtcs[0].code, QString("P0171"));
+
+    // Earlier snapshots are immutable and remain valid for their holders
+    QCOMPARE(before->version, versionBefore);
+    QVERIFY(before != after);
+
+    // Signal carries the same shared snapshot, no copy
+    ScanResultSnapshot emitted = snapshotSpy.takeFirst().at(0).value<ScanResultSnapshot>();
+    QCOMPARE(emitted.get(), after.get());
+
+    // Publishing identical content is still a new version
+    m_appState->setLastScanResult(result);
+    QCOMPARE(m_appState->lastScanVersion(), versionBefore + 2);
+}
+
+void TestAppState::testScanDiff()
+{
+    AppState state;
+    QSignalSpy diffSpy(&state, &AppState::lastScanDiffChanged);
+
+    ScanResult first;
+    first.vin = "VIN_DIFF";
+    first.dtcs.append(DtcEntry("P0420", DtcStatus::Pending));
+    first.dtcs.append(DtcEntry("P0133"));
+
+    // Seeded from history; the next scan of the VIN is compared with it
+    QVERIFY(!state.hasScanBaseline("VIN_DIFF"));
+    state.setScanBaseline(first);
+    QVERIFY(state.hasScanBaseline("VIN_DIFF"));
+
+    // Progressive updates do not produce a diff
+    ScanResult partial;
+    partial.vin = "VIN_DIFF";
+    partial.complete = false;
+    state.setLastScanResult(partial);
+    QCOMPARE(diffSpy.count(), 0);
+
+    ScanResult second;
+    second.vin = "VIN_DIFF";
+    second.dtcs.append(DtcEntry("P0420"));
+    second.dtcs.append(DtcEntry("P0300"));
+    state.setLastScanResult(second);
+
+    QCOMPARE(diffSpy.count(), 1);
+    ScanDiff diff = state.lastScanDiff();
+    QVERIFY(diff.hasBaseline);
+    QCOMPARE(diff.addedDtcs.size(), 1);
+    QCOMPARE(diff.addedDtcs[0].code, QString("P0300"));
+    QCOMPARE(diff.clearedDtcs.size(), 1);
+    QCOMPARE(diff.clearedDtcs[0].code, QString("P0133"));
+    QCOMPARE(diff.pendingToConfirmedCount(), 1);
+
+    // A different vehicle has no baseline yet
+    ScanResult other;
+    other.vin = "VIN_OTHER";
+    state.setLastScanResult(other);
+    QVERIFY(!state.lastScanDiff().hasBaseline);
+
+    // The complete scan became the baseline for the next one
+    state.setLastScanResult(second);
+    QVERIFY(state.lastScanDiff().hasBaseline);
+    QVERIFY(state.lastScanDiff().isEmpty());
+
+    // Scans without a VIN are never compared and never become a baseline
+    ScanResult anonymous;
+    anonymous.dtcs.append(DtcEntry("P0171"));
+    state.setLastScanResult(anonymous);
+    state.setLastScanResult(anonymous);
+    QVERIFY(!state.lastScanDiff().hasBaseline);
+    QVERIFY(!state.hasScanBaseline(QString()));
+
+    // A timed-out scan is not compared and leaves the baseline as it was
+    const int diffs = diffSpy.count();
+    ScanResult cutShort;
+    cutShort.vin = "VIN_DIFF";
+    cutShort.timedOut = true;
+    state.setLastScanResult(cutShort);
+    QCOMPARE(diffSpy.count(), diffs);
+    state.setLastScanResult(second);
+    QVERIFY(state.lastScanDiff().hasBaseline);
+    QVERIFY(state.lastScanDiff().isEmpty());
+}
+
+void TestAppState::testDtcModel()
+{
+    // Filled as scans complete, with no view attached
+    AppState state;
+    QCOMPARE(state.dtcModel()->rowCount(), 0);
+
+    ScanResult partial;
+    partial.vin = "VIN_CODES";
+    partial.complete = false;
+    partial.dtcs.append(DtcEntry("P0420"));
+    state.setLastScanResult(partial);
+    QCOMPARE(state.dtcModel()->rowCount(), 0);
+
+    ScanResult scan = partial;
+    scan.complete = true;
+    scan.dtcs.append(DtcEntry("P0300", DtcStatus::Pending));
+    state.setLastScanResult(scan);
+    QCOMPARE(state.dtcModel()->rowCount(), 2);
+
+    // Every complete scan is an occurrence, even of the same codes
+    state.setLastScanResult(scan);
+    QCOMPARE(state.dtcModel()->rowCount(), 4);
+    QCOMPARE(state.dtcModel()->store().vehicleCount(), 1);
+}
+
+void TestAppState::testLiveSampleCoalescing()
+{
+    QSignalSpy liveSpy(m_appState, &AppState::liveSampleChanged);
+    m_appState->setNotificationRate(30);
+    QCOMPARE(m_appState->notificationRate(), 30);
+
+    // A burst at data rate: 10 RPM samples and 3 speed samples
+    for (int i = 0; i < 10; ++i) {
+        m_appState->setLiveSample(PidSample("010C", 1000.0 + i, "rpm"));
+    }
+    for (int i = 0; i < 3; ++i) {
+        m_appState->setLiveSample(PidSample("010D", 40.0 + i, "km/h"));
+    }
+
+    // Nothing is delivered synchronously
+    QCOMPARE(liveSpy.count(), 0);
+    QCOMPARE(m_appState->liveSample("010C").value, 1009.0);
+
+    // One notification per PID on the next frame, with the latest value and count
+    QTRY_COMPARE_WITH_TIMEOUT(liveSpy.count(), 2, 1000);
+
+    QList<QVariant> rpm = liveSpy.at(0);
+    QCOMPARE(rpm.at(0).value<PidSample>().pidId, QString("010C"));
+    QCOMPARE(rpm.at(0).value<PidSample>().value, 1009.0);
+    QCOMPARE(rpm.at(1).toInt(), 10);
+
+    QList<QVariant> speed = liveSpy.at(1);
+    QCOMPARE(speed.at(0).value<PidSample>().pidId, QString("010D"));
+    QCOMPARE(speed.at(0).value<PidSample>().value, 42.0);
+    QCOMPARE(speed.at(1).toInt(), 3);
+
+    // No further notifications without new data
+    QTest::qWait(100);
+    QCOMPARE(liveSpy.count(), 2);
+    QCOMPARE(m_appState->liveFrame("010C").min.value, 1000.0);
+    QCOMPARE(m_appState->liveFrame("010C").max.value, 1009.0);
+
+    // A spike between notifications is kept in the frame's extremes
+    m_appState->setLiveSample(PidSample("010C", 900.0, "rpm"));
+    m_appState->setLiveSample(PidSample("010C", 6500.0, "rpm"));
+    m_appState->setLiveSample(PidSample("010C", 950.0, "rpm"));
+    QTRY_COMPARE_WITH_TIMEOUT(liveSpy.count(), 3, 1000);
+    QCOMPARE(liveSpy.at(2).at(0).value<PidSample>().value, 950.0);
+    QCOMPARE(m_appState->liveFrame("010C").min.value, 900.0);
+    QCOMPARE(m_appState->liveFrame("010C").max.value, 6500.0);
+}
+
+void TestAppState::testVirtualPidSamples()
+{
+    AppState state;
+    VirtualPidEngine::Definition economy;
+    economy.pidId = "V_ECON";
+    economy.name = "Fuel economy";
+    economy.unit = "mpg";
+    economy.expression = "(vss*7.718)/maf";
+    QVERIFY(state.virtualPids().define(economy));
+
+    // Listed before its inputs report, but not computable yet
+    QCOMPARE(state.pidMetas().size(), 1);
+    QVERIFY(state.pidMetas().first().isVirtual);
+    QVERIFY(!state.pidMetas().first().supported);
+
+    QSignalSpy liveSpy(&state, &AppState::liveSampleChanged);
+    QSignalSpy metasSpy(&state, &AppState::pidMetasChanged);
+    state.setLiveSamples({PidSample("010D", 100.0, "km/h"), PidSample("0110", 20.0, "g/s")});
+    QCOMPARE(state.liveSample("V_ECON").value, 100.0 * 7.718 / 20.0);
+
+    // Real PIDs by id, then the virtual one, as the live data pickers list them
+    QCOMPARE(metasSpy.count(), 3);
+    const QVector<PidMeta> metas = state.pidMetas();
+    QCOMPARE(metas.size(), 3);
+    QCOMPARE(metas[0].pidId, QString("010D"));
+    QCOMPARE(metas[0].unit, QString("km/h"));
+    QVERIFY(!metas[0].isVirtual);
+    QCOMPARE(metas[1].pidId, QString("0110"));
+    QCOMPARE(metas[2].pidId, QString("V_ECON"));
+    QCOMPARE(metas[2].name, QString("Fuel economy"));
+    QVERIFY(metas[2].isVirtual && metas[2].supported);
+
+    // Single samples go through the engine too
+    state.setLiveSample(PidSample("0110", 10.0, "g/s"));
+    QCOMPARE(state.liveSample("V_ECON").value, 100.0 * 7.718 / 10.0);
+    QCOMPARE(state.liveSample("V_ECON").unit, QString("mpg"));
+    QCOMPARE(metasSpy.count(), 3);
+
+    // Delivered like any other PID
+    QTRY_COMPARE_WITH_TIMEOUT(liveSpy.count(), 3, 1000);
+}
+
+void TestAppState::testLiveStatistics()
+{
+    AppState state;
+    VirtualPidEngine::Definition doubled;
+    doubled.pidId = "V_DOUBLE";
+    doubled.expression = "rpm * 2";
+    QVERIFY(state.virtualPids().define(doubled));
+
+    state.setLiveSamples({PidSample("010C", 800.0, "rpm"), PidSample("010C", 1200.0, "rpm")});
+    state.setLiveSample(PidSample("010C", 1000.0, "rpm"));
+    state.setLiveSample(PidSample());   // Invalid: not counted
+
+    const PidStatistics::Summary rpm = state.statistics().snapshot("010C");
+    QCOMPARE(rpm.unit, QString("rpm"));
+    QCOMPARE(rpm.moments.count, quint64(3));
+    QCOMPARE(rpm.moments.mean, 1000.0);
+    QCOMPARE(rpm.moments.min, 800.0);
+    QCOMPARE(rpm.moments.max, 1200.0);
+    QCOMPARE(state.statistics().snapshot("V_DOUBLE").moments.max, 2400.0);
+    QCOMPARE(state.statistics().pids(), QStringList({"010C", "V_DOUBLE"}));
+}
+
+void TestAppState::testTriggerCaptures()
+{
+    AppState state;
+    VirtualPidEngine::Definition doubled;
+    doubled.pidId = "V_DOUBLE";
+    doubled.expression = "rpm * 2";
+    QVERIFY(state.virtualPids().define(doubled));
+
+    TriggerEngine::Condition over;
+    over.type = TriggerEngine::Above;
+    over.pidId = "V_DOUBLE";
+    over.threshold = 3000.0;
+    TriggerEngine::Rule overRev;
+    overRev.name = "over-rev";
+    overRev.conditions = {over};
+    QVERIFY(state.triggers()->addRule(overRev));
+
+    TriggerEngine::Condition misfire;
+    misfire.type = TriggerEngine::DtcAppeared;
+    misfire.dtcCode = "P0300";
+    TriggerEngine::Rule misfireRule;
+    misfireRule.name = "misfire";
+    misfireRule.conditions = {misfire};
+    QVERIFY(state.triggers()->addRule(misfireRule));
+
+    state.triggers()->setPreTriggerMs(1000);
+    state.triggers()->setPostTriggerMs(100);
+    QSignalSpy triggered(state.triggers(), &TriggerEngine::triggered);
+    QSignalSpy completed(state.triggers(), &TriggerEngine::captureComplete);
+
+    // Live samples reach the engine with their virtual PIDs, timed by sampleTimeNs
+    for (int t = 0; t <= 200; t += 50) {
+        state.setLiveSample(sample("010C", t == 100 ? 1600.0 : 1000.0, t, "rpm"));
+    }
+    QCOMPARE(triggered.size(), 1);
+    QCOMPARE(triggered.first().at(0).toString(), QString("over-rev"));
+    QCOMPARE(triggered.first().at(1).toLongLong(), START_NS + 100000000);
+    QCOMPARE(completed.size(), 1);
+    const TriggerEngine::Capture capture = completed.first().first().value<TriggerEngine::Capture>();
+    QCOMPARE(capture.pids, QStringList({"010C", "V_DOUBLE"}));
+    QCOMPARE(capture.samples.first().timeNs, START_NS);
+    QCOMPARE(capture.samples.last().timeNs, START_NS + 200000000);
+
+    // So do the codes of complete scans
+    ScanResult scan;
+    scan.vin = "VIN_TRIGGER";
+    scan.dtcs.append(DtcEntry("P0300"));
+    state.setLastScanResult(scan);
+    QCOMPARE(triggered.size(), 1);
+    scan.complete = true;
+    state.setLastScanResult(scan);
+    QCOMPARE(triggered.size(), 2);
+    QCOMPARE(triggered.last().at(0).toString(), QString("misfire"));
+}
+
 void TestAppState::testExpertMode()
 {
     m_expertModeChanged = false;
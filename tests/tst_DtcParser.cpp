@@ -13,6 +13,7 @@ private slots:
     void testDecodeDtc_Chassis();
     void testDecodeDtc_Body();
     void testDecodeDtc_Network();
+    void testEncodeDtc();
 
     void testParseDtc_Powertrain();
     void testParseDtc_Chassis();
@@ -62,6 +63,33 @@ void TestDtcParser::testDecodeDtc_Network()
     QCOMPARE(result, QString("U0100"));
 }
 
+void TestDtcParser::testEncodeDtc()
+{
+    bool ok = false;
+    QCOMPARE(DtcParser::encodeDtc("P0133", &ok), quint16(0x0133));
+    QVERIFY(ok);
+    QCOMPARE(DtcParser::encodeDtc("U0100", &ok), quint16(0xC100));
+    QCOMPARE(DtcParser::encodeDtc("b1234", &ok), quint16(0x9234));
+    QVERIFY(ok);
+
+    // Round trip over every code shape
+    for (quint32 raw = 0x0001; raw <= 0xFFFF; raw += 0x0101) {
+        const QString code = DtcParser::decodeDtc(quint8(raw >> 8), quint8(raw & 0xFF));
+        QCOMPARE(DtcParser::encodeDtc(code, &ok), quint16(raw));
+        QVERIFY(ok);
+    }
+
+    // First digit above 3, bad prefix, bad length
+    DtcParser::encodeDtc("P4133", &ok);
+    QVERIFY(!ok);
+    DtcParser::encodeDtc("X0133", &ok);
+    QVERIFY(!ok);
+    DtcParser::encodeDtc("P013", &ok);
+    QVERIFY(!ok);
+    DtcParser::encodeDtc("P01G3", &ok);
+    QVERIFY(!ok);
+}
+
 // PARSER TESTS
 void TestDtcParser::testParseDtc_Powertrain()
 {
@@ -0,0 +1,251 @@
+#include <QtTest/QtTest>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include "core/DtcStore.h"
+#include "ui/models/DtcTableModel.h"
+#include "ui/models/DtcFilterProxyModel.h"
+
+class TestDtcTableModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStoreColumns();
+    void testSelectMatchesRowByRow();
+    void testIncrementalInsert();
+    void testProxyFilterAndSort();
+    void testFleetScale();
+
+private:
+    static DtcEntry entry(const QString& code, DtcStatus status, const QString& module = QString());
+    static void fillFleet(DtcTableModel& model, int vehicles, int codesPerVehicle, quint32 seed);
+};
+
+DtcEntry TestDtcTableModel::entry(const QString& code, DtcStatus status, const QString& module)
+{
+    DtcEntry dtc(code, status);
+    dtc.module = module;
+    return dtc;
+}
+
+void TestDtcTableModel::fillFleet(DtcTableModel& model, int vehicles, int codesPerVehicle, quint32 seed)
+{
+    static const char* prefixes = "PBCU";
+    static const QStringList modules = {"ECM", "TCM", "ABS", "BCM", "SRS"};
+    QRandomGenerator random(seed);
+    for (int v = 0; v < vehicles; ++v) {
+        const QString vin = QString("1HGCM8%1A%2").arg(v % 97, 2, 10, QChar('0')).arg(v, 8, 10, QChar('0'));
+        QVector<DtcEntry> dtcs;
+        for (int i = 0; i < codesPerVehicle; ++i) {
+            const QString code = QString("%1%2").arg(QChar(prefixes[random.bounded(4)]))
+                                                 .arg(random.bounded(800), 4, 10, QChar('0'));
+            dtcs.append(entry(code, DtcStatus(random.bounded(3)), modules[random.bounded(modules.size())]));
+        }
+        model.appendDtcs(vin, dtcs, 1700000000000 + qint64(random.bounded(86400)) * 1000);
+    }
+}
+
+void TestDtcTableModel::testStoreColumns()
+{
+    DtcStore store;
+    QCOMPARE(store.append("VIN-B", {entry("P0420", DtcStatus::Confirmed, "ECM"),
+                                    entry("U0100", DtcStatus::Pending, "TCM")}, 2000), 0);
+    QCOMPARE(store.append("VIN-A", entry("P0420", DtcStatus::Permanent), 1000), 2);
+
+    QCOMPARE(store.rowCount(), 3);
+    QCOMPARE(store.vehicleCount(), 2);
+    QCOMPARE(store.distinctCodeCount(), 2);
+    QCOMPARE(store.code(2), QString("P0420"));
+    QCOMPARE(store.status(1), DtcStatus::Pending);
+    QCOMPARE(store.category(1), DtcCategory::U);
+    QCOMPARE(store.module(0), QString("ECM"));
+    QCOMPARE(store.module(2), QString());
+    QCOMPARE(store.vin(2), QString("VIN-A"));
+    QCOMPARE(store.timestampMs(0), qint64(2000));
+
+    // Ranks follow string order; equal strings share a rank
+    QVERIFY(store.codeRank(0) < store.codeRank(1));
+    QCOMPARE(store.codeRank(0), store.codeRank(2));
+    QVERIFY(store.vinRank(2) < store.vinRank(0));
+    store.append("VIN-0", entry("B1000", DtcStatus::Confirmed), 3000);
+    QVERIFY(store.codeRank(3) < store.codeRank(0));
+    QVERIFY(store.vinRank(3) < store.vinRank(2));
+
+    store.clear();
+    QCOMPARE(store.rowCount(), 0);
+    QCOMPARE(store.vehicleCount(), 0);
+    QCOMPARE(store.select(DtcStore::Filter()).count(), 0);
+}
+
+void TestDtcTableModel::testSelectMatchesRowByRow()
+{
+    DtcTableModel model;
+    fillFleet(model, 300, 7, 5);
+    const DtcStore& store = model.store();
+    QCOMPARE(store.rowCount(), 2100);
+
+    QVector<DtcStore::Filter> filters(5);
+    filters[1].statuses = DtcStore::statusBit(DtcStatus::Pending);
+    filters[2].categories = DtcStore::categoryBit(DtcCategory::U) | DtcStore::categoryBit(DtcCategory::B);
+    filters[3].text = "p01";                                  // Codes, case-insensitive
+    filters[4].statuses = DtcStore::statusBit(DtcStatus::Confirmed);
+    filters[4].text = "abs";                                  // Modules
+    for (const DtcStore::Filter& filter : filters) {
+        const DtcStore::RowSet selected = store.select(filter);
+        int expected = 0;
+        for (int row = 0; row < store.rowCount(); ++row) {
+            QCOMPARE(selected.test(row), store.matches(row, filter));
+            expected += store.matches(row, filter) ? 1 : 0;
+        }
+        QCOMPARE(selected.count(), expected);
+        QCOMPARE(selected.rows().size(), expected);
+    }
+    QCOMPARE(store.select(filters[0]).count(), store.rowCount());
+
+    // A VIN search finds every code of that vehicle and nothing else
+    DtcStore::Filter byVin;
+    byVin.text = "A00000042";
+    const QVector<int> rows = store.select(byVin).rows();
+    QCOMPARE(rows.size(), 7);
+    for (int row : rows) {
+        QVERIFY(store.vin(row).endsWith("A00000042"));
+    }
+
+    DtcStore::Filter none;
+    none.statuses = 0;
+    QCOMPARE(store.select(none).count(), 0);
+}
+
+void TestDtcTableModel::testIncrementalInsert()
+{
+    DtcTableModel model;
+    DtcFilterProxyModel proxy;
+    proxy.setDtcModel(&model);
+    proxy.setTextFilter("P0420");
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+    ScanResult scan;
+    scan.vin = "VIN-1";
+    scan.timestamp = QDateTime::fromMSecsSinceEpoch(1700000000000);
+    scan.dtcs = {entry("P0420", DtcStatus::Confirmed), entry("P0171", DtcStatus::Pending)};
+    model.appendScan(scan);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.first().at(1).toInt(), 0);
+    QCOMPARE(inserted.first().at(2).toInt(), 1);
+
+    // Rows added after the filter was set are checked as they arrive
+    QCOMPARE(proxy.rowCount(), 1);
+    model.appendDtcs("VIN-2", {entry("P0420", DtcStatus::Pending), entry("C0035", DtcStatus::Confirmed)}, 0);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.last().at(1).toInt(), 2);
+    QCOMPARE(proxy.rowCount(), 2);
+    model.appendDtcs("VIN-3", {}, 0);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(reset.count(), 0);
+
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.data(model.index(1, DtcTableModel::StatusColumn)).toString(), QString("Pending"));
+    QCOMPARE(model.data(model.index(3, DtcTableModel::CategoryColumn)).toString(), QString("Chassis"));
+    QCOMPARE(model.data(model.index(2, DtcTableModel::VinColumn)).toString(), QString("VIN-2"));
+    QVERIFY(!model.data(model.index(2, DtcTableModel::TimeColumn)).isValid());
+    QVERIFY(!model.data(model.index(0, DtcTableModel::TimeColumn)).toString().isEmpty());
+    QCOMPARE(model.headerData(DtcTableModel::VinColumn, Qt::Horizontal).toString(), QString("VIN"));
+
+    // Clearing is the one reset; the proxy's row set is recomputed with it
+    model.clear();
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(proxy.rowCount(), 0);
+    model.appendDtcs("VIN-4", {entry("B0001", DtcStatus::Confirmed), entry("P0420", DtcStatus::Confirmed)}, 0);
+    QCOMPARE(proxy.rowCount(), 1);
+    QCOMPARE(proxy.data(proxy.index(0, DtcTableModel::CodeColumn)).toString(), QString("P0420"));
+}
+
+void TestDtcTableModel::testProxyFilterAndSort()
+{
+    DtcTableModel model;
+    model.appendDtcs("VIN-C", {entry("P0300", DtcStatus::Confirmed, "ECM"),
+                               entry("U0100", DtcStatus::Permanent, "BCM")}, 3000);
+    model.appendDtcs("VIN-A", {entry("B1342", DtcStatus::Pending, "BCM")}, 1000);
+    model.appendDtcs("VIN-B", {entry("P0101", DtcStatus::Pending, "ECM")}, 2000);
+
+    DtcFilterProxyModel proxy;
+    proxy.setDtcModel(&model);
+    auto column = [&proxy](int column) {
+        QStringList values;
+        for (int row = 0; row < proxy.rowCount(); ++row) {
+            values.append(proxy.data(proxy.index(row, column)).toString());
+        }
+        return values;
+    };
+
+    proxy.sort(DtcTableModel::CodeColumn);
+    QCOMPARE(column(DtcTableModel::CodeColumn), QStringList({"B1342", "P0101", "P0300", "U0100"}));
+    proxy.sort(DtcTableModel::VinColumn, Qt::DescendingOrder);
+    QCOMPARE(column(DtcTableModel::VinColumn), QStringList({"VIN-C", "VIN-C", "VIN-B", "VIN-A"}));
+    proxy.sort(DtcTableModel::TimeColumn);
+    QCOMPARE(column(DtcTableModel::CodeColumn).first(), QString("B1342"));
+    proxy.sort(DtcTableModel::StatusColumn);
+    QCOMPARE(column(DtcTableModel::StatusColumn).first(), QString("Confirmed"));
+    QCOMPARE(column(DtcTableModel::StatusColumn).last(), QString("Permanent"));
+
+    // Filters combine; new rows land in sorted position
+    proxy.sort(DtcTableModel::CodeColumn);
+    proxy.setStatusFilter(DtcStore::statusBit(DtcStatus::Pending));
+    QCOMPARE(column(DtcTableModel::CodeColumn), QStringList({"B1342", "P0101"}));
+    proxy.setCategoryFilter(DtcStore::categoryBit(DtcCategory::P));
+    QCOMPARE(column(DtcTableModel::CodeColumn), QStringList({"P0101"}));
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    model.appendDtcs("VIN-D", {entry("P0011", DtcStatus::Pending), entry("P0012", DtcStatus::Confirmed)}, 4000);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.first().at(1).toInt(), 1);        // After B1342
+    QCOMPARE(column(DtcTableModel::CodeColumn), QStringList({"P0011", "P0101"}));
+
+    proxy.setStatusFilter(DtcStore::ALL_STATUSES);
+    proxy.setCategoryFilter(DtcStore::ALL_CATEGORIES);
+    proxy.setTextFilter("  bcm ");
+    QCOMPARE(proxy.filter().text, QString("bcm"));
+    QCOMPARE(column(DtcTableModel::CodeColumn), QStringList({"B1342", "U0100"}));
+    proxy.setTextFilter(QString());
+    QCOMPARE(proxy.rowCount(), 6);
+
+    // No sort column: insertion order
+    proxy.sort(-1);
+    QCOMPARE(column(DtcTableModel::CodeColumn).first(), QString("P0300"));
+    QCOMPARE(column(DtcTableModel::CodeColumn).last(), QString("P0012"));
+}
+
+void TestDtcTableModel::testFleetScale()
+{
+    // 100k codes from 10k vehicles
+    DtcTableModel model;
+    fillFleet(model, 10000, 10, 9);
+    QCOMPARE(model.rowCount(), 100000);
+
+    DtcFilterProxyModel proxy;
+    proxy.setDtcModel(&model);
+
+    proxy.sort(DtcTableModel::CodeColumn);
+    QCOMPARE(proxy.rowCount(), 100000);
+    QCOMPARE(model.sortColumn(), int(DtcTableModel::CodeColumn));
+    for (int row = 1; row < 100000; row += 997) {
+        QVERIFY(proxy.data(proxy.index(row - 1, DtcTableModel::CodeColumn)).toString()
+                <= proxy.data(proxy.index(row, DtcTableModel::CodeColumn)).toString());
+    }
+
+    // Typing a VIN, one keystroke at a time, with the list sorted
+    const QString search = "1HGCM842A";
+    for (int length = 1; length <= search.size(); ++length) {
+        proxy.setTextFilter(search.left(length));
+        QVERIFY(proxy.rowCount() > 0);
+    }
+    for (int row = 0; row < proxy.rowCount(); ++row) {
+        QVERIFY(proxy.data(proxy.index(row, DtcTableModel::VinColumn)).toString().contains(search));
+    }
+    proxy.setStatusFilter(DtcStore::statusBit(DtcStatus::Confirmed));
+    proxy.setTextFilter(QString());
+    QVERIFY(proxy.rowCount() < 50000);
+}
+
+QTEST_MAIN(TestDtcTableModel)
+#include "tst_DtcTableModel.moc"
@@ -169,7 +169,7 @@ void TestDtos::testScanResultCreation()
 {
     ScanResult result;
     QVERIFY(result.isEmpty());
-    QVERIFY(result.timestamp.isValid());
+    QVERIFY(!result.timestamp.isValid());   // Set by ScanService from the first reply
     QVERIFY(!result.milOn);
     QVERIFY(result.dtcs.isEmpty());
 }
@@ -194,11 +194,11 @@ void TestDtos::testReadinessResult()
     ReadinessResult result;
     QVERIFY(!result.overallReady);
 
-    result.setMonitorStatus("MISFIRE", MonitorStatus::Complete);
-    result.setMonitorStatus("FUEL", MonitorStatus::Complete);
+    result.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+    result.setMonitorStatus(Monitor::FuelSystem, MonitorStatus::Complete);
     QVERIFY(result.overallReady);
 
-    result.setMonitorStatus("CATALYST", MonitorStatus::Incomplete);
+    result.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Incomplete);
     QVERIFY(!result.overallReady);
 }
 
@@ -206,9 +206,9 @@ void TestDtos::testReadinessResultOverallReady()
 {
     ReadinessResult result;
     
-    result.setMonitorStatus("MISFIRE", MonitorStatus::Complete);
-    result.setMonitorStatus("FUEL", MonitorStatus::Complete);
-    result.setMonitorStatus("CATALYST", MonitorStatus::Unsupported);
+    result.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+    result.setMonitorStatus(Monitor::FuelSystem, MonitorStatus::Complete);
+    result.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Unsupported);
     
     QVERIFY(result.overallReady);  // Unsupported monitors don't affect readiness
 }
@@ -231,7 +231,14 @@ void TestDtos::testPidSample()
     QCOMPARE(sample.pidId, QString("0105"));
     QCOMPARE(sample.value, 2000.0);
     QCOMPARE(sample.unit, QString("rpm"));
-    QVERIFY(sample.timestamp.isValid());
+    QVERIFY(!sample.timestamp.isValid());   // No clock read on construction
+    QCOMPARE(sample.sampleTimeNs, qint64(0));
+
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(1700000000123);
+    PidSample stamped("010C", 850.0, "rpm", time, 42000000);
+    QCOMPARE(stamped.timestamp, time);
+    QCOMPARE(stamped.sampleTimeNs, qint64(42000000));
+    QVERIFY(!(stamped == PidSample("010C", 850.0, "rpm")));
 }
 
 // LogMeta tests
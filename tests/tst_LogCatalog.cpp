@@ -0,0 +1,344 @@
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "core/LogCatalog.h"
+#include "ui/models/LogCatalogModel.h"
+
+class TestLogCatalog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testHeaderRoundTrip();
+    void testUnreadableHeader();
+    void testRecordAndPage();
+    void testRescan();
+    void testWatcherRescan();
+    void testRecordDuringRescan();
+    void testReopenLargeArchive();
+    void testModelPaging();
+
+private:
+    static LogMeta makeMeta(const QString& id, const QDateTime& started);
+    bool writeLog(const QString& fileName, const LogMeta& meta, int sampleLines = 1);
+
+    QTemporaryDir* m_dir = nullptr;
+    QString m_logDir;
+    QString m_catalogPath;
+};
+
+LogMeta TestLogCatalog::makeMeta(const QString& id, const QDateTime& started)
+{
+    LogMeta meta;
+    meta.id = id;
+    meta.timestamp = started;
+    meta.duration = 600;
+    meta.pidCount = 8;
+    meta.sampleRate = 10.0;
+    meta.vehicleProfile = VehicleProfile(2018, "Toyota", "Corolla");
+    meta.vehicleProfile.vin = "JTDBR32E520012345";
+    meta.vehicleProfile.notes = "Daily driver";
+    return meta;
+}
+
+bool TestLogCatalog::writeLog(const QString& fileName, const LogMeta& meta, int sampleLines)
+{
+    QFile file(QDir(m_logDir).filePath(fileName));
+    if (!file.open(QIODevice::WriteOnly) || !LogCatalog::writeHeader(&file, meta)) {
+        return false;
+    }
+    for (int i = 0; i < sampleLines; ++i) {
+        file.write("0C,1234.0\n");
+    }
+    return true;
+}
+
+void TestLogCatalog::init()
+{
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid());
+    m_logDir = m_dir->filePath("logs");
+    QVERIFY(QDir().mkpath(m_logDir));
+    m_catalogPath = m_dir->filePath("log-catalog.sqlite");
+}
+
+void TestLogCatalog::cleanup()
+{
+    delete m_dir;
+    m_dir = nullptr;
+}
+
+void TestLogCatalog::testHeaderRoundTrip()
+{
+    const LogMeta meta = makeMeta("drive-1", QDateTime(QDate(2024, 3, 1), QTime(8, 15, 30, 250), Qt::UTC));
+    QVERIFY(writeLog("drive-1.obdlog", meta, 100));
+
+    LogMeta read;
+    QString error;
+    QVERIFY2(LogCatalog::readHeader(QDir(m_logDir).filePath("drive-1.obdlog"), &read, &error), qPrintable(error));
+    QCOMPARE(read, meta);
+}
+
+void TestLogCatalog::testUnreadableHeader()
+{
+    QFile garbage(QDir(m_logDir).filePath("broken.obdlog"));
+    QVERIFY(garbage.open(QIODevice::WriteOnly));
+    garbage.write("not a header\n");
+    garbage.close();
+
+    LogMeta read;
+    QString error;
+    QVERIFY(!LogCatalog::readHeader(garbage.fileName(), &read, &error));
+    QVERIFY(!error.isEmpty());
+
+    // Still listed, under its file name
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+    QCOMPARE(catalog.count(), 1);
+    const QVector<LogCatalog::Entry> entries = catalog.entries(0, 10);
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries[0].fileName, QString("broken.obdlog"));
+    QCOMPARE(entries[0].meta.id, QString("broken"));
+}
+
+void TestLogCatalog::testRecordAndPage()
+{
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+    QCOMPARE(catalog.count(), 0);
+
+    QSignalSpy changedSpy(&catalog, &LogCatalog::changed);
+    const QDateTime base(QDate(2024, 1, 1), QTime(12, 0), Qt::UTC);
+    for (int i = 0; i < 5; ++i) {
+        const LogMeta meta = makeMeta(QString("log-%1").arg(i), base.addSecs(i * 3600));
+        const QString fileName = QString("log-%1.obdlog").arg(i);
+        QVERIFY(writeLog(fileName, meta));
+        QString error;
+        QVERIFY2(catalog.record(fileName, meta, &error), qPrintable(error));
+    }
+    QCOMPARE(changedSpy.count(), 5);
+    QCOMPARE(catalog.count(), 5);
+
+    // Newest first, one page at a time
+    QVector<LogCatalog::Entry> page = catalog.entries(0, 2);
+    QCOMPARE(page.size(), 2);
+    QCOMPARE(page[0].meta.id, QString("log-4"));
+    QCOMPARE(page[1].meta.id, QString("log-3"));
+    QCOMPARE(page[0].meta.timestamp, base.addSecs(4 * 3600));
+    QCOMPARE(page[0].meta.vehicleProfile.make, QString("Toyota"));
+    QVERIFY(page[0].fileSize > 0);
+    page = catalog.entries(4, 2);
+    QCOMPARE(page.size(), 1);
+    QCOMPARE(page[0].meta.id, QString("log-0"));
+
+    // A second record of the same file replaces its row
+    LogMeta updated = makeMeta("log-2", base.addSecs(2 * 3600));
+    updated.duration = 1200;
+    QVERIFY(catalog.record("log-2.obdlog", updated));
+    QCOMPARE(catalog.count(), 5);
+    QCOMPARE(catalog.entries(2, 1)[0].meta.duration, qint64(1200));
+
+    QVERIFY(!catalog.record("missing.obdlog", updated));
+
+    QVERIFY(catalog.remove("log-4.obdlog"));
+    QCOMPARE(catalog.count(), 4);
+    QCOMPARE(catalog.entries(0, 1)[0].meta.id, QString("log-3"));
+}
+
+void TestLogCatalog::testRescan()
+{
+    const QDateTime base(QDate(2024, 1, 1), QTime(12, 0), Qt::UTC);
+    QVERIFY(writeLog("a.obdlog", makeMeta("a", base)));
+    QVERIFY(writeLog("b.obdlog", makeMeta("b", base.addSecs(60))));
+    QVERIFY(writeLog("ignored.txt", makeMeta("ignored", base)));
+
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QSignalSpy finishedSpy(&catalog, &LogCatalog::scanFinished);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy[0], (QList<QVariant>{2, 0, 0}));
+    QCOMPARE(catalog.count(), 2);
+
+    // Grows a, deletes b, adds c
+    QVERIFY(writeLog("a.obdlog", makeMeta("a", base), 50));
+    QVERIFY(QFile::remove(QDir(m_logDir).filePath("b.obdlog")));
+    QVERIFY(writeLog("c.obdlog", makeMeta("c", base.addSecs(120))));
+
+    finishedSpy.clear();
+    catalog.rescan();
+    catalog.waitForScan();
+    QVERIFY(finishedSpy.count() >= 1);
+    QCOMPARE(finishedSpy[0], (QList<QVariant>{1, 1, 1}));
+
+    const QVector<LogCatalog::Entry> entries = catalog.entries(0, 10);
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries[0].meta.id, QString("c"));
+    QCOMPARE(entries[1].meta.id, QString("a"));
+    QCOMPARE(entries[1].fileSize, QFileInfo(QDir(m_logDir).filePath("a.obdlog")).size());
+
+    // Nothing changed: nothing re-read
+    finishedSpy.clear();
+    catalog.rescan();
+    catalog.waitForScan();
+    QCOMPARE(finishedSpy[0], (QList<QVariant>{0, 0, 0}));
+}
+
+void TestLogCatalog::testWatcherRescan()
+{
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+
+    QSignalSpy changedSpy(&catalog, &LogCatalog::changed);
+    QVERIFY(writeLog("new.obdlog", makeMeta("new", QDateTime::currentDateTimeUtc())));
+
+    // Watcher, RESCAN_DELAY_MS debounce, then the background scan
+    QTRY_VERIFY_WITH_TIMEOUT(catalog.count() == 1, 10000);
+    QVERIFY(changedSpy.count() >= 1);
+    QCOMPARE(catalog.entries(0, 1)[0].meta.id, QString("new"));
+}
+
+void TestLogCatalog::testRecordDuringRescan()
+{
+    const QDateTime base(QDate(2024, 1, 1), QTime(12, 0), Qt::UTC);
+    LogMeta growing = makeMeta("growing", base);
+    growing.duration = 0;               // Header as written when recording starts
+    QVERIFY(writeLog("growing.obdlog", growing));
+
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+    QCOMPARE(catalog.count(), 1);
+
+    // Enough new files that the rescan is still reading headers when the
+    // recorder finishes two logs: one it already listed, one it has not
+    const int logCount = 2000;
+    for (int i = 0; i < logCount; ++i) {
+        QVERIFY(writeLog(QString("log-%1.obdlog").arg(i, 5, 10, QChar('0')),
+                         makeMeta(QString::number(i), base.addSecs(qint64(i) * 3600))));
+    }
+    LogMeta fresh = makeMeta("fresh", base.addSecs(60));
+    fresh.duration = 0;
+    QVERIFY(writeLog("fresh.obdlog", fresh));
+    QVERIFY(writeLog("growing.obdlog", growing, 50));
+
+    QSignalSpy finishedSpy(&catalog, &LogCatalog::scanFinished);
+    catalog.rescan();
+    QVERIFY(catalog.isScanning());
+    QThread::msleep(20);
+    growing.duration = 900;
+    fresh.duration = 300;
+    QVERIFY(catalog.record("growing.obdlog", growing));
+    QVERIFY(catalog.record("fresh.obdlog", fresh));
+    catalog.waitForScan();
+
+    // Whichever way the writes interleaved, the recorded rows win
+    QCOMPARE(catalog.count(), logCount + 2);
+    QHash<QString, LogCatalog::Entry> byFile;
+    for (const LogCatalog::Entry& entry : catalog.entries(0, logCount + 2)) {
+        byFile.insert(entry.fileName, entry);
+    }
+    QCOMPARE(byFile.value("growing.obdlog").meta.duration, qint64(900));
+    QCOMPARE(byFile.value("fresh.obdlog").meta.duration, qint64(300));
+    QCOMPARE(byFile.value("log-00042.obdlog").meta.id, QString("42"));
+
+    // Rows the rescan skipped are not counted as its changes
+    QVERIFY(finishedSpy.count() >= 1);
+    const int added = finishedSpy[0][0].toInt();
+    const int updated = finishedSpy[0][1].toInt();
+    QVERIFY(added == logCount || added == logCount + 1);
+    QVERIFY(updated <= 1);
+
+    // A later rescan finds every row matching its file
+    finishedSpy.clear();
+    catalog.rescan();
+    catalog.waitForScan();
+    QCOMPARE(finishedSpy[0], (QList<QVariant>{0, 0, 0}));
+    QCOMPARE(catalog.entries(0, logCount + 2).size(), logCount + 2);
+}
+
+void TestLogCatalog::testReopenLargeArchive()
+{
+    const int logCount = 3000;
+    const QDateTime base(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC);
+    for (int i = 0; i < logCount; ++i) {
+        QVERIFY(writeLog(QString("log-%1.obdlog").arg(i, 5, 10, QChar('0')),
+                         makeMeta(QString::number(i), base.addSecs(qint64(i) * 3600))));
+    }
+
+    {
+        LogCatalog catalog(m_logDir, m_catalogPath);
+        QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+        catalog.waitForScan();
+        QCOMPARE(catalog.count(), logCount);
+    }
+
+    // Opening the tab: open, count and the first screen of rows. The scan
+    // runs in the background and finds nothing to re-read
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QSignalSpy finishedSpy(&catalog, &LogCatalog::scanFinished);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    QCOMPARE(catalog.count(), logCount);
+    const QVector<LogCatalog::Entry> firstPage = catalog.entries(0, LogCatalogModel::PAGE_SIZE);
+    QCOMPARE(firstPage.size(), LogCatalogModel::PAGE_SIZE);
+    QCOMPARE(firstPage[0].meta.id, QString::number(logCount - 1));
+
+    catalog.waitForScan();
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy[0], (QList<QVariant>{0, 0, 0}));
+}
+
+void TestLogCatalog::testModelPaging()
+{
+    LogCatalog catalog(m_logDir, m_catalogPath);
+    QVERIFY2(catalog.open(), qPrintable(catalog.lastError()));
+    catalog.waitForScan();
+
+    const int logCount = 300;
+    const QDateTime base(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC);
+    for (int i = 0; i < logCount; ++i) {
+        const LogMeta meta = makeMeta(QString::number(i), base.addSecs(qint64(i) * 60));
+        const QString fileName = QString("log-%1.obdlog").arg(i, 3, 10, QChar('0'));
+        QVERIFY(writeLog(fileName, meta));
+        QVERIFY(catalog.record(fileName, meta));
+    }
+
+    LogCatalogModel model;
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    model.setCatalog(&catalog);
+    QCOMPARE(model.rowCount(), logCount);
+    QCOMPARE(model.columnCount(), int(LogCatalogModel::ColumnCount));
+    QCOMPARE(model.pageLoads(), 0);
+
+    QCOMPARE(model.entry(0).meta.id, QString::number(logCount - 1));
+    QCOMPARE(model.pageLoads(), 1);
+    QCOMPARE(model.data(model.index(1, LogCatalogModel::FileColumn)).toString(), QString("log-298.obdlog"));
+    QCOMPARE(model.data(model.index(0, LogCatalogModel::DurationColumn)).toString(), QString("10:00"));
+    QCOMPARE(model.data(model.index(0, LogCatalogModel::VehicleColumn)).toString(), QString("2018 Toyota Corolla"));
+    QCOMPARE(model.pageLoads(), 1);
+
+    QCOMPARE(model.entry(logCount - 1).meta.id, QString("0"));
+    QCOMPARE(model.pageLoads(), 2);
+    QVERIFY(!model.data(model.index(logCount, 0)).isValid());
+
+    // A catalog change resets the model with the new count
+    resetSpy.clear();
+    const LogMeta newest = makeMeta("newest", base.addDays(1));
+    QVERIFY(writeLog("newest.obdlog", newest));
+    QVERIFY(catalog.record("newest.obdlog", newest));
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(model.rowCount(), logCount + 1);
+    QCOMPARE(model.entry(0).meta.id, QString("newest"));
+
+    QCOMPARE(LogCatalogModel::durationText(3725), QString("1:02:05"));
+}
+
+QTEST_MAIN(TestLogCatalog)
+#include "tst_LogCatalog.moc"
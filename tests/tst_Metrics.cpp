@@ -0,0 +1,223 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QThread>
+#include "core/Metrics.h"
+#include "core/MetricsServer.h"
+#include "core/ScanService.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void testCounters();
+    void testConcurrentIncrements();
+    void testRttHistogram();
+    void testTimeoutsPerCommand();
+    void testPrometheusText();
+    void testScanServiceMetrics();
+    void testServer();
+
+private:
+    static QByteArray httpRequest(quint16 port, const QList<QByteArray>& parts);
+};
+
+void TestMetrics::init()
+{
+    Metrics::reset();
+}
+
+QByteArray TestMetrics::httpRequest(quint16 port, const QList<QByteArray>& parts)
+{
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, port);
+    if (!socket.waitForConnected(2000)) {
+        return QByteArray();
+    }
+    for (const QByteArray& part : parts) {
+        socket.write(part);
+        socket.flush();
+        QTest::qWait(20);
+    }
+
+    // The server closes the connection after its response
+    QByteArray response;
+    QElapsedTimer timer;
+    timer.start();
+    while (socket.state() != QAbstractSocket::UnconnectedState && timer.elapsed() < 5000) {
+        QTest::qWait(10);
+        response += socket.readAll();
+    }
+    return response + socket.readAll();
+}
+
+void TestMetrics::testCounters()
+{
+    Metrics::increment(Metrics::ScansCompleted);
+    Metrics::increment(Metrics::ScansCompleted, 2);
+    QCOMPARE(Metrics::value(Metrics::ScansCompleted), quint64(3));
+    QCOMPARE(Metrics::value(Metrics::ScansFailed), quint64(0));
+
+    Metrics::addTransportBytes(Metrics::Serial, Metrics::Sent, 6);
+    Metrics::addTransportBytes(Metrics::Serial, Metrics::Received, 20);
+    QCOMPARE(Metrics::transportBytes(Metrics::Serial, Metrics::Sent), quint64(6));
+    QCOMPARE(Metrics::transportBytes(Metrics::Serial, Metrics::Received), quint64(20));
+    QCOMPARE(Metrics::transportBytes(Metrics::Tcp, Metrics::Sent), quint64(0));
+
+    Metrics::transportConnected(Metrics::Tcp, false);
+    Metrics::transportConnected(Metrics::Tcp, true);
+    QCOMPARE(Metrics::transportConnects(Metrics::Tcp), quint64(2));
+    QCOMPARE(Metrics::transportReconnects(Metrics::Tcp), quint64(1));
+
+    Metrics::reset();
+    QCOMPARE(Metrics::value(Metrics::ScansCompleted), quint64(0));
+    QCOMPARE(Metrics::transportConnects(Metrics::Tcp), quint64(0));
+}
+
+void TestMetrics::testConcurrentIncrements()
+{
+    const int threads = 4;
+    const int perThread = 100000;
+    QVector<QThread*> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.append(QThread::create([]() {
+            for (int i = 0; i < perThread; ++i) {
+                Metrics::increment(Metrics::CommandsSent);
+                Metrics::observeCommandRtt(20000000);
+            }
+        }));
+        workers.last()->start();
+    }
+    for (QThread* worker : workers) {
+        QVERIFY(worker->wait(10000));
+        delete worker;
+    }
+
+    // No update is lost without a lock
+    QCOMPARE(Metrics::value(Metrics::CommandsSent), quint64(threads * perThread));
+    QCOMPARE(Metrics::commandRttCount(), quint64(threads * perThread));
+}
+
+void TestMetrics::testRttHistogram()
+{
+    Metrics::observeCommandRtt(5000000);        // 5 ms
+    Metrics::observeCommandRtt(10000000);       // 10 ms, on the bound
+    Metrics::observeCommandRtt(30000000);       // 30 ms
+    Metrics::observeCommandRtt(6000000000);     // 6 s
+
+    const QVector<quint64> buckets = Metrics::commandRttBuckets();
+    QCOMPARE(buckets.size(), Metrics::RTT_BUCKET_COUNT);
+    QCOMPARE(buckets[0], quint64(2));
+    QCOMPARE(buckets[1], quint64(0));
+    QCOMPARE(buckets[2], quint64(1));
+    QCOMPARE(buckets.last(), quint64(1));
+    QCOMPARE(Metrics::commandRttCount(), quint64(4));
+    QVERIFY(qAbs(Metrics::commandRttSumSeconds() - 6.045) < 1e-9);
+
+    QCOMPARE(Metrics::rttBucketBound(0), 0.01);
+    QVERIFY(qIsInf(Metrics::rttBucketBound(Metrics::RTT_BUCKET_COUNT - 1)));
+}
+
+void TestMetrics::testTimeoutsPerCommand()
+{
+    Metrics::commandTimedOut("01 0C\r");
+    Metrics::commandTimedOut("01 0C\r");
+    Metrics::commandTimedOut("03\r");
+    QCOMPARE(Metrics::commandTimeouts("01 0C"), quint64(2));
+    QCOMPARE(Metrics::commandTimeouts("03\r"), quint64(1));
+    QCOMPARE(Metrics::commandTimeouts("07"), quint64(0));
+    QCOMPARE(Metrics::value(Metrics::CommandTimeouts), quint64(3));
+
+    // Once the table is full, further commands are counted as "other"
+    for (int pid = 0; pid < Metrics::TIMEOUT_SLOTS + 10; ++pid) {
+        Metrics::commandTimedOut(QByteArray("21 ") + QByteArray::number(pid, 16));
+    }
+    QCOMPARE(Metrics::value(Metrics::CommandTimeouts), quint64(3 + Metrics::TIMEOUT_SLOTS + 10));
+    QCOMPARE(Metrics::commandTimeouts("01 0C"), quint64(2));
+    QVERIFY(Metrics::prometheusText().contains("obdread_command_timeouts_total{command=\"other\"} 12"));
+}
+
+void TestMetrics::testPrometheusText()
+{
+    Metrics::increment(Metrics::ScansCompleted, 4);
+    Metrics::increment(Metrics::ScansFailed);
+    Metrics::observeCommandRtt(5000000);
+    Metrics::observeCommandRtt(30000000);
+    Metrics::commandTimedOut("01 0C\r");
+    Metrics::addTransportBytes(Metrics::Tcp, Metrics::Received, 42);
+    Metrics::setRequestedSampleRate(30);
+
+    const QByteArray text = Metrics::prometheusText();
+    const QList<QByteArray> expected = {
+        "# TYPE obdread_scans_completed_total counter\nobdread_scans_completed_total 4\n",
+        "obdread_scans_failed_total 1\n",
+        "# TYPE obdread_command_rtt_seconds histogram\n",
+        "obdread_command_rtt_seconds_bucket{le=\"0.01\"} 1\n",
+        "obdread_command_rtt_seconds_bucket{le=\"0.025\"} 1\n",
+        "obdread_command_rtt_seconds_bucket{le=\"0.05\"} 2\n",
+        "obdread_command_rtt_seconds_bucket{le=\"+Inf\"} 2\n",
+        "obdread_command_rtt_seconds_count 2\n",
+        "obdread_command_timeouts_total{command=\"01 0C\"} 1\n",
+        "obdread_transport_bytes_total{transport=\"tcp\",direction=\"received\"} 42\n",
+        "obdread_transport_reconnects_total{transport=\"serial\"} 0\n",
+        "obdread_live_notification_rate_requested_hz 30\n",
+    };
+    for (const QByteArray& line : expected) {
+        QVERIFY2(text.contains(line), line.constData());
+    }
+}
+
+void TestMetrics::testScanServiceMetrics()
+{
+    SimulatedTransporter transporter;
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    QSignalSpy connectedSpy(&scanService, &ScanService::connectionComplete);
+    transporter.connectToDevice("sim");
+    QTRY_COMPARE_WITH_TIMEOUT(connectedSpy.count(), 1, 5000);
+
+    QSignalSpy completeSpy(&scanService, &ScanService::scanComplete);
+    scanService.startScan(ScanPlanner::Quick);
+    QTRY_COMPARE_WITH_TIMEOUT(completeSpy.count(), 1, 5000);
+
+    QCOMPARE(Metrics::value(Metrics::ScansCompleted), quint64(1));
+    QCOMPARE(Metrics::value(Metrics::ScansFailed), quint64(0));
+    QCOMPARE(Metrics::value(Metrics::CommandsSent), quint64(transporter.commandCount()));
+    QCOMPARE(Metrics::commandRttCount(), quint64(transporter.commandCount()));
+    QCOMPARE(Metrics::value(Metrics::CommandTimeouts), quint64(0));
+}
+
+void TestMetrics::testServer()
+{
+    Metrics::increment(Metrics::ScansCompleted, 7);
+
+    MetricsServer server;
+    QVERIFY2(server.listen(0), qPrintable(server.lastError()));
+    QVERIFY(server.serverPort() != 0);
+
+    const QByteArray ok = httpRequest(server.serverPort(), {"GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n"});
+    QVERIFY2(ok.startsWith("HTTP/1.0 200 OK\r\n"), ok.left(64).constData());
+    QVERIFY(ok.contains("Content-Type: text/plain; version=0.0.4"));
+    QVERIFY(ok.contains("\r\n\r\n"));
+    const QByteArray body = ok.mid(ok.indexOf("\r\n\r\n") + 4);
+    QVERIFY(ok.contains("Content-Length: " + QByteArray::number(body.size()) + "\r\n"));
+    QVERIFY(body.contains("obdread_scans_completed_total 7\n"));
+
+    // The request may arrive in pieces
+    QVERIFY(httpRequest(server.serverPort(), {"GET /metr", "ics HTTP/1.0\r\n", "\r\n"}).startsWith("HTTP/1.0 200"));
+
+    QVERIFY(httpRequest(server.serverPort(), {"GET / HTTP/1.0\r\n\r\n"}).startsWith("HTTP/1.0 404"));
+    QVERIFY(httpRequest(server.serverPort(), {"POST /metrics HTTP/1.0\r\n\r\n"}).startsWith("HTTP/1.0 405"));
+
+    MetricsServer second;
+    QVERIFY(!second.listen(server.serverPort()));
+    QVERIFY(!second.lastError().isEmpty());
+}
+
+QTEST_MAIN(TestMetrics)
+#include "tst_Metrics.moc"
@@ -0,0 +1,241 @@
+#include <QtTest/QtTest>
+#include <QRandomGenerator>
+#include "core/PidStatistics.h"
+#include "core/TDigest.h"
+#include "TestSamples.h"
+#include <algorithm>
+#include <cmath>
+
+using TestSamples::sample;
+using TestSamples::START_NS;
+
+class TestPidStatistics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testMoments();
+    void testDigestAccuracy();
+    void testDigestMerge();
+    void testHistogram();
+    void testSessionAndWindow();
+    void testSnapshotIsDetached();
+
+private:
+    static double exactQuantile(QVector<double> values, double q);
+};
+
+double TestPidStatistics::exactQuantile(QVector<double> values, double q)
+{
+    std::sort(values.begin(), values.end());
+    return values[qMin(values.size() - 1, int(q * values.size()))];
+}
+
+void TestPidStatistics::testMoments()
+{
+    PidStatistics::Moments moments;
+    for (double value : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+        moments.add(value);
+    }
+    QCOMPARE(moments.count, quint64(8));
+    QCOMPARE(moments.mean, 5.0);
+    QCOMPARE(moments.min, 2.0);
+    QCOMPARE(moments.max, 9.0);
+    QVERIFY(qAbs(moments.variance() - 32.0 / 7.0) < 1e-12);
+    QVERIFY(qAbs(moments.stddev() - std::sqrt(32.0 / 7.0)) < 1e-12);
+
+    // Merging halves gives the same as adding everything
+    PidStatistics::Moments left;
+    PidStatistics::Moments right;
+    for (double value : {2.0, 4.0, 4.0}) {
+        left.add(value);
+    }
+    for (double value : {4.0, 5.0, 5.0, 7.0, 9.0}) {
+        right.add(value);
+    }
+    left.merge(right);
+    QCOMPARE(left.count, moments.count);
+    QVERIFY(qAbs(left.mean - moments.mean) < 1e-12);
+    QVERIFY(qAbs(left.variance() - moments.variance()) < 1e-12);
+    QCOMPARE(left.min, 2.0);
+    QCOMPARE(left.max, 9.0);
+
+    // Large offsets do not lose precision (the naive sum of squares would)
+    PidStatistics::Moments offset;
+    for (double value : {1e9 + 4, 1e9 + 7, 1e9 + 13, 1e9 + 16}) {
+        offset.add(value);
+    }
+    QVERIFY(qAbs(offset.variance() - 30.0) < 1e-6);
+}
+
+void TestPidStatistics::testDigestAccuracy()
+{
+    QRandomGenerator random(7);
+    TDigest digest;
+    QVector<double> values;
+    for (int i = 0; i < 100000; ++i) {
+        // Skewed, like coolant temperature: mostly warm, a tail of cold starts
+        const double value = i % 10 == 0 ? random.bounded(90.0) : 85.0 + random.bounded(15.0);
+        values.append(value);
+        digest.add(value);
+    }
+    digest.add(std::nan(""));           // Ignored
+    QCOMPARE(digest.count(), 100000.0);
+
+    // Accuracy is in rank: the estimate has about the requested share of values below it
+    std::sort(values.begin(), values.end());
+    for (double q : {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99}) {
+        const double estimate = digest.quantile(q);
+        const double rank = double(std::upper_bound(values.cbegin(), values.cend(), estimate) - values.cbegin())
+                          / values.size();
+        QVERIFY2(qAbs(rank - q) < 0.005, qPrintable(QString("q=%1 estimate %2 rank %3").arg(q).arg(estimate).arg(rank)));
+        QVERIFY(qAbs(digest.cdf(exactQuantile(values, q)) - q) < 0.005);
+    }
+    QCOMPARE(digest.quantile(0.0), *std::min_element(values.cbegin(), values.cend()));
+    QCOMPARE(digest.quantile(1.0), *std::max_element(values.cbegin(), values.cend()));
+
+    // Memory grows with the compression and the log of the number of values
+    digest.compress();
+    QVERIFY(digest.centroidCount() < 10 * int(TDigest::DEFAULT_COMPRESSION));
+
+    TDigest empty;
+    QVERIFY(std::isnan(empty.quantile(0.5)));
+    TDigest single;
+    single.add(42.0);
+    QCOMPARE(single.quantile(0.5), 42.0);
+    QCOMPARE(single.cdf(41.0), 0.0);
+    QCOMPARE(single.cdf(42.0), 1.0);
+}
+
+void TestPidStatistics::testDigestMerge()
+{
+    QRandomGenerator random(11);
+    TDigest whole;
+    TDigest parts[4];
+    for (int i = 0; i < 40000; ++i) {
+        const double value = random.bounded(6000.0);
+        whole.add(value);
+        parts[i % 4].add(value);
+    }
+
+    TDigest merged(50.0);
+    for (const TDigest& part : parts) {
+        merged.merge(part);
+    }
+    QCOMPARE(merged.count(), whole.count());
+    QCOMPARE(merged.min(), whole.min());
+    QCOMPARE(merged.max(), whole.max());
+    for (double q : {0.01, 0.5, 0.99}) {
+        QVERIFY(qAbs(merged.quantile(q) - whole.quantile(q)) < 30.0);   // 0.5% of the range
+    }
+}
+
+void TestPidStatistics::testHistogram()
+{
+    PidStatistics::Histogram histogram;
+    QVERIFY(histogram.isEmpty());
+
+    histogram.add(90.0);
+    QCOMPARE(histogram.total(), quint64(1));
+    QVERIFY(histogram.lower() <= 90.0 && 90.0 < histogram.upper());
+
+    // Widening keeps every count and the bins stay aligned
+    QRandomGenerator random(3);
+    for (int i = 0; i < 999; ++i) {
+        histogram.add(random.bounded(7000.0));
+    }
+    histogram.add(std::nan(""));
+    QCOMPARE(histogram.total(), quint64(1000));
+    QVERIFY(histogram.lower() <= 0.0);
+    QVERIFY(histogram.upper() >= 7000.0);
+    QVERIFY(histogram.binWidth() <= 512.0);      // No wider than needed for 32 bins
+    QCOMPARE(std::fmod(histogram.lower(), histogram.binWidth()), 0.0);
+    quint64 sum = 0;
+    for (quint64 count : histogram.counts()) {
+        sum += count;
+    }
+    QCOMPARE(sum, quint64(1000));
+
+    // A value below the range
+    histogram.add(-3000.0);
+    QVERIFY(histogram.lower() <= -3000.0);
+    QCOMPARE(histogram.total(), quint64(1001));
+
+    // Histograms of different widths merge into the coarser grid
+    PidStatistics::Histogram fine;
+    for (int i = 0; i < 100; ++i) {
+        fine.add(10.0 + i * 0.01);
+    }
+    QVERIFY(fine.binWidth() < histogram.binWidth());
+    const int binOfTen = int((10.0 - histogram.lower()) / histogram.binWidth());
+    const quint64 before = histogram.counts()[binOfTen];
+    histogram.merge(fine);
+    QCOMPARE(histogram.total(), quint64(1101));
+    QCOMPARE(histogram.counts()[binOfTen], before + 100);
+}
+
+void TestPidStatistics::testSessionAndWindow()
+{
+    PidStatistics statistics(12000);     // Twelve 1 s buckets
+    QCOMPARE(statistics.windowMs(), 12000);
+
+    // Idle for 30 s, then 3000 rpm for 10 s, at 10 Hz; coolant stops after 10 s
+    for (qint64 t = 0; t < 40000; t += 100) {
+        statistics.add(sample("010C", t < 30000 ? 1000.0 : 3000.0, t, "rpm"));
+        if (t < 10000) {
+            statistics.add(sample("0105", 80.0 + t / 1000.0, t));
+        }
+    }
+    statistics.add(sample("010C", std::nan(""), 40000, "rpm"));   // Ignored
+
+    QCOMPARE(statistics.pids(), QStringList({"010C", "0105"}));
+    const PidStatistics::Summary session = statistics.snapshot("010C");
+    QCOMPARE(session.unit, QString("rpm"));
+    QCOMPARE(session.moments.count, quint64(400));
+    QCOMPARE(session.moments.mean, 1500.0);
+    QCOMPARE(session.quantile(0.5), 1000.0);
+    QCOMPARE(session.firstTimeNs, START_NS);
+    QCOMPARE(session.lastTimeNs, START_NS + qint64(39900) * 1000000);
+    QCOMPARE(session.histogram.total(), quint64(400));
+
+    // Newest bucket is at 39 s: the window holds 28 s to 39 s
+    const PidStatistics::Summary window = statistics.snapshot("010C", PidStatistics::Window);
+    QCOMPARE(window.moments.count, quint64(120));
+    QCOMPARE(window.moments.min, 1000.0);
+    QCOMPARE(window.moments.max, 3000.0);
+    QCOMPARE(window.quantile(0.5), 3000.0);
+    QCOMPARE(window.firstTimeNs, START_NS + qint64(28000) * 1000000);
+
+    // A PID that stopped reporting drops out of the window, not the session
+    QVERIFY(statistics.snapshot("0105", PidStatistics::Window).isEmpty());
+    const PidStatistics::Summary coolant = statistics.snapshot("0105");
+    QCOMPARE(coolant.moments.count, quint64(100));
+    QCOMPARE(coolant.moments.min, 80.0);
+    QVERIFY(qAbs(coolant.moments.max - 89.9) < 1e-9);
+
+    QCOMPARE(statistics.snapshotAll(PidStatistics::Window).size(), 2);
+    QVERIFY(statistics.snapshot("0110").isEmpty());
+
+    // A new window length starts the window over
+    statistics.setWindowMs(6000);
+    QVERIFY(statistics.snapshot("010C", PidStatistics::Window).isEmpty());
+    QCOMPARE(statistics.snapshot("010C").moments.count, quint64(400));
+
+    statistics.reset();
+    QVERIFY(statistics.pids().isEmpty());
+}
+
+void TestPidStatistics::testSnapshotIsDetached()
+{
+    PidStatistics statistics;
+    statistics.add(sample("010C", 800.0, 0, "rpm"));
+    const PidStatistics::Summary before = statistics.snapshot("010C");
+
+    statistics.add(sample("010C", 5000.0, 100, "rpm"));
+    QCOMPARE(before.moments.count, quint64(1));
+    QCOMPARE(before.quantile(1.0), 800.0);
+    QCOMPARE(statistics.snapshot("010C").quantile(1.0), 5000.0);
+}
+
+QTEST_MAIN(TestPidStatistics)
+#include "tst_PidStatistics.moc"
@@ -17,6 +17,9 @@ private slots:
     void testValidResponseAllIncomplete();
     void testValidResponseMixed();
     void testPartialResponse();
+    void testCompressionIgnition();
+    void testIncompleteButUnsupported();
+    void testMonitorNames();
 
 private:
     ReadinessParser* m_parser = nullptr;
@@ -37,8 +40,10 @@ void TestReadinessParser::testEmptyResponse()
     QByteArray emptyResponse = "NODATA";
     ReadinessResult result = m_parser->parseReadinessResponse(emptyResponse);
     
-    QVERIFY(result.monitors.isEmpty());
+    QVERIFY(result.isEmpty());
     QVERIFY(!result.overallReady);
+
+    QVERIFY(m_parser->parseReadinessResponse("NO DATA\r\r>").isEmpty());
 }
 
 void TestReadinessParser::testErrorResponse()
@@ -46,7 +51,7 @@ void TestReadinessParser::testErrorResponse()
     QByteArray errorResponse = "ERROR";
     ReadinessResult result = m_parser->parseReadinessResponse(errorResponse);
     
-    QVERIFY(result.monitors.isEmpty());
+    QVERIFY(result.isEmpty());
     QVERIFY(!result.overallReady);
 }
 
@@ -55,7 +60,7 @@ void TestReadinessParser::testInvalidResponse()
     QByteArray invalidResponse = "43 01 33 00"; // Mode 03 response, not Mode 01
     ReadinessResult result = m_parser->parseReadinessResponse(invalidResponse);
     
-    QVERIFY(result.monitors.isEmpty());
+    QVERIFY(result.isEmpty());
     QVERIFY(!result.overallReady);
 }
 
@@ -80,18 +85,18 @@ void TestReadinessParser::testValidResponseAllComplete()
     QByteArray response = "41 01 00 07 67 00";
     ReadinessResult result = m_parser->parseReadinessResponse(response);
     
-    QVERIFY(!result.monitors.isEmpty());
+    QVERIFY(!result.isEmpty());
     QVERIFY(result.overallReady);
     
     // Check that all monitors are Complete
-    QCOMPARE(result.getMonitorStatus("MIS"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("FUEL"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("CCM"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("CAT"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("HCAT"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("EVAP"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("O2S"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("O2SH"), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Misfire), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::FuelSystem), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Components), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Catalyst), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::HeatedCatalyst), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::EvapSystem), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensor), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensorHeater), MonitorStatus::Complete);
 }
 
 void TestReadinessParser::testValidResponseAllIncomplete()
@@ -114,18 +119,18 @@ void TestReadinessParser::testValidResponseAllIncomplete()
     QByteArray response = "41 01 00 77 67 67";
     ReadinessResult result = m_parser->parseReadinessResponse(response);
     
-    QVERIFY(!result.monitors.isEmpty());
+    QVERIFY(!result.isEmpty());
     QVERIFY(!result.overallReady);
     
     // Check that all monitors are Incomplete
-    QCOMPARE(result.getMonitorStatus("MIS"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("FUEL"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("CCM"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("CAT"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("HCAT"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("EVAP"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("O2S"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("O2SH"), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Misfire), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::FuelSystem), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Components), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Catalyst), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::HeatedCatalyst), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::EvapSystem), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensor), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensorHeater), MonitorStatus::Incomplete);
 }
 
 void TestReadinessParser::testValidResponseMixed()
@@ -148,15 +153,15 @@ void TestReadinessParser::testValidResponseMixed()
     QByteArray response = "41 01 00 67 60 00";
     ReadinessResult result = m_parser->parseReadinessResponse(response);
     
-    QVERIFY(!result.monitors.isEmpty());
+    QVERIFY(!result.isEmpty());
     QVERIFY(!result.overallReady); // Not all complete (FUEL and CCM are incomplete)
     
     // Check specific monitors
-    QCOMPARE(result.getMonitorStatus("MIS"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("FUEL"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("CCM"), MonitorStatus::Incomplete);
-    QCOMPARE(result.getMonitorStatus("O2S"), MonitorStatus::Complete);
-    QCOMPARE(result.getMonitorStatus("O2SH"), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Misfire), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::FuelSystem), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Components), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensor), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::OxygenSensorHeater), MonitorStatus::Complete);
 }
 
 void TestReadinessParser::testPartialResponse()
@@ -171,9 +176,74 @@ void TestReadinessParser::testPartialResponse()
     QByteArray response = "41 01 00 07 67 00 >";
     ReadinessResult result = m_parser->parseReadinessResponse(response);
     
-    QVERIFY(!result.monitors.isEmpty());
+    QVERIFY(!result.isEmpty());
     QVERIFY(result.overallReady);
 }
 
+void TestReadinessParser::testCompressionIgnition()
+{
+    // 0F (B): common monitors available and complete, B3 = 1: compression ignition
+    // EB (C): NMHC, NOX, BOOST, EGS, PM and EGR available
+    // 40 (D): PM filter incomplete
+    ReadinessResult result = m_parser->parseReadinessResponse("41 01 00 0F EB 40");
+
+    QVERIFY(result.compressionIgnition);
+    QVERIFY(!result.overallReady);
+    QCOMPARE(result.monitorCount(), 9);     // 3 common + 6 diesel
+    QCOMPARE(result.getMonitorStatus(Monitor::NmhcCatalyst), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::NoxScr), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::BoostPressure), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::ExhaustGasSensor), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::PmFilter), MonitorStatus::Incomplete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Egr), MonitorStatus::Complete);
+
+    // Spark monitors are not part of the diesel layout
+    QVERIFY(!result.isReported(Monitor::Catalyst));
+    QVERIFY(!result.isReported(Monitor::OxygenSensorHeater));
+
+    // The same C/D bytes with B3 = 0 use the spark layout
+    ReadinessResult spark = m_parser->parseReadinessResponse("41 01 00 07 EB 40");
+    QVERIFY(!spark.compressionIgnition);
+    QCOMPARE(spark.monitorCount(), 11);     // 3 common + 8 spark
+    QCOMPARE(spark.getMonitorStatus(Monitor::Catalyst), MonitorStatus::Complete);
+    QCOMPARE(spark.getMonitorStatus(Monitor::SecondaryAir), MonitorStatus::Complete);
+    QCOMPARE(spark.getMonitorStatus(Monitor::EvapSystem), MonitorStatus::Unsupported);
+    QCOMPARE(spark.getMonitorStatus(Monitor::OxygenSensorHeater), MonitorStatus::Incomplete);
+    QVERIFY(!spark.isReported(Monitor::PmFilter));
+
+    QCOMPARE(ReadinessParser::decode(0x0F, 0xEB, 0x40), result);
+}
+
+void TestReadinessParser::testIncompleteButUnsupported()
+{
+    // Completeness bits of unsupported monitors do not affect readiness
+    // 61 (B): only MIS available and complete; FUEL and CCM flag incomplete
+    // 01 (C): only CAT available
+    // FE (D): CAT complete, every other bit set
+    ReadinessResult result = m_parser->parseReadinessResponse("41 01 00 61 01 FE");
+
+    QVERIFY(result.overallReady);
+    QCOMPARE(result.getMonitorStatus(Monitor::Misfire), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::FuelSystem), MonitorStatus::Unsupported);
+    QCOMPARE(result.getMonitorStatus(Monitor::Catalyst), MonitorStatus::Complete);
+    QCOMPARE(result.getMonitorStatus(Monitor::Egr), MonitorStatus::Unsupported);
+    QCOMPARE(result.incompleteMask, quint16(0));
+}
+
+void TestReadinessParser::testMonitorNames()
+{
+    for (int i = 0; i < ReadinessResult::MONITOR_COUNT; ++i) {
+        const QString name = QString::fromLatin1(ReadinessResult::monitorName(Monitor(i)));
+        QVERIFY(!name.isEmpty());
+
+        Monitor monitor = Monitor::Count;
+        QVERIFY(ReadinessResult::monitorFromName(name, &monitor));
+        QCOMPARE(monitor, Monitor(i));
+    }
+
+    Monitor monitor = Monitor::Count;
+    QVERIFY(!ReadinessResult::monitorFromName("CATALYST", &monitor));
+}
+
 QTEST_MAIN(TestReadinessParser)
 #include "tst_ReadinessParser.moc"
@@ -0,0 +1,170 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include "core/ReadinessTracker.h"
+#include "core/ScanService.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestReadinessTracker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTransitionsAndEstimates();
+    void testIntervalClamped();
+    void testPollingSharesScanQueue();
+    void testPollDroppedByFailedScan();
+};
+
+void TestReadinessTracker::testTransitionsAndEstimates()
+{
+    ReadinessTracker tracker(nullptr);
+    QSignalSpy transitions(&tracker, &ReadinessTracker::transitionRecorded);
+    const qint64 start = 1700000000000;
+    const qint64 minute = 60 * 1000;
+
+    // Baselines: EVAP incomplete since clearing; EVAP and O2S running this drive
+    QVERIFY(tracker.handleResponse(0x01, "41 01 00 07 65 04", start));
+    QVERIFY(tracker.handleResponse(0x41, "41 41 00 07 65 24", start));
+    QVERIFY(transitions.isEmpty());
+    QVERIFY(!tracker.sinceCleared().overallReady);
+
+    // Six minutes in, the oxygen sensor monitor completes
+    QVERIFY(tracker.handleResponse(0x41, "41 41 00 07 65 04", start + 6 * minute));
+    QCOMPARE(transitions.size(), 1);
+    QCOMPARE(tracker.transitions().size(), 1);
+    const ReadinessTracker::Transition o2s = tracker.transitions().first();
+    QCOMPARE(o2s.timestampMs, start + 6 * minute);
+    QCOMPARE(o2s.monitor, Monitor::OxygenSensor);
+    QCOMPARE(o2s.scope, ReadinessTracker::ThisDriveCycle);
+    QCOMPARE(o2s.before, MonitorStatus::Incomplete);
+    QCOMPARE(o2s.after, MonitorStatus::Complete);
+
+    // Nothing changed: nothing recorded
+    QVERIFY(tracker.handleResponse(0x41, "41 41 00 07 65 04", start + 8 * minute));
+    QCOMPARE(tracker.transitions().size(), 1);
+
+    const ReadinessTracker::Estimate evap = tracker.estimate(Monitor::EvapSystem);
+    QCOMPARE(evap.sinceCleared, MonitorStatus::Incomplete);
+    QCOMPARE(evap.thisDriveCycle, MonitorStatus::Incomplete);
+    QCOMPARE(evap.runningMs, 8 * minute);
+    QCOMPARE(evap.remainingMs, ReadinessTracker::typicalDurationMs(Monitor::EvapSystem) - 8 * minute);
+    QCOMPARE(evap.percent, int(8 * minute * 100 / ReadinessTracker::typicalDurationMs(Monitor::EvapSystem)));
+
+    QCOMPARE(tracker.estimate(Monitor::OxygenSensor).percent, 100);
+    QCOMPARE(tracker.estimate(Monitor::OxygenSensor).remainingMs, qint64(0));
+    QCOMPARE(tracker.estimate(Monitor::HeatedCatalyst).remainingMs, qint64(-1));   // Not on this vehicle
+
+    // EVAP completes for good
+    QVERIFY(tracker.handleResponse(0x01, "41 01 00 07 65 00", start + 9 * minute));
+    QCOMPARE(tracker.transitions().size(), 2);
+    QCOMPARE(tracker.transitions().last().scope, ReadinessTracker::SinceCleared);
+    QCOMPARE(tracker.transitions().last().monitor, Monitor::EvapSystem);
+    QVERIFY(tracker.sinceCleared().overallReady);
+    QCOMPARE(tracker.estimate(Monitor::EvapSystem).percent, 100);
+
+    // Replies that do not decode change nothing
+    QVERIFY(!tracker.handleResponse(0x41, "NO DATA", start + 10 * minute));
+    QVERIFY(!tracker.handleResponse(0x41, "41 01 00 07 65 00", start + 10 * minute));
+    QCOMPARE(tracker.transitions().size(), 2);
+
+    tracker.clear();
+    QVERIFY(tracker.transitions().isEmpty());
+    QVERIFY(tracker.sinceCleared().isEmpty());
+}
+
+void TestReadinessTracker::testIntervalClamped()
+{
+    ReadinessTracker tracker(nullptr);
+    QCOMPARE(tracker.intervalMs(), ReadinessTracker::DEFAULT_INTERVAL_MS);
+    tracker.setIntervalMs(10);
+    QCOMPARE(tracker.intervalMs(), ReadinessTracker::MIN_INTERVAL_MS);
+    tracker.setIntervalMs(5000);
+    QCOMPARE(tracker.intervalMs(), 5000);
+}
+
+void TestReadinessTracker::testPollingSharesScanQueue()
+{
+    SimulatedTransporter transporter;
+    transporter.setLatency(20);
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    bool connected = false;
+    connect(&scanService, &ScanService::connectionComplete, this, [&]() { connected = true; });
+    transporter.connectToDevice("sim");
+    QTRY_VERIFY_WITH_TIMEOUT(connected, 5000);
+
+    ReadinessTracker tracker(&scanService);
+    tracker.setIntervalMs(ReadinessTracker::MIN_INTERVAL_MS);
+    const int commandsBefore = transporter.commandCount();
+
+    // The first PID 01 request is in flight when the scan starts; the scan waits for it
+    tracker.start();
+    QVERIFY(scanService.isPolling());
+    QSignalSpy complete(&scanService, &ScanService::scanComplete);
+    scanService.startScan();
+    QVERIFY(scanService.isScanning());
+    QTRY_COMPARE_WITH_TIMEOUT(complete.size(), 1, 5000);
+    QVERIFY(!tracker.sinceCleared().isEmpty());
+    const ScanResult scan = complete.first().first().value<ScanResult>();
+    QVERIFY(scan.milOn);
+    QCOMPARE(scan.dtcs.size(), 1);
+
+    // Then PID 41, at no more than one request per interval
+    QTRY_VERIFY_WITH_TIMEOUT(!tracker.thisDriveCycle().isEmpty(), 3000);
+    QCOMPARE(tracker.thisDriveCycle().getMonitorStatus(Monitor::EvapSystem), MonitorStatus::Incomplete);
+    QCOMPARE(tracker.requestsSent(), 2);
+
+    tracker.stop();
+    QTRY_VERIFY_WITH_TIMEOUT(!scanService.isPolling(), 1000);
+    const int scanCommands = transporter.commandCount() - commandsBefore - tracker.requestsSent();
+    QCOMPARE(scanCommands, int(scanService.planScan(ScanPlanner::Quick).commands.size()));
+}
+
+void TestReadinessTracker::testPollDroppedByFailedScan()
+{
+    SimulatedTransporter transporter;
+    transporter.setLatency(20);
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    bool connected = false;
+    connect(&scanService, &ScanService::connectionComplete, this, [&]() { connected = true; });
+    transporter.connectToDevice("sim");
+    QTRY_VERIFY_WITH_TIMEOUT(connected, 5000);
+
+    // The scan's first command never gets its reply in time, so the scan
+    // times out; the tracker's first request is queued behind it
+    transporter.setLatency(60000);
+    QSignalSpy complete(&scanService, &ScanService::scanComplete);
+    QSignalSpy failed(&scanService, &ScanService::pollFailed);
+    scanService.startScan();
+    ReadinessTracker tracker(&scanService);
+    tracker.setIntervalMs(ReadinessTracker::MIN_INTERVAL_MS);
+    tracker.start();
+    QVERIFY(scanService.isScanning());
+    QCOMPARE(tracker.requestsSent(), 1);
+    transporter.setLatency(20);
+
+    // The timed-out scan drops the queued request and fails it, and the
+    // tracker polls again on a later tick
+    QTRY_COMPARE_WITH_TIMEOUT(complete.size(), 1, 10000);
+    QVERIFY(complete.first().first().value<ScanResult>().timedOut);
+    QCOMPARE(failed.size(), 1);
+    QCOMPARE(failed.first().first().toByteArray(), QByteArray("01 01\r"));
+    QVERIFY(tracker.sinceCleared().isEmpty());
+    QTRY_VERIFY_WITH_TIMEOUT(!tracker.thisDriveCycle().isEmpty(), 5000);
+    QVERIFY(tracker.requestsSent() >= 2);
+
+    // A cancelled poll is failed too
+    tracker.stop();
+    QTRY_VERIFY_WITH_TIMEOUT(!scanService.isPolling(), 1000);
+    failed.clear();
+    QVERIFY(scanService.enqueuePoll("01 41\r"));
+    QVERIFY(scanService.isPolling());
+    scanService.cancel();
+    QCOMPARE(failed.size(), 1);
+}
+
+QTEST_MAIN(TestReadinessTracker)
+#include "tst_ReadinessTracker.moc"
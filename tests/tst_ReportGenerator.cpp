@@ -0,0 +1,222 @@
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include "core/PidStatistics.h"
+#include "core/ReportGenerator.h"
+#include "core/ReportTemplate.h"
+#include "core/dto/ScanResult.h"
+
+class TestReportGenerator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTemplateVariables();
+    void testTemplateSections();
+    void testTemplateErrors();
+    void testHtmlReport();
+    void testJsonReportDeterministic();
+    void testStatistics();
+    void testFleetReport();
+
+private:
+    static QVector<ScanResult> fleet(int vehicles);
+    static QByteArray readFile(const QString& path);
+};
+
+QVector<ScanResult> TestReportGenerator::fleet(int vehicles)
+{
+    QVector<ScanResult> scans;
+    scans.reserve(vehicles);
+    for (int i = 0; i < vehicles; ++i) {
+        ScanResult scan;
+        scan.vin = QString("VIN%1").arg(i, 14, 10, QChar('0'));
+        for (int d = 0; d < i % 6; ++d) {
+            DtcEntry entry(QString("P0%1").arg(300 + d), d % 2 ? DtcStatus::Pending : DtcStatus::Confirmed);
+            entry.shortText = "Cylinder misfire <detected>";
+            scan.dtcs.append(entry);
+        }
+        scan.milOn = !scan.dtcs.isEmpty();
+        scan.readiness.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+        scan.readiness.setMonitorStatus(Monitor::Catalyst, i % 3 ? MonitorStatus::Complete : MonitorStatus::Incomplete);
+        scans.append(scan);
+    }
+    return scans;
+}
+
+QByteArray TestReportGenerator::readFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void TestReportGenerator::testTemplateVariables()
+{
+    ReportTemplate tpl = ReportTemplate::parse("VIN {{ vin }}: {{note}}{{missing}}.");
+    QVERIFY(tpl.isValid());
+
+    ReportTemplate::Context context;
+    context.set("vin", "1D4GP00R55B123456");
+    context.set("note", "<b>&</b>");
+    QCOMPARE(tpl.render(context), QByteArray("VIN 1D4GP00R55B123456: &lt;b&gt;&amp;&lt;/b&gt;."));
+}
+
+void TestReportGenerator::testTemplateSections()
+{
+    ReportTemplate tpl = ReportTemplate::parse(
+        "{{#items}}[{{name}}@{{vin}}]{{/items}}{{^items}}none{{/items}}"
+        "|{{#flag}}on{{/flag}}{{^flag}}off{{/flag}}");
+    QVERIFY(tpl.isValid());
+
+    ReportTemplate::Context context;
+    context.set("vin", "V1");
+    context.setFlag("flag", false);
+    QCOMPARE(tpl.render(context), QByteArray("none|off"));
+
+    ReportTemplate::Context a;
+    a.set("name", "a");
+    ReportTemplate::Context b;
+    b.set("name", "b");
+    b.set("vin", "V2");     // Item values shadow the enclosing context
+    context.lists.insert("items", {a, b});
+    context.setFlag("flag", true);
+    QCOMPARE(tpl.render(context), QByteArray("[a@V1][b@V2]|on"));
+}
+
+void TestReportGenerator::testTemplateErrors()
+{
+    QString error;
+    QVERIFY(!ReportTemplate::parse("{{#a}}text", &error).isValid());
+    QVERIFY(error.contains("a"));
+    QVERIFY(!ReportTemplate::parse("{{#a}}{{/b}}", &error).isValid());
+    QVERIFY(!ReportTemplate::parse("{{unclosed", &error).isValid());
+    QVERIFY(!ReportTemplate::parse("{{}}", &error).isValid());
+
+    ReportGenerator generator;
+    QVERIFY(!generator.setVehicleTemplate("{{#dtcs}}"));
+    QVERIFY(!generator.lastError().isEmpty());
+}
+
+void TestReportGenerator::testHtmlReport()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QVector<ScanResult> scans = fleet(5);
+    scans[2].vin.clear();
+
+    ReportGenerator generator(ReportGenerator::Html);
+    generator.setWindowSize(2);
+    QVERIFY2(generator.generate(scans, dir.path()), qPrintable(generator.lastError()));
+
+    const QStringList files = generator.writtenFiles();
+    QCOMPARE(files.size(), 6);
+    QVERIFY(files.last().endsWith("index.html"));
+    QVERIFY(files[0].endsWith("0001-VIN00000000000000.html"));
+    QVERIFY(files[2].endsWith("0003-unknown.html"));
+
+    const QByteArray page = readFile(files[4]);
+    QVERIFY(page.contains("Vehicle VIN00000000000004"));
+    QVERIFY(page.contains("<td>P0303</td><td>pending</td>"));
+    QVERIFY(page.contains("&lt;detected&gt;"));
+    QVERIFY(page.contains("<td>CAT</td><td>complete</td>"));
+
+    const QByteArray empty = readFile(files[0]);
+    QVERIFY(empty.contains("No trouble codes."));
+
+    // Index rows are in input order and link to the pages
+    const QByteArray index = readFile(files.last());
+    QVERIFY(index.contains("5 vehicles, 4 with MIL on"));
+    int last = -1;
+    for (int i = 0; i < files.size() - 1; ++i) {
+        const int at = index.indexOf(QFileInfo(files[i]).fileName().toUtf8());
+        QVERIFY(at > last);
+        last = at;
+    }
+}
+
+void TestReportGenerator::testJsonReportDeterministic()
+{
+    const QVector<ScanResult> scans = fleet(40);
+
+    auto vehiclesIn = [&](int threads) {
+        QTemporaryDir dir;
+        ReportGenerator generator(ReportGenerator::Json);
+        generator.setMaxThreads(threads);
+        generator.setWindowSize(7);
+        if (!generator.generate(scans, dir.path())) {
+            return QJsonArray();
+        }
+        const QJsonObject index = QJsonDocument::fromJson(readFile(dir.filePath("index.json"))).object();
+        return index.value("vehicles").toArray();
+    };
+
+    const QJsonArray serial = vehiclesIn(1);
+    const QJsonArray parallel = vehiclesIn(8);
+    QCOMPARE(serial.size(), 40);
+    QCOMPARE(parallel, serial);
+    QCOMPARE(serial.at(7).toObject().value("vin").toString(), scans[7].vin);
+    QCOMPARE(serial.at(7).toObject().value("dtcCount").toInt(), 1);
+}
+
+void TestReportGenerator::testStatistics()
+{
+    PidStatistics statistics;
+    for (double rpm : {800.0, 1000.0, 1200.0}) {
+        statistics.add(PidSample("010C", rpm, "rpm"));
+    }
+    statistics.add(PidSample("0105", 90.0, "C"));
+    const QVector<ScanResult> scans = fleet(2);
+
+    // Left out of the index unless given
+    QTemporaryDir plain;
+    ReportGenerator generator(ReportGenerator::Html);
+    QVERIFY(generator.generate(scans, plain.path()));
+    QVERIFY(!readFile(plain.filePath("index.html")).contains("Live data"));
+
+    QTemporaryDir html;
+    generator.setStatistics(statistics.snapshotAll());
+    QVERIFY(generator.generate(scans, html.path()));
+    const QByteArray index = readFile(html.filePath("index.html"));
+    QVERIFY(index.contains("Live data"));
+    QVERIFY(index.contains("<td>010C</td><td>rpm</td><td>3</td><td>1000</td><td>200</td><td>800</td>"));
+    QVERIFY(index.contains("<td>0105</td><td>C</td><td>1</td><td>90</td>"));
+
+    QTemporaryDir json;
+    ReportGenerator jsonGenerator(ReportGenerator::Json);
+    jsonGenerator.setStatistics(statistics.snapshotAll());
+    QVERIFY(jsonGenerator.generate(scans, json.path()));
+    const QJsonArray entries = QJsonDocument::fromJson(readFile(json.filePath("index.json")))
+                                   .object().value("statistics").toArray();
+    QCOMPARE(entries.size(), 2);
+    const QJsonObject rpm = entries.at(0).toObject();
+    QCOMPARE(rpm.value("pid").toString(), QString("010C"));
+    QCOMPARE(rpm.value("count").toInt(), 3);
+    QCOMPARE(rpm.value("mean").toDouble(), 1000.0);
+    QCOMPARE(rpm.value("max").toDouble(), 1200.0);
+    QVERIFY(rpm.value("p95").toDouble() >= 1000.0 && rpm.value("p95").toDouble() <= 1200.0);
+    QCOMPARE(rpm.value("histogram").toObject().value("counts").toArray().size(), PidStatistics::Histogram::BINS);
+}
+
+void TestReportGenerator::testFleetReport()
+{
+    QTemporaryDir dir;
+    const QVector<ScanResult> scans = fleet(500);
+
+    ReportGenerator generator;
+    QVERIFY(generator.generate(scans, dir.path()));
+
+    // One page per vehicle, windows of 64 written in order, index last
+    const QStringList files = generator.writtenFiles();
+    QCOMPARE(files.size(), 501);
+    QCOMPARE(QFileInfo(files[499]).fileName(), generator.pageFileName(scans[499], 499));
+    QCOMPARE(QFileInfo(files.last()).fileName(), QString("index.html"));
+}
+
+QTEST_MAIN(TestReportGenerator)
+#include "tst_ReportGenerator.moc"
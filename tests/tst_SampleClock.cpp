@@ -0,0 +1,109 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include "core/SampleClock.h"
+#include "core/ScanService.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestSampleClock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSampleTimeIsBusMidpoint();
+    void testWallClockAnchor();
+    void testTransportStamps();
+};
+
+void TestSampleClock::testSampleTimeIsBusMidpoint()
+{
+    const qint64 ms = 1000000;
+    SampleClock clock;
+    QCOMPARE(clock.adapterLatencyNs(), qint64(0));
+
+    // Uncalibrated: plain midpoint
+    QCOMPARE(clock.sampleTimeNs(100 * ms, 140 * ms), 120 * ms);
+
+    // The smallest adapter-local round trip wins
+    clock.addAdapterRoundTrip(10 * ms, 22 * ms);
+    clock.addAdapterRoundTrip(30 * ms, 38 * ms);
+    clock.addAdapterRoundTrip(50 * ms, 70 * ms);
+    clock.addAdapterRoundTrip(80 * ms, 80 * ms);     // Not a round trip
+    QCOMPARE(clock.adapterLatencyNs(), 8 * ms);
+
+    // Bus exchange is [sent + 8, received]
+    QCOMPARE(clock.sampleTimeNs(100 * ms, 140 * ms), 124 * ms);
+
+    // Faster than the calibration: midpoint; never stamped as sent: received
+    QCOMPARE(clock.sampleTimeNs(100 * ms, 106 * ms), 103 * ms);
+    QCOMPARE(clock.sampleTimeNs(0, 106 * ms), 106 * ms);
+
+    clock.reset();
+    QCOMPARE(clock.adapterLatencyNs(), qint64(0));
+    QVERIFY(!clock.isAnchored());
+}
+
+void TestSampleClock::testWallClockAnchor()
+{
+    const qint64 wallMs = 1700000000000;
+    const qint64 anchorNs = 5000000000;
+    SampleClock clock;
+    clock.anchorAt(wallMs, anchorNs);
+    QVERIFY(clock.isAnchored());
+
+    QCOMPARE(clock.toWallMs(anchorNs), wallMs);
+    QCOMPARE(clock.toWallMs(anchorNs + 1500000), wallMs + 1);
+    QCOMPARE(clock.toWallMs(anchorNs + 60 * qint64(1000000000)), wallMs + 60000);
+    QCOMPARE(clock.toWallMs(anchorNs - 1), wallMs - 1);      // Rounded down, stays ordered
+    QCOMPARE(clock.toDateTime(anchorNs + 2000000).toMSecsSinceEpoch(), wallMs + 2);
+
+    // The live anchor agrees with the wall clock
+    SampleClock live;
+    live.anchor();
+    const qint64 diffMs = live.toWallMs(SampleClock::now()) - QDateTime::currentMSecsSinceEpoch();
+    QVERIFY(qAbs(diffMs) < 100);
+}
+
+void TestSampleClock::testTransportStamps()
+{
+    SimulatedTransporter transporter;
+    transporter.setLatency(10);
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    bool connected = false;
+    connect(&scanService, &ScanService::connectionComplete, this, [&]() { connected = true; });
+    transporter.connectToDevice("sim");
+    QTRY_VERIFY_WITH_TIMEOUT(connected, 5000);
+
+    // Calibrated on AT E0, AT SP 0 and AT DP
+    const SampleClock& clock = scanService.sampleClock();
+    QVERIFY(clock.isAnchored());
+    QVERIFY(clock.adapterLatencyNs() >= 10 * 1000000);
+
+    // A slower bus reply is dated inside its bus exchange
+    transporter.setLatency(60);
+    QSignalSpy polled(&scanService, &ScanService::pollResponse);
+    QVERIFY(scanService.enqueuePoll("01 0C\r"));
+    QTRY_COMPARE_WITH_TIMEOUT(polled.size(), 1, 5000);
+    const qint64 sentNs = transporter.lastSentNs();
+    const qint64 receivedNs = transporter.firstReceivedNs();
+    QVERIFY(receivedNs - sentNs >= 60 * 1000000);
+    const qint64 sampleNs = polled.first().at(2).toLongLong();
+    QCOMPARE(sampleNs, clock.sampleTimeNs(sentNs, receivedNs));
+    QVERIFY(sampleNs > sentNs);
+    QVERIFY(sampleNs < receivedNs);
+
+    // A scan is dated by its first reply, from the session anchor
+    QSignalSpy complete(&scanService, &ScanService::scanComplete);
+    const qint64 beforeMs = clock.toWallMs(SampleClock::now());
+    scanService.startScan();
+    QTRY_COMPARE_WITH_TIMEOUT(complete.size(), 1, 5000);
+    const qint64 afterMs = clock.toWallMs(SampleClock::now());
+    const ScanResult scan = complete.first().first().value<ScanResult>();
+    QVERIFY(scan.timestamp.isValid());
+    QVERIFY(scan.timestamp.toMSecsSinceEpoch() >= beforeMs);
+    QVERIFY(scan.timestamp.toMSecsSinceEpoch() <= afterMs - 60);   // Later replies took 60 ms each
+}
+
+QTEST_MAIN(TestSampleClock)
+#include "tst_SampleClock.moc"
@@ -0,0 +1,175 @@
+#include <QtTest/QtTest>
+#include "core/ScanDiffer.h"
+#include "core/dto/ScanResult.h"
+
+class TestScanDiffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testIdenticalScans();
+    void testAddedAndCleared();
+    void testStatusTransitions();
+    void testDuplicateCodesAcrossModes();
+    void testMonitorTransitions();
+    void testMilChange();
+    void testNonStandardCodes();
+    void testFleetDiff();
+
+private:
+    static ScanResult scan(const QString& vin, const QVector<DtcEntry>& dtcs);
+};
+
+ScanResult TestScanDiffer::scan(const QString& vin, const QVector<DtcEntry>& dtcs)
+{
+    ScanResult result;
+    result.vin = vin;
+    result.dtcs = dtcs;
+    result.milOn = !dtcs.isEmpty();
+    result.readiness.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+    result.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Incomplete);
+    return result;
+}
+
+void TestScanDiffer::testIdenticalScans()
+{
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420"), DtcEntry("P0133", DtcStatus::Pending)});
+    // Same codes in a different order
+    const ScanResult b = scan("VIN1", {DtcEntry("P0133", DtcStatus::Pending), DtcEntry("P0420")});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QVERIFY(diff.hasBaseline);
+    QVERIFY(diff.isEmpty());
+    QCOMPARE(diff.vin, QString("VIN1"));
+    QCOMPARE(diff.baselineTime, a.timestamp);
+}
+
+void TestScanDiffer::testAddedAndCleared()
+{
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420"), DtcEntry("U0100"), DtcEntry("P0171")});
+    const ScanResult b = scan("VIN1", {DtcEntry("C0500"), DtcEntry("P0420"), DtcEntry("P0300")});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+
+    // Key order: P before C before B before U, then by number
+    QCOMPARE(diff.addedDtcs.size(), 2);
+    QCOMPARE(diff.addedDtcs[0].code, QString("P0300"));
+    QCOMPARE(diff.addedDtcs[1].code, QString("C0500"));
+    QVERIFY(diff.addedDtcs[0].isAdded());
+    QCOMPARE(diff.addedDtcs[0].after, quint8(DtcConfirmedFlag));
+
+    QCOMPARE(diff.clearedDtcs.size(), 2);
+    QCOMPARE(diff.clearedDtcs[0].code, QString("P0171"));
+    QCOMPARE(diff.clearedDtcs[1].code, QString("U0100"));
+    QVERIFY(diff.clearedDtcs[1].isCleared());
+
+    QVERIFY(diff.changedDtcs.isEmpty());
+}
+
+void TestScanDiffer::testStatusTransitions()
+{
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420", DtcStatus::Pending), DtcEntry("P0133")});
+    const ScanResult b = scan("VIN1", {DtcEntry("P0420"), DtcEntry("P0133", DtcStatus::Pending)});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QVERIFY(diff.addedDtcs.isEmpty());
+    QVERIFY(diff.clearedDtcs.isEmpty());
+    QCOMPARE(diff.changedDtcs.size(), 2);
+
+    QCOMPARE(diff.changedDtcs[0].code, QString("P0133"));
+    QVERIFY(!diff.changedDtcs[0].isPendingToConfirmed());
+    QCOMPARE(diff.changedDtcs[1].code, QString("P0420"));
+    QVERIFY(diff.changedDtcs[1].isPendingToConfirmed());
+    QCOMPARE(diff.pendingToConfirmedCount(), 1);
+}
+
+void TestScanDiffer::testDuplicateCodesAcrossModes()
+{
+    // Stored and permanent at once: one code with two status flags
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420"), DtcEntry("P0420", DtcStatus::Permanent)});
+    const ScanResult b = scan("VIN1", {DtcEntry("P0420", DtcStatus::Permanent)});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QVERIFY(diff.addedDtcs.isEmpty());
+    QVERIFY(diff.clearedDtcs.isEmpty());
+    QCOMPARE(diff.changedDtcs.size(), 1);
+    QCOMPARE(diff.changedDtcs[0].before, quint8(DtcConfirmedFlag | DtcPermanentFlag));
+    QCOMPARE(diff.changedDtcs[0].after, quint8(DtcPermanentFlag));
+}
+
+void TestScanDiffer::testMonitorTransitions()
+{
+    ScanResult a = scan("VIN1", {});
+    ScanResult b = scan("VIN1", {});
+    b.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Complete);
+    b.readiness.setMonitorStatus(Monitor::EvapSystem, MonitorStatus::Incomplete);
+    a.readiness.setMonitorStatus(Monitor::Egr, MonitorStatus::Unsupported);
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QCOMPARE(diff.monitorChanges.size(), 2);
+    QCOMPARE(diff.monitorChanges[0], MonitorChange("CAT", MonitorStatus::Incomplete, MonitorStatus::Complete));
+    QCOMPARE(diff.monitorChanges[1], MonitorChange("EVAP", MonitorStatus::Unsupported, MonitorStatus::Incomplete));
+}
+
+void TestScanDiffer::testMilChange()
+{
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420")});
+    const ScanResult b = scan("VIN1", {});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QVERIFY(diff.milChanged());
+    QVERIFY(diff.milBefore);
+    QVERIFY(!diff.milAfter);
+
+    ScanDiff none = ScanDiffer::withoutBaseline(a);
+    QVERIFY(!none.hasBaseline);
+    QVERIFY(!none.milChanged());
+    QVERIFY(none.isEmpty());
+}
+
+void TestScanDiffer::testNonStandardCodes()
+{
+    const ScanResult a = scan("VIN1", {DtcEntry("P0420"), DtcEntry("MFR-12")});
+    const ScanResult b = scan("VIN1", {DtcEntry("MFR-12"), DtcEntry("MFR-07"), DtcEntry("P0420")});
+
+    ScanDiff diff = ScanDiffer::diff(a, b);
+    QCOMPARE(diff.addedDtcs.size(), 1);
+    QCOMPARE(diff.addedDtcs[0].code, QString("MFR-07"));
+    QVERIFY(diff.clearedDtcs.isEmpty());
+}
+
+void TestScanDiffer::testFleetDiff()
+{
+    const int vehicles = 5000;
+    QVector<ScanResult> previous;
+    QVector<ScanResult> current;
+    previous.reserve(vehicles);
+    current.reserve(vehicles);
+    for (int i = 0; i < vehicles; ++i) {
+        const QString vin = QString("VIN%1").arg(i, 14, 10, QChar('0'));
+        QVector<DtcEntry> before;
+        QVector<DtcEntry> after;
+        for (int d = 0; d < 8; ++d) {
+            const QString code = QString("P%1").arg(0x0100 + ((i + d * 37) & 0x0FFF), 4, 16, QChar('0')).toUpper();
+            before.append(DtcEntry(code, d % 3 == 0 ? DtcStatus::Pending : DtcStatus::Confirmed));
+            if (d != 2) {
+                after.append(DtcEntry(code));
+            }
+        }
+        after.append(DtcEntry("P0420"));
+        previous.append(scan(vin, before));
+        current.append(scan(vin, after));
+    }
+    current.append(scan("NEWVIN", {DtcEntry("P0300")}));
+
+    const QVector<ScanDiff> diffs = ScanDiffer::diffFleet(previous, current);
+
+    QCOMPARE(diffs.size(), vehicles + 1);
+    QVERIFY(diffs[0].hasBaseline);
+    QCOMPARE(diffs[0].clearedDtcs.size(), 1);
+    QVERIFY(!diffs.last().hasBaseline);
+    QVERIFY(diffs.last().addedDtcs.isEmpty());
+}
+
+QTEST_MAIN(TestScanDiffer)
+#include "tst_ScanDiffer.moc"
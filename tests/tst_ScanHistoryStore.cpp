@@ -0,0 +1,220 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include "core/ScanHistoryStore.h"
+#include "core/dto/ScanResult.h"
+
+class TestScanHistoryStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testOpenCreatesWalDatabase();
+    void testRecordAndReadBack();
+    void testFullRoundTrip();
+    void testVehiclesWithDtc();
+    void testBatchedWrites();
+    void testPersistsAcrossReopen();
+
+private:
+    static ScanResult makeScan(const QString& vin, const QDateTime& time, const QStringList& codes);
+
+    QTemporaryDir* m_dir = nullptr;
+    QString m_path;
+};
+
+ScanResult TestScanHistoryStore::makeScan(const QString& vin, const QDateTime& time, const QStringList& codes)
+{
+    ScanResult result;
+    result.vin = vin;
+    result.timestamp = time;
+    result.milOn = !codes.isEmpty();
+    for (const QString& code : codes) {
+        result.dtcs.append(DtcEntry(code, DtcStatus::Confirmed));
+    }
+    result.readiness.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+    result.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Incomplete);
+    return result;
+}
+
+void TestScanHistoryStore::init()
+{
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid());
+    m_path = m_dir->filePath("history.sqlite");
+}
+
+void TestScanHistoryStore::cleanup()
+{
+    delete m_dir;
+    m_dir = nullptr;
+}
+
+void TestScanHistoryStore::testOpenCreatesWalDatabase()
+{
+    ScanHistoryStore store(m_path);
+    QVERIFY2(store.open(), qPrintable(store.lastError()));
+    QVERIFY(store.isOpen());
+    QCOMPARE(store.scanCount(), qint64(0));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tst-inspect");
+        db.setDatabaseName(m_path);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("PRAGMA journal_mode") && query.next());
+        QCOMPARE(query.value(0).toString(), QString("wal"));
+
+        QVERIFY(query.exec("SELECT name FROM sqlite_master WHERE type = 'index' AND name = 'idx_scan_dtcs_code_time'"));
+        QVERIFY(query.next());
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("tst-inspect");
+}
+
+void TestScanHistoryStore::testRecordAndReadBack()
+{
+    ScanHistoryStore store(m_path);
+    QVERIFY(store.open());
+
+    const QDateTime time = QDateTime::currentDateTime().addSecs(-60);
+    ScanResult scan = makeScan("1D4GP00R55B123456", time, {"P0420", "P0133"});
+    scan.dtcs.append(DtcEntry("P0171", DtcStatus::Pending));
+    store.record(scan);
+    store.flush();
+
+    QVector<ScanResult> scans = store.scansForVehicle("1D4GP00R55B123456");
+    QCOMPARE(scans.size(), 1);
+    const ScanResult& stored = scans.first();
+    QCOMPARE(stored.timestamp.toMSecsSinceEpoch(), time.toMSecsSinceEpoch());
+    QVERIFY(stored.milOn);
+    QCOMPARE(stored.dtcs.size(), 3);
+    QCOMPARE(stored.dtcs[0].code, QString("P0420"));
+    QCOMPARE(stored.dtcs[2].status, DtcStatus::Pending);
+    QCOMPARE(stored.readiness.getMonitorStatus(Monitor::Misfire), MonitorStatus::Complete);
+    QCOMPARE(stored.readiness.getMonitorStatus(Monitor::Catalyst), MonitorStatus::Incomplete);
+    QCOMPARE(stored.readiness.overallReady, scan.readiness.overallReady);
+
+    QVERIFY(store.scansForVehicle("OTHERVIN000000000").isEmpty());
+}
+
+void TestScanHistoryStore::testFullRoundTrip()
+{
+    ScanHistoryStore store(m_path);
+    QVERIFY(store.open());
+
+    ScanResult scan;
+    scan.vin = "WDB2030461A123456";
+    scan.timestamp = QDateTime::fromMSecsSinceEpoch(1700000123456);
+    scan.milOn = true;
+    scan.receivedItems = 0x7f;
+    scan.timedOut = true;
+
+    DtcEntry misfire("P0301", DtcStatus::Confirmed);
+    misfire.shortText = "Cylinder 1 misfire detected";
+    misfire.module = "ECM";
+    misfire.freezeFrame = FreezeFrame(1);
+    misfire.freezeFrame.addParameter("RPM", "812 rpm");
+    misfire.freezeFrame.addParameter("Coolant temperature", "88 °C");
+    scan.dtcs.append(misfire);
+    DtcEntry network("U0100", DtcStatus::Permanent);
+    network.module = "TCM";
+    scan.dtcs.append(network);
+    DtcEntry body("B1000", DtcStatus::Pending);
+    body.category = DtcCategory::C;     // Stored as given, not derived from the code again
+    scan.dtcs.append(body);
+
+    // Diesel layout with no diesel-only monitor reported: only the stored flag can tell
+    scan.readiness.compressionIgnition = true;
+    scan.readiness.setMonitorStatus(Monitor::Misfire, MonitorStatus::Complete);
+    scan.readiness.setMonitorStatus(Monitor::Egr, MonitorStatus::Incomplete);
+    scan.readiness.setMonitorStatus(Monitor::Catalyst, MonitorStatus::Unsupported);
+
+    scan.modules.append(ModuleInfo("ECM", "7E8"));
+    ModuleInfo silent("TCM", "7E9");
+    silent.responding = false;
+    scan.modules.append(silent);
+
+    store.record(scan);
+    store.flush();
+
+    const QVector<ScanResult> scans = store.scansForVehicle(scan.vin);
+    QCOMPARE(scans.size(), 1);
+    QVERIFY(scans.first() == scan);
+}
+
+void TestScanHistoryStore::testVehiclesWithDtc()
+{
+    ScanHistoryStore store(m_path);
+    QVERIFY(store.open());
+
+    const QDateTime now = QDateTime::currentDateTime();
+    store.record(makeScan("VIN_A", now.addDays(-40), {"P0420"}));   // Outside the window
+    store.record(makeScan("VIN_A", now.addDays(-10), {"P0420"}));
+    store.record(makeScan("VIN_A", now.addDays(-2), {"P0420", "P0133"}));
+    store.record(makeScan("VIN_B", now.addDays(-5), {"P0420"}));
+    store.record(makeScan("VIN_C", now.addDays(-1), {"P0133"}));
+    store.record(makeScan("VIN_D", now.addDays(-50), {"P0420"}));   // Outside the window
+    store.flush();
+
+    QVector<ScanHistoryStore::DtcHit> hits = store.vehiclesWithDtc("P0420", now.addDays(-30));
+    QCOMPARE(hits.size(), 2);
+
+    // Most recent first
+    QCOMPARE(hits[0].vin, QString("VIN_A"));
+    QCOMPARE(hits[0].scanCount, 2);
+    QCOMPARE(hits[0].lastSeen.toMSecsSinceEpoch(), now.addDays(-2).toMSecsSinceEpoch());
+    QCOMPARE(hits[0].firstSeen.toMSecsSinceEpoch(), now.addDays(-10).toMSecsSinceEpoch());
+    QCOMPARE(hits[1].vin, QString("VIN_B"));
+    QCOMPARE(hits[1].scanCount, 1);
+
+    QVERIFY(store.vehiclesWithDtc("U0100", now.addDays(-30)).isEmpty());
+}
+
+void TestScanHistoryStore::testBatchedWrites()
+{
+    ScanHistoryStore store(m_path);
+    QVERIFY(store.open());
+    QSignalSpy batchSpy(&store, &ScanHistoryStore::batchWritten);
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const int total = 200;
+    for (int i = 0; i < total; ++i) {
+        store.record(makeScan(QString("VIN_%1").arg(i % 7), now.addSecs(-i), {"P0420"}));
+    }
+
+    // Writes happen in the background, in far fewer transactions than scans
+    QTRY_COMPARE_WITH_TIMEOUT(store.scanCount(), qint64(total), 5000);
+    store.flush();
+
+    int written = 0;
+    for (const QList<QVariant>& args : batchSpy) {
+        written += args.at(0).toInt();
+    }
+    QCOMPARE(written, total);
+    QVERIFY(batchSpy.count() < total / 10);
+}
+
+void TestScanHistoryStore::testPersistsAcrossReopen()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    {
+        ScanHistoryStore store(m_path);
+        QVERIFY(store.open());
+        store.record(makeScan("VIN_A", now, {"P0300"}));
+        // No flush: closing commits what is queued
+    }
+
+    ScanHistoryStore reopened(m_path);
+    QVERIFY(reopened.open());
+    QCOMPARE(reopened.scanCount(), qint64(1));
+    QCOMPARE(reopened.vehiclesWithDtc("P0300", now.addDays(-1)).size(), 1);
+}
+
+QTEST_MAIN(TestScanHistoryStore)
+#include "tst_ScanHistoryStore.moc"
@@ -0,0 +1,154 @@
+#include <QtTest/QtTest>
+#include "core/ScanPlanner.h"
+#include "core/dto/SupportedPids.h"
+
+class TestScanPlanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testQuickMergesSharedReply();
+    void testRecipesGrow();
+    void testUnknownSupportAddsDependency();
+    void testKnownUnsupportedPidIsSkipped();
+    void testBusTimeEstimate();
+    void testParseSupportedPids();
+    void testParseSupportedPidsMultipleEcus();
+    void testRecipeNames();
+
+private:
+    static SupportedPids allSupported();
+};
+
+SupportedPids TestScanPlanner::allSupported()
+{
+    SupportedPids supported;
+    supported.setBitmap(0x01, 0xFFFFFFFF);
+    supported.setBitmap(0x09, 0xFFFFFFFF);
+    return supported;
+}
+
+void TestScanPlanner::testQuickMergesSharedReply()
+{
+    ScanPlanner::ScanPlan plan = ScanPlanner::compile(ScanPlanner::Quick, allSupported());
+
+    // MIL status and readiness share one "01 01" round-trip
+    QCOMPARE(plan.commands.size(), 3);
+    QCOMPARE(plan.commands[0].data, QByteArray("01 01\r"));
+    QCOMPARE(plan.commands[0].items, quint32(ScanPlanner::MilStatus | ScanPlanner::Readiness));
+    QCOMPARE(plan.commands[1].data, QByteArray("03\r"));
+    QCOMPARE(plan.commands[2].data, QByteArray("07\r"));
+    QCOMPARE(plan.skippedItems, quint32(0));
+
+    int count0101 = 0;
+    for (const ScanPlanner::PlannedCommand& command : plan.commands) {
+        if (command.data == "01 01\r") {
+            ++count0101;
+        }
+    }
+    QCOMPARE(count0101, 1);
+}
+
+void TestScanPlanner::testRecipesGrow()
+{
+    ScanPlanner::ScanPlan emissions = ScanPlanner::compile(ScanPlanner::EmissionsPrecheck, allSupported());
+    QCOMPARE(emissions.commands.size(), 4);
+    QCOMPARE(emissions.commands.last().data, QByteArray("0A\r"));
+
+    // Full reads the VIN first
+    ScanPlanner::ScanPlan full = ScanPlanner::compile(ScanPlanner::Full, allSupported());
+    QCOMPARE(full.commands.size(), 5);
+    QCOMPARE(full.commands.first().data, QByteArray("09 02\r"));
+    QCOMPARE(full.recipe, ScanPlanner::Full);
+}
+
+void TestScanPlanner::testUnknownSupportAddsDependency()
+{
+    // Mode 01 support is learned during connection; Mode 09 is not
+    SupportedPids supported;
+    supported.setBitmap(0x01, 0xBE1FA813);
+
+    ScanPlanner::ScanPlan plan = ScanPlanner::compile(ScanPlanner::Full, supported);
+    QCOMPARE(plan.commands[0].data, QByteArray("09 00\r"));
+    QCOMPARE(plan.commands[1].data, QByteArray("09 02\r"));
+
+    // The VIN request waits on the support query at run time
+    QCOMPARE(int(plan.commands[1].gateMode), 0x09);
+    QCOMPARE(int(plan.commands[1].gatePid), 0x02);
+
+    // Mode 01 is already known, so "01 00" is not repeated
+    for (const ScanPlanner::PlannedCommand& command : plan.commands) {
+        QVERIFY(command.data != "01 00\r");
+    }
+}
+
+void TestScanPlanner::testKnownUnsupportedPidIsSkipped()
+{
+    SupportedPids supported = allSupported();
+    supported.setBitmap(0x09, 0x00000000);   // No Mode 09 info types
+
+    ScanPlanner::ScanPlan plan = ScanPlanner::compile(ScanPlanner::Full, supported);
+    QCOMPARE(plan.skippedItems, quint32(ScanPlanner::Vin));
+    for (const ScanPlanner::PlannedCommand& command : plan.commands) {
+        QVERIFY(!command.data.startsWith("09"));
+    }
+}
+
+void TestScanPlanner::testBusTimeEstimate()
+{
+    ScanPlanner::ScanPlan can = ScanPlanner::compile(ScanPlanner::Quick, allSupported(), "CAN 11/500");
+    ScanPlanner::ScanPlan kline = ScanPlanner::compile(ScanPlanner::Quick, allSupported(), "ISO 9141-2");
+    ScanPlanner::ScanPlan full = ScanPlanner::compile(ScanPlanner::Full, allSupported(), "ISO 9141-2");
+
+    QVERIFY(can.estimatedBusTimeMs > 0);
+    QVERIFY(can.estimatedBusTimeMs < kline.estimatedBusTimeMs);
+    QVERIFY(kline.estimatedBusTimeMs < full.estimatedBusTimeMs);
+
+    int sum = 0;
+    for (const ScanPlanner::PlannedCommand& command : kline.commands) {
+        sum += ScanPlanner::estimateCommandMs(command, "ISO 9141-2");
+    }
+    QCOMPARE(kline.estimatedBusTimeMs, sum);
+}
+
+void TestScanPlanner::testParseSupportedPids()
+{
+    quint32 bitmap = 0;
+    QVERIFY(ScanPlanner::parseSupportedPids("41 00 BE 1F A8 13 \r\r>", 0x01, &bitmap));
+    QCOMPARE(bitmap, quint32(0xBE1FA813));
+
+    SupportedPids supported;
+    supported.setBitmap(0x01, bitmap);
+    QVERIFY(supported.isSupported(0x01, 0x01));
+    QVERIFY(!supported.isSupported(0x01, 0x02));
+    QVERIFY(supported.isSupported(0x01, 0x20));
+    QVERIFY(!supported.isSupported(0x09, 0x02));   // Unknown mode
+
+    QVERIFY(!ScanPlanner::parseSupportedPids("NO DATA\r\r>", 0x09, &bitmap));
+    QVERIFY(!ScanPlanner::parseSupportedPids("41 00 BE 1F A8 13", 0x09, &bitmap));
+}
+
+void TestScanPlanner::testParseSupportedPidsMultipleEcus()
+{
+    // Engine and transmission ECUs answer with headers on; bitmaps are merged
+    quint32 bitmap = 0;
+    QVERIFY(ScanPlanner::parseSupportedPids("SEARCHING...\r7E8 06 41 00 80 00 00 01\r7E9 06 41 00 40 00 00 00\r\r>",
+                                            0x01, &bitmap));
+    QCOMPARE(bitmap, quint32(0xC0000001));
+}
+
+void TestScanPlanner::testRecipeNames()
+{
+    for (ScanPlanner::Recipe recipe : {ScanPlanner::Quick, ScanPlanner::EmissionsPrecheck, ScanPlanner::Full}) {
+        bool ok = false;
+        QCOMPARE(ScanPlanner::recipeFromName(ScanPlanner::recipeName(recipe), &ok), recipe);
+        QVERIFY(ok);
+    }
+
+    bool ok = true;
+    ScanPlanner::recipeFromName("everything", &ok);
+    QVERIFY(!ok);
+}
+
+QTEST_MAIN(TestScanPlanner)
+#include "tst_ScanPlanner.moc"
@@ -3,6 +3,7 @@
 #include "hardware/ObdTransporter.h"
 #include "core/dto/ScanResult.h"
 #include "core/dto/DtcEntry.h"
+#include "core/Metrics.h"
 #include <QSignalSpy>
 #include <QTimer>
 #include <qtestcase.h>
@@ -28,6 +29,13 @@ public:
     
     void sendCommand(const QByteArray &cmd) override {
         m_lastCommand = cmd;
+        m_sentCommands.append(cmd);
+        if (m_repliesLeft == 0) {
+            return; // Adapter went silent: the command times out
+        }
+        if (m_repliesLeft > 0) {
+            --m_repliesLeft;
+        }
         // Determine response based on command
         QByteArray response;
         if (cmd.contains("01 01")) {
@@ -56,10 +64,14 @@ public:
     }
     
     QByteArray lastCommand() const { return m_lastCommand; }
+    QList<QByteArray>& sentCommands() { return m_sentCommands; }
+    void setRepliesLeft(int replies) { m_repliesLeft = replies; }   // -1 = unlimited
 
 private:
     bool m_connected;
+    int m_repliesLeft = -1;
     QByteArray m_lastCommand;
+    QList<QByteArray> m_sentCommands;
 };
 
 class TestScanService : public QObject
@@ -73,7 +85,11 @@ private slots:
     void testInitialState();
     void testConnectionSequence();
     void testScanSequence();
+    void testScanSendsSharedCommandOnce();
+    void testProgressiveUpdates();
     void testCancel();
+    void testScanTimeout();
+    void testPollFromScanComplete();
 
 private:
     MockTransporter* m_transporter = nullptr;
@@ -142,6 +158,63 @@ void TestScanService::testScanSequence()
     QCOMPARE(scanFailedSpy.count(), 0);
 }
 
+void TestScanService::testScanSendsSharedCommandOnce()
+{
+    m_transporter->sentCommands().clear();
+
+    QSignalSpy scanCompleteSpy(m_scanService, &ScanService::scanComplete);
+    m_scanService->startScan(ScanPlanner::Quick);
+    QTRY_VERIFY_WITH_TIMEOUT(!m_scanService->isScanning(), 1000);
+    QCOMPARE(scanCompleteSpy.count(), 1);
+
+    // MIL status and readiness both come from the single "01 01" reply
+    QCOMPARE(m_transporter->sentCommands().count(QByteArray("01 01\r")), 1);
+    QCOMPARE(m_transporter->sentCommands().size(), 3);
+    QCOMPARE(m_scanService->lastPlan().commands.size(), m_transporter->sentCommands().size());
+
+    ScanResult result = scanCompleteSpy.at(0).at(0).value<ScanResult>();
+    QVERIFY(result.milOn);
+    QCOMPARE(result.getDtcCount(DtcStatus::Confirmed), 1);
+}
+
+void TestScanService::testProgressiveUpdates()
+{
+    QSignalSpy updatedSpy(m_scanService, &ScanService::scanUpdated);
+    QSignalSpy scanCompleteSpy(m_scanService, &ScanService::scanComplete);
+
+    // Updates must arrive while the scan is still running
+    int updatesWhileScanning = 0;
+    QMetaObject::Connection probe = connect(m_scanService, &ScanService::scanUpdated, this, [&]() {
+        if (m_scanService->isScanning()) {
+            ++updatesWhileScanning;
+        }
+    });
+
+    m_scanService->startScan(ScanPlanner::Quick);
+    QTRY_VERIFY_WITH_TIMEOUT(!m_scanService->isScanning(), 1000);
+    disconnect(probe);
+
+    QCOMPARE(updatesWhileScanning, 3);
+    QCOMPARE(updatedSpy.count(), 3);
+    QCOMPARE(scanCompleteSpy.count(), 1);
+
+    // The first update carries only the "01 01" reply
+    ScanResult first = updatedSpy.at(0).at(0).value<ScanResult>();
+    QVERIFY(!first.complete);
+    QVERIFY(first.milOn);
+    QCOMPARE(updatedSpy.at(0).at(1).value<quint32>(), quint32(ScanPlanner::MilStatus | ScanPlanner::Readiness));
+    QCOMPARE(first.receivedItems, quint32(ScanPlanner::MilStatus | ScanPlanner::Readiness));
+    QVERIFY(first.dtcs.isEmpty());
+
+    ScanResult last = updatedSpy.at(2).at(0).value<ScanResult>();
+    QCOMPARE(last.receivedItems, ScanPlanner::recipeItems(ScanPlanner::Quick));
+    QCOMPARE(last.getDtcCount(DtcStatus::Confirmed), 1);
+
+    ScanResult completed = scanCompleteSpy.at(0).at(0).value<ScanResult>();
+    QVERIFY(completed.complete);
+    QCOMPARE(completed.dtcs, last.dtcs);
+}
+
 void TestScanService::testCancel()
 {
     m_scanService->startScan();
@@ -151,5 +224,54 @@ void TestScanService::testCancel()
     QVERIFY(!m_scanService->isScanning());
 }
 
+void TestScanService::testScanTimeout()
+{
+    // Replies to the cancelled scan arrive first and are ignored
+    QTest::qWait(10);
+
+    QSignalSpy scanCompleteSpy(m_scanService, &ScanService::scanComplete);
+    const quint64 failedBefore = Metrics::value(Metrics::ScansFailed);
+    const quint64 completedBefore = Metrics::value(Metrics::ScansCompleted);
+
+    // The adapter answers the first scan command and then goes silent
+    m_transporter->setRepliesLeft(1);
+    m_scanService->startScan(ScanPlanner::Quick);
+    QTRY_COMPARE_WITH_TIMEOUT(scanCompleteSpy.size(), 1, 10000);
+    m_transporter->setRepliesLeft(-1);
+    QVERIFY(!m_scanService->isScanning());
+
+    // The result keeps the first reply and says the scan was cut short, and
+    // the metrics count it as failed, not completed
+    const ScanResult result = scanCompleteSpy.at(0).at(0).value<ScanResult>();
+    QVERIFY(result.complete);
+    QVERIFY(result.timedOut);
+    QCOMPARE(result.receivedItems, quint32(ScanPlanner::MilStatus | ScanPlanner::Readiness));
+    QVERIFY(result.milOn);
+    QCOMPARE(Metrics::value(Metrics::ScansFailed), failedBefore + 1);
+    QCOMPARE(Metrics::value(Metrics::ScansCompleted), completedBefore);
+}
+
+void TestScanService::testPollFromScanComplete()
+{
+    QSignalSpy pollResponseSpy(m_scanService, &ScanService::pollResponse);
+    QSignalSpy pollFailedSpy(m_scanService, &ScanService::pollFailed);
+
+    // A receiver of the result queues its next request straight away
+    bool queued = false;
+    const QMetaObject::Connection connection =
+        connect(m_scanService, &ScanService::scanComplete, this, [&]() {
+            queued = m_scanService->enqueuePoll("01 01\r");
+        });
+    m_scanService->startScan(ScanPlanner::Quick);
+    QTRY_COMPARE_WITH_TIMEOUT(pollResponseSpy.size(), 1, 1000);
+    disconnect(connection);
+
+    // The poll is sent and answered, not dropped by the end of the scan
+    QVERIFY(queued);
+    QVERIFY(pollFailedSpy.isEmpty());
+    QCOMPARE(pollResponseSpy.first().at(0).toByteArray(), QByteArray("01 01\r"));
+    QVERIFY(!m_scanService->isPolling());
+}
+
 QTEST_MAIN(TestScanService)
 #include "tst_ScanService.moc"
@@ -0,0 +1,137 @@
+#include <QtTest/QtTest>
+#include "core/SeriesDecimator.h"
+#include "core/dto/PidSeries.h"
+#include <cmath>
+
+class TestSeriesDecimator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmptySeries();
+    void testShortSeriesPassesThrough();
+    void testMinMaxKeepsSpikes();
+    void testOutputIsBounded();
+    void testIncrementalMatchesOneShot();
+    void testLttbKeepsEndpoints();
+    void testShrinkingSeriesResets();
+};
+
+static PidSeries makeSineSeries(int count)
+{
+    PidSeries series("010C", "rpm");
+    series.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        series.append(i * 0.05, 2000.0 + 500.0 * std::sin(i * 0.01));
+    }
+    return series;
+}
+
+void TestSeriesDecimator::testEmptySeries()
+{
+    SeriesDecimator decimator;
+    decimator.update(PidSeries());
+    QVERIFY(decimator.points().isEmpty());
+    QCOMPARE(decimator.sourceCount(), 0);
+}
+
+void TestSeriesDecimator::testShortSeriesPassesThrough()
+{
+    PidSeries series = makeSineSeries(10);
+
+    SeriesDecimator decimator(SeriesDecimator::Lttb, 100);
+    decimator.update(series);
+
+    QCOMPARE(decimator.points().size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(decimator.points()[i].x(), series.times[i]);
+        QCOMPARE(decimator.points()[i].y(), series.values[i]);
+    }
+}
+
+void TestSeriesDecimator::testMinMaxKeepsSpikes()
+{
+    PidSeries series = makeSineSeries(50000);
+    series.values[31337] = 9000.0;  // Single-sample spike
+    series.values[40000] = -100.0;  // Single-sample dropout
+
+    SeriesDecimator decimator(SeriesDecimator::MinMaxEnvelope, 200);
+    decimator.update(series);
+
+    double maxValue = -1e9;
+    double minValue = 1e9;
+    for (const QPointF& point : decimator.points()) {
+        maxValue = qMax(maxValue, point.y());
+        minValue = qMin(minValue, point.y());
+    }
+    QCOMPARE(maxValue, 9000.0);
+    QCOMPARE(minValue, -100.0);
+}
+
+void TestSeriesDecimator::testOutputIsBounded()
+{
+    PidSeries series = makeSineSeries(200000);
+
+    SeriesDecimator minMax(SeriesDecimator::MinMaxEnvelope, 800);
+    minMax.update(series);
+    QVERIFY(minMax.bucketCount() <= 800);
+    QVERIFY(minMax.points().size() <= 2 * 800 + 2);
+
+    SeriesDecimator lttb(SeriesDecimator::Lttb, 800);
+    lttb.update(series);
+    QVERIFY(lttb.points().size() <= 800 + 2);
+
+    // Output must stay in time order
+    const QVector<QPointF>& points = lttb.points();
+    for (int i = 1; i < points.size(); ++i) {
+        QVERIFY(points[i].x() > points[i - 1].x());
+    }
+}
+
+void TestSeriesDecimator::testIncrementalMatchesOneShot()
+{
+    PidSeries full = makeSineSeries(20000);
+
+    SeriesDecimator incremental(SeriesDecimator::Lttb, 300);
+    PidSeries growing("010C", "rpm");
+    for (int i = 0; i < full.size(); ++i) {
+        growing.append(full.times[i], full.values[i]);
+        if (i % 17 == 0) {
+            incremental.update(growing);
+        }
+    }
+    incremental.update(growing);
+
+    QVector<QPointF> oneShot = SeriesDecimator::decimateLttb(full.times.constData(), full.values.constData(),
+                                                             full.size(), 300);
+    QCOMPARE(incremental.points(), oneShot);
+}
+
+void TestSeriesDecimator::testLttbKeepsEndpoints()
+{
+    PidSeries series = makeSineSeries(5000);
+
+    SeriesDecimator decimator(SeriesDecimator::Lttb, 50);
+    decimator.update(series);
+
+    const QVector<QPointF>& points = decimator.points();
+    QCOMPARE(points.first().x(), series.times.first());
+    QCOMPARE(points.last().x(), series.times.last());
+}
+
+void TestSeriesDecimator::testShrinkingSeriesResets()
+{
+    PidSeries series = makeSineSeries(1000);
+
+    SeriesDecimator decimator(SeriesDecimator::MinMaxEnvelope, 100);
+    decimator.update(series);
+    QCOMPARE(decimator.sourceCount(), 1000);
+
+    series = makeSineSeries(10);
+    decimator.update(series);
+    QCOMPARE(decimator.sourceCount(), 10);
+    QCOMPARE(decimator.points().size(), 10);
+}
+
+QTEST_MAIN(TestSeriesDecimator)
+#include "tst_SeriesDecimator.moc"
@@ -0,0 +1,106 @@
+#include <QtTest/QtTest>
+#include "core/StartupProfiler.h"
+
+class TestStartupProfiler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPhases();
+    void testOnlyColdStartCounts();
+    void testReport();
+    void testClock();
+
+private:
+    static constexpr qint64 MS = 1000000;
+};
+
+void TestStartupProfiler::testPhases()
+{
+    StartupProfiler::start(1000 * MS);
+    QVERIFY(StartupProfiler::phases().isEmpty());
+    QCOMPARE(StartupProfiler::firstPaintNs(), qint64(-1));
+    QVERIFY(!StartupProfiler::isInteractive());
+
+    StartupProfiler::mark("application", 1012 * MS);
+    StartupProfiler::mark("main window", 1050 * MS);
+    StartupProfiler::mark("clock skew", 1040 * MS);     // Never negative
+    StartupProfiler::markFirstPaint(1090 * MS);
+    StartupProfiler::markInteractive(1100 * MS);
+
+    const QVector<StartupProfiler::Phase> phases = StartupProfiler::phases();
+    QCOMPARE(phases.size(), 5);
+    QCOMPARE(phases[0].name, QString("application"));
+    QCOMPARE(phases[0].startNs, qint64(0));
+    QCOMPARE(phases[0].durationNs, 12 * MS);
+    QCOMPARE(phases[1].startNs, 12 * MS);
+    QCOMPARE(phases[1].durationNs, 38 * MS);
+    QCOMPARE(phases[2].durationNs, qint64(0));
+    QCOMPARE(phases[3].name, QString("first paint"));
+    QCOMPARE(phases[3].startNs, 50 * MS);
+    QCOMPARE(phases[3].durationNs, 40 * MS);
+    QCOMPARE(phases[4].name, QString("interactive"));
+
+    QCOMPARE(StartupProfiler::firstPaintNs(), 90 * MS);
+    QCOMPARE(StartupProfiler::interactiveNs(), 100 * MS);
+    QVERIFY(StartupProfiler::isInteractive());
+    QVERIFY(!StartupProfiler::isOverBudget());
+}
+
+void TestStartupProfiler::testOnlyColdStartCounts()
+{
+    StartupProfiler::start(0);
+    StartupProfiler::markFirstPaint(80 * MS);
+    StartupProfiler::markFirstPaint(95 * MS);           // Later paints are not the first
+    QCOMPARE(StartupProfiler::firstPaintNs(), 80 * MS);
+
+    StartupProfiler::markInteractive(400 * MS);
+    QVERIFY(StartupProfiler::isOverBudget());
+
+    // A view built when its tab is first opened is not part of the start
+    StartupProfiler::mark("codes view", 900 * MS);
+    StartupProfiler::markInteractive(950 * MS);
+    QCOMPARE(StartupProfiler::phases().size(), 2);
+    QCOMPARE(StartupProfiler::interactiveNs(), 400 * MS);
+
+    // start() begins a new profile
+    StartupProfiler::start(2000 * MS);
+    QVERIFY(StartupProfiler::phases().isEmpty());
+    QVERIFY(!StartupProfiler::isInteractive());
+    QVERIFY(!StartupProfiler::isOverBudget());
+}
+
+void TestStartupProfiler::testReport()
+{
+    StartupProfiler::start(0);
+    QVERIFY(StartupProfiler::report().startsWith("Startup: not interactive yet"));
+
+    StartupProfiler::mark("application", 12 * MS);
+    StartupProfiler::markFirstPaint(150 * MS);
+    StartupProfiler::markInteractive(165 * MS);
+
+    const QStringList lines = StartupProfiler::report().split('\n');
+    QCOMPARE(lines.size(), 4);
+    QCOMPARE(lines[0], QString("Startup: interactive after 165.0 ms, first paint after 150.0 ms (budget 300 ms)"));
+    QVERIFY(lines[1].trimmed().startsWith("application"));
+    QVERIFY(lines[1].endsWith("12.0 ms"));
+    QVERIFY(lines[2].endsWith("138.0 ms"));
+
+    StartupProfiler::start(0);
+    StartupProfiler::markInteractive(301 * MS);
+    QVERIFY(StartupProfiler::report().contains("(budget 300 ms, exceeded)"));
+}
+
+void TestStartupProfiler::testClock()
+{
+    // Without explicit times the monotonic trace clock is used
+    StartupProfiler::start();
+    QTest::qSleep(5);
+    StartupProfiler::mark("sleep");
+    StartupProfiler::markInteractive();
+    QVERIFY(StartupProfiler::phases().first().durationNs >= 4 * MS);
+    QVERIFY(StartupProfiler::interactiveNs() >= StartupProfiler::phases().first().durationNs);
+}
+
+QTEST_MAIN(TestStartupProfiler)
+#include "tst_StartupProfiler.moc"
@@ -0,0 +1,161 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QThread>
+#include "core/Trace.h"
+#include "core/ScanService.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void testRecordAndFormat();
+    void testPackText();
+    void testRingOverwritesOldest();
+    void testThreadsHaveOwnRings();
+    void testDisabled();
+    void testScanServiceTrace();
+    void testRecordCost();
+};
+
+void TestTrace::init()
+{
+    Trace::setEnabled(true);
+    Trace::clear();
+}
+
+void TestTrace::testRecordAndFormat()
+{
+    QVERIFY(Trace::compiledIn(Trace::Scan));
+
+    OBD_TRACE(Scan, ScanCommandSent, 0x20, Trace::packText(QByteArray("03\r")));
+    OBD_TRACE(Scan, ScanResponse, 12, Trace::packText(QByteArray("43 01 33 00 00 00")));
+
+    const QVector<Trace::ThreadEvent> events = Trace::snapshot();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events[0].event.id, quint16(Trace::ScanCommandSent));
+    QCOMPARE(events[0].event.category, quint8(Trace::Scan));
+    QCOMPARE(events[0].event.arg0, quint32(0x20));
+    QVERIFY(events[0].event.timestampNs <= events[1].event.timestampNs);
+
+    const QStringList lines = Trace::formatAll();
+    QCOMPARE(lines.size(), 2);
+    QVERIFY2(lines[0].startsWith("+0.000 ms"), qPrintable(lines[0]));
+    QVERIFY2(lines[0].contains("scan.command_sent 03\\r items=0x20"), qPrintable(lines[0]));
+    QVERIFY2(lines[1].contains("scan.response 12 bytes: 43 01 33..."), qPrintable(lines[1]));
+}
+
+void TestTrace::testPackText()
+{
+    QCOMPARE(Trace::unpackText(Trace::packText(QByteArray("AT Z\r"))), QByteArray("AT Z\r"));
+    QCOMPARE(Trace::unpackText(Trace::packText(QByteArray("0123456789"))), QByteArray("01234567"));
+    QCOMPARE(Trace::unpackText(Trace::packText(QString("ISO 9141-2"))), QByteArray("ISO 9141"));
+    QCOMPARE(Trace::unpackText(Trace::packText(QByteArray())), QByteArray());
+}
+
+void TestTrace::testRingOverwritesOldest()
+{
+    const int total = Trace::RING_SIZE + 100;
+    for (int i = 0; i < total; ++i) {
+        OBD_TRACE(Scan, ScanVinUnreadable, quint32(i));
+    }
+
+    // The oldest slot of a full ring is the one the next record overwrites,
+    // so it is never exported
+    const QVector<Trace::ThreadEvent> events = Trace::snapshot();
+    QCOMPARE(events.size(), Trace::RING_SIZE - 1);
+    QCOMPARE(events.first().event.arg0, quint32(101));
+    QCOMPARE(events.last().event.arg0, quint32(total - 1));
+}
+
+void TestTrace::testThreadsHaveOwnRings()
+{
+    OBD_TRACE(Scan, ScanConnectStart);
+
+    QThread* worker = QThread::create([]() {
+        for (int i = 0; i < 10; ++i) {
+            OBD_TRACE(Transport, TransportSend, quint32(i));
+        }
+    });
+    worker->setObjectName("trace-worker");
+    worker->start();
+    QVERIFY(worker->wait(5000));
+    delete worker;
+
+    // Events of a finished thread stay readable until cleared
+    const QVector<Trace::ThreadEvent> events = Trace::snapshot();
+    QCOMPARE(events.size(), 11);
+
+    int workerEvents = 0;
+    quint32 mainThread = 0;
+    for (const Trace::ThreadEvent& entry : events) {
+        if (entry.event.id == Trace::TransportSend) {
+            ++workerEvents;
+            QCOMPARE(entry.threadName, QString("trace-worker"));
+        } else {
+            mainThread = entry.thread;
+        }
+    }
+    QCOMPARE(workerEvents, 10);
+    QVERIFY(mainThread != 0);
+    QVERIFY(events.last().thread != mainThread);
+
+    Trace::clear();
+    QVERIFY(Trace::snapshot().isEmpty());
+}
+
+void TestTrace::testDisabled()
+{
+    Trace::setEnabled(false);
+    OBD_TRACE(Scan, ScanConnectStart);
+    Trace::setEnabled(true);
+    QVERIFY(Trace::snapshot().isEmpty());
+}
+
+void TestTrace::testScanServiceTrace()
+{
+    SimulatedTransporter transporter;
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    bool connected = false;
+    connect(&scanService, &ScanService::connectionComplete, this, [&]() { connected = true; });
+    transporter.connectToDevice("sim");
+    QTRY_VERIFY_WITH_TIMEOUT(connected, 5000);
+
+    // The connection sequence is in the trace, in order
+    QStringList sent;
+    int responses = 0;
+    for (const Trace::ThreadEvent& entry : Trace::snapshot()) {
+        if (entry.event.id == Trace::ScanCommandSent) {
+            sent.append(QString::fromLatin1(Trace::unpackText(entry.event.arg1)));
+        } else if (entry.event.id == Trace::ScanResponse) {
+            ++responses;
+        }
+    }
+    QCOMPARE(sent, QStringList({"AT Z\r", "AT E0\r", "AT SP 0\r", "01 00\r", "AT DP\r"}));
+    QCOMPARE(responses, sent.size());
+}
+
+void TestTrace::testRecordCost()
+{
+    const int iterations = 1000000;
+    const QByteArray command("01 0C\r");
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        OBD_TRACE(Scan, ScanCommandSent, quint32(i), Trace::packText(command));
+    }
+    const double nsPerEvent = double(timer.nsecsElapsed()) / iterations;
+
+    // Typically well under 50 ns even in debug builds; the bound only catches
+    // accidental formatting or locking on the record path
+    QVERIFY2(nsPerEvent < 500.0, qPrintable(QString("%1 ns per event").arg(nsPerEvent)));
+}
+
+QTEST_MAIN(TestTrace)
+#include "tst_Trace.moc"
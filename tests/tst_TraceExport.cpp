@@ -0,0 +1,209 @@
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include "core/Trace.h"
+#include "core/TraceExport.h"
+#include "core/ScanService.h"
+#include "hardware/SimulatedTransporter.h"
+
+class TestTraceExport : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testLifecycleOffByDefault();
+    void testChromeJsonStructure();
+    void testConnectPhaseOrder();
+    void testWriteFile();
+
+private:
+    static Trace::ThreadEvent event(qint64 timestampNs, Trace::EventId id, Trace::Category category,
+                                    quint32 arg0 = 0, quint64 arg1 = 0);
+    static QJsonArray traceEvents(const QByteArray& json);
+
+    quint8 m_defaultCategories = 0;
+};
+
+void TestTraceExport::init()
+{
+    m_defaultCategories = Trace::enabledCategories();
+    Trace::setEnabled(true);
+    Trace::clear();
+}
+
+void TestTraceExport::cleanup()
+{
+    Trace::setCategoriesEnabled(m_defaultCategories);
+}
+
+Trace::ThreadEvent TestTraceExport::event(qint64 timestampNs, Trace::EventId id, Trace::Category category,
+                                          quint32 arg0, quint64 arg1)
+{
+    Trace::ThreadEvent entry;
+    entry.event.timestampNs = timestampNs;
+    entry.event.id = id;
+    entry.event.category = category;
+    entry.event.arg0 = arg0;
+    entry.event.arg1 = arg1;
+    entry.thread = 1;
+    entry.threadName = "main";
+    return entry;
+}
+
+QJsonArray TestTraceExport::traceEvents(const QByteArray& json)
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &error);
+    if (error.error != QJsonParseError::NoError) {
+        return QJsonArray();
+    }
+    return document.object().value("traceEvents").toArray();
+}
+
+void TestTraceExport::testLifecycleOffByDefault()
+{
+    QVERIFY(!(m_defaultCategories & Trace::Lifecycle));
+    OBD_TRACE(Lifecycle, CommandEnqueued, 1);
+    QVERIFY(Trace::snapshot().isEmpty());
+
+    Trace::setCategoriesEnabled(m_defaultCategories | Trace::Lifecycle);
+    OBD_TRACE(Lifecycle, CommandEnqueued, 1);
+    OBD_TRACE(Scan, ScanConnectStart);
+    QCOMPARE(Trace::snapshot().size(), 2);
+
+    // Switching a category off leaves the others recording
+    Trace::setCategoriesEnabled(Trace::Scan);
+    OBD_TRACE(Lifecycle, CommandDequeued, 1);
+    OBD_TRACE(Scan, ScanConnectStart);
+    QCOMPARE(Trace::snapshot().size(), 3);
+}
+
+void TestTraceExport::testChromeJsonStructure()
+{
+    const quint64 text = Trace::packText(QByteArray("01 0C\r"));
+    const QVector<Trace::ThreadEvent> events = {
+        event(1000000, Trace::CommandEnqueued, Trace::Lifecycle, 7, text),
+        event(1002000, Trace::CommandDequeued, Trace::Lifecycle, 7),
+        event(1003000, Trace::ScanCommandSent, Trace::Scan, 0x1, text),
+        event(1004000, Trace::CommandWritten, Trace::Lifecycle, 7),
+        event(1010000, Trace::CommandFirstByte, Trace::Lifecycle, 7),
+        event(1012000, Trace::CommandPrompt, Trace::Lifecycle, 7, 11),
+        event(1012500, Trace::CommandParseBegin, Trace::Lifecycle, 7),
+        event(1013000, Trace::CommandParseEnd, Trace::Lifecycle, 7),
+    };
+
+    const QJsonArray json = traceEvents(TraceExport::toChromeJson(events));
+    QVERIFY(!json.isEmpty());
+
+    QStringList asyncSpans;
+    bool threadNamed = false;
+    bool instantFound = false;
+    int parseSlices = 0;
+    for (const QJsonValue& value : json) {
+        const QJsonObject e = value.toObject();
+        const QString ph = e.value("ph").toString();
+        QCOMPARE(e.value("pid").toInt(), 1);
+
+        if (ph == "M" && e.value("name").toString() == "thread_name") {
+            threadNamed = e.value("args").toObject().value("name").toString() == "main";
+        } else if (ph == "i") {
+            instantFound = true;
+            QCOMPARE(e.value("name").toString(), QString("scan.command_sent"));
+            QCOMPARE(e.value("ts").toDouble(), 3.0);
+            QVERIFY(e.value("args").toObject().value("detail").toString().contains("01 0C"));
+        } else if (ph == "b" || ph == "e") {
+            QCOMPARE(e.value("id").toInt(), 7);
+            QCOMPARE(e.value("cat").toString(), QString("command"));
+            asyncSpans.append(ph + ":" + e.value("name").toString() + "@" + QString::number(e.value("ts").toDouble()));
+        } else if ((ph == "B" || ph == "E") && e.value("name").toString() == "parse") {
+            ++parseSlices;
+        }
+    }
+
+    QVERIFY(threadNamed);
+    QVERIFY(instantFound);
+    QCOMPARE(parseSlices, 2);
+
+    // Timestamps are microseconds from the first event; children close before the command
+    QCOMPARE(asyncSpans, QStringList({
+        "b:01 0C@0",
+        "b:queued@0", "e:queued@2",
+        "b:write@2", "e:write@4",
+        "b:wait@4", "e:wait@10",
+        "b:receive@10", "e:receive@12",
+        "b:parse@12.5", "e:parse@13",
+        "e:01 0C@13",
+    }));
+}
+
+void TestTraceExport::testConnectPhaseOrder()
+{
+    Trace::setCategoriesEnabled(m_defaultCategories | Trace::Lifecycle);
+
+    SimulatedTransporter transporter;
+    ScanService scanService(&transporter);
+    connect(&transporter, &ObdTransporter::connected, &scanService, &ScanService::startConnection);
+
+    bool connected = false;
+    connect(&scanService, &ScanService::connectionComplete, this, [&]() { connected = true; });
+    transporter.connectToDevice("sim");
+    QTRY_VERIFY_WITH_TIMEOUT(connected, 5000);
+
+    // Every command passes through the phases in order
+    const QList<Trace::EventId> phases = {
+        Trace::CommandEnqueued, Trace::CommandDequeued, Trace::CommandWritten, Trace::CommandFirstByte,
+        Trace::CommandPrompt, Trace::CommandParseBegin, Trace::CommandParseEnd
+    };
+    QMap<quint32, QList<quint16>> seen;
+    for (const Trace::ThreadEvent& entry : Trace::snapshot()) {
+        if (entry.event.category == Trace::Lifecycle) {
+            seen[entry.event.arg0].append(entry.event.id);
+        }
+    }
+    QCOMPARE(seen.size(), 5);
+    for (auto it = seen.constBegin(); it != seen.constEnd(); ++it) {
+        QList<quint16> expected;
+        for (Trace::EventId id : phases) {
+            expected.append(id);
+        }
+        QCOMPARE(it.value(), expected);
+    }
+
+    // One named track per command, in queue order
+    QStringList commands;
+    for (const QJsonValue& value : traceEvents(TraceExport::toChromeJson(Trace::snapshot()))) {
+        const QJsonObject e = value.toObject();
+        if (e.value("ph").toString() == "b" && e.value("args").toObject().contains("sequence")) {
+            commands.append(e.value("name").toString());
+        }
+    }
+    QCOMPARE(commands, QStringList({"AT Z", "AT E0", "AT SP 0", "01 00", "AT DP"}));
+}
+
+void TestTraceExport::testWriteFile()
+{
+    Trace::setCategoriesEnabled(m_defaultCategories | Trace::Lifecycle);
+    OBD_TRACE(Lifecycle, CommandEnqueued, 1, Trace::packText(QByteArray("03\r")));
+    OBD_TRACE(Lifecycle, CommandDequeued, 1);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("trace.json");
+    QString error;
+    QVERIFY2(TraceExport::writeChromeJson(path, &error), qPrintable(error));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(!traceEvents(file.readAll()).isEmpty());
+
+    QVERIFY(!TraceExport::writeChromeJson(dir.filePath("missing/trace.json"), &error));
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_MAIN(TestTraceExport)
+#include "tst_TraceExport.moc"
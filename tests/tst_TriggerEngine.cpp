@@ -0,0 +1,365 @@
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "core/CaptureWriter.h"
+#include "core/TriggerEngine.h"
+#include "TestSamples.h"
+
+using TestSamples::sample;
+using TestSamples::START_NS;
+
+class TestTriggerEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRuleValidation();
+    void testConditions();
+    void testCombine();
+    void testDtcAppeared();
+    void testCaptureWindow();
+    void testRingTruncation();
+    void testRingFollowsTime();
+    void testFinishAndReset();
+    void testWriteCapture();
+
+private:
+    static TriggerEngine::Rule rule(const QString& name, TriggerEngine::ConditionType type, const QString& pidId,
+                                    double threshold, double upper = 0.0);
+    static QStringList names(const QSignalSpy& spy);
+};
+
+TriggerEngine::Rule TestTriggerEngine::rule(const QString& name, TriggerEngine::ConditionType type,
+                                            const QString& pidId, double threshold, double upper)
+{
+    TriggerEngine::Condition condition;
+    condition.type = type;
+    condition.pidId = pidId;
+    condition.threshold = threshold;
+    condition.upper = upper;
+
+    TriggerEngine::Rule result;
+    result.name = name;
+    result.conditions = {condition};
+    return result;
+}
+
+QStringList TestTriggerEngine::names(const QSignalSpy& spy)
+{
+    QStringList result;
+    for (const QList<QVariant>& arguments : spy) {
+        result.append(arguments.at(0).toString());
+    }
+    return result;
+}
+
+void TestTriggerEngine::testRuleValidation()
+{
+    TriggerEngine engine;
+    QString error;
+
+    QVERIFY(!engine.addRule(TriggerEngine::Rule(), &error));       // No conditions
+    QVERIFY(!error.isEmpty());
+    QVERIFY(!engine.addRule(rule("no pid", TriggerEngine::Above, QString(), 1.0), &error));
+
+    TriggerEngine::Rule tooMany = rule("too many", TriggerEngine::Above, "010C", 1.0);
+    for (int i = 0; i < TriggerEngine::MAX_CONDITIONS; ++i) {
+        tooMany.conditions.append(tooMany.conditions.first());
+    }
+    QVERIFY(!engine.addRule(tooMany, &error));
+    QCOMPARE(engine.ruleCount(), 0);
+
+    QVERIFY(engine.addRule(rule("ok", TriggerEngine::Above, "010C", 1.0), &error));
+    QVERIFY(error.isEmpty());
+    QCOMPARE(engine.ruleCount(), 1);
+    engine.clearRules();
+    QCOMPARE(engine.ruleCount(), 0);
+}
+
+void TestTriggerEngine::testConditions()
+{
+    TriggerEngine engine;
+    engine.setPostTriggerMs(0);     // Every trigger completes its own capture
+    QVERIFY(engine.addRule(rule("hot", TriggerEngine::Above, "0105", 100.0)));
+    QVERIFY(engine.addRule(rule("cold", TriggerEngine::Below, "0105", 0.0)));
+    QVERIFY(engine.addRule(rule("idle", TriggerEngine::InsideWindow, "010C", 600.0, 900.0)));
+    QVERIFY(engine.addRule(rule("voltage", TriggerEngine::OutsideWindow, "0142", 11.5, 15.0)));
+    QVERIFY(engine.addRule(rule("rev", TriggerEngine::RisingFaster, "010C", 5000.0)));
+    QVERIFY(engine.addRule(rule("drop", TriggerEngine::FallingFaster, "010C", 5000.0)));
+    QSignalSpy triggered(&engine, &TriggerEngine::triggered);
+    QSignalSpy completed(&engine, &TriggerEngine::captureComplete);
+
+    // Fires on the edge only: staying true does not fire again
+    engine.ingest(sample("0105", 95.0, 0));
+    engine.ingest(sample("0105", 101.0, 100));
+    engine.ingest(sample("0105", 102.0, 200));
+    engine.ingest(sample("0105", 99.0, 300));
+    engine.ingest(sample("0105", 103.0, 400));
+    QCOMPARE(names(triggered), QStringList({"hot", "hot"}));
+    QCOMPARE(triggered.at(0).at(1).toLongLong(), START_NS + 100000000);
+    triggered.clear();
+
+    engine.ingest(sample("0105", -5.0, 500));
+    engine.ingest(sample("0142", 14.0, 500));
+    engine.ingest(sample("0142", 16.0, 600));
+    QCOMPARE(names(triggered), QStringList({"cold", "voltage"}));
+    triggered.clear();
+
+    // 800 rpm is idle; +3000 rpm in 100 ms is 30000 rpm/s; -1000 in 100 ms is 10000 rpm/s down
+    engine.ingest(sample("010C", 800.0, 1000));
+    engine.ingest(sample("010C", 3800.0, 1100));
+    engine.ingest(sample("010C", 3900.0, 1200));
+    engine.ingest(sample("010C", 2900.0, 1300));
+    QCOMPARE(names(triggered), QStringList({"idle", "rev", "drop"}));
+
+    // A sample at the same time has no rate
+    triggered.clear();
+    engine.ingest(sample("010C", 0.0, 1300));
+    QVERIFY(triggered.isEmpty());
+
+    QCOMPARE(completed.size(), 7);
+    QCOMPARE(engine.samplesIngested(), quint64(13));
+}
+
+void TestTriggerEngine::testCombine()
+{
+    TriggerEngine engine;
+    engine.setPostTriggerMs(0);
+
+    TriggerEngine::Rule lugging = rule("lugging", TriggerEngine::Below, "010C", 1200.0);
+    lugging.conditions.append(rule(QString(), TriggerEngine::Above, "0104", 80.0).conditions.first());
+    lugging.combine = TriggerEngine::All;
+    QVERIFY(engine.addRule(lugging));
+
+    TriggerEngine::Rule either = lugging;
+    either.name = "either";
+    either.combine = TriggerEngine::Any;
+    QVERIFY(engine.addRule(either));
+
+    QSignalSpy triggered(&engine, &TriggerEngine::triggered);
+    engine.ingest(sample("010C", 1000.0, 0));   // Low rpm only: Any fires
+    QCOMPARE(names(triggered), QStringList({"either"}));
+    engine.ingest(sample("0104", 90.0, 10));    // Both: All fires, Any stays true
+    QCOMPARE(names(triggered), QStringList({"either", "lugging"}));
+    engine.ingest(sample("010C", 2000.0, 20));  // Rpm recovers: All clears
+    engine.ingest(sample("010C", 1100.0, 30));  // And fires again
+    QCOMPARE(names(triggered), QStringList({"either", "lugging", "lugging"}));
+}
+
+void TestTriggerEngine::testDtcAppeared()
+{
+    TriggerEngine engine;
+    engine.setPostTriggerMs(0);
+
+    TriggerEngine::Rule misfire;
+    misfire.name = "misfire";
+    TriggerEngine::Condition condition;
+    condition.type = TriggerEngine::DtcAppeared;
+    condition.dtcCode = "P0300";
+    misfire.conditions = {condition};
+    QVERIFY(engine.addRule(misfire));
+
+    TriggerEngine::Rule any = misfire;
+    any.name = "any";
+    any.conditions.first().dtcCode.clear();
+    QVERIFY(engine.addRule(any));
+
+    QSignalSpy triggered(&engine, &TriggerEngine::triggered);
+    engine.ingestDtcs({DtcEntry("P0171")}, START_NS);
+    QCOMPARE(names(triggered), QStringList({"any"}));
+
+    // Each new code is one event; codes seen before are not
+    engine.ingestDtcs({DtcEntry("P0171"), DtcEntry("P0300")}, START_NS + 1000000);
+    QCOMPARE(names(triggered), QStringList({"any", "misfire", "any"}));
+    engine.ingestDtcs({DtcEntry("P0171"), DtcEntry("P0300")}, START_NS + 2000000);
+    QCOMPARE(triggered.size(), 3);
+
+    // Until reset
+    engine.reset();
+    engine.ingestDtcs({DtcEntry("P0300")}, START_NS + 3000000);
+    QCOMPARE(triggered.size(), 5);
+}
+
+void TestTriggerEngine::testCaptureWindow()
+{
+    TriggerEngine engine;
+    engine.setPreTriggerMs(1000);
+    engine.setPostTriggerMs(500);
+    QVERIFY(engine.addRule(rule("over-rev", TriggerEngine::Above, "010C", 3000.0)));
+    QSignalSpy completed(&engine, &TriggerEngine::captureComplete);
+
+    // Rpm spikes at 2.0 s, dips, and rises again at 2.2 s while capturing
+    for (qint64 t = 0; t <= 3000; t += 100) {
+        const bool high = t == 2000 || t >= 2200;
+        engine.ingest(sample("010C", high ? 4000.0 : 1000.0, t));
+        engine.ingest(sample("0105", 90.0, t));
+        if (t == 2000) {
+            QVERIFY(engine.isCapturing());
+        }
+    }
+    QVERIFY(!engine.isCapturing());
+    QCOMPARE(completed.size(), 1);
+
+    const TriggerEngine::Capture capture = completed.first().first().value<TriggerEngine::Capture>();
+    const qint64 ms = 1000000;
+    QCOMPARE(capture.ruleName, QString("over-rev"));
+    QCOMPARE(capture.triggerTimeNs, START_NS + 2000 * ms);
+    QCOMPARE(capture.triggerWallMs, qint64(1700000002000));
+    QCOMPARE(capture.preTriggerNs, 1000 * ms);
+    QCOMPARE(capture.postTriggerNs, 500 * ms);
+    QCOMPARE(capture.pids, QStringList({"010C", "0105"}));
+    QCOMPARE(capture.suppressedTriggers, 1);
+    QVERIFY(!capture.truncated);
+
+    // Both PIDs from 1.0 s to 2.4 s, and the rpm sample at 2.5 s that completed it
+    QCOMPARE(capture.samples.size(), 31);
+    QCOMPARE(capture.samples.first().timeNs, START_NS + 1000 * ms);
+    QCOMPARE(capture.samples.last().timeNs, START_NS + 2500 * ms);
+    QCOMPARE(capture.pids[capture.samples.last().pid], QString("010C"));
+    for (int i = 1; i < capture.samples.size(); ++i) {
+        QVERIFY(capture.samples[i].timeNs >= capture.samples[i - 1].timeNs);
+    }
+}
+
+void TestTriggerEngine::testRingTruncation()
+{
+    TriggerEngine engine(10);
+    QCOMPARE(engine.capacity(), 16);
+    engine.setPreTriggerMs(10000);
+    engine.setPostTriggerMs(50);
+    QVERIFY(engine.addRule(rule("spike", TriggerEngine::Above, "010C", 3000.0)));
+    QSignalSpy completed(&engine, &TriggerEngine::captureComplete);
+
+    for (int i = 0; i < 40; ++i) {
+        engine.ingest(sample("010C", i == 30 ? 4000.0 : 1000.0, i * 10));
+    }
+    QCOMPARE(completed.size(), 1);
+
+    // Completed at 350 ms: the ring only holds the last 16 samples
+    const TriggerEngine::Capture capture = completed.first().first().value<TriggerEngine::Capture>();
+    QVERIFY(capture.truncated);
+    QCOMPARE(capture.samples.size(), 16);
+    QCOMPARE(capture.samples.first().timeNs, START_NS + 200000000);
+    QCOMPARE(capture.samples.last().timeNs, START_NS + 350000000);
+}
+
+void TestTriggerEngine::testRingFollowsTime()
+{
+    TriggerEngine engine;
+    engine.setPreTriggerMs(1000);
+    engine.setPostTriggerMs(500);
+    QVERIFY(engine.addRule(rule("spike", TriggerEngine::Above, "010C", 3000.0)));
+    QSignalSpy completed(&engine, &TriggerEngine::captureComplete);
+
+    // Two PIDs every millisecond: the ring keeps one second, whatever the count
+    for (int t = 0; t < 5000; ++t) {
+        engine.ingest(sample("010C", t == 4000 ? 4000.0 : 1000.0, t));
+        engine.ingest(sample("0105", 90.0, t));
+        if (t == 3999) {
+            QCOMPARE(engine.bufferedSamples(), 2002);
+        }
+    }
+    QCOMPARE(completed.size(), 1);
+
+    // Past the initial ring size, but the whole window is there: 3.0 s to 4.5 s
+    const TriggerEngine::Capture capture = completed.first().first().value<TriggerEngine::Capture>();
+    const qint64 ms = 1000000;
+    QVERIFY(!capture.truncated);
+    QCOMPARE(capture.samples.size(), 3001);
+    QCOMPARE(capture.samples.first().timeNs, START_NS + 3000 * ms);
+    QCOMPARE(capture.samples.last().timeNs, START_NS + 4500 * ms);
+    QVERIFY(engine.bufferedSamples() <= 2002);
+}
+
+void TestTriggerEngine::testFinishAndReset()
+{
+    TriggerEngine engine;
+    engine.setPreTriggerMs(0);
+    engine.setPostTriggerMs(60000);
+    QVERIFY(engine.addRule(rule("hot", TriggerEngine::Above, "0105", 100.0)));
+    QSignalSpy completed(&engine, &TriggerEngine::captureComplete);
+
+    engine.ingest(sample("0105", 105.0, 10));
+    engine.ingest(sample("0105", 106.0, 100));
+    QVERIFY(engine.isCapturing());
+    QVERIFY(completed.isEmpty());
+
+    // Streaming stops: keep what was recorded
+    engine.finishCapture();
+    QVERIFY(!engine.isCapturing());
+    QCOMPARE(completed.size(), 1);
+    QCOMPARE(completed.first().first().value<TriggerEngine::Capture>().samples.size(), 2);
+    engine.finishCapture();
+    QCOMPARE(completed.size(), 1);
+
+    // Reset forgets the rule was true, so the same value fires again
+    engine.reset();
+    QCOMPARE(engine.samplesIngested(), quint64(0));
+    QCOMPARE(engine.ruleCount(), 1);
+    engine.ingest(sample("0105", 106.0, 200));
+    QVERIFY(engine.isCapturing());
+}
+
+void TestTriggerEngine::testWriteCapture()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TriggerEngine engine;
+    engine.setPreTriggerMs(100);
+    engine.setPostTriggerMs(0);
+    engine.setCaptureDirectory(dir.path());
+    QVERIFY(engine.addRule(rule("Over rev!", TriggerEngine::Above, "010C", 3000.0)));
+    QSignalSpy written(&engine, &TriggerEngine::captureWritten);
+    QSignalSpy failed(&engine, &TriggerEngine::captureWriteFailed);
+
+    engine.ingest(sample("010C", 1000.0, 50));
+    engine.ingest(sample("010C", 1500.5, 100));
+    engine.ingest(sample("010C", 2000.0, 150));
+    engine.ingest(sample("010C", 4000.0, 200));
+    QTRY_COMPARE_WITH_TIMEOUT(written.size(), 1, 5000);
+    QVERIFY(failed.isEmpty());
+
+    const QString path = written.first().first().toString();
+    QCOMPARE(QFileInfo(path).fileName(), QString("capture-20231114-221320-200-Over_rev_.csv"));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+
+    QHash<QString, QString> header;
+    QStringList rows;
+    for (const QString& line : lines) {
+        if (line.startsWith("# ")) {
+            const int equals = line.indexOf('=');
+            header.insert(line.mid(2, equals - 2), line.mid(equals + 1));
+        } else {
+            rows.append(line);
+        }
+    }
+    QCOMPARE(header.value("format"), QString("obdread-capture-1"));
+    QCOMPARE(header.value("rule"), QString("Over rev!"));
+    QCOMPARE(header.value("trigger_time"), QString("2023-11-14T22:13:20.200Z"));
+    QCOMPARE(header.value("trigger_ns"), QString::number(START_NS + 200000000));
+    QCOMPARE(header.value("pre_trigger_ms"), QString("100"));
+    QCOMPARE(header.value("post_trigger_ms"), QString("0"));
+    QCOMPARE(header.value("samples"), QString("3"));
+    QCOMPARE(header.value("truncated"), QString("false"));
+    QCOMPARE(header.value("suppressed_triggers"), QString("0"));
+    QCOMPARE(rows, QStringList({
+        "time_ms,pid,value",
+        "-100.000,010C,1500.5",
+        "-50.000,010C,2000",
+        "0.000,010C,4000"
+    }));
+
+    // Unwritable directory
+    engine.setCaptureDirectory(dir.filePath("missing/nested"));
+    engine.ingest(sample("010C", 1000.0, 300));
+    engine.ingest(sample("010C", 4000.0, 350));
+    QTRY_COMPARE_WITH_TIMEOUT(failed.size(), 1, 5000);
+    QCOMPARE(written.size(), 1);
+}
+
+QTEST_MAIN(TestTriggerEngine)
+#include "tst_TriggerEngine.moc"
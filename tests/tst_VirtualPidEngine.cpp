@@ -0,0 +1,258 @@
+#include <QtTest/QtTest>
+#include <QRandomGenerator>
+#include "core/PidExpression.h"
+#include "core/SampleClock.h"
+#include "core/VirtualPidEngine.h"
+#include "TestSamples.h"
+#include <cmath>
+
+using TestSamples::sample;
+
+class TestVirtualPidEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testParse();
+    void testParseErrors_data();
+    void testParseErrors();
+    void testBatchMatchesRows();
+    void testSampleAndHold();
+    void testDefinitionRules();
+    void testFilters();
+
+private:
+};
+
+void TestVirtualPidEngine::testParse()
+{
+    QString error;
+    const PidExpression economy = PidExpression::parse("(vss*7.718)/maf", &error);
+    QVERIFY2(economy.isValid(), qPrintable(error));
+    QCOMPARE(economy.inputs(), QStringList({"010D", "0110"}));
+    QCOMPARE(economy.code().size(), 5);
+    QCOMPARE(economy.stackDepth(), 2);
+    const double row[] = {100.0, 20.0};
+    QCOMPARE(economy.evaluate(row), 100.0 * 7.718 / 20.0);
+
+    // Precedence and associativity
+    QCOMPARE(PidExpression::parse("1 + 2 * 3 ^ 2").evaluate(nullptr), 19.0);
+    QCOMPARE(PidExpression::parse("-2^2").evaluate(nullptr), -4.0);
+    QCOMPARE(PidExpression::parse("2^3^2").evaluate(nullptr), 512.0);
+    QCOMPARE(PidExpression::parse("10 - 4 - 3").evaluate(nullptr), 3.0);
+    QCOMPARE(PidExpression::parse("2 * -3 + 1e1").evaluate(nullptr), 4.0);
+    QCOMPARE(PidExpression::parse("max(1, min(5, 3)) + abs(-2.5)").evaluate(nullptr), 5.5);
+
+    // Ids in brackets, repeated inputs share a slot, repeated constants share an entry
+    const PidExpression raw = PidExpression::parse("[010c] * 2 + RPM / 2");
+    QVERIFY(raw.isValid());
+    QCOMPARE(raw.inputs(), QStringList({"010C"}));
+    QCOMPARE(raw.constants().size(), 1);
+    const double rpm[] = {3000.0};
+    QCOMPARE(raw.evaluate(rpm), 7500.0);
+}
+
+void TestVirtualPidEngine::testParseErrors_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::newRow("empty") << "";
+    QTest::newRow("dangling operator") << "rpm +";
+    QTest::newRow("unknown name") << "rpm * foo";
+    QTest::newRow("unclosed paren") << "(rpm";
+    QTest::newRow("unclosed bracket") << "[010C";
+    QTest::newRow("empty bracket") << "[ ]";
+    QTest::newRow("unknown function") << "sqrt(rpm)";
+    QTest::newRow("missing operator") << "1 2";
+    QTest::newRow("missing argument") << "min(rpm)";
+    QTest::newRow("bad number") << "1e";
+    QTest::newRow("stack too deep") << QString("1+(").repeated(70) + "1" + QString(")").repeated(70);
+    QTest::newRow("nested too deeply") << QString("-").repeated(100000) + "1";
+}
+
+void TestVirtualPidEngine::testParseErrors()
+{
+    QFETCH(QString, text);
+    QString error;
+    const PidExpression expression = PidExpression::parse(text, &error);
+    QVERIFY(!expression.isValid());
+    QVERIFY(!error.isEmpty());
+    QVERIFY(expression.code().isEmpty());
+}
+
+void TestVirtualPidEngine::testBatchMatchesRows()
+{
+    const PidExpression expression = PidExpression::parse("max(load, 1) * (rpm - 800) / -(maf + 1) ^ 0.5 + abs(vss - 50)");
+    QVERIFY(expression.isValid());
+    const int inputs = expression.inputs().size();
+    const int rows = 1000;
+
+    QRandomGenerator random(42);
+    QVector<QVector<double>> columns(inputs, QVector<double>(rows));
+    QVector<const double*> pointers;
+    for (QVector<double>& column : columns) {
+        for (double& value : column) {
+            value = random.bounded(5000.0);
+        }
+        pointers.append(column.constData());
+    }
+
+    QVector<double> out(rows);
+    QVector<double> scratch(expression.scratchSize(rows));
+    expression.evaluateBatch(pointers.constData(), rows, out.data(), scratch.data());
+
+    QVector<double> row(inputs);
+    for (int r = 0; r < rows; ++r) {
+        for (int k = 0; k < inputs; ++k) {
+            row[k] = columns[k][r];
+        }
+        QCOMPARE(out[r], expression.evaluate(row.constData()));
+    }
+}
+
+void TestVirtualPidEngine::testSampleAndHold()
+{
+    VirtualPidEngine engine;
+    VirtualPidEngine::Definition economy;
+    economy.pidId = "V_ECON";
+    economy.name = "Fuel economy";
+    economy.unit = "mpg";
+    economy.expression = "(vss*7.718)/maf";
+    economy.category = PidCategory::Fuel;
+    QVERIFY(engine.define(economy));
+    QCOMPARE(engine.inputPids(), QStringList({"010D", "0110"}));
+
+    // No value until both inputs were seen; then one per input sample
+    const QVector<PidSample> batch = {
+        sample("010D", 100.0, 0),
+        sample("010C", 2000.0, 10),     // Not an input
+        sample("0110", 20.0, 20),
+        sample("010D", 50.0, 30),
+        sample("0110", 0.0, 40),        // Division by zero: dropped
+        sample("0110", 10.0, 50)
+    };
+    const QVector<PidSample> derived = engine.process(batch);
+    QCOMPARE(derived.size(), 3);
+    QCOMPARE(derived[0].pidId, QString("V_ECON"));
+    QCOMPARE(derived[0].unit, QString("mpg"));
+    QCOMPARE(derived[0].value, 100.0 * 7.718 / 20.0);
+    QCOMPARE(derived[0].sampleTimeNs, TestSamples::START_NS + 20000000);
+    QCOMPARE(derived[0].timestamp, batch[2].timestamp);
+    QCOMPARE(derived[1].value, 50.0 * 7.718 / 20.0);
+    QCOMPARE(derived[2].value, 50.0 * 7.718 / 10.0);
+
+    // Held values carry over to the next batch, until reset()
+    QCOMPARE(engine.process({sample("010D", 60.0, 60)}).first().value, 60.0 * 7.718 / 10.0);
+    engine.reset();
+    QVERIFY(engine.process({sample("010D", 60.0, 70)}).isEmpty());
+
+    const QVector<PidMeta> metas = engine.pidMetas({"010C", "010D"});
+    QCOMPARE(metas.size(), 1);
+    QCOMPARE(metas[0].pidId, QString("V_ECON"));
+    QCOMPARE(metas[0].category, PidCategory::Fuel);
+    QVERIFY(metas[0].isVirtual);
+    QVERIFY(!metas[0].supported);     // No MAF on this vehicle
+    QVERIFY(engine.pidMetas({"010D", "0110"})[0].supported);
+}
+
+void TestVirtualPidEngine::testDefinitionRules()
+{
+    VirtualPidEngine engine;
+    QString error;
+
+    VirtualPidEngine::Definition definition;
+    QVERIFY(!engine.define(definition, &error));   // No id
+    QVERIFY(!error.isEmpty());
+
+    definition.pidId = "V_A";
+    definition.expression = "2 * 3";
+    QVERIFY(!engine.define(definition, &error));   // Reads nothing
+    definition.expression = "rpm +";
+    QVERIFY(!engine.define(definition, &error));
+    definition.expression = "[V_A] * 2";
+    QVERIFY(!engine.define(definition, &error));   // Itself
+
+    definition.expression = "rpm / 100";
+    QVERIFY(engine.define(definition, &error));
+    QVERIFY(error.isEmpty());
+    QVERIFY(engine.isVirtual("V_A"));
+
+    VirtualPidEngine::Definition other;
+    other.pidId = "V_B";
+    other.expression = "[V_A] + 1";
+    QVERIFY(!engine.define(other, &error));        // Virtual PIDs read real PIDs only
+    other.pidId = "010C";
+    other.expression = "vss";
+    QVERIFY(!engine.define(other, &error));        // Already a real input
+
+    // Redefinition replaces; removal forgets
+    definition.expression = "rpm / 10";
+    QVERIFY(engine.define(definition));
+    QCOMPARE(engine.count(), 1);
+    QCOMPARE(engine.process({sample("010C", 3000.0, 0)}).first().value, 300.0);
+    QVERIFY(engine.remove("V_A"));
+    QVERIFY(!engine.remove("V_A"));
+    QCOMPARE(engine.count(), 0);
+    QVERIFY(engine.inputPids().isEmpty());
+    QVERIFY(engine.process({sample("010C", 3000.0, 10)}).isEmpty());
+}
+
+void TestVirtualPidEngine::testFilters()
+{
+    VirtualPidEngine engine;
+    VirtualPidEngine::Definition definition;
+    definition.expression = "vss";
+
+    definition.pidId = "V_EMA";
+    definition.filter = VirtualPidEngine::Ema;
+    definition.timeConstantS = 1.0;
+    QVERIFY(engine.define(definition));
+
+    definition.pidId = "V_ACCEL";
+    definition.filter = VirtualPidEngine::Derivative;
+    QVERIFY(engine.define(definition));
+
+    definition.pidId = "V_DIST";
+    definition.expression = "vss / 3600";      // km/h to km/s
+    definition.filter = VirtualPidEngine::Integral;
+    QVERIFY(engine.define(definition));
+
+    // Speed steps from 0 to 36 km/h and holds for two seconds
+    const QVector<PidSample> derived = engine.process({
+        sample("010D", 0.0, 1000),
+        sample("010D", 36.0, 2000),
+        sample("010D", 36.0, 3000)
+    });
+
+    QHash<QString, QVector<double>> values;
+    for (const PidSample& s : derived) {
+        values[s.pidId].append(s.value);
+    }
+
+    QCOMPARE(values["V_EMA"].size(), 3);
+    QCOMPARE(values["V_EMA"][0], 0.0);
+    QVERIFY(qAbs(values["V_EMA"][1] - 36.0 * (1.0 - std::exp(-1.0))) < 1e-9);
+    QVERIFY(values["V_EMA"][2] > values["V_EMA"][1]);
+    QVERIFY(values["V_EMA"][2] < 36.0);
+
+    QCOMPARE(values["V_ACCEL"], QVector<double>({36.0, 0.0}));   // First sample has no rate
+
+    QCOMPARE(values["V_DIST"].size(), 3);
+    QCOMPARE(values["V_DIST"][0], 0.0);
+    QVERIFY(qAbs(values["V_DIST"][1] - 0.005) < 1e-12);           // Trapezoid over the step
+    QVERIFY(qAbs(values["V_DIST"][2] - 0.015) < 1e-12);
+
+    // An unstamped sample is timed on the monotonic clock when it is processed,
+    // never from its wall-clock timestamp
+    PidSample unstamped("010D", 36.0, QString());
+    unstamped.timestamp = QDateTime::currentDateTime();
+    const qint64 beforeNs = SampleClock::now();
+    const QVector<PidSample> late = engine.process({unstamped});
+    QVERIFY(!late.isEmpty());
+    for (const PidSample& s : late) {
+        QVERIFY(s.sampleTimeNs >= beforeNs);
+        QVERIFY(s.sampleTimeNs <= SampleClock::now());
+    }
+}
+
+QTEST_MAIN(TestVirtualPidEngine)
+#include "tst_VirtualPidEngine.moc"